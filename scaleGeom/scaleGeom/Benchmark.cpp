@@ -0,0 +1,58 @@
+#include "Benchmark.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+    struct BenchmarkEntry
+    {
+        const char* name;
+        scaleGeom::bench::BenchmarkFunction function;
+    };
+
+    // Function local so registration works regardless of static initialisation order.
+    std::vector<BenchmarkEntry>& registry()
+    {
+        static std::vector<BenchmarkEntry> entries;
+        return entries;
+    }
+
+    volatile const void* sink;
+}
+
+scaleGeom::bench::BenchmarkRegistrar::BenchmarkRegistrar(const char* name, BenchmarkFunction function)
+{
+    registry().push_back({ name, function });
+}
+
+int scaleGeom::bench::runBenchmarks(const char* filter)
+{
+    int run = 0;
+    for (const BenchmarkEntry& entry : registry())
+    {
+        if (filter && !std::strstr(entry.name, filter))
+            continue;
+        std::cout << "== " << entry.name << " ==" << std::endl;
+        entry.function();
+        std::cout << std::endl;
+        run++;
+    }
+    return run;
+}
+
+void scaleGeom::bench::doNotOptimize(const void* value)
+{
+    sink = value;
+}
+
+size_t scaleGeom::bench::problemSize(size_t defaultSize)
+{
+    const char* value = std::getenv("SCALEGEOM_BENCH_SIZE");
+    if (value && *value)
+        return static_cast<size_t>(std::strtoull(value, nullptr, 10));
+    return defaultSize;
+}
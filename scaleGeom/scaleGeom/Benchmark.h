@@ -0,0 +1,68 @@
+/*
+	Benchmark.h - Minimal Benchmark Harness
+
+	Overview:
+	Benchmarks live in *Benchmark.cpp files next to the code they measure and register themselves
+	with SCALEGEOM_BENCHMARK. They are run from the scaleGeom executable:
+
+		scaleGeom bench            runs every registered benchmark
+		scaleGeom bench <filter>   runs the benchmarks whose name contains <filter>
+
+	The harness only provides a wall clock timer, a registry and a guard against dead code
+	elimination; each benchmark prints its own figures.
+
+*/
+
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace scaleGeom {
+namespace bench {
+
+	// Wall clock stopwatch started on construction.
+	class Timer
+	{
+		std::chrono::steady_clock::time_point start;
+
+	public:
+
+		Timer() : start(std::chrono::steady_clock::now()) {}
+
+		// Restart the stopwatch.
+		void reset() { start = std::chrono::steady_clock::now(); }
+
+		// Seconds elapsed since construction or the last reset.
+		double seconds() const
+		{
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+	};
+
+	typedef void (*BenchmarkFunction)();
+
+	// Registers a benchmark at static initialisation time.
+	struct BenchmarkRegistrar
+	{
+		BenchmarkRegistrar(const char* name, BenchmarkFunction function);
+	};
+
+	// Run every benchmark whose name contains filter (all of them when filter is null). Returns the number run.
+	int runBenchmarks(const char* filter);
+
+	// Keep a computed value alive so the optimizer cannot remove the work that produced it.
+	void doNotOptimize(const void* value);
+
+	// Number of elements used by the benchmarks, overridable with the SCALEGEOM_BENCH_SIZE environment variable.
+	size_t problemSize(size_t defaultSize);
+
+} // Closing the bench namespace.
+} // Closing the scaleGeom namespace.
+
+// Define and register a benchmark function.
+#define SCALEGEOM_BENCHMARK(name) \
+	static void name(); \
+	static scaleGeom::bench::BenchmarkRegistrar name##Registrar(#name, &name); \
+	static void name()
@@ -0,0 +1,829 @@
+#include "Bvh.h"
+#include "Parallel.h"
+#include "VectorOrder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+    typedef scaleGeom::Bvh::Node Node;
+    typedef scaleGeom::Vector3f Vector3f;
+
+    // Centroid bins per axis evaluated by the SAH split search.
+    const unsigned BIN_COUNT = 16;
+
+    // Nodes with more triangles are always split; smaller ones become leaves when the SAH says so.
+    const uint32_t MAX_LEAF_SIZE = 8;
+
+    // Cost of visiting a node relative to one triangle test.
+    const float TRAVERSAL_COST = 1.0f;
+
+    // Nodes at least this large are bounded and binned in parallel.
+    const size_t PARALLEL_BIN_THRESHOLD = 1 << 16;
+
+    // Nodes at this depth become leaves whatever their size, which bounds the traversal stacks.
+    const unsigned MAX_DEPTH = 60;
+    const size_t STACK_SIZE = 64;
+
+    // Batches at least this large are traced in rayOrder rather than input order.
+    const size_t RAY_REORDER_THRESHOLD = 4096;
+
+    // Relative slack on a slab test's entry and exit distances, so that rounding in the box test cannot cull a
+    // triangle touching the box surface, nor one tying with the closest hit on a flat box (a few ulps; see Ize,
+    // "Robust BVH Ray Traversal").
+    const float SLAB_SLACK = 4 * FLT_EPSILON;
+
+    struct Box
+    {
+        float lower[3];
+        float upper[3];
+
+        void reset()
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                lower[axis] = FLT_MAX;
+                upper[axis] = -FLT_MAX;
+            }
+        }
+
+        void grow(const Box& other)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                lower[axis] = std::min(lower[axis], other.lower[axis]);
+                upper[axis] = std::max(upper[axis], other.upper[axis]);
+            }
+        }
+
+        void grow(const float* point)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                lower[axis] = std::min(lower[axis], point[axis]);
+                upper[axis] = std::max(upper[axis], point[axis]);
+            }
+        }
+
+        // Half the surface area; empty boxes have area 0.
+        float halfArea() const
+        {
+            float dx = std::max(upper[0] - lower[0], 0.0f);
+            float dy = std::max(upper[1] - lower[1], 0.0f);
+            float dz = std::max(upper[2] - lower[2], 0.0f);
+            return dx * dy + dy * dz + dz * dx;
+        }
+    };
+
+    struct Bin
+    {
+        Box bounds;
+        uint32_t count;
+    };
+
+    struct Bins
+    {
+        Bin bins[3][BIN_COUNT];
+
+        void reset()
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                for (unsigned b = 0; b < BIN_COUNT; b++)
+                {
+                    bins[axis][b].bounds.reset();
+                    bins[axis][b].count = 0;
+                }
+            }
+        }
+    };
+
+    // A triangle during the build: its box and input index. The items are partitioned themselves, rather than
+    // an index array into them, so every pass over a node reads memory sequentially.
+    struct BuildItem
+    {
+        Box box;
+        uint32_t index;
+
+        // Twice the box centre; only compared with other centroids, so the factor 1/2 is left out.
+        float centroid(int axis) const { return box.lower[axis] + box.upper[axis]; }
+    };
+
+    struct BuildTask
+    {
+        uint32_t node;
+        uint32_t begin;
+        uint32_t end;
+        unsigned depth;
+    };
+
+    class BvhBuilder
+    {
+        std::vector<Node>& nodes;
+        std::vector<BuildItem> items;
+        std::atomic<uint32_t> nodeCount;
+
+        // Bin index of centroid value c on an axis whose centroid range starts at lower.
+        static unsigned binIndex(float c, float lower, float scale)
+        {
+            int bin = static_cast<int>((c - lower) * scale);
+            return static_cast<unsigned>(std::min(std::max(bin, 0), static_cast<int>(BIN_COUNT) - 1));
+        }
+
+        void bound(size_t begin, size_t end, Box& box, Box& centroidBox) const
+        {
+            box.reset();
+            centroidBox.reset();
+            for (size_t i = begin; i < end; i++)
+            {
+                const BuildItem& item = items[i];
+                box.grow(item.box);
+                float centroid[3] = { item.centroid(0), item.centroid(1), item.centroid(2) };
+                centroidBox.grow(centroid);
+            }
+        }
+
+        void binRange(size_t begin, size_t end, const Box& centroidBox, const float* scale, Bins& bins) const
+        {
+            bins.reset();
+            for (size_t i = begin; i < end; i++)
+            {
+                const BuildItem& item = items[i];
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    Bin& bin = bins.bins[axis][binIndex(item.centroid(axis), centroidBox.lower[axis], scale[axis])];
+                    bin.bounds.grow(item.box);
+                    bin.count++;
+                }
+            }
+        }
+
+        void makeLeaf(const BuildTask& task)
+        {
+            Node& node = nodes[task.node];
+            node.first = task.begin;
+            node.count = task.end - task.begin;
+        }
+
+        // Bound the node and either split it, writing its two child tasks and returning true, or make it a leaf.
+        bool split(const BuildTask& task, BuildTask children[2], unsigned _threads)
+        {
+            const uint32_t count = task.end - task.begin;
+            const unsigned threads = count >= PARALLEL_BIN_THRESHOLD ? _threads : 1;
+
+            // Node box and centroid box.
+            Box box, centroidBox;
+            if (threads > 1)
+            {
+                std::vector<Box> partial(2 * size_t(threads));
+                unsigned chunks = scaleGeom::parallelChunks(task.begin, task.end, threads, PARALLEL_BIN_THRESHOLD / 4,
+                    [&](unsigned chunk, size_t begin, size_t end) {
+                        bound(begin, end, partial[2 * chunk], partial[2 * chunk + 1]);
+                    });
+                box = partial[0];
+                centroidBox = partial[1];
+                for (unsigned c = 1; c < chunks; c++)
+                {
+                    box.grow(partial[2 * c]);
+                    centroidBox.grow(partial[2 * c + 1]);
+                }
+            }
+            else
+            {
+                bound(task.begin, task.end, box, centroidBox);
+            }
+            Node& node = nodes[task.node];
+            std::copy(box.lower, box.lower + 3, node.lower);
+            std::copy(box.upper, box.upper + 3, node.upper);
+
+            if (count <= 1 || task.depth >= MAX_DEPTH)
+            {
+                makeLeaf(task);
+                return false;
+            }
+
+            float scale[3];
+            bool degenerate = true;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                // A zero (or denormal) extent has no usable bins.
+                float extent = centroidBox.upper[axis] - centroidBox.lower[axis];
+                scale[axis] = extent > 0 && BIN_COUNT / extent <= FLT_MAX ? BIN_COUNT / extent : 0.0f;
+                degenerate = degenerate && scale[axis] == 0;
+            }
+
+            // All centroids coincide: no plane separates them, so split the range in half.
+            if (degenerate)
+            {
+                if (count <= MAX_LEAF_SIZE)
+                {
+                    makeLeaf(task);
+                    return false;
+                }
+                return assignChildren(task, task.begin + count / 2, children);
+            }
+
+            // Bin the centroids along all three axes.
+            Bins bins;
+            if (threads > 1)
+            {
+                std::vector<Bins> partial(threads);
+                unsigned chunks = scaleGeom::parallelChunks(task.begin, task.end, threads, PARALLEL_BIN_THRESHOLD / 4,
+                    [&](unsigned chunk, size_t begin, size_t end) {
+                        binRange(begin, end, centroidBox, scale, partial[chunk]);
+                    });
+                bins = partial[0];
+                for (unsigned c = 1; c < chunks; c++)
+                {
+                    for (int axis = 0; axis < 3; axis++)
+                    {
+                        for (unsigned b = 0; b < BIN_COUNT; b++)
+                        {
+                            bins.bins[axis][b].bounds.grow(partial[c].bins[axis][b].bounds);
+                            bins.bins[axis][b].count += partial[c].bins[axis][b].count;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                binRange(task.begin, task.end, centroidBox, scale, bins);
+            }
+
+            // Sweep the bins from both ends; plane p separates bins [0, p) from [p, BIN_COUNT).
+            float bestCost = FLT_MAX;
+            int bestAxis = -1;
+            unsigned bestPlane = 0;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (scale[axis] == 0)
+                    continue;
+
+                const Bin* axisBins = bins.bins[axis];
+                float rightCost[BIN_COUNT];
+                Box right;
+                right.reset();
+                uint32_t rightCount = 0;
+                for (unsigned p = BIN_COUNT - 1; p > 0; p--)
+                {
+                    right.grow(axisBins[p].bounds);
+                    rightCount += axisBins[p].count;
+                    rightCost[p] = right.halfArea() * rightCount;
+                }
+
+                Box left;
+                left.reset();
+                uint32_t leftCount = 0;
+                for (unsigned p = 1; p < BIN_COUNT; p++)
+                {
+                    left.grow(axisBins[p - 1].bounds);
+                    leftCount += axisBins[p - 1].count;
+                    if (leftCount == 0 || leftCount == count)
+                        continue;
+                    float cost = left.halfArea() * leftCount + rightCost[p];
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestPlane = p;
+                    }
+                }
+            }
+
+            // Both costs are in units of triangle tests, relative to the probability of entering this node.
+            const float area = box.halfArea();
+            const float splitCost = area > 0 ? TRAVERSAL_COST + bestCost / area : TRAVERSAL_COST;
+            if (bestAxis < 0 || (count <= MAX_LEAF_SIZE && splitCost >= count))
+            {
+                if (count <= MAX_LEAF_SIZE)
+                {
+                    makeLeaf(task);
+                    return false;
+                }
+                if (bestAxis < 0)
+                    return assignChildren(task, task.begin + count / 2, children);
+            }
+
+            const float lower = centroidBox.lower[bestAxis];
+            const float axisScale = scale[bestAxis];
+            BuildItem* middle = std::partition(items.data() + task.begin, items.data() + task.end, [&](const BuildItem& item) {
+                return binIndex(item.centroid(bestAxis), lower, axisScale) < bestPlane;
+            });
+            return assignChildren(task, static_cast<uint32_t>(middle - items.data()), children);
+        }
+
+        bool assignChildren(const BuildTask& task, uint32_t middle, BuildTask children[2])
+        {
+            uint32_t left = nodeCount.fetch_add(2, std::memory_order_relaxed);
+            nodes[task.node].first = left;
+            nodes[task.node].count = 0;
+            children[0] = { left, task.begin, middle, task.depth + 1 };
+            children[1] = { left + 1, middle, task.end, task.depth + 1 };
+            return true;
+        }
+
+        void buildSubtree(const BuildTask& root)
+        {
+            std::vector<BuildTask> stack(1, root);
+            while (!stack.empty())
+            {
+                BuildTask task = stack.back();
+                stack.pop_back();
+                BuildTask children[2];
+                if (split(task, children, 1))
+                {
+                    stack.push_back(children[1]);
+                    stack.push_back(children[0]);
+                }
+            }
+        }
+
+    public:
+
+        explicit BvhBuilder(std::vector<Node>& _nodes) : nodes(_nodes), nodeCount(1) {}
+
+        // Build the tree into the node array; order receives the input index of each triangle in leaf order.
+        void build(const Vector3f* vertices, const uint32_t* indices, uint32_t triangleCount, unsigned threads, std::vector<uint32_t>& order)
+        {
+            items.resize(triangleCount);
+            scaleGeom::parallelFor(0, triangleCount, threads, 1 << 14, [&](size_t t) {
+                BuildItem& item = items[t];
+                item.box.reset();
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    const Vector3f& v = vertices[indices ? indices[3 * t + corner] : 3 * t + corner];
+                    float point[3] = { v[0], v[1], v[2] };
+                    item.box.grow(point);
+                }
+                item.index = static_cast<uint32_t>(t);
+            });
+
+            // A binary tree with at most one triangle per leaf has at most 2n - 1 nodes.
+            nodes.resize(std::max<size_t>(2 * size_t(triangleCount), 1));
+
+            // Split level by level while there are too few subtrees to keep every thread busy; the large
+            // nodes near the root are binned in parallel instead.
+            std::vector<BuildTask> tasks(1, BuildTask{ 0, 0, triangleCount, 0 });
+            std::vector<BuildTask> next;
+            while (!tasks.empty() && tasks.size() < 4 * size_t(threads))
+            {
+                next.clear();
+                for (const BuildTask& task : tasks)
+                {
+                    BuildTask children[2];
+                    if (split(task, children, threads))
+                    {
+                        next.push_back(children[0]);
+                        next.push_back(children[1]);
+                    }
+                }
+                tasks.swap(next);
+            }
+            scaleGeom::parallelFor(0, tasks.size(), threads, 1, [&](size_t i) {
+                buildSubtree(tasks[i]);
+            });
+
+            nodes.resize(nodeCount.load());
+            nodes.shrink_to_fit();
+            order.resize(triangleCount);
+            scaleGeom::parallelFor(0, triangleCount, threads, 1 << 14, [&](size_t i) {
+                order[i] = items[i].index;
+            });
+        }
+    };
+
+    // Ray with the reciprocal direction precomputed for slab tests. A zero direction component gives an
+    // infinite reciprocal; see slabInterval for how the resulting NaNs are handled.
+    struct SlabRay
+    {
+        float origin[3];
+        float inverse[3];
+
+        explicit SlabRay(const scaleGeom::Ray& ray)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                origin[axis] = ray.origin[axis];
+                inverse[axis] = 1.0f / ray.direction[axis];
+            }
+        }
+    };
+
+    // Clip [tNear, tFar] to one slab. The entry plane is chosen by the sign of the reciprocal, and the comparisons
+    // are written so that a NaN bound is ignored: 0 * inf = NaN only occurs for a ray parallel to the slab
+    // with its origin on a boundary plane, which is inside the slab (Williams et al., "An Efficient and Robust
+    // Ray-Box Intersection Algorithm").
+    inline void slabInterval(float lower, float upper, float origin, float inverse, float& tNear, float& tFar)
+    {
+        float t0 = (lower - origin) * inverse;
+        float t1 = (upper - origin) * inverse;
+        float entry = inverse >= 0 ? t0 : t1;
+        float exit = inverse >= 0 ? t1 : t0;
+        entry -= std::fabs(entry) * SLAB_SLACK;
+        exit += std::fabs(exit) * SLAB_SLACK;
+        tNear = entry > tNear ? entry : tNear;
+        tFar = exit < tFar ? exit : tFar;
+    }
+
+    // Whether the ray enters the node box within [tMin, tMax]; entry receives the entry distance.
+    inline bool slabTest(const Node& node, const SlabRay& ray, float tMin, float tMax, float& entry)
+    {
+        float tNear = tMin, tFar = tMax;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            slabInterval(node.lower[axis], node.upper[axis], ray.origin[axis], ray.inverse[axis], tNear, tFar);
+        }
+        entry = tNear;
+        return tNear <= tFar;
+    }
+
+    // Moller-Trumbore test of the ray against the triangle tri[0] + u * tri[1] + v * tri[2].
+    inline bool intersectTriangle(const Vector3f* tri, const Vector3f& origin, const Vector3f& direction,
+        float tMin, float tMax, float& t, float& u, float& v)
+    {
+        Vector3f p = scaleGeom::crossProduct3D(direction, tri[2]);
+        float det = scaleGeom::dotProduct(tri[1], p);
+        if (det == 0)
+            return false;
+        float invDet = 1.0f / det;
+        Vector3f s = origin - tri[0];
+        u = scaleGeom::dotProduct(s, p) * invDet;
+        if (!(u >= 0 && u <= 1))
+            return false;
+        Vector3f q = scaleGeom::crossProduct3D(s, tri[1]);
+        v = scaleGeom::dotProduct(direction, q) * invDet;
+        if (!(v >= 0 && u + v <= 1))
+            return false;
+        t = scaleGeom::dotProduct(tri[2], q) * invDet;
+        return t >= tMin && t <= tMax;
+    }
+
+    // Closest-hit acceptance: nearer, or equally near with a lower triangle index.
+    inline bool closer(float t, uint32_t triangle, const scaleGeom::RayHit& hit)
+    {
+        return t < hit.t || (t == hit.t && triangle < hit.triangle);
+    }
+
+    // A packet of rays in SoA form. Unused lanes have an empty interval and never hit anything.
+    struct Packet
+    {
+        float origin[3][scaleGeom::Bvh::PACKET_SIZE];
+        float inverse[3][scaleGeom::Bvh::PACKET_SIZE];
+        float tMin[scaleGeom::Bvh::PACKET_SIZE];
+        float tMax[scaleGeom::Bvh::PACKET_SIZE];
+    };
+
+    // Slab test of every lane against the node. Returns the mask of lanes that enter it; entry receives
+    // the smallest entry distance among them.
+    inline unsigned slabTest(const Node& node, const Packet& packet, float& entry)
+    {
+        const size_t LANES = scaleGeom::Bvh::PACKET_SIZE;
+        float tNear[LANES];
+        int enters[LANES];
+        for (size_t lane = 0; lane < LANES; lane++)
+        {
+            float tEntry = packet.tMin[lane], tExit = packet.tMax[lane];
+            for (int axis = 0; axis < 3; axis++)
+            {
+                slabInterval(node.lower[axis], node.upper[axis], packet.origin[axis][lane], packet.inverse[axis][lane], tEntry, tExit);
+            }
+            tNear[lane] = tEntry;
+            enters[lane] = tEntry <= tExit;
+        }
+        unsigned mask = 0;
+        entry = FLT_MAX;
+        for (size_t lane = 0; lane < LANES; lane++)
+        {
+            if (enters[lane])
+            {
+                mask |= 1u << lane;
+                entry = std::min(entry, tNear[lane]);
+            }
+        }
+        return mask;
+    }
+
+    // Order in which a large batch is traced: by direction octant, then Morton order of the origin, so each packet
+    // holds rays that start close together and point the same way. The radix sort is stable, so rays sharing an
+    // origin and octant (camera rays) keep their input order. Empty (input order) for small batches.
+    std::vector<uint32_t> rayOrder(const scaleGeom::Ray* rays, size_t count, unsigned threads)
+    {
+        if (count < RAY_REORDER_THRESHOLD)
+            return std::vector<uint32_t>();
+
+        Box bounds;
+        bounds.reset();
+        for (size_t i = 0; i < count; i++)
+        {
+            float origin[3] = { rays[i].origin[0], rays[i].origin[1], rays[i].origin[2] };
+            bounds.grow(origin);
+        }
+        const scaleGeom::SpatialKeyEncoder<float, scaleGeom::DIM3> encoder(Vector3f(bounds.lower[0], bounds.lower[1], bounds.lower[2]),
+            Vector3f(bounds.upper[0], bounds.upper[1], bounds.upper[2]));
+
+        // 3 octant bits above the top 60 of the 63 Morton bits.
+        std::vector<uint64_t> keys(count);
+        std::vector<uint32_t> order(count);
+        scaleGeom::parallelFor(0, count, threads, 1 << 14, [&](size_t i) {
+            const Vector3f& direction = rays[i].direction;
+            uint64_t octant = (direction[0] < 0) | (direction[1] < 0) << 1 | (direction[2] < 0) << 2;
+            keys[i] = octant << 60 | encoder.morton(rays[i].origin) >> 3;
+            order[i] = static_cast<uint32_t>(i);
+        });
+        scaleGeom::radixSort(keys.data(), order.data(), count, 63, threads);
+        return order;
+    }
+}
+
+void scaleGeom::Bvh::build(const Vector3f* vertices, const uint32_t* indices, size_t triangleCount, unsigned _threads)
+{
+    if (triangleCount >= NONE)
+        throw std::length_error("Bvh: triangle count exceeds 32-bit indices\n");
+
+    const unsigned threads = resolveThreadCount(_threads);
+    nodes.clear();
+    triangles.clear();
+    triangleIds.clear();
+    if (triangleCount == 0)
+        return;
+
+    BvhBuilder(nodes).build(vertices, indices, static_cast<uint32_t>(triangleCount), threads, triangleIds);
+
+    // Store the triangles in leaf order as a vertex and two edges.
+    triangles.resize(3 * triangleCount);
+    parallelFor(0, triangleCount, threads, 1 << 14, [&](size_t i) {
+        const size_t t = triangleIds[i];
+        const Vector3f& a = vertices[indices ? indices[3 * t] : 3 * t];
+        const Vector3f& b = vertices[indices ? indices[3 * t + 1] : 3 * t + 1];
+        const Vector3f& c = vertices[indices ? indices[3 * t + 2] : 3 * t + 2];
+        triangles[3 * i] = a;
+        triangles[3 * i + 1] = b - a;
+        triangles[3 * i + 2] = c - a;
+    });
+}
+
+scaleGeom::RayHit scaleGeom::Bvh::intersect(const Ray& ray) const
+{
+    RayHit hit = { NONE, ray.tMax, 0, 0 };
+    float entry;
+    const SlabRay slab(ray);
+    if (nodes.empty() || !slabTest(nodes[0], slab, ray.tMin, hit.t, entry))
+        return hit;
+
+    uint32_t stack[STACK_SIZE];
+    float stackEntry[STACK_SIZE];
+    size_t top = 0;
+    uint32_t current = 0;
+    while (true)
+    {
+        const Node& node = nodes[current];
+        if (node.count)
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; i++)
+            {
+                float t, u, v;
+                if (intersectTriangle(&triangles[3 * size_t(i)], ray.origin, ray.direction, ray.tMin, hit.t, t, u, v)
+                    && closer(t, triangleIds[i], hit))
+                {
+                    hit = { triangleIds[i], t, u, v };
+                }
+            }
+        }
+        else
+        {
+            float leftEntry, rightEntry;
+            bool left = slabTest(nodes[node.first], slab, ray.tMin, hit.t, leftEntry);
+            bool right = slabTest(nodes[node.first + 1], slab, ray.tMin, hit.t, rightEntry);
+            if (left && right)
+            {
+                // Visit the nearer child first; the other waits on the stack.
+                bool leftFirst = leftEntry <= rightEntry;
+                stack[top] = leftFirst ? node.first + 1 : node.first;
+                stackEntry[top++] = leftFirst ? rightEntry : leftEntry;
+                current = leftFirst ? node.first : node.first + 1;
+                continue;
+            }
+            if (left || right)
+            {
+                current = left ? node.first : node.first + 1;
+                continue;
+            }
+        }
+
+        // Pop the next subtree that can still hold a closer hit.
+        while (top && stackEntry[top - 1] > hit.t)
+        {
+            top--;
+        }
+        if (!top)
+            break;
+        current = stack[--top];
+    }
+    return hit;
+}
+
+bool scaleGeom::Bvh::occluded(const Ray& ray) const
+{
+    float entry;
+    const SlabRay slab(ray);
+    if (nodes.empty() || !slabTest(nodes[0], slab, ray.tMin, ray.tMax, entry))
+        return false;
+
+    uint32_t stack[STACK_SIZE];
+    size_t top = 0;
+    uint32_t current = 0;
+    while (true)
+    {
+        const Node& node = nodes[current];
+        if (node.count)
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; i++)
+            {
+                float t, u, v;
+                if (intersectTriangle(&triangles[3 * size_t(i)], ray.origin, ray.direction, ray.tMin, ray.tMax, t, u, v))
+                    return true;
+            }
+        }
+        else
+        {
+            float leftEntry, rightEntry;
+            bool left = slabTest(nodes[node.first], slab, ray.tMin, ray.tMax, leftEntry);
+            bool right = slabTest(nodes[node.first + 1], slab, ray.tMin, ray.tMax, rightEntry);
+            if (left && right)
+            {
+                stack[top++] = node.first + 1;
+                current = node.first;
+                continue;
+            }
+            if (left || right)
+            {
+                current = left ? node.first : node.first + 1;
+                continue;
+            }
+        }
+        if (!top)
+            return false;
+        current = stack[--top];
+    }
+}
+
+void scaleGeom::Bvh::tracePacket(const Ray* rays, size_t count, RayHit* hits, bool anyHit) const
+{
+    Packet packet;
+    for (size_t lane = 0; lane < PACKET_SIZE; lane++)
+    {
+        if (lane < count)
+        {
+            const SlabRay slab(rays[lane]);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                packet.origin[axis][lane] = slab.origin[axis];
+                packet.inverse[axis][lane] = slab.inverse[axis];
+            }
+            packet.tMin[lane] = rays[lane].tMin;
+            packet.tMax[lane] = rays[lane].tMax;
+            hits[lane] = { NONE, rays[lane].tMax, 0, 0 };
+        }
+        else
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                packet.origin[axis][lane] = 0;
+                packet.inverse[axis][lane] = 1;
+            }
+            packet.tMin[lane] = 1;
+            packet.tMax[lane] = 0;
+        }
+    }
+
+    float entry;
+    unsigned mask = nodes.empty() ? 0 : slabTest(nodes[0], packet, entry);
+    if (!mask)
+        return;
+
+    // Stack of subtrees with the lanes that entered them and their smallest entry distance.
+    uint32_t stack[STACK_SIZE];
+    unsigned stackMask[STACK_SIZE];
+    float stackEntry[STACK_SIZE];
+    size_t top = 0;
+    uint32_t current = 0;
+    while (true)
+    {
+        const Node& node = nodes[current];
+        if (node.count)
+        {
+            for (size_t lane = 0; lane < PACKET_SIZE; lane++)
+            {
+                if (!(mask >> lane & 1))
+                    continue;
+                const Ray& ray = rays[lane];
+                RayHit& hit = hits[lane];
+                for (uint32_t i = node.first; i < node.first + node.count; i++)
+                {
+                    float t, u, v;
+                    if (intersectTriangle(&triangles[3 * size_t(i)], ray.origin, ray.direction, packet.tMin[lane], packet.tMax[lane], t, u, v)
+                        && closer(t, triangleIds[i], hit))
+                    {
+                        hit = { triangleIds[i], t, u, v };
+                        if (anyHit)
+                        {
+                            // Retire the lane: its interval becomes empty.
+                            packet.tMin[lane] = 1;
+                            packet.tMax[lane] = 0;
+                            break;
+                        }
+                        packet.tMax[lane] = t;
+                    }
+                }
+            }
+        }
+        else
+        {
+            float leftEntry, rightEntry;
+            unsigned left = slabTest(nodes[node.first], packet, leftEntry) & mask;
+            unsigned right = slabTest(nodes[node.first + 1], packet, rightEntry) & mask;
+            if (left && right)
+            {
+                bool leftFirst = leftEntry <= rightEntry;
+                stack[top] = leftFirst ? node.first + 1 : node.first;
+                stackMask[top] = leftFirst ? right : left;
+                stackEntry[top++] = leftFirst ? rightEntry : leftEntry;
+                current = leftFirst ? node.first : node.first + 1;
+                mask = leftFirst ? left : right;
+                continue;
+            }
+            if (left || right)
+            {
+                current = left ? node.first : node.first + 1;
+                mask = left ? left : right;
+                continue;
+            }
+        }
+
+        // Pop the next subtree that some of its lanes can still hit closer than their current best.
+        while (top)
+        {
+            const unsigned lanes = stackMask[top - 1];
+            float furthest = -FLT_MAX;
+            for (size_t lane = 0; lane < PACKET_SIZE; lane++)
+            {
+                if (lanes >> lane & 1)
+                    furthest = std::max(furthest, packet.tMax[lane]);
+            }
+            if (stackEntry[top - 1] <= furthest)
+                break;
+            top--;
+        }
+        if (!top)
+            break;
+        top--;
+        current = stack[top];
+        mask = stackMask[top];
+    }
+}
+
+void scaleGeom::Bvh::intersectBatch(const Ray* rays, size_t count, RayHit* hits, unsigned _threads) const
+{
+    const std::vector<uint32_t> order = rayOrder(rays, count, resolveThreadCount(_threads));
+    const size_t packets = (count + PACKET_SIZE - 1) / PACKET_SIZE;
+    parallelFor(0, packets, _threads, 64, [&](size_t p) {
+        const size_t first = p * PACKET_SIZE;
+        const size_t lanes = std::min(PACKET_SIZE, count - first);
+        Ray packet[PACKET_SIZE]{};
+        RayHit packetHits[PACKET_SIZE];
+        for (size_t lane = 0; lane < lanes; lane++)
+        {
+            packet[lane] = rays[order.empty() ? first + lane : order[first + lane]];
+        }
+        tracePacket(packet, lanes, packetHits, false);
+        for (size_t lane = 0; lane < lanes; lane++)
+        {
+            hits[order.empty() ? first + lane : order[first + lane]] = packetHits[lane];
+        }
+    });
+}
+
+void scaleGeom::Bvh::occludedBatch(const Ray* rays, size_t count, uint8_t* occluded, unsigned _threads) const
+{
+    const std::vector<uint32_t> order = rayOrder(rays, count, resolveThreadCount(_threads));
+    const size_t packets = (count + PACKET_SIZE - 1) / PACKET_SIZE;
+    parallelFor(0, packets, _threads, 64, [&](size_t p) {
+        const size_t first = p * PACKET_SIZE;
+        const size_t lanes = std::min(PACKET_SIZE, count - first);
+        Ray packet[PACKET_SIZE]{};
+        RayHit packetHits[PACKET_SIZE];
+        for (size_t lane = 0; lane < lanes; lane++)
+        {
+            packet[lane] = rays[order.empty() ? first + lane : order[first + lane]];
+        }
+        tracePacket(packet, lanes, packetHits, true);
+        for (size_t lane = 0; lane < lanes; lane++)
+        {
+            occluded[order.empty() ? first + lane : order[first + lane]] = packetHits[lane].triangle != NONE;
+        }
+    });
+}
@@ -0,0 +1,127 @@
+/*
+	Bvh.h - Bounding Volume Hierarchy for Ray and Segment Queries
+
+	Overview:
+	Bvh accelerates ray and segment queries against a triangle mesh or triangle soup of Vector3f
+	vertices. It is built once and is read-only afterwards, so any number of threads may query
+	it at the same time.
+
+	Build:
+	Top-down binned SAH (surface area heuristic): each node bins the triangle centroids along
+	every axis and splits where the estimated traversal cost is lowest. Large nodes are binned in
+	parallel, and independent subtrees are built on separate threads.
+
+	Layout:
+	- Nodes are 32 bytes (box plus two 32-bit fields), two per cache line, in one flat array.
+	  The two children of a node are adjacent.
+	- Triangles are stored in leaf order as a vertex and two edges, the form the Moller-Trumbore
+	  test uses, so a leaf is one contiguous run.
+
+	Queries:
+	A ray is origin + t * direction for t in [tMin, tMax]; a segment from a to b is the ray with
+	direction b - a and t in [0, 1]. intersect() returns the closest hit, occluded() whether there
+	is any hit. The batched functions trace packets of consecutive rays together: the packet
+	walks the tree once, testing every node against all of its rays, which pays off for coherent
+	rays such as camera rays in tile order. Rays with equal hit distance on two triangles report
+	the lower triangle index, so results do not depend on the build's thread count.
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	// Ray (or segment) origin + t * direction, t in [tMin, tMax].
+	struct Ray
+	{
+		Vector3f origin;
+		Vector3f direction;
+		float tMin;
+		float tMax;
+	};
+
+	// Result of a closest-hit query. triangle is Bvh::NONE on a miss; u and v are the barycentric coordinates
+	// of the hit point relative to the triangle's second and third vertex.
+	struct RayHit
+	{
+		uint32_t triangle;
+		float t;
+		float u;
+		float v;
+	};
+
+	class Bvh
+	{
+	public:
+
+		static constexpr uint32_t NONE = 0xffffffffu;
+
+		// Rays traced together by the batched queries.
+		static constexpr size_t PACKET_SIZE = 8;
+
+		struct Node
+		{
+			float lower[3];
+
+			// Internal node: index of the left child (the right child follows it). Leaf: first triangle.
+			uint32_t first;
+
+			float upper[3];
+
+			// Number of triangles of a leaf; 0 for internal nodes.
+			uint32_t count;
+		};
+
+	private:
+
+		std::vector<Node> nodes;
+
+		// Three vectors per triangle in leaf order: the first vertex and the two edges leaving it.
+		std::vector<Vector3f> triangles;
+
+		// Input index of each triangle in leaf order.
+		std::vector<uint32_t> triangleIds;
+
+		void tracePacket(const Ray* rays, size_t count, RayHit* hits, bool anyHit) const;
+
+	public:
+
+		Bvh() {}
+
+		// Build over an indexed mesh: triangle i has vertices vertices[indices[3i]], [3i + 1] and [3i + 2]. With
+		// indices null the vertices are a triangle soup, three per triangle. See build().
+		Bvh(const Vector3f* vertices, const uint32_t* indices, size_t triangleCount, unsigned _threads = 0)
+		{
+			build(vertices, indices, triangleCount, _threads);
+		}
+
+		// Build, replacing the current contents. The triangles are copied; the arrays are not referenced afterwards.
+		// Throws std::length_error if triangleCount does not fit 32-bit indices.
+		void build(const Vector3f* vertices, const uint32_t* indices, size_t triangleCount, unsigned _threads = 0);
+
+		// Closest hit along the ray.
+		RayHit intersect(const Ray& ray) const;
+
+		// Whether the ray hits any triangle.
+		bool occluded(const Ray& ray) const;
+
+		// Closest hits of rays[0, count), traced in packets of PACKET_SIZE consecutive rays.
+		void intersectBatch(const Ray* rays, size_t count, RayHit* hits, unsigned _threads = 0) const;
+
+		// Any-hit results of rays[0, count) (1 = occluded), traced in packets.
+		void occludedBatch(const Ray* rays, size_t count, uint8_t* occluded, unsigned _threads = 0) const;
+
+		size_t triangleCount() const { return triangleIds.size(); }
+
+		const std::vector<Node>& nodeArray() const { return nodes; }
+	};
+
+	static_assert(sizeof(Bvh::Node) == 32, "Bvh nodes must stay 32 bytes");
+
+} // Closing the scaleGeom namespace.
@@ -0,0 +1,251 @@
+#include "Benchmark.h"
+#include "Bvh.h"
+#include "Parallel.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    // Height field over a side x side grid of quads, two triangles each, with bumps at several scales.
+    void terrain(size_t side, std::vector<scaleGeom::Vector3f>& vertices, std::vector<uint32_t>& indices)
+    {
+        vertices.clear();
+        indices.clear();
+        for (size_t j = 0; j <= side; j++)
+        {
+            for (size_t i = 0; i <= side; i++)
+            {
+                float x = static_cast<float>(i), y = static_cast<float>(j);
+                float height = 8.0f * std::sin(x * 0.02f) * std::cos(y * 0.03f) + 2.0f * std::sin(x * 0.3f + y * 0.2f)
+                    + 0.5f * std::cos(x * 1.7f - y * 1.3f);
+                vertices.push_back(scaleGeom::Vector3f(x, y, height));
+            }
+        }
+        for (size_t j = 0; j < side; j++)
+        {
+            for (size_t i = 0; i < side; i++)
+            {
+                uint32_t a = static_cast<uint32_t>(j * (side + 1) + i);
+                uint32_t b = a + 1, c = a + static_cast<uint32_t>(side + 1), d = c + 1;
+                indices.insert(indices.end(), { a, b, d, a, d, c });
+            }
+        }
+    }
+
+    // Camera rays over the whole terrain, ordered in 4 x 2 pixel tiles so each packet is one tile.
+    std::vector<scaleGeom::Ray> cameraRays(size_t side, size_t width, size_t height)
+    {
+        const float extent = static_cast<float>(side);
+        const scaleGeom::Vector3f eye(0.5f * extent, -0.3f * extent, 0.4f * extent);
+        std::vector<scaleGeom::Ray> rays;
+        rays.reserve(width * height);
+        for (size_t ty = 0; ty < height; ty += 2)
+        {
+            for (size_t tx = 0; tx < width; tx += 4)
+            {
+                for (size_t py = ty; py < ty + 2; py++)
+                {
+                    for (size_t px = tx; px < tx + 4; px++)
+                    {
+                        float u = (px + 0.5f) / width - 0.5f, v = (py + 0.5f) / height;
+                        scaleGeom::Vector3f target(extent * (0.5f + 1.2f * u), extent * v, 0.0f);
+                        rays.push_back({ eye, target - eye, 0.0f, 1e30f });
+                    }
+                }
+            }
+        }
+        return rays;
+    }
+
+    // Rays from random points above the terrain in random downward directions.
+    std::vector<scaleGeom::Ray> randomRays(size_t side, size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> position(0.0f, static_cast<float>(side));
+        std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+        std::vector<scaleGeom::Ray> rays(count);
+        for (scaleGeom::Ray& ray : rays)
+        {
+            ray = { scaleGeom::Vector3f(position(rng), position(rng), 20.0f),
+                scaleGeom::Vector3f(direction(rng), direction(rng), -1.0f), 0.0f, 1e30f };
+        }
+        return rays;
+    }
+
+    // Coplanar soup: random triangles in the plane z = 0, every fourth one repeated under a later index, so
+    // closest hits tie on the distance and flat boxes bound the leaves.
+    std::vector<scaleGeom::Vector3f> coplanarSoup(size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> position(0.0f, 100.0f), offset(-4.0f, 4.0f);
+        std::vector<scaleGeom::Vector3f> vertices;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i % 4 == 3)
+            {
+                vertices.insert(vertices.end(), vertices.end() - 9, vertices.end() - 6);
+                continue;
+            }
+            const float x = position(rng), y = position(rng);
+            vertices.push_back(scaleGeom::Vector3f(x, y, 0.0f));
+            vertices.push_back(scaleGeom::Vector3f(x + offset(rng), y + offset(rng), 0.0f));
+            vertices.push_back(scaleGeom::Vector3f(x + offset(rng), y + offset(rng), 0.0f));
+        }
+        return vertices;
+    }
+
+    // Closest hit by testing every triangle, with the Moller-Trumbore test and tie rule of Bvh.
+    scaleGeom::RayHit bruteForce(const std::vector<scaleGeom::Vector3f>& vertices, const scaleGeom::Ray& ray)
+    {
+        scaleGeom::RayHit hit = { scaleGeom::Bvh::NONE, ray.tMax, 0, 0 };
+        for (uint32_t i = 0; i < vertices.size() / 3; i++)
+        {
+            const scaleGeom::Vector3f e1 = vertices[3 * i + 1] - vertices[3 * i], e2 = vertices[3 * i + 2] - vertices[3 * i];
+            const scaleGeom::Vector3f p = scaleGeom::crossProduct3D(ray.direction, e2);
+            const float det = scaleGeom::dotProduct(e1, p);
+            if (det == 0)
+                continue;
+            const float invDet = 1.0f / det;
+            const scaleGeom::Vector3f s = ray.origin - vertices[3 * i];
+            const float u = scaleGeom::dotProduct(s, p) * invDet;
+            if (!(u >= 0 && u <= 1))
+                continue;
+            const scaleGeom::Vector3f q = scaleGeom::crossProduct3D(s, e1);
+            const float v = scaleGeom::dotProduct(ray.direction, q) * invDet;
+            if (!(v >= 0 && u + v <= 1))
+                continue;
+            const float t = scaleGeom::dotProduct(e2, q) * invDet;
+            if (t >= ray.tMin && t <= hit.t && (t < hit.t || i < hit.triangle))
+                hit = { i, t, u, v };
+        }
+        return hit;
+    }
+
+    void report(const char* label, unsigned threads, double seconds, size_t count, const char* unit)
+    {
+        std::cout << "  " << std::left << std::setw(32) << label << std::right
+            << std::setw(3) << threads << " threads "
+            << std::setw(9) << std::fixed << std::setprecision(2) << seconds * 1e3 << " ms  "
+            << std::setw(7) << std::setprecision(2) << count / seconds / 1e6 << " " << unit << std::endl;
+    }
+}
+
+SCALEGEOM_BENCHMARK(BvhRayCasting)
+{
+    const size_t triangleCount = scaleGeom::bench::problemSize(2000000);
+    const size_t side = std::max<size_t>(static_cast<size_t>(std::sqrt(triangleCount / 2.0)), 4);
+    const unsigned hardware = scaleGeom::resolveThreadCount(0);
+    std::vector<scaleGeom::Vector3f> vertices;
+    std::vector<uint32_t> indices;
+    terrain(side, vertices, indices);
+    const size_t triangles = indices.size() / 3;
+    const std::vector<scaleGeom::Ray> camera = cameraRays(side, 1024, 1024);
+    const std::vector<scaleGeom::Ray> scattered = randomRays(side, camera.size(), 1);
+    std::cout << "  triangles: " << triangles << ", rays: " << camera.size() << std::endl;
+
+    scaleGeom::Bvh bvh;
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware))
+    {
+        Timer timer;
+        bvh.build(vertices.data(), indices.data(), triangles, threads);
+        report("build", threads, timer.seconds(), triangles, "Mtri/s");
+        if (threads == hardware)
+            break;
+    }
+    std::cout << "  nodes: " << bvh.nodeArray().size() << std::endl;
+
+    const struct { const char* single; const char* batch; const std::vector<scaleGeom::Ray>* rays; } sets[] = {
+        { "camera, one ray at a time", "camera, packets", &camera },
+        { "scattered, one ray at a time", "scattered, packets", &scattered },
+    };
+    std::vector<scaleGeom::RayHit> hits(camera.size());
+    for (const auto& set : sets)
+    {
+        const std::vector<scaleGeom::Ray>& rays = *set.rays;
+        {
+            Timer timer;
+            for (size_t i = 0; i < rays.size(); i++)
+            {
+                hits[i] = bvh.intersect(rays[i]);
+            }
+            report(set.single, 1, timer.seconds(), rays.size(), "Mrays/s");
+            scaleGeom::bench::doNotOptimize(hits.data());
+        }
+        for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware))
+        {
+            Timer timer;
+            bvh.intersectBatch(rays.data(), rays.size(), hits.data(), threads);
+            report(set.batch, threads, timer.seconds(), rays.size(), "Mrays/s");
+            scaleGeom::bench::doNotOptimize(hits.data());
+            if (threads == hardware)
+                break;
+        }
+    }
+
+    // Shadow segments from the camera hits towards a light: any-hit queries.
+    bvh.intersectBatch(camera.data(), camera.size(), hits.data(), hardware);
+    const scaleGeom::Vector3f light(0.0f, 0.0f, 4.0f * side);
+    std::vector<scaleGeom::Ray> shadows;
+    for (size_t i = 0; i < camera.size(); i++)
+    {
+        if (hits[i].triangle == scaleGeom::Bvh::NONE)
+            continue;
+        const scaleGeom::Ray& ray = camera[i];
+        scaleGeom::Vector3f point(ray.origin[0] + hits[i].t * ray.direction[0], ray.origin[1] + hits[i].t * ray.direction[1],
+            ray.origin[2] + hits[i].t * ray.direction[2]);
+        shadows.push_back({ point, light - point, 1e-4f, 1.0f });
+    }
+    std::vector<uint8_t> occluded(shadows.size());
+    {
+        Timer timer;
+        size_t blocked = 0;
+        for (size_t i = 0; i < shadows.size(); i++)
+        {
+            blocked += bvh.occluded(shadows[i]);
+        }
+        report("shadow segments, one at a time", 1, timer.seconds(), shadows.size(), "Mrays/s");
+        scaleGeom::bench::doNotOptimize(&blocked);
+    }
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware))
+    {
+        Timer timer;
+        bvh.occludedBatch(shadows.data(), shadows.size(), occluded.data(), threads);
+        report("shadow segments, packets", threads, timer.seconds(), shadows.size(), "Mrays/s");
+        scaleGeom::bench::doNotOptimize(occluded.data());
+        if (threads == hardware)
+            break;
+    }
+
+    // Closest hits on the coplanar soup against brute force, one ray at a time and in packets.
+    const std::vector<scaleGeom::Vector3f> soup = coplanarSoup(4096, 2);
+    std::vector<scaleGeom::Ray> down(20000);
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> position(0.0f, 100.0f), tilt(-0.5f, 0.5f);
+    for (scaleGeom::Ray& ray : down)
+    {
+        ray = { scaleGeom::Vector3f(position(rng), position(rng), 10.0f), scaleGeom::Vector3f(tilt(rng), tilt(rng), -1.0f), 0.0f, 1e30f };
+    }
+    std::vector<scaleGeom::RayHit> soupHits(down.size());
+    size_t mismatches = 0;
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware))
+    {
+        bvh.build(soup.data(), nullptr, soup.size() / 3, threads);
+        bvh.intersectBatch(down.data(), down.size(), soupHits.data(), threads);
+        for (size_t i = 0; i < down.size(); i++)
+        {
+            const scaleGeom::RayHit expected = bruteForce(soup, down[i]), single = bvh.intersect(down[i]);
+            mismatches += single.triangle != expected.triangle || single.t != expected.t;
+            mismatches += soupHits[i].triangle != expected.triangle || soupHits[i].t != expected.t;
+        }
+        if (threads == hardware)
+            break;
+    }
+    std::cout << "  coplanar soup, " << down.size() << " rays: " << (mismatches ? "MISMATCH " : "matches brute force") << (mismatches ? std::to_string(mismatches) : "") << std::endl;
+}
@@ -0,0 +1,269 @@
+#include "ConvexHull2D.h"
+#include "Parallel.h"
+#include "Predicates.h"
+#include "VectorOrder.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    // Chunks smaller than this are not worth a thread of their own.
+    const size_t MIN_CHUNK = 1 << 16;
+
+    // Candidate sets at least this large are radix sorted.
+    const size_t RADIX_SORT_THRESHOLD = 1 << 12;
+
+    // Error bound factor for the double precision cross product of float inputs, as in orient2d's filter.
+    const double CROSS_ERRBOUND = 3.3306690738754716e-16;
+
+    struct Point
+    {
+        double x, y;
+    };
+
+    inline Point load(const scaleGeom::Vector2f* points, size_t index)
+    {
+        const float* raw = reinterpret_cast<const float*>(points + index);
+        return { raw[0], raw[1] };
+    }
+
+    // True only if p is certainly strictly to the left of the directed line a -> b.
+    inline bool definitelyLeft(const Point& a, const Point& b, const Point& p)
+    {
+        double left = (b.x - a.x) * (p.y - a.y);
+        double right = (b.y - a.y) * (p.x - a.x);
+        double det = left - right;
+        return det > CROSS_ERRBOUND * (std::fabs(left) + std::fabs(right));
+    }
+
+    // A candidate hull vertex: its coordinates are kept next to the index so sorting stays cache friendly.
+    struct Entry
+    {
+        float x, y;
+        size_t index;
+    };
+
+    inline bool lexicographicLess(const Entry& a, const Entry& b)
+    {
+        if (a.x != b.x)
+            return a.x < b.x;
+        if (a.y != b.y)
+            return a.y < b.y;
+        return a.index < b.index;
+    }
+
+    // Sort by (x, y, index). Large inputs go through the radix sort on (x, y) keys; its stability makes that
+    // equivalent, because equal points always arrive in ascending index order (chunk survivors are scanned in
+    // order, and a merge puts the hull of the lower index range first).
+    void sortEntries(std::vector<Entry>& entries)
+    {
+        const size_t count = entries.size();
+        if (count < RADIX_SORT_THRESHOLD || count > 0xffffffffull)
+        {
+            std::sort(entries.begin(), entries.end(), lexicographicLess);
+            return;
+        }
+
+        std::vector<uint64_t> keys(count);
+        std::vector<uint32_t> order(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            keys[i] = scaleGeom::orderedKey(entries[i].x) << 32 | scaleGeom::orderedKey(entries[i].y);
+            order[i] = static_cast<uint32_t>(i);
+        }
+        scaleGeom::radixSort(keys.data(), order.data(), count, 64, 1);
+
+        std::vector<Entry> sorted(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            sorted[i] = entries[order[i]];
+        }
+        entries.swap(sorted);
+    }
+
+    // Exact orientation of three candidates.
+    inline double orient(const Entry& a, const Entry& b, const Entry& c)
+    {
+        const double pa[2] = { a.x, a.y }, pb[2] = { b.x, b.y }, pc[2] = { c.x, c.y };
+        return scaleGeom::orient2d(pa, pb, pc);
+    }
+
+    // Andrew's monotone chain over the candidates (reordered in place). Returns the hull, counterclockwise.
+    std::vector<Entry> monotoneChain(std::vector<Entry>& entries)
+    {
+        sortEntries(entries);
+
+        // Drop duplicate points, keeping the lowest index.
+        entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return a.x == b.x && a.y == b.y;
+        }), entries.end());
+
+        if (entries.size() < 3)
+            return entries;
+
+        std::vector<Entry> hull(2 * entries.size());
+        size_t k = 0;
+
+        // Lower hull.
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            while (k >= 2 && orient(hull[k - 2], hull[k - 1], entries[i]) <= 0)
+                k--;
+            hull[k++] = entries[i];
+        }
+
+        // Upper hull.
+        size_t lower = k + 1;
+        for (size_t i = entries.size() - 1; i-- > 0;)
+        {
+            while (k >= lower && orient(hull[k - 2], hull[k - 1], entries[i]) <= 0)
+                k--;
+            hull[k++] = entries[i];
+        }
+
+        // The last point is the first one again.
+        hull.resize(k - 1);
+        return hull;
+    }
+
+    // Hull of one chunk: drop the points strictly inside the octagon of extreme points, then run the monotone chain.
+    std::vector<Entry> chunkHull(const scaleGeom::Vector2f* points, size_t begin, size_t end)
+    {
+        // Points maximising -y, x - y, x, x + y, y, y - x, -x and -x - y. The directions turn counterclockwise,
+        // so the points do too. The scan only tracks values; the points are looked up afterwards.
+        float best[8];
+        for (int d = 0; d < 8; d++)
+        {
+            best[d] = -INFINITY;
+        }
+        const float* raw = reinterpret_cast<const float*>(points);
+        for (size_t i = begin; i < end; i++)
+        {
+            float x = raw[2 * i], y = raw[2 * i + 1];
+            best[0] = std::max(best[0], -y);
+            best[1] = std::max(best[1], x - y);
+            best[2] = std::max(best[2], x);
+            best[3] = std::max(best[3], x + y);
+            best[4] = std::max(best[4], y);
+            best[5] = std::max(best[5], y - x);
+            best[6] = std::max(best[6], -x);
+            best[7] = std::max(best[7], -x - y);
+        }
+        size_t extreme[8];
+        int missing = 8;
+        for (int d = 0; d < 8; d++)
+        {
+            extreme[d] = end;
+        }
+        for (size_t i = begin; i < end && missing; i++)
+        {
+            float x = raw[2 * i], y = raw[2 * i + 1];
+            const float values[8] = { -y, x - y, x, x + y, y, y - x, -x, -x - y };
+            for (int d = 0; d < 8; d++)
+            {
+                if (extreme[d] == end && values[d] == best[d])
+                {
+                    extreme[d] = i;
+                    missing--;
+                }
+            }
+        }
+        for (int d = 0; d < 8; d++)
+        {
+            // Only NaN input can leave a direction without a point.
+            if (extreme[d] == end)
+                extreme[d] = begin;
+        }
+
+        Point extremes[8];
+        for (int d = 0; d < 8; d++)
+        {
+            extremes[d] = load(points, extreme[d]);
+        }
+
+        // The extremes in direction order form a convex polygon (possibly with repeated vertices).
+        Point polygon[8];
+        int corners = 0;
+        for (int d = 0; d < 8; d++)
+        {
+            const Point& p = extremes[d];
+            if (corners == 0 || p.x != polygon[corners - 1].x || p.y != polygon[corners - 1].y)
+                polygon[corners++] = p;
+        }
+        if (corners > 1 && polygon[0].x == polygon[corners - 1].x && polygon[0].y == polygon[corners - 1].y)
+            corners--;
+
+        // Axis-aligned box inside the quadrilateral of the diagonal extremes (x - y, x + y, y - x, -x - y).
+        // Each box corner lies between the two quadrilateral vertices it is compared with, so the box is
+        // inside the quadrilateral using comparisons alone; points strictly inside it are skipped without
+        // the octagon test.
+        double left = std::max(extremes[5].x, extremes[7].x);
+        double right = std::min(extremes[1].x, extremes[3].x);
+        double bottom = std::max(extremes[7].y, extremes[1].y);
+        double top = std::min(extremes[3].y, extremes[5].y);
+
+        std::vector<Entry> survivors;
+        for (size_t i = begin; i < end; i++)
+        {
+            Point p = load(points, i);
+            if (p.x > left && p.x < right && p.y > bottom && p.y < top)
+                continue;
+            bool inside = corners >= 3;
+            for (int c = 0; c < corners && inside; c++)
+            {
+                inside = definitelyLeft(polygon[c], polygon[(c + 1) % corners], p);
+            }
+            if (!inside)
+                survivors.push_back({ static_cast<float>(p.x), static_cast<float>(p.y), i });
+        }
+
+        return monotoneChain(survivors);
+    }
+}
+
+std::vector<size_t> scaleGeom::convexHull2DIndices(const Vector2f* points, size_t count, unsigned _threads)
+{
+    if (count == 0)
+        return std::vector<size_t>();
+
+    unsigned threads = resolveThreadCount(_threads);
+    std::vector<std::vector<Entry>> hulls(std::max<size_t>(1, std::min<size_t>(threads, (count + MIN_CHUNK - 1) / MIN_CHUNK)));
+
+    parallelChunks(0, count, static_cast<unsigned>(hulls.size()), MIN_CHUNK, [&](unsigned chunk, size_t begin, size_t end) {
+        hulls[chunk] = chunkHull(points, begin, end);
+    });
+
+    // Pairwise merge tree; every level halves the number of hulls.
+    while (hulls.size() > 1)
+    {
+        size_t pairs = hulls.size() / 2;
+        std::vector<std::vector<Entry>> merged(pairs + hulls.size() % 2);
+        parallelFor(0, pairs, threads, 1, [&](size_t i) {
+            std::vector<Entry> both = hulls[2 * i];
+            both.insert(both.end(), hulls[2 * i + 1].begin(), hulls[2 * i + 1].end());
+            merged[i] = monotoneChain(both);
+        });
+        if (hulls.size() % 2)
+            merged.back() = std::move(hulls.back());
+        hulls.swap(merged);
+    }
+
+    std::vector<size_t> indices(hulls[0].size());
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        indices[i] = hulls[0][i].index;
+    }
+    return indices;
+}
+
+std::vector<scaleGeom::Vector2f> scaleGeom::convexHull2D(const Vector2f* points, size_t count, unsigned _threads)
+{
+    std::vector<size_t> indices = convexHull2DIndices(points, count, _threads);
+    std::vector<Vector2f> hull(indices.size());
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        hull[i] = points[indices[i]];
+    }
+    return hull;
+}
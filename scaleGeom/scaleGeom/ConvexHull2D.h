@@ -0,0 +1,48 @@
+/*
+	ConvexHull2D.h - Parallel 2D Convex Hull
+
+	Overview:
+	Computes the convex hull of a contiguous array of Vector2f with Andrew's monotone chain,
+	parallelised as a divide-and-conquer:
+
+	1. The input is split into one contiguous chunk per thread.
+	2. Each thread discards the points that lie strictly inside the octagon spanned by its
+	   chunk's extreme points (Akl-Toussaint heuristic), sorts the survivors and runs the
+	   monotone chain to get the chunk's hull.
+	3. The chunk hulls are merged pairwise, level by level, with the merges of a level running
+	   in parallel. A merge is the monotone chain over the union of two hulls.
+
+	All orientation decisions use the exact orient2d predicate, so nearly collinear input cannot
+	produce a non-convex or self-intersecting result; the interior filter of step 2 only drops a
+	point when a conservative double precision test proves it is strictly inside.
+
+	Output:
+	Indices into the input array of the hull vertices in counterclockwise order, starting at the
+	lexicographically smallest point (smallest x, then smallest y). Collinear points on hull edges
+	and duplicate points are not reported. Degenerate input yields one index (all points equal)
+	or two (all points collinear). Coordinates must not be NaN.
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	// Indices of the convex hull vertices of points[0, count), counterclockwise.
+	// _threads = 0 uses every hardware thread.
+	std::vector<size_t> convexHull2DIndices(const Vector2f* points, size_t count, unsigned _threads = 0);
+
+	// Convenience overload returning the hull vertices themselves.
+	std::vector<Vector2f> convexHull2D(const Vector2f* points, size_t count, unsigned _threads = 0);
+
+	inline std::vector<Vector2f> convexHull2D(const std::vector<Vector2f>& points, unsigned _threads = 0)
+	{
+		return convexHull2D(points.data(), points.size(), _threads);
+	}
+
+} // Closing the scaleGeom namespace.
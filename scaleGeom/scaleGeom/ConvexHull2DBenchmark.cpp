@@ -0,0 +1,89 @@
+#include "Benchmark.h"
+#include "ConvexHull2D.h"
+#include "Parallel.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    const int REPEATS = 3;
+
+    // Input families: few hull vertices (square, disk) and many hull vertices (circle).
+    enum Distribution { SQUARE, DISK, CIRCLE };
+    const char* const DISTRIBUTION_NAMES[] = { "uniform square", "uniform disk", "on circle" };
+
+    std::vector<scaleGeom::Vector2f> makePoints(size_t count, Distribution distribution)
+    {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        std::uniform_real_distribution<double> angle(0.0, 6.283185307179586);
+        std::vector<scaleGeom::Vector2f> points(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (distribution == CIRCLE)
+            {
+                double a = angle(rng);
+                points[i] = scaleGeom::Vector2f(static_cast<float>(1000.0 * std::cos(a)), static_cast<float>(1000.0 * std::sin(a)));
+                continue;
+            }
+            float x = dist(rng), y = dist(rng);
+            while (distribution == DISK && x * x + y * y > 1.0f)
+            {
+                x = dist(rng);
+                y = dist(rng);
+            }
+            points[i] = scaleGeom::Vector2f(1000.0f * x, 1000.0f * y);
+        }
+        return points;
+    }
+}
+
+SCALEGEOM_BENCHMARK(ConvexHull2DScaling)
+{
+    const size_t count = scaleGeom::bench::problemSize(10000000);
+    const unsigned hardware = scaleGeom::resolveThreadCount(0);
+    std::cout << "  points: " << count << ", hardware threads: " << hardware << std::endl;
+
+    for (int d = SQUARE; d <= CIRCLE; d++)
+    {
+        std::vector<scaleGeom::Vector2f> points = makePoints(count, static_cast<Distribution>(d));
+        std::vector<size_t> reference;
+        double serial = 0.0;
+
+        for (unsigned threads = 1; threads <= hardware; threads *= 2)
+        {
+            std::vector<size_t> hull;
+            double best = 1e30;
+            for (int r = 0; r < REPEATS; r++)
+            {
+                Timer timer;
+                hull = scaleGeom::convexHull2DIndices(points.data(), points.size(), threads);
+                best = std::min(best, timer.seconds());
+            }
+            if (threads == 1)
+            {
+                reference = hull;
+                serial = best;
+            }
+
+            std::cout << "  " << std::left << std::setw(16) << DISTRIBUTION_NAMES[d] << std::right
+                << std::setw(3) << threads << " threads "
+                << std::setw(9) << std::fixed << std::setprecision(2) << best * 1e3 << " ms  "
+                << std::setw(8) << std::setprecision(1) << count / best / 1e6 << " Mpts/s  "
+                << std::setw(5) << std::setprecision(2) << serial / best << "x  "
+                << hull.size() << " hull vertices"
+                << (hull == reference ? "" : "  MISMATCH") << std::endl;
+
+            if (threads == hardware)
+                break;
+            if (threads * 2 > hardware)
+                threads = hardware / 2;
+        }
+    }
+}
@@ -0,0 +1,501 @@
+#include "ConvexHull3D.h"
+#include "Predicates.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+    const uint32_t NONE = 0xffffffffu;
+
+    // Bound on the rounding error of the double precision plane test relative to its permanent.
+    // The exact factor is about 7 * 2^-53; this leaves a wide margin.
+    const double PLANE_ERRBOUND = 1e-14;
+
+    // Compact the conflict array once it holds this many dead entries and more dead than live ones.
+    const size_t MIN_COMPACTION = 1 << 20;
+
+    struct Face
+    {
+        // Plane through the first vertex a with normal (b - a) x (c - a), plus the sums of the absolute
+        // values of the products in each normal component, which scale the error bound.
+        double ax, ay, az;
+        double nx, ny, nz;
+        double mx, my, mz;
+
+        // Range of the conflict list in the flat conflict array.
+        uint32_t conflictBegin;
+        uint32_t conflictCount;
+
+        // The outside point furthest from the plane and its height (distance times |normal|).
+        uint32_t furthest;
+        double furthestHeight;
+
+        // Horizon search bookkeeping: visible is valid when visitStamp equals the current stamp.
+        uint32_t visitStamp;
+        bool visible;
+        bool alive;
+    };
+
+    // Half-edge h belongs to face h / 3; its successor in the face is the next index modulo 3.
+    inline uint32_t nextEdge(uint32_t h)
+    {
+        return h % 3 == 2 ? h - 2 : h + 1;
+    }
+
+    class Quickhull
+    {
+        const float* raw;
+        size_t count;
+
+        // Face pool, with the half-edge pool laid out alongside (3 per face).
+        std::vector<Face> faces;
+        std::vector<uint32_t> origin;
+        std::vector<uint32_t> twin;
+        std::vector<uint32_t> freeFaces;
+
+        // Flat conflict lists and the number of entries still referenced by live faces.
+        std::vector<uint32_t> conflicts;
+        size_t liveConflicts = 0;
+
+        // Faces that may still have outside points.
+        std::vector<uint32_t> pending;
+        uint32_t stamp = 0;
+
+        // Scratch buffers reused by every iteration.
+        struct Frame
+        {
+            uint32_t edge;
+            uint32_t remaining;
+        };
+        std::vector<Frame> stack;
+        std::vector<uint32_t> visibleFaces;
+        std::vector<uint32_t> horizon;
+        std::vector<uint32_t> newFaces;
+        std::vector<uint32_t> orphans;
+        std::vector<uint32_t> targets;
+        std::vector<uint32_t> cursors;
+        std::vector<double> planes;
+
+        void load(uint32_t p, double* out) const
+        {
+            out[0] = raw[3 * p];
+            out[1] = raw[3 * p + 1];
+            out[2] = raw[3 * p + 2];
+        }
+
+        // Height of point p above face f: positive exactly when p is strictly outside.
+        double height(uint32_t f, uint32_t p) const
+        {
+            const Face& face = faces[f];
+            double wx = raw[3 * p] - face.ax;
+            double wy = raw[3 * p + 1] - face.ay;
+            double wz = raw[3 * p + 2] - face.az;
+            double det = face.nx * wx + face.ny * wy + face.nz * wz;
+            double bound = PLANE_ERRBOUND * (face.mx * std::fabs(wx) + face.my * std::fabs(wy) + face.mz * std::fabs(wz));
+            if (det > bound || det < -bound)
+                return det;
+
+            double pa[3], pb[3], pc[3], pp[3];
+            load(origin[3 * f], pa);
+            load(origin[3 * f + 1], pb);
+            load(origin[3 * f + 2], pc);
+            load(p, pp);
+            return -scaleGeom::orient3d(pa, pb, pc, pp);
+        }
+
+        uint32_t allocateFace(uint32_t a, uint32_t b, uint32_t c)
+        {
+            uint32_t f;
+            if (!freeFaces.empty())
+            {
+                f = freeFaces.back();
+                freeFaces.pop_back();
+            }
+            else
+            {
+                f = static_cast<uint32_t>(faces.size());
+                faces.emplace_back();
+                origin.resize(origin.size() + 3);
+                twin.resize(twin.size() + 3);
+            }
+
+            origin[3 * f] = a;
+            origin[3 * f + 1] = b;
+            origin[3 * f + 2] = c;
+            twin[3 * f] = twin[3 * f + 1] = twin[3 * f + 2] = NONE;
+
+            double pa[3], pb[3], pc[3];
+            load(a, pa);
+            load(b, pb);
+            load(c, pc);
+            double ux = pb[0] - pa[0], uy = pb[1] - pa[1], uz = pb[2] - pa[2];
+            double vx = pc[0] - pa[0], vy = pc[1] - pa[1], vz = pc[2] - pa[2];
+
+            Face& face = faces[f];
+            face.ax = pa[0];
+            face.ay = pa[1];
+            face.az = pa[2];
+            face.nx = uy * vz - uz * vy;
+            face.ny = uz * vx - ux * vz;
+            face.nz = ux * vy - uy * vx;
+            face.mx = std::fabs(uy * vz) + std::fabs(uz * vy);
+            face.my = std::fabs(uz * vx) + std::fabs(ux * vz);
+            face.mz = std::fabs(ux * vy) + std::fabs(uy * vx);
+            face.conflictBegin = 0;
+            face.conflictCount = 0;
+            face.furthest = NONE;
+            face.furthestHeight = 0.0;
+            face.visitStamp = 0;
+            face.visible = false;
+            face.alive = true;
+            return f;
+        }
+
+        // Move each point of orphans into the conflict list of the first candidate face it is outside of.
+        // Points outside none of them are inside the hull and dropped. The candidates must have empty lists.
+        void distribute(const std::vector<uint32_t>& points, const std::vector<uint32_t>& candidates)
+        {
+            // Most points end up inside the new cone and are tested against every candidate, so the
+            // candidate planes are copied into one contiguous block for that loop.
+            const size_t stride = candidates.size();
+            planes.resize(9 * stride);
+            for (size_t c = 0; c < stride; c++)
+            {
+                const Face& face = faces[candidates[c]];
+                const double plane[9] = { face.ax, face.ay, face.az, face.nx, face.ny, face.nz, face.mx, face.my, face.mz };
+                for (int k = 0; k < 9; k++)
+                {
+                    planes[k * stride + c] = plane[k];
+                }
+            }
+
+            targets.resize(points.size());
+            for (size_t i = 0; i < points.size(); i++)
+            {
+                uint32_t p = points[i];
+                const double px = raw[3 * p], py = raw[3 * p + 1], pz = raw[3 * p + 2];
+                uint32_t target = NONE;
+                double h = 0.0;
+                for (size_t c = 0; c < stride; c++)
+                {
+                    double wx = px - planes[c], wy = py - planes[stride + c], wz = pz - planes[2 * stride + c];
+                    double det = planes[3 * stride + c] * wx + planes[4 * stride + c] * wy + planes[5 * stride + c] * wz;
+                    double bound = PLANE_ERRBOUND * (planes[6 * stride + c] * std::fabs(wx) + planes[7 * stride + c] * std::fabs(wy) + planes[8 * stride + c] * std::fabs(wz));
+                    if (det < -bound)
+                        continue;
+                    h = det > bound ? det : height(candidates[c], p);
+                    if (h > 0)
+                    {
+                        target = static_cast<uint32_t>(c);
+                        break;
+                    }
+                }
+                targets[i] = target;
+                if (target == NONE)
+                    continue;
+
+                Face& face = faces[candidates[target]];
+                face.conflictCount++;
+                if (face.furthest == NONE || h > face.furthestHeight)
+                {
+                    face.furthest = p;
+                    face.furthestHeight = h;
+                }
+            }
+
+            // Lay the new lists out back to back at the end of the conflict array.
+            cursors.resize(candidates.size());
+            size_t begin = conflicts.size();
+            for (uint32_t c = 0; c < candidates.size(); c++)
+            {
+                Face& face = faces[candidates[c]];
+                face.conflictBegin = static_cast<uint32_t>(begin);
+                cursors[c] = static_cast<uint32_t>(begin);
+                begin += face.conflictCount;
+                if (face.conflictCount)
+                    pending.push_back(candidates[c]);
+            }
+            liveConflicts += begin - conflicts.size();
+            conflicts.resize(begin);
+            for (size_t i = 0; i < points.size(); i++)
+            {
+                if (targets[i] != NONE)
+                    conflicts[cursors[targets[i]]++] = points[i];
+            }
+        }
+
+        // Drop the ranges of deleted faces from the conflict array.
+        void compactConflicts()
+        {
+            std::vector<uint32_t> compacted;
+            compacted.reserve(liveConflicts);
+            for (Face& face : faces)
+            {
+                if (!face.alive || !face.conflictCount)
+                    continue;
+                uint32_t begin = static_cast<uint32_t>(compacted.size());
+                compacted.insert(compacted.end(), conflicts.begin() + face.conflictBegin, conflicts.begin() + face.conflictBegin + face.conflictCount);
+                face.conflictBegin = begin;
+            }
+            conflicts.swap(compacted);
+        }
+
+        // Collect the faces visible from eye, starting at the visible face start, and the horizon
+        // half-edges (in visible faces, with a non-visible twin) in counterclockwise order.
+        void findHorizon(uint32_t start, uint32_t eye)
+        {
+            stamp++;
+            visibleFaces.clear();
+            horizon.clear();
+            faces[start].visitStamp = stamp;
+            faces[start].visible = true;
+            visibleFaces.push_back(start);
+            stack.push_back({ 3 * start, 3 });
+
+            while (!stack.empty())
+            {
+                Frame& top = stack.back();
+                if (top.remaining == 0)
+                {
+                    stack.pop_back();
+                    continue;
+                }
+                uint32_t h = top.edge;
+                top.edge = nextEdge(h);
+                top.remaining--;
+
+                uint32_t t = twin[h];
+                Face& neighbour = faces[t / 3];
+                if (neighbour.visitStamp != stamp)
+                {
+                    neighbour.visitStamp = stamp;
+                    neighbour.visible = height(t / 3, eye) > 0;
+                    if (neighbour.visible)
+                    {
+                        // Continue around the neighbour after the edge we came in through.
+                        visibleFaces.push_back(t / 3);
+                        stack.push_back({ nextEdge(t), 2 });
+                        continue;
+                    }
+                }
+                if (!neighbour.visible)
+                    horizon.push_back(h);
+            }
+        }
+
+        void addPoint(uint32_t start, uint32_t eye)
+        {
+            findHorizon(start, eye);
+
+            // Points released by the visible faces.
+            orphans.clear();
+            for (uint32_t f : visibleFaces)
+            {
+                const Face& face = faces[f];
+                for (uint32_t i = face.conflictBegin; i < face.conflictBegin + face.conflictCount; i++)
+                {
+                    if (conflicts[i] != eye)
+                        orphans.push_back(conflicts[i]);
+                }
+                liveConflicts -= face.conflictCount;
+            }
+
+            // Cone of new faces from the horizon to the eye, glued to the horizon and to each other.
+            newFaces.clear();
+            for (uint32_t h : horizon)
+            {
+                uint32_t f = allocateFace(origin[h], origin[nextEdge(h)], eye);
+                twin[3 * f] = twin[h];
+                twin[twin[h]] = 3 * f;
+                newFaces.push_back(f);
+            }
+            for (size_t i = 0; i < newFaces.size(); i++)
+            {
+                uint32_t f = newFaces[i];
+                uint32_t g = newFaces[(i + 1) % newFaces.size()];
+                twin[3 * f + 1] = 3 * g + 2;
+                twin[3 * g + 2] = 3 * f + 1;
+            }
+
+            for (uint32_t f : visibleFaces)
+            {
+                faces[f].alive = false;
+                faces[f].conflictCount = 0;
+                freeFaces.push_back(f);
+            }
+
+            distribute(orphans, newFaces);
+
+            size_t dead = conflicts.size() - liveConflicts;
+            if (dead > MIN_COMPACTION && dead > liveConflicts)
+                compactConflicts();
+        }
+
+        // Four affinely independent points, or false if the input is coplanar.
+        bool initialSimplex(uint32_t* simplex) const
+        {
+            // The pair of axis extremes furthest apart.
+            uint32_t extremes[6] = { 0, 0, 0, 0, 0, 0 };
+            for (uint32_t p = 1; p < count; p++)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    if (raw[3 * p + k] < raw[3 * extremes[2 * k] + k])
+                        extremes[2 * k] = p;
+                    if (raw[3 * p + k] > raw[3 * extremes[2 * k + 1] + k])
+                        extremes[2 * k + 1] = p;
+                }
+            }
+            double bestDistance = 0.0;
+            for (int i = 0; i < 6; i++)
+            {
+                for (int j = i + 1; j < 6; j++)
+                {
+                    double pi[3], pj[3];
+                    load(extremes[i], pi);
+                    load(extremes[j], pj);
+                    double distance = (pi[0] - pj[0]) * (pi[0] - pj[0]) + (pi[1] - pj[1]) * (pi[1] - pj[1]) + (pi[2] - pj[2]) * (pi[2] - pj[2]);
+                    if (distance > bestDistance)
+                    {
+                        bestDistance = distance;
+                        simplex[0] = extremes[i];
+                        simplex[1] = extremes[j];
+                    }
+                }
+            }
+            if (bestDistance == 0.0)
+                return false;
+
+            // The point furthest from that line, then the point furthest from the plane. These are only
+            // heuristics for a large starting volume; the exact test below decides degeneracy.
+            const scaleGeom::Vector3f* points = reinterpret_cast<const scaleGeom::Vector3f*>(raw);
+            scaleGeom::Vector3f a = points[simplex[0]];
+            scaleGeom::Vector3f ab = points[simplex[1]] - a;
+            float bestArea = -1.0f;
+            simplex[2] = simplex[0];
+            for (uint32_t p = 0; p < count; p++)
+            {
+                scaleGeom::Vector3f normal = scaleGeom::crossProduct3D(ab, points[p] - a);
+                float area = scaleGeom::dotProduct(normal, normal);
+                if (area > bestArea)
+                {
+                    bestArea = area;
+                    simplex[2] = p;
+                }
+            }
+            scaleGeom::Vector3f ac = points[simplex[2]] - a;
+            float bestVolume = -1.0f;
+            simplex[3] = simplex[0];
+            for (uint32_t p = 0; p < count; p++)
+            {
+                float volume = std::fabs(scaleGeom::scalarTripleProduct(ab, ac, points[p] - a));
+                if (volume > bestVolume)
+                {
+                    bestVolume = volume;
+                    simplex[3] = p;
+                }
+            }
+
+            double pa[3], pb[3], pc[3], pd[3];
+            load(simplex[0], pa);
+            load(simplex[1], pb);
+            load(simplex[2], pc);
+            load(simplex[3], pd);
+            if (scaleGeom::orient3d(pa, pb, pc, pd) != 0)
+                return true;
+
+            // Rounding hid the best candidates; any point off the plane will do.
+            for (uint32_t p = 0; p < count; p++)
+            {
+                load(p, pd);
+                if (scaleGeom::orient3d(pa, pb, pc, pd) != 0)
+                {
+                    simplex[3] = p;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    public:
+
+        Quickhull(const scaleGeom::Vector3f* points, size_t _count)
+            : raw(reinterpret_cast<const float*>(points)), count(_count)
+        {
+            static_assert(sizeof(scaleGeom::Vector3f) == 3 * sizeof(float), "Vector3f must be tightly packed");
+        }
+
+        scaleGeom::ConvexHullMesh run()
+        {
+            scaleGeom::ConvexHullMesh mesh;
+            uint32_t simplex[4];
+            if (count < 4 || !initialSimplex(simplex))
+                return mesh;
+
+            // Tetrahedron with every face oriented away from the opposite vertex.
+            const int corners[4][4] = { { 0, 1, 2, 3 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 }, { 2, 3, 0, 1 } };
+            for (int i = 0; i < 4; i++)
+            {
+                double pa[3], pb[3], pc[3], pd[3];
+                uint32_t a = simplex[corners[i][0]], b = simplex[corners[i][1]], c = simplex[corners[i][2]];
+                load(a, pa);
+                load(b, pb);
+                load(c, pc);
+                load(simplex[corners[i][3]], pd);
+                if (scaleGeom::orient3d(pa, pb, pc, pd) > 0)
+                    newFaces.push_back(allocateFace(a, b, c));
+                else
+                    newFaces.push_back(allocateFace(a, c, b));
+            }
+            for (uint32_t h = 0; h < 12; h++)
+            {
+                for (uint32_t g = 0; g < 12; g++)
+                {
+                    if (origin[h] == origin[nextEdge(g)] && origin[nextEdge(h)] == origin[g])
+                        twin[h] = g;
+                }
+            }
+
+            orphans.clear();
+            orphans.reserve(count);
+            for (uint32_t p = 0; p < count; p++)
+            {
+                if (p != simplex[0] && p != simplex[1] && p != simplex[2] && p != simplex[3])
+                    orphans.push_back(p);
+            }
+            distribute(orphans, newFaces);
+
+            while (!pending.empty())
+            {
+                uint32_t f = pending.back();
+                pending.pop_back();
+                if (faces[f].alive && faces[f].conflictCount)
+                    addPoint(f, faces[f].furthest);
+            }
+
+            for (uint32_t f = 0; f < faces.size(); f++)
+            {
+                if (!faces[f].alive)
+                    continue;
+                mesh.triangles.push_back(origin[3 * f]);
+                mesh.triangles.push_back(origin[3 * f + 1]);
+                mesh.triangles.push_back(origin[3 * f + 2]);
+            }
+            mesh.vertices = mesh.triangles;
+            std::sort(mesh.vertices.begin(), mesh.vertices.end());
+            mesh.vertices.erase(std::unique(mesh.vertices.begin(), mesh.vertices.end()), mesh.vertices.end());
+            return mesh;
+        }
+    };
+}
+
+scaleGeom::ConvexHullMesh scaleGeom::convexHull3D(const Vector3f* points, size_t count)
+{
+    if (count >= NONE)
+        throw std::length_error("convexHull3D: too many points for 32-bit indices\n");
+
+    Quickhull hull(points, count);
+    return hull.run();
+}
@@ -0,0 +1,63 @@
+/*
+	ConvexHull3D.h - 3D Convex Hull (Quickhull)
+
+	Overview:
+	Computes the convex hull of a contiguous array of Vector3f with the Quickhull algorithm
+	(Barber, Dobkin and Huhdanpaa). The implementation is laid out for large inputs:
+
+	- Faces are triangles kept in a pool; a deleted face's slot is reused by the next new face.
+	  The three half-edges of a face live at indices 3 * face .. 3 * face + 2 of the half-edge
+	  pool, so the next/previous links are implicit and only the twin is stored.
+	- Conflict lists (the outside points of each face) are ranges of one flat index array rather
+	  than per-face lists. Points released by deleted faces are redistributed in bulk into new
+	  ranges at the end of that array, which is compacted once dead ranges dominate it.
+	- The horizon is found with an iterative depth-first walk, so very large visible regions do
+	  not recurse.
+
+	Robustness:
+	A point is outside a face only if orient3d says so; each test first evaluates the face plane
+	in double precision with an error bound and calls the exact predicate only when that is
+	inconclusive. The hull is therefore convex for any input. Coplanar neighbouring triangles are
+	not merged, so with degenerate input (e.g. points on a grid) a point lying on a flat part of
+	the hull can still be a vertex if it was added before that part became flat.
+
+	Output:
+	An index-based triangle mesh referring to the input array, so no coordinates are copied.
+	Triangles are counterclockwise seen from outside. Fewer than four points, or input that is
+	entirely coplanar, yields an empty mesh. Coordinates must be finite.
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	// Convex hull as indices into the input point array.
+	struct ConvexHullMesh
+	{
+		// Three point indices per triangle, counterclockwise seen from outside.
+		std::vector<uint32_t> triangles;
+
+		// Indices of the points that are hull vertices, ascending.
+		std::vector<uint32_t> vertices;
+
+		size_t triangleCount() const { return triangles.size() / 3; }
+
+		bool empty() const { return triangles.empty(); }
+	};
+
+	// Convex hull of points[0, count). count must be below 2^32; throws std::length_error otherwise.
+	ConvexHullMesh convexHull3D(const Vector3f* points, size_t count);
+
+	inline ConvexHullMesh convexHull3D(const std::vector<Vector3f>& points)
+	{
+		return convexHull3D(points.data(), points.size());
+	}
+
+} // Closing the scaleGeom namespace.
@@ -0,0 +1,65 @@
+#include "Benchmark.h"
+#include "ConvexHull3D.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    // Input families: few hull vertices (cube, ball) and every point on the hull (sphere).
+    enum Distribution { CUBE, BALL, SPHERE };
+    const char* const DISTRIBUTION_NAMES[] = { "uniform cube", "uniform ball", "on sphere" };
+
+    std::vector<scaleGeom::Vector3f> makePoints(size_t count, Distribution distribution)
+    {
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        std::normal_distribution<float> normal;
+        std::vector<scaleGeom::Vector3f> points(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (distribution == SPHERE)
+            {
+                float x = normal(rng), y = normal(rng), z = normal(rng);
+                float length = std::sqrt(x * x + y * y + z * z);
+                points[i] = scaleGeom::Vector3f(100.0f * x / length, 100.0f * y / length, 100.0f * z / length);
+                continue;
+            }
+            float x = dist(rng), y = dist(rng), z = dist(rng);
+            while (distribution == BALL && x * x + y * y + z * z > 1.0f)
+            {
+                x = dist(rng);
+                y = dist(rng);
+                z = dist(rng);
+            }
+            points[i] = scaleGeom::Vector3f(100.0f * x, 100.0f * y, 100.0f * z);
+        }
+        return points;
+    }
+}
+
+SCALEGEOM_BENCHMARK(ConvexHull3DQuickhull)
+{
+    const size_t count = scaleGeom::bench::problemSize(5000000);
+    std::cout << "  points: " << count << " (sphere: " << count / 10 << ")" << std::endl;
+
+    for (int d = CUBE; d <= SPHERE; d++)
+    {
+        size_t n = d == SPHERE ? count / 10 : count;
+        std::vector<scaleGeom::Vector3f> points = makePoints(n, static_cast<Distribution>(d));
+
+        Timer timer;
+        scaleGeom::ConvexHullMesh hull = scaleGeom::convexHull3D(points);
+        double seconds = timer.seconds();
+
+        std::cout << "  " << std::left << std::setw(14) << DISTRIBUTION_NAMES[d] << std::right
+            << std::setw(9) << std::fixed << std::setprecision(2) << seconds * 1e3 << " ms  "
+            << std::setw(7) << std::setprecision(1) << n / seconds / 1e6 << " Mpts/s  "
+            << hull.triangleCount() << " triangles, " << hull.vertices.size() << " vertices" << std::endl;
+    }
+}
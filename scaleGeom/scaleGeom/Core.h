@@ -1,14 +1,13 @@
 #pragma once
 #include<math.h>
+#include "Tolerance.h"
 
-// Define a tolerance value for floating-point comparisons. 
-// This is to account for small discrepancies in floating-point arithmetic.
-#define TOLERANCE 0.0000001
+// Tolerances for floating-point comparisons are policies chosen per coordinate type (see Tolerance.h).
+// The double default, 1e-7, is the value of the former TOLERANCE macro.
 
-// A static function that checks the equality of two double values with respect to a tolerance.
-// The use of fabs computes the absolute difference between the two numbers.
-// If this difference is less than the defined tolerance, the numbers are considered equal.
+// A static function that checks the equality of two double values with respect to the default double tolerance.
+// Kept for existing callers; new code should use a tolerance policy directly.
 static bool IsEqualD(double a, double b)
 {
-	return fabs(a - b) < TOLERANCE;
-}
\ No newline at end of file
+	return scaleGeom::AbsoluteTolerance<double>()(a, b);
+}
@@ -0,0 +1,101 @@
+#include "CpuFeatures.h"
+
+#include <atomic>
+
+#if defined(SCALEGEOM_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+    scaleGeom::CpuFeatures detect()
+    {
+        scaleGeom::CpuFeatures features = { false, false, false, false };
+#if defined(SCALEGEOM_X86) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        features.sse41 = (info[2] & (1 << 19)) != 0;
+        features.fma = (info[2] & (1 << 12)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+
+        // The OS must save the YMM (and for AVX-512 the ZMM/opmask) state on context switches.
+        unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+        const bool ymmEnabled = (xcr0 & 0x6) == 0x6;
+        const bool zmmEnabled = (xcr0 & 0xe6) == 0xe6;
+
+        if (maxLeaf >= 7)
+        {
+            __cpuidex(info, 7, 0);
+            features.avx2 = avx && ymmEnabled && (info[1] & (1 << 5)) != 0;
+            features.avx512f = features.avx2 && zmmEnabled && (info[1] & (1 << 16)) != 0;
+        }
+        features.fma = features.fma && ymmEnabled;
+#elif defined(SCALEGEOM_X86)
+        // __builtin_cpu_supports already accounts for the OS enabled register state.
+        __builtin_cpu_init();
+        features.sse41 = __builtin_cpu_supports("sse4.1");
+        features.avx2 = __builtin_cpu_supports("avx2");
+        features.fma = __builtin_cpu_supports("fma");
+        features.avx512f = __builtin_cpu_supports("avx512f");
+#endif
+        return features;
+    }
+
+    scaleGeom::SimdLevel levelOf(const scaleGeom::CpuFeatures& features)
+    {
+        if (features.avx512f)
+            return scaleGeom::SimdLevel::AVX512;
+        if (features.avx2)
+            return scaleGeom::SimdLevel::AVX2;
+        if (features.sse41)
+            return scaleGeom::SimdLevel::SSE41;
+        return scaleGeom::SimdLevel::Scalar;
+    }
+
+    std::atomic<int>& forcedLevel()
+    {
+        static std::atomic<int> level(-1);
+        return level;
+    }
+}
+
+const scaleGeom::CpuFeatures& scaleGeom::cpuFeatures()
+{
+    static const CpuFeatures features = detect();
+    return features;
+}
+
+scaleGeom::SimdLevel scaleGeom::detectedSimdLevel()
+{
+    static const SimdLevel level = levelOf(cpuFeatures());
+    return level;
+}
+
+scaleGeom::SimdLevel scaleGeom::activeSimdLevel()
+{
+    int forced = forcedLevel().load(std::memory_order_relaxed);
+    return forced < 0 ? detectedSimdLevel() : static_cast<SimdLevel>(forced);
+}
+
+scaleGeom::SimdLevel scaleGeom::forceSimdLevel(SimdLevel level)
+{
+    if (level > detectedSimdLevel())
+        level = detectedSimdLevel();
+    forcedLevel().store(static_cast<int>(level), std::memory_order_relaxed);
+    return level;
+}
+
+const char* scaleGeom::simdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::SSE41: return "SSE4.1";
+    case SimdLevel::AVX2: return "AVX2";
+    case SimdLevel::AVX512: return "AVX-512";
+    default: return "scalar";
+    }
+}
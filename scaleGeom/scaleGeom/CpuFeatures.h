@@ -0,0 +1,68 @@
+/*
+	CpuFeatures.h - Runtime CPU Feature Detection
+
+	Overview:
+	Batch kernels are compiled for several instruction sets and the best one supported by the
+	running CPU (and enabled by the operating system) is picked the first time a kernel is called.
+	This header exposes the detected features, the selected SIMD level and a way to force a lower
+	level for benchmarking or for reproducing results of an older machine.
+
+	The SCALEGEOM_TARGET_* macros mark a single function as compiled for a given instruction set,
+	which GCC and Clang need to accept the intrinsics; MSVC accepts them without any annotation.
+
+*/
+
+
+#pragma once
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SCALEGEOM_X86 1
+#endif
+
+#if defined(SCALEGEOM_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SCALEGEOM_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SCALEGEOM_TARGET_AVX2 __attribute__((target("avx2")))
+#define SCALEGEOM_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define SCALEGEOM_TARGET_SSE41
+#define SCALEGEOM_TARGET_AVX2
+#define SCALEGEOM_TARGET_AVX512
+#endif
+
+namespace scaleGeom {
+
+	// Instruction set extensions usable by the current process.
+	struct CpuFeatures
+	{
+		bool sse41;
+		bool avx2;
+		bool fma;
+		bool avx512f;
+	};
+
+	// Kernel families, ordered from the most portable to the widest.
+	enum class SimdLevel
+	{
+		Scalar = 0,
+		SSE41 = 1,
+		AVX2 = 2,
+		AVX512 = 3
+	};
+
+	// Features of the CPU the process is running on, detected once.
+	const CpuFeatures& cpuFeatures();
+
+	// Widest SIMD level supported by the CPU.
+	SimdLevel detectedSimdLevel();
+
+	// SIMD level used by the batch kernels: the detected level unless a lower one was forced.
+	SimdLevel activeSimdLevel();
+
+	// Restrict the batch kernels to at most the given level (clamped to what the CPU supports).
+	// Returns the level actually selected.
+	SimdLevel forceSimdLevel(SimdLevel level);
+
+	// Human readable name of a SIMD level.
+	const char* simdLevelName(SimdLevel level);
+
+} // Closing the scaleGeom namespace.
@@ -0,0 +1,174 @@
+/*
+	Dedup.h - Hashed Spatial Deduplication of Points
+
+	Overview:
+	deduplicatePoints merges points that are equal under a tolerance policy (Tolerance.h) without
+	comparing every pair. Points are hashed into a uniform grid whose cell size is the policy's
+	reach at the largest coordinate magnitude of the input (times three), so two points that can
+	compare equal always lie in the same or in neighbouring cells, and only the neighbour on the
+	nearer side of each axis can matter. Each point is compared only with the unique points already
+	found in those 2^dimension cells.
+
+	Points are processed in input order and a point is merged into an earlier unique point it
+	equals, if there is one. Tolerance equality is not transitive, so the result depends on the
+	order of the input (a chain of points each within tolerance of the next is not collapsed into
+	one).
+
+	The hash table is a flat open-addressing table over the occupied cells, with the unique points
+	of one cell chained through an index array; no memory is allocated per point.
+
+	Usage:
+	std::vector<size_t> remap(points.size());
+	std::vector<scaleGeom::Vector3f> unique = scaleGeom::deduplicatePoints(points.data(), points.size(), remap.data(),
+		scaleGeom::AbsoluteTolerance<float>{ 1e-4f });
+	// points[i] was merged into unique[remap[i]].
+
+*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	namespace detail {
+
+		template<size_t dimension>
+		using DedupCell = std::array<int64_t, dimension>;
+
+		template<size_t dimension>
+		uint64_t hashDedupCell(const DedupCell<dimension>& cell)
+		{
+			uint64_t hash = 0x9e3779b97f4a7c15ull;
+			for (size_t i = 0; i < dimension; i++)
+			{
+				hash = (hash ^ static_cast<uint64_t>(cell[i])) * 0xff51afd7ed558ccdull;
+				hash ^= hash >> 32;
+			}
+			return hash;
+		}
+
+		// Grid cell of a coordinate given in cell units, clamped to a range where the neighbouring cells can still be formed.
+		inline int64_t dedupCellIndex(double scaled)
+		{
+			const double limit = 4.0e18;
+			return static_cast<int64_t>(std::max(-limit, std::min(limit, std::floor(scaled))));
+		}
+	}
+
+	// Unique points of points[0, count) under the tolerance policy, in order of first occurrence.
+	// If remap is not null, remap[i] receives the index of the unique point that points[i] was merged into.
+	template<class coordDataType, size_t dimension, class Policy = typename ToleranceTraits<coordDataType>::DefaultPolicy>
+	std::vector<Vector<coordDataType, dimension>> deduplicatePoints(const Vector<coordDataType, dimension>* points, size_t count,
+		size_t* remap = nullptr, const Policy& policy = Policy())
+	{
+		typedef detail::DedupCell<dimension> Cell;
+		const size_t NONE = std::numeric_limits<size_t>::max();
+
+		// Cell size: three times the policy's reach at the largest magnitude (a few times the magnitude's own
+		// precision for exact policies), so that only the neighbour on the nearer side of each axis can hold a match.
+		coordDataType magnitude = 0;
+		for (size_t p = 0; p < count; p++)
+		{
+			for (size_t i = 0; i < dimension; i++)
+			{
+				const coordDataType value = points[p][i] < 0 ? static_cast<coordDataType>(-points[p][i]) : points[p][i];
+				magnitude = value > magnitude ? value : magnitude;
+			}
+		}
+		double cellSize = 3.0 * static_cast<double>(policy.reach(magnitude));
+		if (!(cellSize > 0))
+			cellSize = magnitude > 0 ? static_cast<double>(magnitude) * std::numeric_limits<double>::epsilon() * 16 : 1.0;
+		const double inverseCellSize = 1.0 / cellSize;
+
+		std::vector<Vector<coordDataType, dimension>> unique;
+		std::vector<size_t> nextInCell;
+
+		// Open addressing table over the occupied cells: the cell and its most recent unique point. Grown at half load.
+		struct Slot
+		{
+			Cell cell;
+			size_t first;
+		};
+		std::vector<Slot> table(64, Slot{ Cell(), NONE });
+		size_t cellsUsed = 0;
+		auto findSlot = [&](const Cell& cell) -> size_t {
+			const size_t mask = table.size() - 1;
+			size_t slot = static_cast<size_t>(detail::hashDedupCell<dimension>(cell)) & mask;
+			while (table[slot].first != NONE && table[slot].cell != cell)
+			{
+				slot = (slot + 1) & mask;
+			}
+			return slot;
+		};
+
+		for (size_t p = 0; p < count; p++)
+		{
+			Cell home;
+			std::array<int64_t, dimension> side;
+			for (size_t i = 0; i < dimension; i++)
+			{
+				const double scaled = static_cast<double>(points[p][i]) * inverseCellSize;
+				home[i] = detail::dedupCellIndex(scaled);
+				side[i] = scaled - std::floor(scaled) < 0.5 ? -1 : 1;
+			}
+
+			// Search the 2^dimension cells between the home cell and its nearer neighbours.
+			size_t match = NONE;
+			for (size_t corner = 0; corner < (size_t(1) << dimension) && match == NONE; corner++)
+			{
+				Cell cell = home;
+				for (size_t i = 0; i < dimension; i++)
+				{
+					if (corner & (size_t(1) << i))
+						cell[i] += side[i];
+				}
+				const size_t slot = findSlot(cell);
+				for (size_t u = table[slot].first; u != NONE; u = nextInCell[u])
+				{
+					if (unique[u].equals(points[p], policy))
+					{
+						match = u;
+						break;
+					}
+				}
+			}
+
+			if (match == NONE)
+			{
+				if (2 * (cellsUsed + 1) > table.size())
+				{
+					std::vector<Slot> old(2 * table.size(), Slot{ Cell(), NONE });
+					old.swap(table);
+					for (const Slot& slot : old)
+					{
+						if (slot.first != NONE)
+							table[findSlot(slot.cell)] = slot;
+					}
+				}
+				match = unique.size();
+				const size_t slot = findSlot(home);
+				if (table[slot].first == NONE)
+				{
+					table[slot].cell = home;
+					cellsUsed++;
+				}
+				unique.push_back(points[p]);
+				nextInCell.push_back(table[slot].first);
+				table[slot].first = match;
+			}
+			if (remap)
+				remap[p] = match;
+		}
+		return unique;
+	}
+
+} // Closing the scaleGeom namespace.
@@ -0,0 +1,599 @@
+#include "Delaunay2D.h"
+#include "Parallel.h"
+#include "Predicates.h"
+#include "VectorOrder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+    const uint32_t NONE = scaleGeom::DelaunayMesh2D::NONE;
+
+    // Inputs smaller than this are triangulated sequentially.
+    const size_t MIN_PARALLEL = 1 << 16;
+
+    // Chunks smaller than this are not worth a thread of their own when preparing the input.
+    const size_t MIN_CHUNK = 1 << 16;
+
+    // The smallest BRIO round holds about this many points.
+    const size_t MIN_ROUND = 64;
+
+    // In parallel mode, the last PARALLEL_ROUNDS rounds (15/16 of the points) are inserted in strips.
+    const unsigned PARALLEL_ROUNDS = 4;
+
+    // Bits per axis of the Hilbert grid used for the insertion order.
+    const unsigned CURVE_AXIS_BITS = 16;
+
+    // Cavity boundaries up to this size are linked by a linear search, larger ones through a sorted table.
+    const size_t LINEAR_LINK = 32;
+
+    inline uint32_t next(uint32_t h) { return h % 3 == 2 ? h - 2 : h + 1; }
+
+    // Edge of a cavity's boundary, counterclockwise around the cavity, and the half-edge across it.
+    struct BoundaryEdge
+    {
+        uint32_t from, to, outer;
+    };
+
+    // Insertion state of one thread.
+    struct Inserter
+    {
+        // Triangle the next walk starts from.
+        uint32_t last = NONE;
+
+        // Unused slots reserved for this inserter. When empty, slots are appended (sequential insertion only).
+        uint32_t freshNext = 0, freshEnd = 0;
+
+        // Only triangles whose vertices all have x in [lo, hi) may be visited.
+        double lo = -std::numeric_limits<double>::infinity();
+        double hi = std::numeric_limits<double>::infinity();
+
+        uint64_t random = 0x9e3779b97f4a7c15ull;
+
+        std::vector<uint32_t> cavity, stack;
+        std::vector<BoundaryEdge> boundary;
+        std::vector<uint64_t> links;
+        std::vector<uint32_t> deferred;
+
+        unsigned nextRandom()
+        {
+            random ^= random << 13;
+            random ^= random >> 7;
+            random ^= random << 17;
+            return static_cast<unsigned>(random >> 32);
+        }
+    };
+
+    enum class Insertion { Inserted, Duplicate, Deferred };
+
+    // Triangulation closed by ghost triangles: every hull edge a -> b (interior on its left) has a ghost
+    // triangle (b, a, infinite) on its right, so that every half-edge has an opposite.
+    class Triangulation
+    {
+    public:
+
+        Triangulation(const double* _xy, uint32_t _count)
+            : xy(_xy), infinite(_count)
+        {
+        }
+
+        const double* xy;
+        const uint32_t infinite;
+
+        // Three vertices and three opposite half-edges per triangle slot, and the last point whose
+        // cavity the triangle was found in. Unused slots have vertex NONE.
+        std::vector<uint32_t> vertex, twin, mark;
+
+        const double* at(uint32_t v) const { return xy + 2 * static_cast<size_t>(v); }
+
+        bool isGhost(uint32_t t) const
+        {
+            return vertex[3 * t] == infinite || vertex[3 * t + 1] == infinite || vertex[3 * t + 2] == infinite;
+        }
+
+        bool accessible(uint32_t t, const Inserter& in) const
+        {
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                const uint32_t v = vertex[3 * t + k];
+                if (v != infinite && !(xy[2 * static_cast<size_t>(v)] >= in.lo && xy[2 * static_cast<size_t>(v)] < in.hi))
+                    return false;
+            }
+            return true;
+        }
+
+        // Initial triangle a, b, c (not collinear) and its three ghosts.
+        void start(uint32_t a, uint32_t b, uint32_t c)
+        {
+            if (scaleGeom::orient2d(at(a), at(b), at(c)) < 0)
+                std::swap(b, c);
+            vertex = { a, b, c, b, a, infinite, c, b, infinite, a, c, infinite };
+            twin = { 3, 6, 9, 0, 11, 7, 1, 5, 10, 2, 8, 4 };
+            mark.assign(4, NONE);
+        }
+
+        uint32_t allocate(Inserter& in)
+        {
+            if (in.freshNext < in.freshEnd)
+                return in.freshNext++;
+            const uint32_t t = static_cast<uint32_t>(vertex.size() / 3);
+            vertex.resize(vertex.size() + 3, NONE);
+            twin.resize(twin.size() + 3, NONE);
+            mark.push_back(NONE);
+            return t;
+        }
+
+        // Triangle containing p, or the ghost of a hull edge p lies strictly outside of; NONE if the walk
+        // leaves the inserter's range. Remembering stochastic walk: the edges are tried from a random one
+        // and the edge just crossed is skipped.
+        uint32_t locate(const double* p, Inserter& in) const
+        {
+            uint32_t t = in.last;
+            if (!accessible(t, in))
+                return NONE;
+            if (isGhost(t))
+            {
+                uint32_t k = 0;
+                while (vertex[3 * t + k] == infinite || vertex[3 * t + (k + 1) % 3] == infinite)
+                {
+                    k++;
+                }
+                t = twin[3 * t + k] / 3;
+                if (!accessible(t, in))
+                    return NONE;
+            }
+
+            uint32_t entered = NONE;
+            for (;;)
+            {
+                const unsigned first = in.nextRandom() % 3;
+                bool moved = false;
+                for (unsigned j = 0; j < 3 && !moved; j++)
+                {
+                    const uint32_t h = 3 * t + (first + j) % 3;
+                    if (h == entered || scaleGeom::orient2d(at(vertex[h]), at(vertex[next(h)]), p) >= 0)
+                        continue;
+                    const uint32_t across = twin[h];
+                    const uint32_t neighbour = across / 3;
+                    if (!accessible(neighbour, in))
+                        return NONE;
+                    if (isGhost(neighbour))
+                        return neighbour;
+                    t = neighbour;
+                    entered = across;
+                    moved = true;
+                }
+                if (!moved)
+                    return t;
+            }
+        }
+
+        // True if p lies strictly inside the circumcircle of t. For a ghost of the hull edge a -> b: p lies
+        // strictly right of the edge, or on the open segment.
+        bool conflict(uint32_t t, const double* p) const
+        {
+            const uint32_t* v = &vertex[3 * t];
+            if (v[0] != infinite && v[1] != infinite && v[2] != infinite)
+                return scaleGeom::inCircle(at(v[0]), at(v[1]), at(v[2]), p) > 0;
+
+            // Ghost (x, y, infinite) stands for the hull edge y -> x.
+            const uint32_t x = v[0] == infinite ? v[1] : v[1] == infinite ? v[2] : v[0];
+            const uint32_t y = v[0] == infinite ? v[2] : v[1] == infinite ? v[0] : v[1];
+            const double side = scaleGeom::orient2d(at(x), at(y), p);
+            if (side != 0)
+                return side > 0;
+            const double* a = at(x);
+            const double* b = at(y);
+            const int axis = a[0] != b[0] ? 0 : 1;
+            return std::min(a[axis], b[axis]) < p[axis] && p[axis] < std::max(a[axis], b[axis]);
+        }
+
+        Insertion insert(uint32_t point, Inserter& in)
+        {
+            const double* p = at(point);
+            const uint32_t start = locate(p, in);
+            if (start == NONE)
+                return Insertion::Deferred;
+            if (!isGhost(start))
+            {
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    const double* q = at(vertex[3 * start + k]);
+                    if (q[0] == p[0] && q[1] == p[1])
+                        return Insertion::Duplicate;
+                }
+            }
+
+            // Bowyer-Watson cavity: the connected triangles whose circumcircle holds p.
+            in.cavity.clear();
+            in.boundary.clear();
+            in.stack.clear();
+            mark[start] = point;
+            in.cavity.push_back(start);
+            in.stack.push_back(start);
+            while (!in.stack.empty())
+            {
+                const uint32_t t = in.stack.back();
+                in.stack.pop_back();
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    const uint32_t h = 3 * t + k;
+                    const uint32_t across = twin[h];
+                    const uint32_t neighbour = across / 3;
+                    if (mark[neighbour] == point)
+                        continue;
+                    if (!accessible(neighbour, in))
+                    {
+                        for (uint32_t c : in.cavity)
+                        {
+                            mark[c] = NONE;
+                        }
+                        return Insertion::Deferred;
+                    }
+                    if (conflict(neighbour, p))
+                    {
+                        mark[neighbour] = point;
+                        in.cavity.push_back(neighbour);
+                        in.stack.push_back(neighbour);
+                    }
+                    else
+                    {
+                        in.boundary.push_back({ vertex[h], vertex[next(h)], across });
+                    }
+                }
+            }
+
+            // Fan from p to the boundary: the cavity's slots plus two new ones.
+            const size_t edges = in.boundary.size();
+            while (in.cavity.size() < edges)
+            {
+                in.cavity.push_back(allocate(in));
+            }
+            for (size_t j = 0; j < edges; j++)
+            {
+                const uint32_t t = in.cavity[j];
+                const BoundaryEdge& e = in.boundary[j];
+                vertex[3 * t] = e.from;
+                vertex[3 * t + 1] = e.to;
+                vertex[3 * t + 2] = point;
+                twin[3 * t] = e.outer;
+                twin[e.outer] = 3 * t;
+            }
+
+            // Half-edge to -> p of the triangle on edge j is opposite p -> to of the triangle on the edge leaving to.
+            if (edges <= LINEAR_LINK)
+            {
+                for (size_t j = 0; j < edges; j++)
+                {
+                    size_t k = 0;
+                    while (in.boundary[k].from != in.boundary[j].to)
+                    {
+                        k++;
+                    }
+                    twin[3 * in.cavity[j] + 1] = 3 * in.cavity[k] + 2;
+                    twin[3 * in.cavity[k] + 2] = 3 * in.cavity[j] + 1;
+                }
+            }
+            else
+            {
+                in.links.resize(edges);
+                for (size_t j = 0; j < edges; j++)
+                {
+                    in.links[j] = static_cast<uint64_t>(in.boundary[j].from) << 32 | j;
+                }
+                std::sort(in.links.begin(), in.links.end());
+                for (size_t j = 0; j < edges; j++)
+                {
+                    const uint64_t key = static_cast<uint64_t>(in.boundary[j].to) << 32;
+                    const size_t k = static_cast<uint32_t>(*std::lower_bound(in.links.begin(), in.links.end(), key));
+                    twin[3 * in.cavity[j] + 1] = 3 * in.cavity[k] + 2;
+                    twin[3 * in.cavity[k] + 2] = 3 * in.cavity[j] + 1;
+                }
+            }
+
+            in.last = in.cavity[0];
+            for (size_t j = 0; j < edges; j++)
+            {
+                if (in.boundary[j].from != infinite && in.boundary[j].to != infinite)
+                {
+                    in.last = in.cavity[j];
+                    break;
+                }
+            }
+            return Insertion::Inserted;
+        }
+
+        // Real triangles with their adjacency, renumbered densely; vertex v is point original[v].
+        scaleGeom::DelaunayMesh2D extract(const uint32_t* original) const
+        {
+            // Triangles are numbered in the order of their last inserted vertex (a counting sort), so that most
+            // follow the Hilbert order of the final rounds and the triangles around a point are close in memory.
+            const size_t slots = vertex.size() / 3;
+            std::vector<uint32_t> renumber(slots, NONE);
+            std::vector<uint32_t> start(static_cast<size_t>(infinite) + 1, 0);
+            for (size_t t = 0; t < slots; t++)
+            {
+                if (vertex[3 * t] != NONE && !isGhost(static_cast<uint32_t>(t)))
+                    start[std::max(std::max(vertex[3 * t], vertex[3 * t + 1]), vertex[3 * t + 2])]++;
+            }
+            uint32_t triangles = 0;
+            for (uint32_t& s : start)
+            {
+                const uint32_t n = s;
+                s = triangles;
+                triangles += n;
+            }
+            for (size_t t = 0; t < slots; t++)
+            {
+                if (vertex[3 * t] != NONE && !isGhost(static_cast<uint32_t>(t)))
+                    renumber[t] = start[std::max(std::max(vertex[3 * t], vertex[3 * t + 1]), vertex[3 * t + 2])]++;
+            }
+
+            scaleGeom::DelaunayMesh2D mesh;
+            mesh.triangles.resize(3 * static_cast<size_t>(triangles));
+            mesh.halfedges.resize(3 * static_cast<size_t>(triangles));
+            for (size_t t = 0; t < slots; t++)
+            {
+                if (renumber[t] == NONE)
+                    continue;
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    const uint32_t across = twin[3 * t + k];
+                    const uint32_t neighbour = renumber[across / 3];
+                    mesh.triangles[3 * renumber[t] + k] = original[vertex[3 * t + k]];
+                    mesh.halfedges[3 * renumber[t] + k] = neighbour == NONE ? NONE : 3 * neighbour + across % 3;
+                }
+            }
+            return mesh;
+        }
+    };
+
+    // Position of cell (x, y) along a Hilbert curve over a 2^CURVE_AXIS_BITS grid. Insertion order only needs
+    // a coarse curve, which is much cheaper than SpatialKeyEncoder's full 32 bits per axis.
+    inline uint64_t hilbertIndex(uint32_t x, uint32_t y)
+    {
+        const uint32_t n = 1u << CURVE_AXIS_BITS;
+        uint64_t d = 0;
+        for (uint32_t s = n >> 1; s > 0; s >>= 1)
+        {
+            const uint32_t rx = (x & s) ? 1 : 0;
+            const uint32_t ry = (y & s) ? 1 : 0;
+            d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+            if (ry == 0)
+            {
+                if (rx == 1)
+                {
+                    x = n - 1 - x;
+                    y = n - 1 - y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return d;
+    }
+
+    // BRIO insertion order: each point is assigned to a round by a hash of its index (the last round gets half
+    // the points, the one before a quarter, ...) and the points of each round are sorted along a Hilbert curve.
+    // roundStart[r] is the position of the first point of round r in the order.
+    std::vector<uint32_t> brioOrder(const double* xy, uint32_t count, std::vector<size_t>& roundStart, unsigned threads)
+    {
+        const unsigned CURVE_BITS = 2 * CURVE_AXIS_BITS;
+        unsigned rounds = 1;
+        while (rounds < 32 && (size_t(MIN_ROUND) << rounds) <= count)
+        {
+            rounds++;
+        }
+
+        double low[2] = { xy[0], xy[1] }, high[2] = { xy[0], xy[1] };
+        for (size_t i = 1; i < count; i++)
+        {
+            for (int a = 0; a < 2; a++)
+            {
+                low[a] = std::min(low[a], xy[2 * i + a]);
+                high[a] = std::max(high[a], xy[2 * i + a]);
+            }
+        }
+        const double extent = std::max(high[0] - low[0], high[1] - low[1]);
+        const double scale = extent > 0 ? std::ldexp(1.0, CURVE_AXIS_BITS) / extent : 0.0;
+        const double top = static_cast<double>((1u << CURVE_AXIS_BITS) - 1);
+        auto cell = [&](double v, int axis) { return static_cast<uint32_t>(std::min((v - low[axis]) * scale, top)); };
+
+        std::vector<uint64_t> keys(count);
+        std::vector<uint32_t> order(count);
+        scaleGeom::parallelFor(0, count, threads, MIN_CHUNK, [&](size_t i) {
+            uint64_t hash = (static_cast<uint64_t>(i) + 1) * 0x9e3779b97f4a7c15ull;
+            hash = (hash ^ hash >> 31) * 0xbf58476d1ce4e5b9ull;
+            hash ^= hash >> 29;
+            unsigned depth = 0;
+            while (depth + 1 < rounds && !(hash >> depth & 1))
+            {
+                depth++;
+            }
+            const uint64_t round = rounds - 1 - depth;
+            const uint64_t curve = hilbertIndex(cell(xy[2 * i], 0), cell(xy[2 * i + 1], 1));
+            keys[i] = round << CURVE_BITS | curve;
+            order[i] = static_cast<uint32_t>(i);
+        });
+        scaleGeom::radixSort(keys.data(), order.data(), count, CURVE_BITS + 6, threads);
+
+        roundStart.assign(rounds + 1, count);
+        for (size_t i = count; i-- > 0;)
+        {
+            roundStart[keys[i] >> CURVE_BITS] = i;
+        }
+        for (unsigned r = rounds; r-- > 0;)
+        {
+            roundStart[r] = std::min(roundStart[r], roundStart[r + 1]);
+        }
+        return order;
+    }
+
+    scaleGeom::DelaunayMesh2D triangulate(const double* xy, size_t count, unsigned _threads)
+    {
+        if (count >= NONE)
+            throw std::length_error("delaunay2D supports at most 2^32 - 2 points\n");
+        if (count < 3)
+            return scaleGeom::DelaunayMesh2D();
+
+        unsigned threads = scaleGeom::resolveThreadCount(_threads);
+        std::vector<size_t> roundStart;
+        const std::vector<uint32_t> order = brioOrder(xy, static_cast<uint32_t>(count), roundStart, threads);
+
+        // Vertices are numbered in insertion order, with their coordinates copied in that order for locality.
+        std::vector<double> sorted(2 * count);
+        scaleGeom::parallelFor(0, count, threads, MIN_CHUNK, [&](size_t i) {
+            sorted[2 * i] = xy[2 * static_cast<size_t>(order[i])];
+            sorted[2 * i + 1] = xy[2 * static_cast<size_t>(order[i]) + 1];
+        });
+
+        // Initial triangle: the first point, the next distinct one and the next one off their line.
+        Triangulation tri(sorted.data(), static_cast<uint32_t>(count));
+        const double* p0 = tri.at(0);
+        size_t second = 1;
+        while (second < count && tri.at(static_cast<uint32_t>(second))[0] == p0[0] && tri.at(static_cast<uint32_t>(second))[1] == p0[1])
+        {
+            second++;
+        }
+        size_t third = second + 1;
+        while (third < count && scaleGeom::orient2d(p0, tri.at(static_cast<uint32_t>(second)), tri.at(static_cast<uint32_t>(third))) == 0)
+        {
+            third++;
+        }
+        if (third >= count)
+            return scaleGeom::DelaunayMesh2D();
+
+        tri.vertex.reserve(6 * count + 12);
+        tri.twin.reserve(6 * count + 12);
+        tri.mark.reserve(2 * count + 4);
+        tri.start(0, static_cast<uint32_t>(second), static_cast<uint32_t>(third));
+
+        Inserter sequential;
+        sequential.last = 0;
+        auto insertRange = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                if (i != 0 && i != second && i != third)
+                    tri.insert(static_cast<uint32_t>(i), sequential);
+            }
+        };
+
+        const unsigned rounds = static_cast<unsigned>(roundStart.size() - 1);
+        if (threads <= 1 || count < MIN_PARALLEL || rounds <= PARALLEL_ROUNDS)
+        {
+            insertRange(0, count);
+            return tri.extract(order.data());
+        }
+
+        // Sequential prefix, then the remaining points cut into strips of equal size along x.
+        const size_t prefix = std::max(roundStart[rounds - PARALLEL_ROUNDS], third + 1);
+        insertRange(0, prefix);
+
+        const size_t remaining = count - prefix;
+        const unsigned strips = 2 * threads;
+        std::vector<double> sample;
+        const size_t step = std::max<size_t>(1, remaining / 65536);
+        for (size_t i = prefix; i < count; i += step)
+        {
+            sample.push_back(sorted[2 * i]);
+        }
+        std::sort(sample.begin(), sample.end());
+        std::vector<double> bounds(strips - 1);
+        for (unsigned s = 0; s + 1 < strips; s++)
+        {
+            bounds[s] = sample[sample.size() * (s + 1) / strips];
+        }
+        auto stripOf = [&](uint32_t point) {
+            return static_cast<unsigned>(std::upper_bound(bounds.begin(), bounds.end(), tri.at(point)[0]) - bounds.begin());
+        };
+
+        std::vector<size_t> stripStart(strips + 1, 0);
+        for (size_t i = prefix; i < count; i++)
+        {
+            stripStart[stripOf(static_cast<uint32_t>(i)) + 1]++;
+        }
+        for (unsigned s = 0; s < strips; s++)
+        {
+            stripStart[s + 1] += stripStart[s];
+        }
+        std::vector<uint32_t> stripPoints(remaining);
+        {
+            std::vector<size_t> fill(stripStart.begin(), stripStart.end() - 1);
+            for (size_t i = prefix; i < count; i++)
+            {
+                const uint32_t point = static_cast<uint32_t>(i);
+                stripPoints[fill[stripOf(point)]++] = point;
+            }
+        }
+
+        // Every insertion reuses its cavity's slots and takes two new ones, so each strip gets a block of
+        // twice its size. Strip s may touch vertices from the middle of strip s - 1 to the middle of strip s + 1.
+        const uint32_t base = static_cast<uint32_t>(tri.vertex.size() / 3);
+        tri.vertex.resize(3 * (base + 2 * remaining), NONE);
+        tri.twin.resize(3 * (base + 2 * remaining), NONE);
+        tri.mark.resize(base + 2 * remaining, NONE);
+        std::vector<Inserter> inserters(strips);
+        for (unsigned s = 0; s < strips; s++)
+        {
+            Inserter& in = inserters[s];
+            in.freshNext = base + static_cast<uint32_t>(2 * stripStart[s]);
+            in.freshEnd = base + static_cast<uint32_t>(2 * stripStart[s + 1]);
+            in.random += s;
+            if (s >= 2)
+                in.lo = 0.5 * (bounds[s - 2] + bounds[s - 1]);
+            if (s + 3 <= strips)
+                in.hi = 0.5 * (bounds[s] + bounds[s + 1]);
+        }
+
+        for (unsigned parity = 0; parity < 2; parity++)
+        {
+            // Start each strip's walk from a triangle near its first point, found by an unrestricted walk.
+            for (unsigned s = parity; s < strips; s += 2)
+            {
+                if (stripStart[s] == stripStart[s + 1])
+                    continue;
+                const uint32_t found = tri.locate(tri.at(stripPoints[stripStart[s]]), sequential);
+                inserters[s].last = found;
+                sequential.last = found;
+            }
+            scaleGeom::parallelFor(0, (strips - parity + 1) / 2, threads, 1, [&](size_t i) {
+                const unsigned s = static_cast<unsigned>(2 * i + parity);
+                Inserter& in = inserters[s];
+                for (size_t j = stripStart[s]; j < stripStart[s + 1]; j++)
+                {
+                    if (tri.insert(stripPoints[j], in) == Insertion::Deferred)
+                        in.deferred.push_back(stripPoints[j]);
+                }
+            });
+            for (unsigned s = parity; s < strips; s += 2)
+            {
+                if (stripStart[s] != stripStart[s + 1])
+                    sequential.last = inserters[s].last;
+            }
+        }
+
+        for (const Inserter& in : inserters)
+        {
+            for (uint32_t point : in.deferred)
+            {
+                tri.insert(point, sequential);
+            }
+        }
+        return tri.extract(order.data());
+    }
+}
+
+scaleGeom::DelaunayMesh2D scaleGeom::delaunay2D(const Vector2f* points, size_t count, unsigned _threads)
+{
+    std::vector<double> xy(2 * count);
+    const float* raw = reinterpret_cast<const float*>(points);
+    parallelFor(0, 2 * count, _threads, 2 * MIN_CHUNK, [&](size_t i) { xy[i] = raw[i]; });
+    return triangulate(xy.data(), count, _threads);
+}
+
+scaleGeom::DelaunayMesh2D scaleGeom::delaunay2D(const Vector2d* points, size_t count, unsigned _threads)
+{
+    return triangulate(reinterpret_cast<const double*>(points), count, _threads);
+}
@@ -0,0 +1,88 @@
+/*
+	Delaunay2D.h - 2D Delaunay Triangulation
+
+	Overview:
+	Computes the Delaunay triangulation of an array of Vector2f or Vector2d points by randomized
+	incremental insertion (Bowyer-Watson):
+
+	- Insertion order is BRIO: the points are shuffled into rounds of doubling size and each
+	  round is sorted along a Hilbert curve, so consecutive points are close together while the
+	  expected cost of the randomized algorithm is kept.
+	- Point location is a remembering stochastic walk from the last triangle created.
+	- The triangulation is closed with "ghost" triangles joining every hull edge to a vertex at
+	  infinity, so points outside the current hull are inserted like any other point and no
+	  bounding super-triangle is needed.
+
+	Robustness:
+	Orientation (the exact sign of crossProduct2D(b - a, c - a)) and the in-circle test come from
+	the adaptive exact predicates of Predicates.h, so the result is a valid Delaunay triangulation
+	for any finite input. Cocircular points are triangulated in one of the valid ways.
+
+	Storage:
+	Triangles and adjacency are flat index arrays in a compact half-edge layout: half-edge
+	3 * t + k runs from triangles[3t + k] to triangles[3t + (k + 1) % 3], and halfedges holds the
+	opposite half-edge in the neighbouring triangle. Slots of the triangles destroyed by an
+	insertion are reused by the triangles it creates. The output is ordered by the last inserted
+	vertex of each triangle, so the triangles around a point are mostly close together.
+
+	Parallel mode:
+	With more than one thread, the first rounds (about 1/16 of the points) are inserted
+	sequentially. The rest are cut into 2 * _threads strips along x; all even strips are inserted
+	concurrently, then all odd strips. A thread may only touch triangles whose vertices lie
+	within its strip plus half of each neighbouring strip, ranges that are disjoint between
+	concurrently running strips, so no locks are needed; a point whose insertion would reach
+	beyond that range is deferred and inserted sequentially at the end. The Delaunay
+	triangulation is unique for points in general position, so the result is the same as the
+	sequential one up to the triangulation of cocircular points and the order of triangles.
+
+	Output:
+	Triangles are counterclockwise and index the input array. Duplicate points are inserted once
+	(the first occurrence in insertion order is the vertex). Fewer than three distinct points, or
+	points that are all collinear, give an empty triangulation. Coordinates must be finite, and
+	count must be below 2^32 - 1 (std::length_error otherwise).
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	struct DelaunayMesh2D
+	{
+		static constexpr uint32_t NONE = 0xffffffffu;
+
+		// Three point indices per triangle, counterclockwise.
+		std::vector<uint32_t> triangles;
+
+		// Opposite of every half-edge, or NONE for half-edges on the convex hull.
+		std::vector<uint32_t> halfedges;
+
+		size_t triangleCount() const { return triangles.size() / 3; }
+
+		bool empty() const { return triangles.empty(); }
+
+		// Next half-edge counterclockwise within the same triangle.
+		static uint32_t nextHalfedge(uint32_t h) { return h % 3 == 2 ? h - 2 : h + 1; }
+	};
+
+	// Delaunay triangulation of points[0, count). _threads = 0 uses every hardware thread; 1 is sequential.
+	DelaunayMesh2D delaunay2D(const Vector2f* points, size_t count, unsigned _threads = 0);
+	DelaunayMesh2D delaunay2D(const Vector2d* points, size_t count, unsigned _threads = 0);
+
+	inline DelaunayMesh2D delaunay2D(const std::vector<Vector2f>& points, unsigned _threads = 0)
+	{
+		return delaunay2D(points.data(), points.size(), _threads);
+	}
+
+	inline DelaunayMesh2D delaunay2D(const std::vector<Vector2d>& points, unsigned _threads = 0)
+	{
+		return delaunay2D(points.data(), points.size(), _threads);
+	}
+
+} // Closing the scaleGeom namespace.
@@ -0,0 +1,73 @@
+#include "Benchmark.h"
+#include "Delaunay2D.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    // Uniform points in the unit square, or points clustered around a few hundred centres.
+    template<class coordDataType>
+    std::vector<scaleGeom::Vector<coordDataType, scaleGeom::DIM2>> makePoints(size_t count, bool clustered)
+    {
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::normal_distribution<double> spread(0.0, 0.002);
+        std::vector<scaleGeom::Vector<coordDataType, scaleGeom::DIM2>> points(count);
+        std::vector<double> centres(512);
+        for (double& c : centres)
+        {
+            c = uniform(rng);
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            double x = uniform(rng), y = uniform(rng);
+            if (clustered)
+            {
+                const size_t c = 2 * (rng() % (centres.size() / 2));
+                x = centres[c] + spread(rng);
+                y = centres[c + 1] + spread(rng);
+            }
+            points[i] = scaleGeom::Vector<coordDataType, scaleGeom::DIM2>(static_cast<coordDataType>(x), static_cast<coordDataType>(y));
+        }
+        return points;
+    }
+
+    template<class coordDataType>
+    void run(const char* label, bool clustered)
+    {
+        const std::vector<scaleGeom::Vector<coordDataType, scaleGeom::DIM2>> points = makePoints<coordDataType>(scaleGeom::bench::problemSize(2000000), clustered);
+        const unsigned hardware = scaleGeom::resolveThreadCount(0);
+        size_t reference = 0;
+        for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware))
+        {
+            Timer timer;
+            const scaleGeom::DelaunayMesh2D mesh = scaleGeom::delaunay2D(points, threads);
+            const double seconds = timer.seconds();
+            if (threads == 1)
+                reference = mesh.triangleCount();
+            std::cout << "  " << std::left << std::setw(22) << label << std::right
+                << std::setw(3) << threads << " threads "
+                << std::setw(9) << std::fixed << std::setprecision(2) << seconds * 1e3 << " ms  "
+                << std::setw(7) << std::setprecision(2) << points.size() / seconds / 1e6 << " Mpts/s  "
+                << std::setw(9) << mesh.triangleCount() << " triangles"
+                << (mesh.triangleCount() == reference ? "" : "  MISMATCH") << std::endl;
+            if (threads == hardware)
+                break;
+        }
+    }
+}
+
+SCALEGEOM_BENCHMARK(Delaunay2D)
+{
+    run<float>("uniform, Vector2f", false);
+    run<double>("uniform, Vector2d", false);
+    run<float>("clustered, Vector2f", true);
+}
@@ -0,0 +1,865 @@
+#include "Delaunay3D.h"
+#include "Parallel.h"
+#include "Predicates.h"
+#include "VectorOrder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+    const uint32_t NONE = scaleGeom::DelaunayMesh3D::NONE;
+
+    // Inputs smaller than this are tetrahedralized sequentially.
+    const size_t MIN_PARALLEL = 1 << 15;
+
+    // Chunks smaller than this are not worth a thread of their own when preparing the input.
+    const size_t MIN_CHUNK = 1 << 16;
+
+    // The smallest BRIO round holds about this many points.
+    const size_t MIN_ROUND = 64;
+
+    // In parallel mode, the last PARALLEL_ROUNDS rounds (15/16 of the points) are inserted in strips.
+    const unsigned PARALLEL_ROUNDS = 4;
+
+    // Parallel phases (alternating even and odd strips) before the points still deferred are inserted sequentially.
+    // Points near the hull of the whole input tend to stay deferred: the hull has few vertices, so the tetrahedra
+    // there reach far along x.
+    const unsigned MAX_PHASES = 4;
+
+    // Minimum strip width in point spacings of the mesh the parallel phases start from. Narrower strips make
+    // most cavities and walks reach past the strip ranges, so most points end up in the sequential pass.
+    const double MIN_STRIP_SPACINGS = 5.0;
+
+    // Cells per axis of the grid of walk starts a strip keeps (ANCHOR_GRID^3 in all).
+    const size_t ANCHOR_GRID = 16;
+
+    // Bits of the Hilbert key kept below the round number in the sort key (16 per axis).
+    const unsigned CURVE_BITS = 48;
+
+    // Slots handed to a thread at a time in parallel mode, and the slots reserved per remaining point.
+    const uint32_t SLOT_BLOCK = 1024;
+    const size_t SLOTS_PER_POINT = 8;
+
+    // Faces are numbered 4 * slot + k in 32 bits.
+    const size_t MAX_SLOTS = size_t(1) << 30;
+
+    // Cavity marks are 2 * point + 1 in 32 bits.
+    const size_t MAX_POINTS = (size_t(1) << 31) - 1;
+
+    // Vertices of face k of a tetrahedron other than vertex k, ordered so that (face, vertex k) is positive
+    // when the tetrahedron is; with the vertex replaced by a point beyond the face the order is negative.
+    const unsigned FACE[4][3] = { { 1, 3, 2 }, { 0, 2, 3 }, { 0, 3, 1 }, { 0, 1, 2 } };
+
+    // The two vertices of a tetrahedron other than i and k (i != k), in ascending order.
+    const unsigned OTHER[4][4][2] = {
+        { { 0, 0 }, { 2, 3 }, { 1, 3 }, { 1, 2 } },
+        { { 2, 3 }, { 0, 0 }, { 0, 3 }, { 0, 2 } },
+        { { 1, 3 }, { 0, 3 }, { 0, 0 }, { 0, 1 } },
+        { { 1, 2 }, { 0, 2 }, { 0, 1 }, { 0, 0 } } };
+
+    // Face of a cavity's boundary: a cavity tetrahedron and the vertex the face excludes, and the face across it.
+    struct BoundaryFace
+    {
+        uint32_t tetrahedron, vertex, outer;
+    };
+
+    // Insertion state of one thread.
+    struct Inserter
+    {
+        // Tetrahedron the next walk starts from.
+        uint32_t last = NONE;
+
+        // Free slots: a list of released ones, then the rest of the current block.
+        std::vector<uint32_t> free;
+        uint32_t blockNext = 0, blockEnd = 0;
+
+        // Sequential inserters append slots when they run out; parallel ones take blocks from a shared counter.
+        bool growable = true;
+
+        // If bounded, only tetrahedra whose vertices all have x in [lo, hi) may be visited.
+        bool bounded = false;
+        double lo = -std::numeric_limits<double>::infinity();
+        double hi = std::numeric_limits<double>::infinity();
+
+        uint64_t random = 0x9e3779b97f4a7c15ull;
+
+        std::vector<uint32_t> cavity, rejected, stack, slots;
+        std::vector<BoundaryFace> boundary;
+        std::vector<uint64_t> edgeKeys;
+        std::vector<uint32_t> edgeFaces;
+        std::vector<uint32_t> deferred;
+
+        // Bounded mode: per cell of the tetrahedralization's anchor grid, a tetrahedron in range near the last
+        // point inserted there, or NONE. A walk that leaves the range is retried from the one of its cell.
+        std::vector<uint32_t> anchors;
+
+        unsigned nextRandom()
+        {
+            random ^= random << 13;
+            random ^= random >> 7;
+            random ^= random << 17;
+            return static_cast<unsigned>(random >> 32);
+        }
+    };
+
+    enum class Insertion { Inserted, Duplicate, Deferred };
+
+    // Tetrahedralization closed by ghost tetrahedra: a ghost has the infinite vertex in place of one vertex,
+    // and is positive when a point beyond its hull face takes the infinite vertex's place.
+    class Tetrahedralization
+    {
+    public:
+
+        Tetrahedralization(const double* _xyz, uint32_t _count)
+            : xyz(_xyz), infinite(_count)
+        {
+        }
+
+        const double* xyz;
+        const uint32_t infinite;
+
+        // Per slot, the four vertices followed by the four opposite faces, interleaved so that a tetrahedron
+        // is one 32-byte record. Unused slots have vertex NONE.
+        std::vector<uint32_t> cells;
+
+        // Per slot, the last point whose cavity search tested the tetrahedron: 2 * point if it was in the
+        // cavity, 2 * point + 1 if not.
+        std::vector<uint32_t> mark;
+
+        // Slots [0, capacity) are preallocated in parallel mode; blocks are taken from blockCursor.
+        std::atomic<size_t> blockCursor{ 0 };
+        size_t capacity = 0;
+
+        // Coarse grid over the points for the inserters' anchors: cells of 1 / gridScale, clamped at the sides.
+        scaleGeom::Vector3d gridLow;
+        double gridScale = 0.0;
+
+        const double* at(uint32_t v) const { return xyz + 3 * static_cast<size_t>(v); }
+
+        size_t anchorCell(const double* p) const
+        {
+            size_t cell = 0;
+            for (size_t a = 0; a < 3; a++)
+            {
+                const double c = std::max(0.0, std::min((p[a] - gridLow[a]) * gridScale, ANCHOR_GRID - 1.0));
+                cell = cell * ANCHOR_GRID + static_cast<size_t>(c);
+            }
+            return cell;
+        }
+
+        uint32_t* vertices(uint32_t t) { return &cells[8 * static_cast<size_t>(t)]; }
+        const uint32_t* vertices(uint32_t t) const { return &cells[8 * static_cast<size_t>(t)]; }
+
+        uint32_t& opposite(uint32_t face) { return cells[8 * static_cast<size_t>(face / 4) + 4 + face % 4]; }
+        uint32_t opposite(uint32_t face) const { return cells[8 * static_cast<size_t>(face / 4) + 4 + face % 4]; }
+
+        // Position of the infinite vertex in t, or 4 for a real tetrahedron.
+        unsigned ghostIndex(uint32_t t) const
+        {
+            unsigned k = 0;
+            while (k < 4 && vertices(t)[k] != infinite)
+            {
+                k++;
+            }
+            return k;
+        }
+
+        bool accessible(uint32_t t, const Inserter& in) const
+        {
+            if (!in.bounded)
+                return true;
+            for (unsigned k = 0; k < 4; k++)
+            {
+                const uint32_t v = vertices(t)[k];
+                if (v != infinite && !(xyz[3 * static_cast<size_t>(v)] >= in.lo && xyz[3 * static_cast<size_t>(v)] < in.hi))
+                    return false;
+            }
+            return true;
+        }
+
+        // orient3d of t with vertex k replaced by p: positive when p is on the same side of face k as vertex k.
+        double orientWith(uint32_t t, unsigned k, const double* p) const
+        {
+            const double* q[4];
+            for (unsigned i = 0; i < 4; i++)
+            {
+                q[i] = i == k ? p : at(vertices(t)[i]);
+            }
+            return scaleGeom::orient3d(q[0], q[1], q[2], q[3]);
+        }
+
+        bool inSphere(uint32_t t, const double* p) const
+        {
+            const uint32_t* v = vertices(t);
+            return scaleGeom::inSphere(at(v[0]), at(v[1]), at(v[2]), at(v[3]), p) > 0;
+        }
+
+        // True if p lies strictly inside the circumsphere of t. For a ghost: p lies strictly beyond its hull
+        // face, or in the face's plane and strictly inside the circumsphere of the tetrahedron behind it.
+        bool conflict(uint32_t t, const double* p) const
+        {
+            const unsigned g = ghostIndex(t);
+            if (g == 4)
+                return inSphere(t, p);
+            const double side = orientWith(t, g, p);
+            if (side != 0)
+                return side > 0;
+            return inSphere(opposite(4 * t + g) / 4, p);
+        }
+
+        // Initial tetrahedron (not coplanar) and its four ghosts, linked by matching their faces.
+        void start(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+        {
+            if (scaleGeom::orient3d(at(a), at(b), at(c), at(d)) < 0)
+                std::swap(a, b);
+            cells = { a, b, c, d, NONE, NONE, NONE, NONE };
+            for (unsigned k = 0; k < 4; k++)
+            {
+                uint32_t ghost[8] = { a, b, c, d, NONE, NONE, NONE, NONE };
+                ghost[k] = infinite;
+                std::swap(ghost[FACE[k][0]], ghost[FACE[k][1]]);
+                cells.insert(cells.end(), ghost, ghost + 8);
+            }
+            mark.assign(5, NONE);
+            for (uint32_t f = 0; f < 20; f++)
+            {
+                for (uint32_t g = f + 4 - f % 4; g < 20 && opposite(f) == NONE; g++)
+                {
+                    if (sameFace(f, g))
+                    {
+                        opposite(f) = g;
+                        opposite(g) = f;
+                    }
+                }
+            }
+        }
+
+        bool sameFace(uint32_t f, uint32_t g) const
+        {
+            uint32_t a[3], b[3];
+            for (unsigned i = 0; i < 3; i++)
+            {
+                a[i] = vertices(f / 4)[FACE[f % 4][i]];
+                b[i] = vertices(g / 4)[FACE[g % 4][i]];
+            }
+            std::sort(a, a + 3);
+            std::sort(b, b + 3);
+            return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+        }
+
+        // Make sure the inserter holds at least needed free slots. Fails only in parallel mode, when the
+        // preallocated slots run out.
+        bool reserve(Inserter& in, size_t needed)
+        {
+            while (in.free.size() + (in.blockEnd - in.blockNext) < needed)
+            {
+                while (in.blockNext < in.blockEnd)
+                {
+                    in.free.push_back(in.blockNext++);
+                }
+                size_t first;
+                if (in.growable)
+                {
+                    first = cells.size() / 8;
+                    if (first + SLOT_BLOCK > MAX_SLOTS)
+                        throw std::length_error("delaunay3D needs more than 2^30 tetrahedron slots\n");
+                    cells.resize(cells.size() + 8 * static_cast<size_t>(SLOT_BLOCK), NONE);
+                    mark.resize(mark.size() + SLOT_BLOCK, NONE);
+                }
+                else
+                {
+                    first = blockCursor.fetch_add(SLOT_BLOCK);
+                    if (first + SLOT_BLOCK > capacity)
+                        return false;
+                }
+                in.blockNext = static_cast<uint32_t>(first);
+                in.blockEnd = static_cast<uint32_t>(first + SLOT_BLOCK);
+            }
+            return true;
+        }
+
+        uint32_t take(Inserter& in)
+        {
+            if (in.blockNext < in.blockEnd)
+                return in.blockNext++;
+            const uint32_t t = in.free.back();
+            in.free.pop_back();
+            return t;
+        }
+
+        // Tetrahedron containing p, or a ghost whose hull face p lies strictly beyond; NONE if the walk leaves
+        // the inserter's range. Remembering stochastic walk, as in 2D.
+        uint32_t locate(const double* p, Inserter& in) const
+        {
+            uint32_t t = in.last;
+            if (!accessible(t, in))
+                return NONE;
+            const unsigned g = ghostIndex(t);
+            if (g != 4)
+            {
+                t = opposite(4 * t + g) / 4;
+                if (!accessible(t, in))
+                    return NONE;
+            }
+
+            uint32_t entered = NONE;
+            for (;;)
+            {
+                const unsigned first = in.nextRandom() % 4;
+                bool moved = false;
+                for (unsigned j = 0; j < 4 && !moved; j++)
+                {
+                    const unsigned k = (first + j) % 4;
+                    const uint32_t face = 4 * t + k;
+                    if (face == entered || orientWith(t, k, p) >= 0)
+                        continue;
+                    const uint32_t across = opposite(face);
+                    const uint32_t neighbour = across / 4;
+                    if (!accessible(neighbour, in))
+                        return NONE;
+                    if (ghostIndex(neighbour) != 4)
+                        return neighbour;
+                    t = neighbour;
+                    entered = across;
+                    moved = true;
+                }
+                if (!moved)
+                    return t;
+            }
+        }
+
+        Insertion insert(uint32_t point, Inserter& in)
+        {
+            const double* p = at(point);
+            uint32_t start = in.last == NONE ? NONE : locate(p, in);
+            if (start == NONE && in.bounded)
+            {
+                // Freed slots have vertex NONE; the others of the strip's anchors are its own tetrahedra.
+                const uint32_t anchor = in.anchors[anchorCell(p)];
+                if (anchor == NONE || vertices(anchor)[0] == NONE)
+                    return Insertion::Deferred;
+                in.last = anchor;
+                start = locate(p, in);
+            }
+            if (start == NONE)
+                return Insertion::Deferred;
+            if (ghostIndex(start) == 4)
+            {
+                for (unsigned k = 0; k < 4; k++)
+                {
+                    const double* q = at(vertices(start)[k]);
+                    if (q[0] == p[0] && q[1] == p[1] && q[2] == p[2])
+                        return Insertion::Duplicate;
+                }
+            }
+
+            // Bowyer-Watson cavity: the connected tetrahedra whose circumsphere holds p.
+            in.cavity.clear();
+            in.boundary.clear();
+            in.stack.clear();
+            const uint32_t inside = 2 * point, outside = 2 * point + 1;
+            in.rejected.clear();
+            mark[start] = inside;
+            in.cavity.push_back(start);
+            in.stack.push_back(start);
+            bool deferred = false;
+            while (!in.stack.empty() && !deferred)
+            {
+                const uint32_t t = in.stack.back();
+                in.stack.pop_back();
+                for (unsigned k = 0; k < 4; k++)
+                {
+                    const uint32_t across = opposite(4 * t + k);
+                    const uint32_t neighbour = across / 4;
+                    if (mark[neighbour] == inside)
+                        continue;
+                    if (mark[neighbour] == outside)
+                    {
+                        in.boundary.push_back({ t, k, across });
+                        continue;
+                    }
+                    if (!accessible(neighbour, in))
+                    {
+                        deferred = true;
+                        break;
+                    }
+                    if (conflict(neighbour, p))
+                    {
+                        mark[neighbour] = inside;
+                        in.cavity.push_back(neighbour);
+                        in.stack.push_back(neighbour);
+                    }
+                    else
+                    {
+                        mark[neighbour] = outside;
+                        in.rejected.push_back(neighbour);
+                        in.boundary.push_back({ t, k, across });
+                    }
+                }
+            }
+            const size_t faces = in.boundary.size();
+            if (deferred || (faces > in.cavity.size() && !reserve(in, faces - in.cavity.size())))
+            {
+                for (uint32_t c : in.cavity)
+                {
+                    mark[c] = NONE;
+                }
+                for (uint32_t c : in.rejected)
+                {
+                    mark[c] = NONE;
+                }
+                return Insertion::Deferred;
+            }
+
+            // One new tetrahedron per boundary face: the cavity tetrahedron with the excluded vertex replaced by
+            // p, which keeps the orientation. They are written into fresh slots first, since the cavity
+            // tetrahedra are read while the new ones are formed.
+            in.slots.resize(faces);
+            for (size_t j = 0; j < faces; j++)
+            {
+                in.slots[j] = j < in.cavity.size() ? NONE : take(in);
+            }
+            std::vector<uint32_t>& newVertex = in.stack;
+            newVertex.resize(4 * faces);
+            for (size_t j = 0; j < faces; j++)
+            {
+                const BoundaryFace& f = in.boundary[j];
+                for (unsigned i = 0; i < 4; i++)
+                {
+                    newVertex[4 * j + i] = i == f.vertex ? point : vertices(f.tetrahedron)[i];
+                }
+            }
+            for (size_t j = 0; j < faces; j++)
+            {
+                if (j < in.cavity.size())
+                    in.slots[j] = in.cavity[j];
+                const uint32_t s = in.slots[j];
+                const BoundaryFace& f = in.boundary[j];
+                for (unsigned i = 0; i < 4; i++)
+                {
+                    vertices(s)[i] = newVertex[4 * j + i];
+                }
+                opposite(4 * s + f.vertex) = f.outer;
+                opposite(f.outer) = 4 * s + f.vertex;
+            }
+            for (size_t j = faces; j < in.cavity.size(); j++)
+            {
+                vertices(in.cavity[j])[0] = NONE;
+                in.free.push_back(in.cavity[j]);
+            }
+            in.stack.clear();
+
+            // The other faces of a new tetrahedron hold p and an edge of the boundary, which exactly two new
+            // tetrahedra share: pair them through a small hash table keyed by the edge.
+            size_t tableSize = 64;
+            while (tableSize < 4 * faces)
+            {
+                tableSize *= 2;
+            }
+            in.edgeKeys.assign(tableSize, ~0ull);
+            in.edgeFaces.resize(tableSize);
+            for (size_t j = 0; j < faces; j++)
+            {
+                const uint32_t s = in.slots[j];
+                const unsigned k = in.boundary[j].vertex;
+                for (unsigned i = 0; i < 4; i++)
+                {
+                    if (i == k)
+                        continue;
+                    uint32_t a = vertices(s)[OTHER[i][k][0]], b = vertices(s)[OTHER[i][k][1]];
+                    if (a > b)
+                        std::swap(a, b);
+                    const uint64_t key = static_cast<uint64_t>(a) << 32 | b;
+                    uint64_t hash = key * 0x9e3779b97f4a7c15ull;
+                    size_t slot = static_cast<size_t>(hash >> 40) & (tableSize - 1);
+                    while (in.edgeKeys[slot] != ~0ull && in.edgeKeys[slot] != key)
+                    {
+                        slot = (slot + 1) & (tableSize - 1);
+                    }
+                    if (in.edgeKeys[slot] == key)
+                    {
+                        const uint32_t other = in.edgeFaces[slot];
+                        opposite(4 * s + i) = other;
+                        opposite(other) = 4 * s + i;
+                    }
+                    else
+                    {
+                        in.edgeKeys[slot] = key;
+                        in.edgeFaces[slot] = 4 * s + i;
+                    }
+                }
+            }
+
+            in.last = in.slots[0];
+            for (size_t j = 0; j < faces; j++)
+            {
+                if (ghostIndex(in.slots[j]) == 4)
+                {
+                    in.last = in.slots[j];
+                    break;
+                }
+            }
+            if (in.bounded)
+                in.anchors[anchorCell(p)] = in.last;
+            return Insertion::Inserted;
+        }
+
+        // Real tetrahedra with their adjacency, renumbered densely; vertex v is point original[v].
+        scaleGeom::DelaunayMesh3D extract(const uint32_t* original, size_t& peakBytes) const
+        {
+            // Tetrahedra are numbered in the order of their last inserted vertex (a counting sort), so that most
+            // follow the Hilbert order of the final rounds and the tetrahedra around a point are close in memory.
+            const size_t slots = cells.size() / 8;
+            std::vector<uint32_t> renumber(slots, NONE);
+            std::vector<uint32_t> start(static_cast<size_t>(infinite) + 1, 0);
+            for (size_t t = 0; t < slots; t++)
+            {
+                const uint32_t* v = vertices(static_cast<uint32_t>(t));
+                if (v[0] != NONE && ghostIndex(static_cast<uint32_t>(t)) == 4)
+                    start[std::max(std::max(v[0], v[1]), std::max(v[2], v[3]))]++;
+            }
+            uint32_t tetrahedra = 0;
+            for (uint32_t& s : start)
+            {
+                const uint32_t n = s;
+                s = tetrahedra;
+                tetrahedra += n;
+            }
+            for (size_t t = 0; t < slots; t++)
+            {
+                const uint32_t* v = vertices(static_cast<uint32_t>(t));
+                if (v[0] != NONE && ghostIndex(static_cast<uint32_t>(t)) == 4)
+                    renumber[t] = start[std::max(std::max(v[0], v[1]), std::max(v[2], v[3]))]++;
+            }
+
+            scaleGeom::DelaunayMesh3D mesh;
+            mesh.tetrahedra.resize(4 * static_cast<size_t>(tetrahedra));
+            mesh.halffaces.resize(4 * static_cast<size_t>(tetrahedra));
+            for (size_t t = 0; t < slots; t++)
+            {
+                if (renumber[t] == NONE)
+                    continue;
+                for (unsigned k = 0; k < 4; k++)
+                {
+                    const uint32_t across = opposite(4 * t + k);
+                    const uint32_t neighbour = renumber[across / 4];
+                    mesh.tetrahedra[4 * renumber[t] + k] = original[vertices(static_cast<uint32_t>(t))[k]];
+                    mesh.halffaces[4 * renumber[t] + k] = neighbour == NONE ? NONE : 4 * neighbour + across % 4;
+                }
+            }
+            peakBytes += (cells.capacity() + mark.capacity() + renumber.capacity() + start.capacity()
+                + mesh.tetrahedra.capacity() + mesh.halffaces.capacity()) * sizeof(uint32_t);
+            return mesh;
+        }
+    };
+
+    // BRIO insertion order as in Delaunay2D.cpp, on a 16-bit per axis 3D Hilbert curve.
+    std::vector<uint32_t> brioOrder(const double* xyz, uint32_t count, std::vector<size_t>& roundStart, unsigned threads)
+    {
+        unsigned rounds = 1;
+        while (rounds < 32 && (size_t(MIN_ROUND) << rounds) <= count)
+        {
+            rounds++;
+        }
+
+        scaleGeom::Vector3d low(xyz[0], xyz[1], xyz[2]), high = low;
+        for (size_t i = 1; i < count; i++)
+        {
+            for (size_t a = 0; a < 3; a++)
+            {
+                low[a] = std::min(low[a], xyz[3 * i + a]);
+                high[a] = std::max(high[a], xyz[3 * i + a]);
+            }
+        }
+        const scaleGeom::SpatialKeyEncoder<double, scaleGeom::DIM3> encoder(low, high);
+
+        std::vector<uint64_t> keys(count);
+        std::vector<uint32_t> order(count);
+        scaleGeom::parallelFor(0, count, threads, MIN_CHUNK, [&](size_t i) {
+            uint64_t hash = (static_cast<uint64_t>(i) + 1) * 0x9e3779b97f4a7c15ull;
+            hash = (hash ^ hash >> 31) * 0xbf58476d1ce4e5b9ull;
+            hash ^= hash >> 29;
+            unsigned depth = 0;
+            while (depth + 1 < rounds && !(hash >> depth & 1))
+            {
+                depth++;
+            }
+            const uint64_t round = rounds - 1 - depth;
+            const uint64_t curve = encoder.hilbert(scaleGeom::Vector3d(xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2]))
+                >> (3 * scaleGeom::SpatialKeyEncoder<double, scaleGeom::DIM3>::BITS - CURVE_BITS);
+            keys[i] = round << CURVE_BITS | curve;
+            order[i] = static_cast<uint32_t>(i);
+        });
+        scaleGeom::radixSort(keys.data(), order.data(), count, CURVE_BITS + 6, threads);
+
+        roundStart.assign(rounds + 1, count);
+        for (size_t i = count; i-- > 0;)
+        {
+            roundStart[keys[i] >> CURVE_BITS] = i;
+        }
+        for (unsigned r = rounds; r-- > 0;)
+        {
+            roundStart[r] = std::min(roundStart[r], roundStart[r + 1]);
+        }
+        return order;
+    }
+
+    // Exact test for three collinear points: collinear in 3D iff collinear in all three coordinate planes.
+    bool collinear(const double* a, const double* b, const double* c)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            const double pa[2] = { a[u], a[v] }, pb[2] = { b[u], b[v] }, pc[2] = { c[u], c[v] };
+            if (scaleGeom::orient2d(pa, pb, pc) != 0)
+                return false;
+        }
+        return true;
+    }
+
+    scaleGeom::DelaunayMesh3D tetrahedralize(const double* xyz, size_t count, unsigned _threads, scaleGeom::Delaunay3DStats* _stats)
+    {
+        if (count >= MAX_POINTS)
+            throw std::length_error("delaunay3D supports at most 2^31 - 1 points\n");
+        if (_stats)
+            *_stats = scaleGeom::Delaunay3DStats();
+        if (count < 4)
+            return scaleGeom::DelaunayMesh3D();
+
+        unsigned threads = scaleGeom::resolveThreadCount(_threads);
+        std::vector<size_t> roundStart;
+        const std::vector<uint32_t> order = brioOrder(xyz, static_cast<uint32_t>(count), roundStart, threads);
+        size_t peakBytes = count * (sizeof(uint64_t) + sizeof(uint32_t));
+
+        // Vertices are numbered in insertion order, with their coordinates copied in that order for locality.
+        std::vector<double> sorted(3 * count);
+        scaleGeom::parallelFor(0, count, threads, MIN_CHUNK, [&](size_t i) {
+            for (size_t a = 0; a < 3; a++)
+            {
+                sorted[3 * i + a] = xyz[3 * static_cast<size_t>(order[i]) + a];
+            }
+        });
+
+        // Initial tetrahedron: the first point, the next distinct one, the next one off their line and the
+        // next one off their plane.
+        Tetrahedralization tet(sorted.data(), static_cast<uint32_t>(count));
+        const double* p0 = tet.at(0);
+        size_t second = 1;
+        while (second < count && tet.at(static_cast<uint32_t>(second))[0] == p0[0] && tet.at(static_cast<uint32_t>(second))[1] == p0[1]
+            && tet.at(static_cast<uint32_t>(second))[2] == p0[2])
+        {
+            second++;
+        }
+        size_t third = second + 1;
+        while (third < count && collinear(p0, tet.at(static_cast<uint32_t>(second)), tet.at(static_cast<uint32_t>(third))))
+        {
+            third++;
+        }
+        size_t fourth = third + 1;
+        while (fourth < count && scaleGeom::orient3d(p0, tet.at(static_cast<uint32_t>(second)), tet.at(static_cast<uint32_t>(third)),
+            tet.at(static_cast<uint32_t>(fourth))) == 0)
+        {
+            fourth++;
+        }
+        if (fourth >= count)
+            return scaleGeom::DelaunayMesh3D();
+
+        const size_t expected = std::min(SLOTS_PER_POINT * count, MAX_SLOTS);
+        tet.cells.reserve(8 * expected);
+        tet.mark.reserve(expected);
+        tet.start(0, static_cast<uint32_t>(second), static_cast<uint32_t>(third), static_cast<uint32_t>(fourth));
+
+        Inserter sequential;
+        sequential.last = 0;
+        auto insertRange = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                if (i != 0 && i != second && i != third && i != fourth)
+                    tet.insert(static_cast<uint32_t>(i), sequential);
+            }
+        };
+        auto finish = [&](size_t deferredPoints) {
+            peakBytes = std::max(peakBytes, sorted.capacity() * sizeof(double) + order.capacity() * sizeof(uint32_t));
+            scaleGeom::DelaunayMesh3D mesh = tet.extract(order.data(), peakBytes);
+            if (_stats)
+            {
+                _stats->peakBytes = peakBytes;
+                _stats->deferredPoints = deferredPoints;
+            }
+            return mesh;
+        };
+
+        const unsigned rounds = static_cast<unsigned>(roundStart.size() - 1);
+        if (threads <= 1 || count < MIN_PARALLEL || rounds <= PARALLEL_ROUNDS)
+        {
+            insertRange(0, count);
+            return finish(0);
+        }
+
+        // Sequential prefix, then the remaining points cut into strips of equal size along x.
+        const size_t prefix = std::max(roundStart[rounds - PARALLEL_ROUNDS], fourth + 1);
+        insertRange(0, prefix);
+
+        // Up to two strips per thread, but each at least MIN_STRIP_SPACINGS point spacings of the prefix mesh
+        // wide. With too few points for four strips, the parallel mode would run one strip at a time.
+        scaleGeom::Vector3d low(tet.at(0)[0], tet.at(0)[1], tet.at(0)[2]), high = low;
+        for (uint32_t i = 1; i < prefix; i++)
+        {
+            for (size_t a = 0; a < 3; a++)
+            {
+                low[a] = std::min(low[a], tet.at(i)[a]);
+                high[a] = std::max(high[a], tet.at(i)[a]);
+            }
+        }
+        tet.gridLow = low;
+        tet.gridScale = ANCHOR_GRID / std::max(std::max(high[0] - low[0], high[1] - low[1]), high[2] - low[2]);
+        const double spacing = std::cbrt((high[0] - low[0]) * (high[1] - low[1]) * (high[2] - low[2]) / prefix);
+        const double widest = std::min(2.0 * threads, (high[0] - low[0]) / (MIN_STRIP_SPACINGS * spacing));
+        const unsigned strips = static_cast<unsigned>(widest) & ~1u;
+        if (strips < 4)
+        {
+            insertRange(prefix, count);
+            return finish(0);
+        }
+
+        const size_t remaining = count - prefix;
+        std::vector<double> sample;
+        const size_t step = std::max<size_t>(1, remaining / 65536);
+        for (size_t i = prefix; i < count; i += step)
+        {
+            sample.push_back(sorted[3 * i]);
+        }
+        std::sort(sample.begin(), sample.end());
+        std::vector<double> bounds(strips - 1);
+        for (unsigned s = 0; s + 1 < strips; s++)
+        {
+            bounds[s] = sample[sample.size() * (s + 1) / strips];
+        }
+        auto stripOf = [&](uint32_t point) {
+            return static_cast<unsigned>(std::upper_bound(bounds.begin(), bounds.end(), tet.at(point)[0]) - bounds.begin());
+        };
+
+        std::vector<std::vector<uint32_t>> pending(strips);
+        for (size_t i = prefix; i < count; i++)
+        {
+            pending[stripOf(static_cast<uint32_t>(i))].push_back(static_cast<uint32_t>(i));
+        }
+
+        // Preallocate the slots the strips take their blocks from. Strip s may touch vertices from the middle
+        // of strip s - 1 to the middle of strip s + 1, so the ranges of the strips of one parity partition x.
+        const size_t base = tet.cells.size() / 8;
+        tet.capacity = std::min<size_t>(base + SLOTS_PER_POINT * remaining + static_cast<size_t>(strips) * SLOT_BLOCK, MAX_SLOTS);
+        tet.blockCursor = base;
+        tet.cells.resize(8 * tet.capacity, NONE);
+        tet.mark.resize(tet.capacity, NONE);
+        std::vector<Inserter> inserters(strips);
+        for (unsigned s = 0; s < strips; s++)
+        {
+            Inserter& in = inserters[s];
+            in.growable = false;
+            in.bounded = true;
+            in.random += s;
+            if (s >= 2)
+                in.lo = 0.5 * (bounds[s - 2] + bounds[s - 1]);
+            if (s + 3 <= strips)
+                in.hi = 0.5 * (bounds[s] + bounds[s + 1]);
+        }
+
+        // Phases alternate between the even and the odd strips. The points a phase defers are handed to the
+        // strip of the other parity whose range holds them; the mesh is denser by then, so most succeed.
+        bool left = true;
+        std::vector<bool> tried;
+        for (unsigned phase = 0; phase < MAX_PHASES && left; phase++)
+        {
+            const unsigned parity = phase % 2;
+
+            // Anchor each strip at the tetrahedra near the first of its points in every grid cell, found by
+            // unrestricted walks; only those in the strip's range can start its walks. The anchors of the last
+            // phase may since have been changed by other strips. Without them, a strip whose points lie on both
+            // sides of a hollow in the data loses its walks there, and defers nearly all points after.
+            for (unsigned s = parity; s < strips; s += 2)
+            {
+                Inserter& in = inserters[s];
+                in.anchors.assign(ANCHOR_GRID * ANCHOR_GRID * ANCHOR_GRID, NONE);
+                tried.assign(in.anchors.size(), false);
+                for (uint32_t point : pending[s])
+                {
+                    const size_t cell = tet.anchorCell(tet.at(point));
+                    if (tried[cell])
+                        continue;
+                    tried[cell] = true;
+                    const uint32_t found = tet.locate(tet.at(point), sequential);
+                    sequential.last = found;
+                    const unsigned g = tet.ghostIndex(found);
+                    if (tet.accessible(found, in) && (g == 4 || tet.accessible(tet.opposite(4 * found + g) / 4, in)))
+                        in.anchors[cell] = found;
+                }
+                in.last = pending[s].empty() ? NONE : in.anchors[tet.anchorCell(tet.at(pending[s].front()))];
+            }
+            scaleGeom::parallelFor(0, (strips - parity + 1) / 2, threads, 1, [&](size_t i) {
+                const unsigned s = static_cast<unsigned>(2 * i + parity);
+                Inserter& in = inserters[s];
+                for (uint32_t point : pending[s])
+                {
+                    if (tet.insert(point, in) == Insertion::Deferred)
+                        in.deferred.push_back(point);
+                }
+                pending[s].clear();
+            });
+
+            for (unsigned s = parity; s < strips; s += 2)
+            {
+                Inserter& in = inserters[s];
+                if (in.last != NONE)
+                    sequential.last = in.last;
+                for (uint32_t point : in.deferred)
+                {
+                    unsigned target = 1 - parity;
+                    while (target + 2 < strips && !(tet.at(point)[0] < inserters[target].hi))
+                    {
+                        target += 2;
+                    }
+                    pending[target].push_back(point);
+                }
+                in.deferred.clear();
+            }
+            left = false;
+            for (const std::vector<uint32_t>& points : pending)
+            {
+                left = left || !points.empty();
+            }
+        }
+
+        // The slots the strips still hold stay unused; the sequential pass appends new ones.
+        size_t deferredPoints = 0;
+        for (const std::vector<uint32_t>& points : pending)
+        {
+            for (uint32_t point : points)
+            {
+                tet.insert(point, sequential);
+            }
+            deferredPoints += points.size();
+        }
+        return finish(deferredPoints);
+    }
+}
+
+scaleGeom::DelaunayMesh3D scaleGeom::delaunay3D(const Vector3f* points, size_t count, unsigned _threads, Delaunay3DStats* _stats)
+{
+    std::vector<double> xyz(3 * count);
+    const float* raw = reinterpret_cast<const float*>(points);
+    parallelFor(0, 3 * count, _threads, 3 * MIN_CHUNK, [&](size_t i) { xyz[i] = raw[i]; });
+    DelaunayMesh3D mesh = tetrahedralize(xyz.data(), count, _threads, _stats);
+    if (_stats)
+        _stats->peakBytes += xyz.capacity() * sizeof(double);
+    return mesh;
+}
+
+scaleGeom::DelaunayMesh3D scaleGeom::delaunay3D(const Vector3d* points, size_t count, unsigned _threads, Delaunay3DStats* _stats)
+{
+    return tetrahedralize(reinterpret_cast<const double*>(points), count, _threads, _stats);
+}
@@ -0,0 +1,93 @@
+/*
+	Delaunay3D.h - 3D Delaunay Tetrahedralization
+
+	Overview:
+	Computes the Delaunay tetrahedralization of an array of Vector3f or Vector3d points with the
+	same machinery as Delaunay2D.h, one dimension up:
+
+	- Bowyer-Watson insertion in BRIO order (rounds of doubling size, each sorted along a
+	  Hilbert curve), with points located by a remembering stochastic walk.
+	- The hull is closed with ghost tetrahedra on a vertex at infinity, so no bounding
+	  super-tetrahedron is needed.
+	- orient3d (the exact sign of -scalarTripleProduct(b - a, c - a, d - a)) and inSphere come
+	  from Predicates.h, so the result is a valid Delaunay tetrahedralization for any finite
+	  input. Cospherical points are tetrahedralized in one of the valid ways.
+
+	Storage:
+	Tetrahedra are four point indices each, with orient3d(v0, v1, v2, v3) > 0 (v3 lies on the side
+	of the plane v0 v1 v2 from which the three appear clockwise). Adjacency is stored per face:
+	face 4 * t + k is the face of tetrahedron t opposite its vertex k, and halffaces[4t + k] is the
+	same face seen from the neighbouring tetrahedron (4 * n + j), or NONE on the convex hull. The
+	slots of destroyed tetrahedra are kept on a free list and reused. The output is ordered by the
+	last inserted vertex of each tetrahedron, so the tetrahedra around a point are mostly close
+	together.
+
+	Parallel mode:
+	As in Delaunay2D.h: after a sequential start on about 1/16 of the points, the rest are inserted
+	in x strips, all even strips concurrently and then all odd strips, each thread touching only
+	tetrahedra whose vertices lie in a range no concurrently running strip can touch. Slots are
+	handed out to threads in blocks. Strips are at least a few point spacings of the start mesh
+	wide, so small inputs use fewer strips than threads, and inputs too small for four strips are
+	inserted sequentially. Walks restart from tetrahedra kept on a coarse grid when they leave the
+	range, as they do across hollows in the data. A point whose insertion reaches outside the range
+	is deferred to the next phase, in the strip of the other parity whose range holds it; after a
+	few phases the points left (mostly near the hull, where tetrahedra are long) are inserted
+	sequentially.
+
+	Output:
+	Duplicate points are inserted once (the first occurrence in insertion order). Inputs with
+	fewer than four points that are not coplanar give an empty result. Coordinates must be finite.
+	Face indices are 32-bit, which limits the work space to 2^30 tetrahedra (about 150 million
+	uniformly spread points); larger inputs throw std::length_error.
+
+	If _stats is not null it receives the peak size of the working arrays and the output, and the
+	number of points that the parallel mode deferred to the sequential pass.
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	struct DelaunayMesh3D
+	{
+		static constexpr uint32_t NONE = 0xffffffffu;
+
+		// Four point indices per tetrahedron, positively oriented.
+		std::vector<uint32_t> tetrahedra;
+
+		// Opposite of every face (4 * tetrahedron + index of the vertex it excludes), or NONE on the hull.
+		std::vector<uint32_t> halffaces;
+
+		size_t tetrahedronCount() const { return tetrahedra.size() / 4; }
+
+		bool empty() const { return tetrahedra.empty(); }
+	};
+
+	struct Delaunay3DStats
+	{
+		size_t peakBytes = 0;
+		size_t deferredPoints = 0;
+	};
+
+	// Delaunay tetrahedralization of points[0, count). _threads = 0 uses every hardware thread; 1 is sequential.
+	DelaunayMesh3D delaunay3D(const Vector3f* points, size_t count, unsigned _threads = 0, Delaunay3DStats* _stats = nullptr);
+	DelaunayMesh3D delaunay3D(const Vector3d* points, size_t count, unsigned _threads = 0, Delaunay3DStats* _stats = nullptr);
+
+	inline DelaunayMesh3D delaunay3D(const std::vector<Vector3f>& points, unsigned _threads = 0, Delaunay3DStats* _stats = nullptr)
+	{
+		return delaunay3D(points.data(), points.size(), _threads, _stats);
+	}
+
+	inline DelaunayMesh3D delaunay3D(const std::vector<Vector3d>& points, unsigned _threads = 0, Delaunay3DStats* _stats = nullptr)
+	{
+		return delaunay3D(points.data(), points.size(), _threads, _stats);
+	}
+
+} // Closing the scaleGeom namespace.
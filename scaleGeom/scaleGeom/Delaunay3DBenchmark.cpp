@@ -0,0 +1,81 @@
+#include "Benchmark.h"
+#include "Delaunay3D.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    // Fraction of the points the parallel mode may leave to its sequential pass before the run is flagged.
+    const double MAX_DEFERRED = 0.03;
+
+    // Uniform points in the unit cube, or a scanned-surface like shell: points near a sphere with some noise.
+    template<class coordDataType>
+    std::vector<scaleGeom::Vector<coordDataType, scaleGeom::DIM3>> makePoints(size_t count, bool shell)
+    {
+        std::mt19937 rng(9);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::normal_distribution<double> gauss(0.0, 1.0);
+        std::vector<scaleGeom::Vector<coordDataType, scaleGeom::DIM3>> points(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            double x = uniform(rng), y = uniform(rng), z = uniform(rng);
+            if (shell)
+            {
+                x = gauss(rng);
+                y = gauss(rng);
+                z = gauss(rng);
+                const double scale = (1.0 + 0.05 * uniform(rng)) / std::sqrt(x * x + y * y + z * z);
+                x *= scale;
+                y *= scale;
+                z *= scale;
+            }
+            points[i] = scaleGeom::Vector<coordDataType, scaleGeom::DIM3>(static_cast<coordDataType>(x), static_cast<coordDataType>(y),
+                static_cast<coordDataType>(z));
+        }
+        return points;
+    }
+
+    template<class coordDataType>
+    void run(const char* label, bool shell)
+    {
+        const std::vector<scaleGeom::Vector<coordDataType, scaleGeom::DIM3>> points = makePoints<coordDataType>(scaleGeom::bench::problemSize(500000), shell);
+        // At least up to 8 threads even on smaller machines, so the strips of a typical parallel run are checked.
+        const unsigned widest = std::max(scaleGeom::resolveThreadCount(0), 8u);
+        size_t reference = 0;
+        for (unsigned threads = 1; ; threads = std::min(threads * 2, widest))
+        {
+            scaleGeom::Delaunay3DStats stats;
+            Timer timer;
+            const scaleGeom::DelaunayMesh3D mesh = scaleGeom::delaunay3D(points, threads, &stats);
+            const double seconds = timer.seconds();
+            if (threads == 1)
+                reference = mesh.tetrahedronCount();
+            std::cout << "  " << std::left << std::setw(20) << label << std::right
+                << std::setw(3) << threads << " threads "
+                << std::setw(9) << std::fixed << std::setprecision(2) << seconds * 1e3 << " ms  "
+                << std::setw(7) << std::setprecision(2) << mesh.tetrahedronCount() / seconds / 1e6 << " Mtets/s  "
+                << std::setw(9) << mesh.tetrahedronCount() << " tets  "
+                << std::setw(5) << std::setprecision(0) << static_cast<double>(stats.peakBytes) / points.size() << " B/point peak  "
+                << std::setw(7) << stats.deferredPoints << " deferred"
+                << (mesh.tetrahedronCount() == reference ? "" : "  MISMATCH")
+                << (stats.deferredPoints > MAX_DEFERRED * points.size() ? "  TOO MANY DEFERRED" : "") << std::endl;
+            if (threads == widest)
+                break;
+        }
+    }
+}
+
+SCALEGEOM_BENCHMARK(Delaunay3D)
+{
+    run<float>("uniform, Vector3f", false);
+    run<double>("uniform, Vector3d", false);
+    run<float>("shell, Vector3f", true);
+}
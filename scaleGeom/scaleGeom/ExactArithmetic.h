@@ -0,0 +1,364 @@
+/*
+	ExactArithmetic.h - Floating-Point Expansion Arithmetic
+
+	Overview:
+	The error-free transformations and expansion arithmetic (Shewchuk, "Adaptive Precision
+	Floating-Point Arithmetic and Fast Robust Geometric Predicates", 1997) behind the exact
+	predicates of Predicates.h, for code that needs the exact sign of other polynomials in double
+	coordinates. An expansion is a sum of non-overlapping doubles, so sums, differences and
+	products of doubles are represented without any rounding.
+
+	Usage:
+	Only for .cpp files: including this header turns off floating-point contraction for the rest
+	of the translation unit, because a fused multiply-add silently breaks the transformations.
+
+	scaleGeom::exact::arena.reset();
+	double sign = (difference(ax, bx) * difference(cy, dy) - difference(ay, by) * difference(cx, dx)).sign();
+
+	Expansions built with the operators live in a per-thread arena that is reused after reset(),
+	so the exact path does not hit the heap once the arena has grown. Every value built since the
+	last reset() is invalidated by the next one.
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize ("fp-contract=off")
+#elif defined(_MSC_VER)
+#pragma fp_contract (off)
+#endif
+
+namespace scaleGeom {
+
+	namespace exact {
+
+		// Machine epsilon (2^-53) and the splitter (2^27 + 1) of IEEE double.
+		const double EPSILON = 1.1102230246251565e-16;
+		const double SPLITTER = 134217729.0;
+
+		// ---------------------------------------------------------------------------------------
+		// Error-free transformations. Each returns the rounded result x and the exact rounding
+		// error y, so that x + y equals the exact result.
+		// ---------------------------------------------------------------------------------------
+
+		inline void fastTwoSum(double a, double b, double& x, double& y)
+		{
+			x = a + b;
+			double bvirt = x - a;
+			y = b - bvirt;
+		}
+
+		inline void twoSum(double a, double b, double& x, double& y)
+		{
+			x = a + b;
+			double bvirt = x - a;
+			double avirt = x - bvirt;
+			double bround = b - bvirt;
+			double around = a - avirt;
+			y = around + bround;
+		}
+
+		inline double twoDiffTail(double a, double b, double x)
+		{
+			double bvirt = a - x;
+			double avirt = x + bvirt;
+			double bround = bvirt - b;
+			double around = a - avirt;
+			return around + bround;
+		}
+
+		inline void twoDiff(double a, double b, double& x, double& y)
+		{
+			x = a - b;
+			y = twoDiffTail(a, b, x);
+		}
+
+		inline void split(double a, double& hi, double& lo)
+		{
+			double c = SPLITTER * a;
+			double abig = c - a;
+			hi = c - abig;
+			lo = a - hi;
+		}
+
+		inline void twoProductPresplit(double a, double b, double bhi, double blo, double& x, double& y)
+		{
+			x = a * b;
+			double ahi, alo;
+			split(a, ahi, alo);
+			double err1 = x - (ahi * bhi);
+			double err2 = err1 - (alo * bhi);
+			double err3 = err2 - (ahi * blo);
+			y = (alo * blo) - err3;
+		}
+
+		inline void twoProduct(double a, double b, double& x, double& y)
+		{
+			double bhi, blo;
+			split(b, bhi, blo);
+			twoProductPresplit(a, b, bhi, blo, x, y);
+		}
+
+		// (a1 + a0) - b as a three term expansion x2 + x1 + x0.
+		inline void twoOneDiff(double a1, double a0, double b, double& x2, double& x1, double& x0)
+		{
+			double i;
+			twoDiff(a0, b, i, x0);
+			twoSum(a1, i, x2, x1);
+		}
+
+		// (a1 + a0) - (b1 + b0) as a four term expansion, stored least significant first in x.
+		inline void twoTwoDiff(double a1, double a0, double b1, double b0, double* x)
+		{
+			double j, zero;
+			twoOneDiff(a1, a0, b0, j, zero, x[0]);
+			twoOneDiff(j, zero, b1, x[3], x[2], x[1]);
+		}
+
+		// ---------------------------------------------------------------------------------------
+		// Expansion arithmetic. An expansion is an array of non-overlapping doubles sorted by
+		// increasing magnitude whose exact sum is the represented value. All routines drop zero
+		// components but always produce at least one component.
+		// ---------------------------------------------------------------------------------------
+
+		// h = e + f. h must have room for elen + flen components.
+		inline int expansionSum(int elen, const double* e, int flen, const double* f, double* h)
+		{
+			double q, qnew, hh;
+			int eindex = 0, findex = 0, hindex = 0;
+			double enow = e[0];
+			double fnow = f[0];
+			if ((fnow > enow) == (fnow > -enow))
+			{
+				q = enow;
+				eindex++;
+			}
+			else
+			{
+				q = fnow;
+				findex++;
+			}
+			if (eindex < elen && findex < flen)
+			{
+				enow = e[eindex];
+				fnow = f[findex];
+				if ((fnow > enow) == (fnow > -enow))
+				{
+					fastTwoSum(enow, q, qnew, hh);
+					eindex++;
+				}
+				else
+				{
+					fastTwoSum(fnow, q, qnew, hh);
+					findex++;
+				}
+				q = qnew;
+				if (hh != 0.0)
+					h[hindex++] = hh;
+				while (eindex < elen && findex < flen)
+				{
+					enow = e[eindex];
+					fnow = f[findex];
+					if ((fnow > enow) == (fnow > -enow))
+					{
+						twoSum(q, enow, qnew, hh);
+						eindex++;
+					}
+					else
+					{
+						twoSum(q, fnow, qnew, hh);
+						findex++;
+					}
+					q = qnew;
+					if (hh != 0.0)
+						h[hindex++] = hh;
+				}
+			}
+			while (eindex < elen)
+			{
+				twoSum(q, e[eindex++], qnew, hh);
+				q = qnew;
+				if (hh != 0.0)
+					h[hindex++] = hh;
+			}
+			while (findex < flen)
+			{
+				twoSum(q, f[findex++], qnew, hh);
+				q = qnew;
+				if (hh != 0.0)
+					h[hindex++] = hh;
+			}
+			if (q != 0.0 || hindex == 0)
+				h[hindex++] = q;
+			return hindex;
+		}
+
+		// h = e * b. h must have room for 2 * elen components.
+		inline int expansionScale(int elen, const double* e, double b, double* h)
+		{
+			double bhi, blo, q, hh, product1, product0, sum;
+			split(b, bhi, blo);
+			twoProductPresplit(e[0], b, bhi, blo, q, hh);
+			int hindex = 0;
+			if (hh != 0.0)
+				h[hindex++] = hh;
+			for (int eindex = 1; eindex < elen; eindex++)
+			{
+				twoProductPresplit(e[eindex], b, bhi, blo, product1, product0);
+				twoSum(q, product0, sum, hh);
+				if (hh != 0.0)
+					h[hindex++] = hh;
+				fastTwoSum(product1, sum, q, hh);
+				if (hh != 0.0)
+					h[hindex++] = hh;
+			}
+			if (q != 0.0 || hindex == 0)
+				h[hindex++] = q;
+			return hindex;
+		}
+
+		// Approximate value of an expansion.
+		inline double estimate(int elen, const double* e)
+		{
+			double q = e[0];
+			for (int i = 1; i < elen; i++)
+			{
+				q += e[i];
+			}
+			return q;
+		}
+
+		// ---------------------------------------------------------------------------------------
+		// Exact fallback. Larger determinants are evaluated with a small expression layer over
+		// expansions whose components live in a per-thread arena, so the slow path does not hit
+		// the heap once the arena has grown.
+		// ---------------------------------------------------------------------------------------
+
+		class ExpansionArena
+		{
+			static const size_t CHUNK = 1 << 16;
+
+			std::vector<std::unique_ptr<double[]>> chunks;
+			size_t chunk = 0;
+			size_t offset = 0;
+
+		public:
+
+			void reset()
+			{
+				chunk = 0;
+				offset = 0;
+			}
+
+			double* allocate(size_t count)
+			{
+				if (offset + count > CHUNK)
+				{
+					chunk++;
+					offset = 0;
+				}
+				if (chunk == chunks.size())
+					chunks.emplace_back(new double[CHUNK]);
+				double* result = chunks[chunk].get() + offset;
+				offset += count;
+				return result;
+			}
+		};
+
+		inline thread_local ExpansionArena arena;
+
+		struct Expansion
+		{
+			const double* terms;
+			int length;
+
+			double sign() const { return terms[length - 1]; }
+		};
+
+		// A single double.
+		inline Expansion value(double a)
+		{
+			double* h = arena.allocate(1);
+			h[0] = a;
+			return { h, 1 };
+		}
+
+		// Exact difference of two doubles.
+		inline Expansion difference(double a, double b)
+		{
+			double* h = arena.allocate(2);
+			double x, y;
+			twoDiff(a, b, x, y);
+			int length = 0;
+			if (y != 0.0)
+				h[length++] = y;
+			if (x != 0.0 || length == 0)
+				h[length++] = x;
+			return { h, length };
+		}
+
+		inline Expansion operator+(const Expansion& e, const Expansion& f)
+		{
+			double* h = arena.allocate(e.length + f.length);
+			return { h, expansionSum(e.length, e.terms, f.length, f.terms, h) };
+		}
+
+		inline Expansion operator-(const Expansion& e)
+		{
+			double* h = arena.allocate(e.length);
+			for (int i = 0; i < e.length; i++)
+			{
+				h[i] = -e.terms[i];
+			}
+			return { h, e.length };
+		}
+
+		inline Expansion operator-(const Expansion& e, const Expansion& f)
+		{
+			return e + (-f);
+		}
+
+		inline Expansion operator*(const Expansion& e, const Expansion& f)
+		{
+			// Multiply the longer expansion by every component of the shorter one and accumulate.
+			const Expansion& longer = e.length >= f.length ? e : f;
+			const Expansion& shorter = e.length >= f.length ? f : e;
+			double* scaled = arena.allocate(2 * longer.length);
+			Expansion result = { scaled, expansionScale(longer.length, longer.terms, shorter.terms[0], scaled) };
+			for (int i = 1; i < shorter.length; i++)
+			{
+				double* next = arena.allocate(2 * longer.length);
+				Expansion term = { next, expansionScale(longer.length, longer.terms, shorter.terms[i], next) };
+				result = result + term;
+			}
+			return result;
+		}
+
+		// Exact difference of two 64-bit integers whose difference fits in 63 bits.
+		// The integer difference is exact; splitting it into a rounded double and its (exact)
+		// remainder gives a two component expansion.
+		inline Expansion difference(int64_t a, int64_t b)
+		{
+			double* h = arena.allocate(2);
+			int64_t d = a - b;
+			double hi = static_cast<double>(d);
+			double lo = static_cast<double>(d - static_cast<int64_t>(hi));
+			int length = 0;
+			if (lo != 0.0)
+				h[length++] = lo;
+			if (hi != 0.0 || length == 0)
+				h[length++] = hi;
+			return { h, length };
+		}
+	}
+
+} // Closing the scaleGeom namespace.
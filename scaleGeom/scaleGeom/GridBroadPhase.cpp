@@ -0,0 +1,559 @@
+#include "GridBroadPhase.h"
+#include "Parallel.h"
+#include "Predicates.h"
+#include "VectorOrder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+    // Chunks smaller than this are not worth a thread of their own when binning.
+    const size_t MIN_CHUNK = 1 << 14;
+
+    // Candidate pairs per thread below which the narrow phase is not split further.
+    const size_t MIN_WORK = 1 << 12;
+
+    // Cells per axis are limited so that a cell key fits in 63 bits.
+    const uint64_t MAX_AXIS_CELLS_2D = uint64_t(1) << 31;
+    const uint64_t MAX_AXIS_CELLS_3D = uint64_t(1) << 21;
+
+    inline int signOf(double value)
+    {
+        return (value > 0.0) - (value < 0.0);
+    }
+
+    inline bool lexicographicLess(const double* p, const double* q)
+    {
+        return p[0] < q[0] || (p[0] == q[0] && p[1] < q[1]);
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Exact triangle-triangle test. Triangles are 9 doubles, and are not degenerate by the time
+    // they get here. Points in 2D are 2 doubles.
+    // ---------------------------------------------------------------------------------------
+
+    inline int orientation(const double* a, const double* b, const double* c)
+    {
+        return signOf(scaleGeom::orient2d(a, b, c));
+    }
+
+    // Closed 2D segments a-b and c-d, neither of them a point.
+    bool segmentsMeet(const double* a, const double* b, const double* c, const double* d)
+    {
+        const int o1 = orientation(a, b, c), o2 = orientation(a, b, d);
+        if (o1 == 0 && o2 == 0)
+        {
+            // On one line: compare the lexicographic extents.
+            const double* sLow = lexicographicLess(b, a) ? b : a;
+            const double* sHigh = sLow == a ? b : a;
+            const double* tLow = lexicographicLess(d, c) ? d : c;
+            const double* tHigh = tLow == c ? d : c;
+            return !lexicographicLess(sHigh, tLow) && !lexicographicLess(tHigh, sLow);
+        }
+        if (o1 * o2 > 0)
+            return false;
+        return orientation(c, d, a) * orientation(c, d, b) <= 0;
+    }
+
+    // Point p in the closed 2D triangle t (6 doubles).
+    bool insideTriangle(const double* p, const double* t)
+    {
+        const int s0 = orientation(t, t + 2, p), s1 = orientation(t + 2, t + 4, p), s2 = orientation(t + 4, t, p);
+        return (s0 >= 0 && s1 >= 0 && s2 >= 0) || (s0 <= 0 && s1 <= 0 && s2 <= 0);
+    }
+
+    bool segmentMeetsTriangle(const double* a, const double* b, const double* t)
+    {
+        if (insideTriangle(a, t))
+            return true;
+        for (int k = 0; k < 3; k++)
+        {
+            if (segmentsMeet(a, b, t + 2 * k, t + 2 * ((k + 1) % 3)))
+                return true;
+        }
+        return false;
+    }
+
+    bool trianglesMeet(const double* t, const double* u)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            for (int l = 0; l < 3; l++)
+            {
+                if (segmentsMeet(t + 2 * k, t + 2 * ((k + 1) % 3), u + 2 * l, u + 2 * ((l + 1) % 3)))
+                    return true;
+            }
+        }
+        return insideTriangle(t, u) || insideTriangle(u, t);
+    }
+
+    // Coordinates of p in the coordinate plane without axis drop. The map is one-to-one on any plane
+    // that is not perpendicular to that coordinate plane.
+    inline void project(const double* p, int drop, double* out)
+    {
+        out[0] = p[drop == 0 ? 1 : 0];
+        out[1] = p[drop == 2 ? 1 : 2];
+    }
+
+    // Axis to drop so that the triangle keeps the largest projected area, or -1 if it has no area.
+    int dropAxis(const double* t)
+    {
+        int best = -1;
+        double largest = 0.0;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            double flat[6];
+            for (int k = 0; k < 3; k++)
+            {
+                project(t + 3 * k, axis, flat + 2 * k);
+            }
+            const double area = std::fabs(scaleGeom::orient2d(flat, flat + 2, flat + 4));
+            if (area > largest)
+            {
+                largest = area;
+                best = axis;
+            }
+        }
+        return best;
+    }
+
+    // Closed segment a-b against the closed triangle t, given the sides sa and sb of a and b of its plane.
+    bool segmentMeetsTriangle3D(const double* a, const double* b, const double* t, int drop, int sa, int sb)
+    {
+        if (sa == 0 && sb == 0)
+        {
+            double flat[10];
+            project(a, drop, flat);
+            project(b, drop, flat + 2);
+            for (int k = 0; k < 3; k++)
+            {
+                project(t + 3 * k, drop, flat + 4 + 2 * k);
+            }
+            return segmentMeetsTriangle(flat, flat + 2, flat + 4);
+        }
+        if (sa * sb > 0)
+            return false;
+
+        // The line through a and b crosses the plane; it passes through the closed triangle when it turns the
+        // same way around all three edges.
+        const int s0 = signOf(scaleGeom::orient3d(a, b, t, t + 3));
+        const int s1 = signOf(scaleGeom::orient3d(a, b, t + 3, t + 6));
+        const int s2 = signOf(scaleGeom::orient3d(a, b, t + 6, t));
+        return (s0 >= 0 && s1 >= 0 && s2 >= 0) || (s0 <= 0 && s1 <= 0 && s2 <= 0);
+    }
+
+    bool trianglesIntersectExact(const double* t, const double* u)
+    {
+        const int dropT = dropAxis(t), dropU = dropAxis(u);
+        if (dropT < 0 || dropU < 0)
+            return false;
+
+        int su[3], st[3];
+        for (int k = 0; k < 3; k++)
+        {
+            su[k] = signOf(scaleGeom::orient3d(t, t + 3, t + 6, u + 3 * k));
+        }
+        if ((su[0] > 0 && su[1] > 0 && su[2] > 0) || (su[0] < 0 && su[1] < 0 && su[2] < 0))
+            return false;
+        if (su[0] == 0 && su[1] == 0 && su[2] == 0)
+        {
+            double flatT[6], flatU[6];
+            for (int k = 0; k < 3; k++)
+            {
+                project(t + 3 * k, dropT, flatT + 2 * k);
+                project(u + 3 * k, dropT, flatU + 2 * k);
+            }
+            return trianglesMeet(flatT, flatU);
+        }
+        for (int k = 0; k < 3; k++)
+        {
+            st[k] = signOf(scaleGeom::orient3d(u, u + 3, u + 6, t + 3 * k));
+        }
+        if ((st[0] > 0 && st[1] > 0 && st[2] > 0) || (st[0] < 0 && st[1] < 0 && st[2] < 0))
+            return false;
+
+        // The intersection lies on the line where the planes meet, and each end of it is on an edge of one
+        // of the triangles, so they meet exactly when an edge of one meets the other.
+        for (int k = 0; k < 3; k++)
+        {
+            const int next = (k + 1) % 3;
+            if (segmentMeetsTriangle3D(t + 3 * k, t + 3 * next, u, dropU, st[k], st[next]))
+                return true;
+            if (segmentMeetsTriangle3D(u + 3 * k, u + 3 * next, t, dropT, su[k], su[next]))
+                return true;
+        }
+        return false;
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Grid.
+    // ---------------------------------------------------------------------------------------
+
+    template<size_t dimension>
+    struct Grid
+    {
+        double origin[dimension];
+        double size = 1.0;
+        double inverse = 1.0;
+        uint64_t cells[dimension];
+
+        uint64_t cell(double value, size_t axis) const
+        {
+            const double c = std::floor((value - origin[axis]) * inverse);
+            return c <= 0.0 ? 0 : std::min(static_cast<uint64_t>(c), cells[axis] - 1);
+        }
+    };
+
+    template<size_t dimension>
+    Grid<dimension> sizeGrid(const double* lower, const double* upper, double meanSize, size_t count)
+    {
+        const uint64_t maxCells = dimension == 2 ? MAX_AXIS_CELLS_2D : MAX_AXIS_CELLS_3D;
+        double volume = 1.0, largest = 0.0;
+        for (size_t axis = 0; axis < dimension; axis++)
+        {
+            volume *= upper[axis] - lower[axis];
+            largest = std::max(largest, upper[axis] - lower[axis]);
+        }
+        const double spacing = volume > 0.0 ? std::pow(volume / static_cast<double>(count), 1.0 / dimension) : largest / std::sqrt(static_cast<double>(count));
+
+        Grid<dimension> grid;
+        grid.size = std::max(meanSize, 0.25 * spacing);
+        for (size_t axis = 0; axis < dimension; axis++)
+        {
+            grid.size = std::max(grid.size, (upper[axis] - lower[axis]) / static_cast<double>(maxCells - 1));
+        }
+        if (!(grid.size > 0.0))
+            grid.size = 1.0;
+        grid.inverse = 1.0 / grid.size;
+        for (size_t axis = 0; axis < dimension; axis++)
+        {
+            grid.origin[axis] = lower[axis];
+            grid.cells[axis] = std::min<uint64_t>(static_cast<uint64_t>((upper[axis] - lower[axis]) * grid.inverse) + 1, maxCells);
+        }
+        return grid;
+    }
+
+    // Bin the primitives and call primitives.narrow(first, second) for every pair whose boxes overlap, once.
+    // Primitives provides box(i, lower, upper) and narrow(i, j), which returns whether the pair intersects.
+    template<size_t dimension, class Primitives>
+    void gridPairs(const Primitives& primitives, size_t count, unsigned threads, scaleGeom::GridBroadPhaseStats* _stats)
+    {
+        if (count >= 0xffffffffull)
+            throw std::length_error("gridBroadPhase supports at most 2^32 - 2 primitives\n");
+        scaleGeom::GridBroadPhaseStats stats;
+        if (count == 0)
+        {
+            if (_stats)
+                *_stats = stats;
+            return;
+        }
+        const unsigned threadCount = scaleGeom::resolveThreadCount(threads);
+
+        // Boxes, their bounds and mean size.
+        struct Extent
+        {
+            double lower[dimension];
+            double upper[dimension];
+            double size = 0.0;
+        };
+        std::vector<double> boxes(2 * dimension * count);
+        std::vector<Extent> extents(threadCount);
+        for (Extent& extent : extents)
+        {
+            std::fill(extent.lower, extent.lower + dimension, std::numeric_limits<double>::infinity());
+            std::fill(extent.upper, extent.upper + dimension, -std::numeric_limits<double>::infinity());
+        }
+        scaleGeom::parallelChunks(0, count, threads, MIN_CHUNK, [&](unsigned chunk, size_t begin, size_t end) {
+            Extent& extent = extents[chunk];
+            for (size_t i = begin; i < end; i++)
+            {
+                double* box = &boxes[2 * dimension * i];
+                primitives.box(i, box, box + dimension);
+                double size = 0.0;
+                for (size_t axis = 0; axis < dimension; axis++)
+                {
+                    extent.lower[axis] = std::min(extent.lower[axis], box[axis]);
+                    extent.upper[axis] = std::max(extent.upper[axis], box[dimension + axis]);
+                    size = std::max(size, box[dimension + axis] - box[axis]);
+                }
+                extent.size += size;
+            }
+        });
+        for (size_t k = 1; k < extents.size(); k++)
+        {
+            for (size_t axis = 0; axis < dimension; axis++)
+            {
+                extents[0].lower[axis] = std::min(extents[0].lower[axis], extents[k].lower[axis]);
+                extents[0].upper[axis] = std::max(extents[0].upper[axis], extents[k].upper[axis]);
+            }
+            extents[0].size += extents[k].size;
+        }
+        const Grid<dimension> grid = sizeGrid<dimension>(extents[0].lower, extents[0].upper, extents[0].size / static_cast<double>(count), count);
+        stats.cellSize = grid.size;
+
+        // References from every primitive to the cells its box overlaps, sorted by cell key (x fastest).
+        std::vector<size_t> offsets(count + 1, 0);
+        scaleGeom::parallelFor(0, count, threads, MIN_CHUNK, [&](size_t i) {
+            const double* box = &boxes[2 * dimension * i];
+            size_t cells = 1;
+            for (size_t axis = 0; axis < dimension; axis++)
+            {
+                cells *= static_cast<size_t>(grid.cell(box[dimension + axis], axis) - grid.cell(box[axis], axis) + 1);
+            }
+            offsets[i + 1] = cells;
+        });
+        for (size_t i = 0; i < count; i++)
+        {
+            offsets[i + 1] += offsets[i];
+        }
+        const size_t references = offsets[count];
+        std::vector<uint64_t> keys(references);
+        std::vector<uint32_t> values(references);
+        scaleGeom::parallelFor(0, count, threads, MIN_CHUNK, [&](size_t i) {
+            const double* box = &boxes[2 * dimension * i];
+            uint64_t first[dimension], last[dimension], at[dimension];
+            for (size_t axis = 0; axis < dimension; axis++)
+            {
+                first[axis] = at[axis] = grid.cell(box[axis], axis);
+                last[axis] = grid.cell(box[dimension + axis], axis);
+            }
+            for (size_t r = offsets[i]; r < offsets[i + 1]; r++)
+            {
+                uint64_t key = 0;
+                for (size_t axis = dimension; axis-- > 0; )
+                {
+                    key = key * grid.cells[axis] + at[axis];
+                }
+                keys[r] = key;
+                values[r] = static_cast<uint32_t>(i);
+                for (size_t axis = 0; axis < dimension && ++at[axis] > last[axis]; axis++)
+                {
+                    at[axis] = first[axis];
+                }
+            }
+        });
+        uint64_t keyRange = 1;
+        for (size_t axis = 0; axis < dimension; axis++)
+        {
+            keyRange *= grid.cells[axis];
+        }
+        unsigned keyBits = 1;
+        while (keyBits < 64 && (keyRange - 1) >> keyBits)
+            keyBits++;
+        scaleGeom::radixSort(keys.data(), values.data(), references, keyBits, threads);
+
+        // Cells with at least two references, as runs of the sorted list, and their number of pairs. A chunk
+        // owns the runs that start in it.
+        std::vector<std::vector<size_t>> chunkRuns(threadCount);
+        scaleGeom::parallelChunks(0, references, threads, MIN_CHUNK, [&](unsigned chunk, size_t begin, size_t end) {
+            std::vector<size_t>& runs = chunkRuns[chunk];
+            size_t r = begin;
+            while (r < end && r > 0 && keys[r] == keys[r - 1])
+                r++;
+            while (r < end)
+            {
+                size_t runEnd = r + 1;
+                while (runEnd < references && keys[runEnd] == keys[r])
+                    runEnd++;
+                if (runEnd - r > 1)
+                    runs.push_back(r);
+                r = runEnd;
+            }
+        });
+        std::vector<size_t> runStart;
+        for (const std::vector<size_t>& runs : chunkRuns)
+        {
+            runStart.insert(runStart.end(), runs.begin(), runs.end());
+        }
+        std::vector<size_t> runEnd(runStart.size()), work(runStart.size() + 1, 0);
+        for (size_t c = 0; c < runStart.size(); c++)
+        {
+            size_t e = runStart[c] + 1;
+            while (e < references && keys[e] == keys[runStart[c]])
+                e++;
+            runEnd[c] = e;
+            const size_t k = e - runStart[c];
+            work[c + 1] = work[c] + k * (k - 1) / 2;
+        }
+
+        // Narrow phase. Each pair is tested in the cell holding the lower corner of the intersection of the boxes.
+        std::vector<size_t> candidates(threadCount, 0), intersections(threadCount, 0);
+        scaleGeom::parallelChunks(0, work.back(), threads, MIN_WORK, [&](unsigned chunk, size_t begin, size_t end) {
+            const size_t firstCell = std::lower_bound(work.begin(), work.end() - 1, begin) - work.begin();
+            const size_t endCell = std::lower_bound(work.begin(), work.end() - 1, end) - work.begin();
+            std::vector<uint32_t> ids;
+            std::vector<double> cellBoxes;
+            for (size_t c = firstCell; c < endCell; c++)
+            {
+                uint64_t at[dimension];
+                uint64_t key = keys[runStart[c]];
+                for (size_t axis = 0; axis < dimension; axis++)
+                {
+                    at[axis] = key % grid.cells[axis];
+                    key /= grid.cells[axis];
+                }
+                ids.assign(values.begin() + runStart[c], values.begin() + runEnd[c]);
+                cellBoxes.resize(2 * dimension * ids.size());
+                for (size_t i = 0; i < ids.size(); i++)
+                {
+                    std::copy_n(&boxes[2 * dimension * ids[i]], 2 * dimension, &cellBoxes[2 * dimension * i]);
+                }
+                for (size_t i = 0; i < ids.size(); i++)
+                {
+                    const double* a = &cellBoxes[2 * dimension * i];
+                    for (size_t j = i + 1; j < ids.size(); j++)
+                    {
+                        const double* b = &cellBoxes[2 * dimension * j];
+                        bool owned = true;
+                        for (size_t axis = 0; axis < dimension && owned; axis++)
+                        {
+                            owned = a[axis] <= b[dimension + axis] && b[axis] <= a[dimension + axis]
+                                && grid.cell(std::max(a[axis], b[axis]), axis) == at[axis];
+                        }
+                        if (!owned)
+                            continue;
+                        candidates[chunk]++;
+                        if (primitives.narrow(std::min(ids[i], ids[j]), std::max(ids[i], ids[j])))
+                            intersections[chunk]++;
+                    }
+                }
+            }
+        });
+
+        if (_stats)
+        {
+            stats.cells = runStart.size();
+            stats.references = references;
+            for (unsigned t = 0; t < threadCount; t++)
+            {
+                stats.candidates += candidates[t];
+                stats.intersections += intersections[t];
+            }
+            *_stats = stats;
+        }
+    }
+
+    struct SegmentPrimitives
+    {
+        const float* endpoints;
+        const scaleGeom::SegmentIntersectionCallback& fn;
+        bool reportSharedEndpoints;
+
+        scaleGeom::Vector2d point(size_t index) const
+        {
+            return scaleGeom::Vector2d(endpoints[2 * index], endpoints[2 * index + 1]);
+        }
+
+        void box(size_t i, double* lower, double* upper) const
+        {
+            const float* p = endpoints + 4 * i;
+            for (int axis = 0; axis < 2; axis++)
+            {
+                lower[axis] = std::min(p[axis], p[2 + axis]);
+                upper[axis] = std::max(p[axis], p[2 + axis]);
+            }
+        }
+
+        bool narrow(uint32_t s, uint32_t t) const
+        {
+            scaleGeom::Vector2d crossing;
+            if (!scaleGeom::segmentsIntersect(point(2 * s), point(2 * s + 1), point(2 * t), point(2 * t + 1), &crossing, reportSharedEndpoints))
+                return false;
+            fn(s, t, crossing);
+            return true;
+        }
+    };
+
+    struct TrianglePrimitives
+    {
+        const float* vertices;
+        const uint32_t* indices;
+        const scaleGeom::TrianglePairCallback& fn;
+
+        size_t corner(size_t triangle, int k) const
+        {
+            return indices ? indices[3 * triangle + k] : 3 * triangle + k;
+        }
+
+        void load(size_t triangle, double* out) const
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                const float* p = vertices + 3 * corner(triangle, k);
+                out[3 * k] = p[0];
+                out[3 * k + 1] = p[1];
+                out[3 * k + 2] = p[2];
+            }
+        }
+
+        void box(size_t i, double* lower, double* upper) const
+        {
+            double t[9];
+            load(i, t);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                lower[axis] = std::min(std::min(t[axis], t[3 + axis]), t[6 + axis]);
+                upper[axis] = std::max(std::max(t[axis], t[3 + axis]), t[6 + axis]);
+            }
+        }
+
+        bool narrow(uint32_t s, uint32_t t) const
+        {
+            if (indices)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    const uint32_t v = indices[3 * size_t(s) + k];
+                    if (v == indices[3 * size_t(t)] || v == indices[3 * size_t(t) + 1] || v == indices[3 * size_t(t) + 2])
+                        return false;
+                }
+            }
+            double a[9], b[9];
+            load(s, a);
+            load(t, b);
+            if (!trianglesIntersectExact(a, b))
+                return false;
+            fn(s, t);
+            return true;
+        }
+    };
+}
+
+void scaleGeom::gridIntersectSegments(const Vector2f* endpoints, size_t count, const SegmentIntersectionCallback& fn,
+    bool _reportSharedEndpoints, unsigned _threads, GridBroadPhaseStats* _stats)
+{
+    const SegmentPrimitives primitives = { reinterpret_cast<const float*>(endpoints), fn, _reportSharedEndpoints };
+    gridPairs<DIM2>(primitives, count, _threads, _stats);
+}
+
+void scaleGeom::gridIntersectTriangles(const Vector3f* vertices, size_t count, const TrianglePairCallback& fn,
+    unsigned _threads, GridBroadPhaseStats* _stats)
+{
+    const TrianglePrimitives primitives = { reinterpret_cast<const float*>(vertices), nullptr, fn };
+    gridPairs<DIM3>(primitives, count, _threads, _stats);
+}
+
+void scaleGeom::gridIntersectTriangles(const Vector3f* vertices, const uint32_t* indices, size_t count, const TrianglePairCallback& fn,
+    unsigned _threads, GridBroadPhaseStats* _stats)
+{
+    const TrianglePrimitives primitives = { reinterpret_cast<const float*>(vertices), indices, fn };
+    gridPairs<DIM3>(primitives, count, _threads, _stats);
+}
+
+bool scaleGeom::trianglesIntersect(const Vector3d& a0, const Vector3d& a1, const Vector3d& a2, const Vector3d& b0, const Vector3d& b1, const Vector3d& b2)
+{
+    const Vector3d* points[6] = { &a0, &a1, &a2, &b0, &b1, &b2 };
+    double t[18];
+    for (int k = 0; k < 6; k++)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            t[3 * k + axis] = (*points[k])[axis];
+        }
+    }
+    return trianglesIntersectExact(t, t + 9);
+}
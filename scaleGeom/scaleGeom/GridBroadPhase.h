@@ -0,0 +1,86 @@
+/*
+	GridBroadPhase.h - Parallel Uniform-Grid Intersection of Segments and Triangles
+
+	Overview:
+	The throughput counterpart of SegmentIntersection.h for many cores. Primitives are binned
+	into a uniform grid by their bounding boxes, and the cells are tested independently in
+	parallel:
+
+	- Sizing: the cell size is the mean bounding box size of the primitives (their largest axis),
+	  but not below a quarter of the spacing they would have if spread evenly over the bounds, so
+	  a typical primitive overlaps a handful of cells and a cell holds a handful of primitives.
+	  The grid is never allocated: only occupied cells exist, as runs of a list of (cell,
+	  primitive) references sorted by cell key with the parallel radix sort of VectorOrder.h.
+	- Narrow phase: each cell tests its pairs of primitives whose boxes overlap. Cells are dealt
+	  out to threads by their number of pairs, so dense cells do not stall one thread.
+	- Deduplication: a pair overlapping several cells is only tested in the cell that holds the
+	  lower corner of the intersection of the two boxes. The rule is decided from the pair alone,
+	  so no shared set or lock is needed and every pair is reported exactly once.
+
+	Narrow phase:
+	Both tests are exact. Segments use segmentsIntersect (SegmentIntersection.h) and report the
+	same pairs and points as intersectSegments, except that a crossing of three or more segments
+	at a point that is not representable may be rounded differently in its last bit.
+
+	Triangles are closed: touching at a point or along an edge counts. Non-coplanar triangles
+	meet exactly when an edge of one meets the other, which is decided with orient3d; coplanar
+	ones are projected to the coordinate plane they are least steep to and tested with orient2d.
+	Zero-area triangles never intersect anything.
+
+	Triangles are given as a soup (vertices[3i .. 3i + 2] is triangle i) or indexed. In the
+	indexed form, pairs of triangles that share a vertex index are mesh neighbours and are not
+	tested, so a closed mesh only reports its self-intersections.
+
+	The callback is called concurrently from several threads unless _threads is 1, and in no
+	particular order; each pair is reported once, with first < second. Coordinates must be
+	finite and counts below 2^32 - 1 (std::length_error otherwise).
+
+	Usage:
+	scaleGeom::gridIntersectTriangles(vertices.data(), indices.data(), indices.size() / 3,
+		[&](uint32_t first, uint32_t second) { ... });
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "SegmentIntersection.h"
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	typedef std::function<void(uint32_t first, uint32_t second)> TrianglePairCallback;
+
+	struct GridBroadPhaseStats
+	{
+		double cellSize = 0.0;
+
+		// Occupied cells, and the references from primitives to the cells their boxes overlap.
+		size_t cells = 0;
+		size_t references = 0;
+
+		// Pairs that reached the exact test, and pairs reported.
+		size_t candidates = 0;
+		size_t intersections = 0;
+	};
+
+	// Report every intersecting pair among the segments (endpoints[2i], endpoints[2i + 1]), i < count.
+	void gridIntersectSegments(const Vector2f* endpoints, size_t count, const SegmentIntersectionCallback& fn,
+		bool _reportSharedEndpoints = true, unsigned _threads = 0, GridBroadPhaseStats* _stats = nullptr);
+
+	// Report every intersecting pair of the triangles (vertices[3i], vertices[3i + 1], vertices[3i + 2]), i < count.
+	void gridIntersectTriangles(const Vector3f* vertices, size_t count, const TrianglePairCallback& fn,
+		unsigned _threads = 0, GridBroadPhaseStats* _stats = nullptr);
+
+	// Report every intersecting pair of the triangles (indices[3i], indices[3i + 1], indices[3i + 2]), i < count,
+	// that do not share a vertex index.
+	void gridIntersectTriangles(const Vector3f* vertices, const uint32_t* indices, size_t count, const TrianglePairCallback& fn,
+		unsigned _threads = 0, GridBroadPhaseStats* _stats = nullptr);
+
+	// Exact test of two closed triangles.
+	bool trianglesIntersect(const Vector3d& a0, const Vector3d& a1, const Vector3d& a2, const Vector3d& b0, const Vector3d& b1, const Vector3d& b2);
+
+} // Closing the scaleGeom namespace.
@@ -0,0 +1,145 @@
+#include "Benchmark.h"
+#include "GridBroadPhase.h"
+#include "Parallel.h"
+#include "SegmentIntersection.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    // Short segments of random direction, about two crossings per segment.
+    std::vector<scaleGeom::Vector2f> makeSegments(size_t count)
+    {
+        std::mt19937 rng(22);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        const double length = 2.0 / std::sqrt(static_cast<double>(count));
+        std::vector<scaleGeom::Vector2f> endpoints;
+        endpoints.reserve(2 * count);
+        for (size_t i = 0; i < count; i++)
+        {
+            const double x = uniform(rng), y = uniform(rng), angle = 6.283185307179586 * uniform(rng);
+            endpoints.push_back(scaleGeom::Vector2f(static_cast<float>(x), static_cast<float>(y)));
+            endpoints.push_back(scaleGeom::Vector2f(static_cast<float>(x + length * std::cos(angle)), static_cast<float>(y + length * std::sin(angle))));
+        }
+        return endpoints;
+    }
+
+    // A closed UV sphere with a radial bump field, and a copy of it rotated and shifted by a fraction of the
+    // radius, so the two shells cut each other along a closed curve while each one alone is a clean mesh.
+    void makeSpheres(size_t targetCount, std::vector<scaleGeom::Vector3f>& vertices, std::vector<uint32_t>& indices)
+    {
+        const uint32_t rings = std::max<uint32_t>(4, static_cast<uint32_t>(std::sqrt(static_cast<double>(targetCount) / 8.0)));
+        const uint32_t sectors = 2 * rings;
+        for (int copy = 0; copy < 2; copy++)
+        {
+            const uint32_t base = static_cast<uint32_t>(vertices.size());
+            const double shift = copy ? 0.3 : 0.0, turn = copy ? 0.5 : 0.0;
+            auto point = [&](double theta, double phi) {
+                const double radius = 1.0 + 0.02 * std::sin(5.0 * theta) * std::cos(7.0 * phi);
+                return scaleGeom::Vector3f(static_cast<float>(radius * std::sin(theta) * std::cos(phi) + shift),
+                    static_cast<float>(radius * std::sin(theta) * std::sin(phi)), static_cast<float>(radius * std::cos(theta)));
+            };
+
+            // The poles, then rings 1 .. rings - 1 of sectors vertices each.
+            vertices.push_back(point(0.0, 0.0));
+            vertices.push_back(point(3.141592653589793, 0.0));
+            for (uint32_t r = 1; r < rings; r++)
+            {
+                for (uint32_t s = 0; s < sectors; s++)
+                {
+                    vertices.push_back(point(3.141592653589793 * r / rings, 6.283185307179586 * s / sectors + turn));
+                }
+            }
+            auto ring = [&](uint32_t r, uint32_t s) {
+                return r == 0 ? base : r == rings ? base + 1 : base + 2 + (r - 1) * sectors + s % sectors;
+            };
+            for (uint32_t r = 0; r < rings; r++)
+            {
+                for (uint32_t s = 0; s < sectors; s++)
+                {
+                    const uint32_t a = ring(r, s), b = ring(r, s + 1), c = ring(r + 1, s), d = ring(r + 1, s + 1);
+                    if (r > 0)
+                        indices.insert(indices.end(), { a, c, b });
+                    if (r + 1 < rings)
+                        indices.insert(indices.end(), { b, c, d });
+                }
+            }
+        }
+    }
+
+    void report(const char* label, unsigned threads, double seconds, size_t count, const scaleGeom::GridBroadPhaseStats& stats, const char* note)
+    {
+        std::cout << "  " << std::left << std::setw(24) << label << std::right
+            << std::setw(3) << threads << " threads "
+            << std::setw(9) << std::fixed << std::setprecision(2) << seconds * 1e3 << " ms  "
+            << std::setw(7) << std::setprecision(2) << count / seconds / 1e6 << " Mprims/s  "
+            << std::setw(9) << stats.candidates << " candidates  "
+            << std::setw(8) << stats.intersections << " intersections"
+            << note << std::endl;
+    }
+}
+
+SCALEGEOM_BENCHMARK(GridBroadPhase)
+{
+    const unsigned hardware = scaleGeom::resolveThreadCount(0);
+
+    // Segments, checked against the sweep.
+    {
+        const std::vector<scaleGeom::Vector2f> endpoints = makeSegments(scaleGeom::bench::problemSize(1000000));
+        const size_t count = endpoints.size() / 2;
+        scaleGeom::SegmentIntersectionStats sweepStats;
+        {
+            Timer timer;
+            scaleGeom::intersectSegments(endpoints.data(), count, [](uint32_t, uint32_t, const scaleGeom::Vector2d&) {}, true, 0, &sweepStats);
+            const double seconds = timer.seconds();
+            std::cout << "  segments: " << count << ", sweep " << std::fixed << std::setprecision(2) << seconds * 1e3 << " ms, "
+                << sweepStats.intersections << " intersections" << std::endl;
+        }
+        for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware))
+        {
+            scaleGeom::GridBroadPhaseStats stats;
+            std::atomic<size_t> reported(0);
+            Timer timer;
+            scaleGeom::gridIntersectSegments(endpoints.data(), count, [&](uint32_t, uint32_t, const scaleGeom::Vector2d&) {
+                reported.fetch_add(1, std::memory_order_relaxed);
+            }, true, threads, &stats);
+            const double seconds = timer.seconds();
+            report("gridIntersectSegments", threads, seconds, count, stats, reported == sweepStats.intersections ? "" : "  MISMATCH");
+            if (threads == hardware)
+                break;
+        }
+    }
+
+    // Two intersecting closed meshes, indexed.
+    {
+        std::vector<scaleGeom::Vector3f> vertices;
+        std::vector<uint32_t> indices;
+        makeSpheres(scaleGeom::bench::problemSize(1000000), vertices, indices);
+        const size_t count = indices.size() / 3;
+        std::cout << "  triangles: " << count << std::endl;
+        size_t reference = 0;
+        for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware))
+        {
+            scaleGeom::GridBroadPhaseStats stats;
+            std::atomic<size_t> reported(0);
+            Timer timer;
+            scaleGeom::gridIntersectTriangles(vertices.data(), indices.data(), count, [&](uint32_t, uint32_t) {
+                reported.fetch_add(1, std::memory_order_relaxed);
+            }, threads, &stats);
+            const double seconds = timer.seconds();
+            if (threads == 1)
+                reference = reported;
+            report("gridIntersectTriangles", threads, seconds, count, stats, reported == reference ? "" : "  MISMATCH");
+            if (threads == hardware)
+                break;
+        }
+    }
+}
@@ -0,0 +1,205 @@
+/*
+	IntegerGeometry.h - Exact Geometry on Integer Coordinates
+
+	Overview:
+	Vectors with integer coordinates (e.g. points snapped to a grid) can be processed exactly with
+	plain integer arithmetic, as long as intermediate products are kept in wide enough
+	accumulators. This header provides those wide versions of the basic products and
+	division-free orientation predicates for 32-bit coordinates that need no floating-point
+	filter at all.
+
+	Accumulators:
+	Products and sums are accumulated in Int128, a 128-bit signed integer. It is the compiler's
+	__int128 where available (GCC, Clang) and a small two-word struct elsewhere (MSVC); define
+	SCALEGEOM_NO_INT128 to force the struct.
+
+	Ranges:
+	- exactDotProduct, exactCrossProduct2D/3D: exact for every integer type up to 32 bits, and
+	  for 64-bit coordinates in [-2^61, 2^61] (the range Predicates.h also requires).
+	- exactScalarTripleProduct: coordinates of at most 32 bits; 64-bit inputs would need more
+	  than 128 bits and do not compile.
+	- orient2dSign / orient3dSign for Vector<int32_t>: exact over the whole int32 range. These
+	  overloads take precedence over the templates in Predicates.h, which remain the exact path
+	  for 64-bit and floating-point coordinates.
+
+	Equality of integer Vectors (operator==) is exact; see Tolerance.h.
+
+*/
+
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include "Vector.h"
+#include "Predicates.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#if defined(__SIZEOF_INT128__) && !defined(SCALEGEOM_NO_INT128)
+#define SCALEGEOM_NATIVE_INT128 1
+#endif
+
+namespace scaleGeom {
+
+	typedef Vector<int32_t, DIM2> Vector2i;
+	typedef Vector<int32_t, DIM3> Vector3i;
+	typedef Vector<int64_t, DIM2> Vector2i64;
+	typedef Vector<int64_t, DIM3> Vector3i64;
+
+#if defined(SCALEGEOM_NATIVE_INT128)
+
+	__extension__ typedef __int128 Int128;
+
+	inline int int128Sign(Int128 v) { return (v > 0) - (v < 0); }
+
+	inline double int128ToDouble(Int128 v) { return static_cast<double>(v); }
+
+#else
+
+	// Two's complement 128-bit integer: high * 2^64 + low. Arithmetic wraps modulo 2^128 like the
+	// native type; the callers in this header never exceed the range.
+	struct Int128
+	{
+		uint64_t low;
+		int64_t high;
+
+		Int128() = default;
+
+		constexpr Int128(int64_t v) : low(static_cast<uint64_t>(v)), high(v < 0 ? -1 : 0) {}
+
+		constexpr Int128(uint64_t _low, int64_t _high) : low(_low), high(_high) {}
+	};
+
+	// Full 128-bit product of two unsigned 64-bit values.
+	inline Int128 multiplyUnsigned64(uint64_t a, uint64_t b)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		uint64_t high;
+		uint64_t low = _umul128(a, b, &high);
+		return Int128(low, static_cast<int64_t>(high));
+#else
+		const uint64_t aLow = a & 0xffffffffu, aHigh = a >> 32, bLow = b & 0xffffffffu, bHigh = b >> 32;
+		const uint64_t lowLow = aLow * bLow, lowHigh = aLow * bHigh, highLow = aHigh * bLow, highHigh = aHigh * bHigh;
+		const uint64_t middle = (lowLow >> 32) + (lowHigh & 0xffffffffu) + (highLow & 0xffffffffu);
+		const uint64_t low = (middle << 32) | (lowLow & 0xffffffffu);
+		const uint64_t high = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+		return Int128(low, static_cast<int64_t>(high));
+#endif
+	}
+
+	inline Int128 operator+(Int128 a, Int128 b)
+	{
+		const uint64_t low = a.low + b.low;
+		const uint64_t carry = low < a.low;
+		return Int128(low, static_cast<int64_t>(static_cast<uint64_t>(a.high) + static_cast<uint64_t>(b.high) + carry));
+	}
+
+	inline Int128 operator-(Int128 a)
+	{
+		const uint64_t low = ~a.low + 1;
+		return Int128(low, static_cast<int64_t>(~static_cast<uint64_t>(a.high) + (low == 0)));
+	}
+
+	inline Int128 operator-(Int128 a, Int128 b) { return a + -b; }
+
+	// Product modulo 2^128.
+	inline Int128 operator*(Int128 a, Int128 b)
+	{
+		Int128 result = multiplyUnsigned64(a.low, b.low);
+		const uint64_t cross = static_cast<uint64_t>(a.high) * b.low + a.low * static_cast<uint64_t>(b.high);
+		result.high = static_cast<int64_t>(static_cast<uint64_t>(result.high) + cross);
+		return result;
+	}
+
+	inline Int128& operator+=(Int128& a, Int128 b) { return a = a + b; }
+
+	inline bool operator==(Int128 a, Int128 b) { return a.low == b.low && a.high == b.high; }
+	inline bool operator!=(Int128 a, Int128 b) { return !(a == b); }
+	inline bool operator<(Int128 a, Int128 b) { return a.high < b.high || (a.high == b.high && a.low < b.low); }
+	inline bool operator>(Int128 a, Int128 b) { return b < a; }
+
+	inline int int128Sign(Int128 v)
+	{
+		if (v.high < 0)
+			return -1;
+		return (v.high > 0 || v.low != 0) ? 1 : 0;
+	}
+
+	// Nearest double (up to one rounding per word). Negative values are converted by magnitude so that
+	// small ones do not cancel.
+	inline double int128ToDouble(Int128 v)
+	{
+		const Int128 magnitude = v.high < 0 ? -v : v;
+		const double result = static_cast<double>(magnitude.high) * 18446744073709551616.0 + static_cast<double>(magnitude.low);
+		return v.high < 0 && magnitude.high >= 0 ? -result : result;
+	}
+
+#endif
+
+	// Exact dot product of integer vectors.
+	template<class coordDataType, size_t dimension>
+	Int128 exactDotProduct(const Vector<coordDataType, dimension>& v1, const Vector<coordDataType, dimension>& v2)
+	{
+		static_assert(std::is_integral<coordDataType>::value && sizeof(coordDataType) <= 8, "exactDotProduct needs integer coordinates of at most 64 bits");
+		Int128 dotProduct = 0;
+		for (size_t i = 0; i < dimension; i++)
+		{
+			dotProduct += Int128(static_cast<int64_t>(v1[i])) * Int128(static_cast<int64_t>(v2[i]));
+		}
+		return dotProduct;
+	}
+
+	// Exact 2D cross product of integer vectors.
+	template<class coordDataType>
+	Int128 exactCrossProduct2D(const Vector<coordDataType, DIM2>& v1, const Vector<coordDataType, DIM2>& v2)
+	{
+		static_assert(std::is_integral<coordDataType>::value && sizeof(coordDataType) <= 8, "exactCrossProduct2D needs integer coordinates of at most 64 bits");
+		return Int128(static_cast<int64_t>(v1[X])) * Int128(static_cast<int64_t>(v2[Y]))
+			- Int128(static_cast<int64_t>(v1[Y])) * Int128(static_cast<int64_t>(v2[X]));
+	}
+
+	// Exact 3D cross product of integer vectors.
+	template<class coordDataType>
+	std::array<Int128, 3> exactCrossProduct3D(const Vector<coordDataType, DIM3>& v1, const Vector<coordDataType, DIM3>& v2)
+	{
+		static_assert(std::is_integral<coordDataType>::value && sizeof(coordDataType) <= 8, "exactCrossProduct3D needs integer coordinates of at most 64 bits");
+		const Int128 ax = static_cast<int64_t>(v1[X]), ay = static_cast<int64_t>(v1[Y]), az = static_cast<int64_t>(v1[Z]);
+		const Int128 bx = static_cast<int64_t>(v2[X]), by = static_cast<int64_t>(v2[Y]), bz = static_cast<int64_t>(v2[Z]);
+		return { { ay * bz - az * by, az * bx - ax * bz, ax * by - ay * bx } };
+	}
+
+	// Exact scalar triple product (v1 x v2) . v3 of integer vectors of at most 32 bits.
+	template<class coordDataType>
+	Int128 exactScalarTripleProduct(const Vector<coordDataType, DIM3>& v1, const Vector<coordDataType, DIM3>& v2, const Vector<coordDataType, DIM3>& v3)
+	{
+		static_assert(std::is_integral<coordDataType>::value && sizeof(coordDataType) <= 4, "exactScalarTripleProduct needs integer coordinates of at most 32 bits");
+		const std::array<Int128, 3> cross = exactCrossProduct3D(v1, v2);
+		return cross[0] * Int128(static_cast<int64_t>(v3[X])) + cross[1] * Int128(static_cast<int64_t>(v3[Y]))
+			+ cross[2] * Int128(static_cast<int64_t>(v3[Z]));
+	}
+
+	// Exact sign of the 2D orientation of int32 points: sign of crossProduct2D(b - a, c - a).
+	// The differences take 33 bits and their products 66, so the determinant fits 128 bits.
+	inline int orient2dSign(const Vector2i& a, const Vector2i& b, const Vector2i& c)
+	{
+		const Int128 abx = static_cast<int64_t>(b[X]) - a[X], aby = static_cast<int64_t>(b[Y]) - a[Y];
+		const Int128 acx = static_cast<int64_t>(c[X]) - a[X], acy = static_cast<int64_t>(c[Y]) - a[Y];
+		return int128Sign(abx * acy - aby * acx);
+	}
+
+	// Exact sign of the 3D orientation of int32 points: sign of -scalarTripleProduct(b - a, c - a, d - a).
+	// Differences take 33 bits, 2x2 minors 67 and the determinant about 102.
+	inline int orient3dSign(const Vector3i& a, const Vector3i& b, const Vector3i& c, const Vector3i& d)
+	{
+		const Int128 adx = static_cast<int64_t>(a[X]) - d[X], ady = static_cast<int64_t>(a[Y]) - d[Y], adz = static_cast<int64_t>(a[Z]) - d[Z];
+		const Int128 bdx = static_cast<int64_t>(b[X]) - d[X], bdy = static_cast<int64_t>(b[Y]) - d[Y], bdz = static_cast<int64_t>(b[Z]) - d[Z];
+		const Int128 cdx = static_cast<int64_t>(c[X]) - d[X], cdy = static_cast<int64_t>(c[Y]) - d[Y], cdz = static_cast<int64_t>(c[Z]) - d[Z];
+		const Int128 det = adx * (bdy * cdz - bdz * cdy) + bdx * (cdy * adz - cdz * ady) + cdx * (ady * bdz - adz * bdy);
+		return int128Sign(det);
+	}
+
+} // Closing the scaleGeom namespace.
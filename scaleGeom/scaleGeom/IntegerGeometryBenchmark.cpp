@@ -0,0 +1,94 @@
+#include "Benchmark.h"
+#include "IntegerGeometry.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    const int REPEATS = 5;
+
+    // Quadruples snapped to a coarse grid, so that many are exactly coplanar; the other half are random.
+    std::vector<scaleGeom::Vector3i> makeQuadruples(size_t count, int gridSize)
+    {
+        std::mt19937 rng(46);
+        std::uniform_int_distribution<int> coarse(0, gridSize - 1), any(-1000000000, 1000000000);
+        std::vector<scaleGeom::Vector3i> points(4 * count);
+        for (size_t i = 0; i < count; i++)
+        {
+            for (int k = 0; k < 4; k++)
+            {
+                if (i % 2 == 0)
+                    points[4 * i + k] = scaleGeom::Vector3i(coarse(rng), coarse(rng), 0);
+                else
+                    points[4 * i + k] = scaleGeom::Vector3i(any(rng), any(rng), any(rng));
+            }
+        }
+        return points;
+    }
+
+    void report(const char* label, double seconds, size_t count)
+    {
+        std::cout << "  " << std::left << std::setw(32) << label << std::right
+            << std::setw(9) << std::fixed << std::setprecision(3) << seconds * 1e3 << " ms  "
+            << std::setw(8) << std::setprecision(2) << seconds * 1e9 / count << " ns/test" << std::endl;
+    }
+}
+
+// orient3d signs of int32 points: 128-bit integer determinant against the filtered predicate on int64 copies.
+SCALEGEOM_BENCHMARK(IntegerPredicates)
+{
+    const size_t count = scaleGeom::bench::problemSize(2000000);
+    const std::vector<scaleGeom::Vector3i> quads = makeQuadruples(count, 8);
+    std::vector<scaleGeom::Vector3i64> wide(quads.size());
+    for (size_t i = 0; i < quads.size(); i++)
+    {
+        wide[i] = scaleGeom::Vector3i64(quads[i][scaleGeom::X], quads[i][scaleGeom::Y], quads[i][scaleGeom::Z]);
+    }
+    std::vector<int> integerSigns(count), filteredSigns(count);
+    std::cout << "  quadruples: " << count << " (half exactly coplanar), 128-bit accumulator: "
+#if defined(SCALEGEOM_NATIVE_INT128)
+        << "native" << std::endl;
+#else
+        << "two-word struct" << std::endl;
+#endif
+
+    Timer timer;
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++)
+    {
+        timer.reset();
+        for (size_t i = 0; i < count; i++)
+        {
+            integerSigns[i] = scaleGeom::orient3dSign(quads[4 * i], quads[4 * i + 1], quads[4 * i + 2], quads[4 * i + 3]);
+        }
+        best = std::min(best, timer.seconds());
+    }
+    scaleGeom::bench::doNotOptimize(integerSigns.data());
+    report("orient3dSign, int32 exact", best, count);
+
+    best = 1e30;
+    for (int r = 0; r < REPEATS; r++)
+    {
+        timer.reset();
+        for (size_t i = 0; i < count; i++)
+        {
+            filteredSigns[i] = scaleGeom::orient3dSign(wide[4 * i], wide[4 * i + 1], wide[4 * i + 2], wide[4 * i + 3]);
+        }
+        best = std::min(best, timer.seconds());
+    }
+    scaleGeom::bench::doNotOptimize(filteredSigns.data());
+    report("orient3dSign, int64 filtered", best, count);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        mismatches += integerSigns[i] != filteredSigns[i];
+    }
+    std::cout << "  sign mismatches: " << mismatches << std::endl;
+}
@@ -0,0 +1,497 @@
+/*
+	KdTree.h - Static kd-tree for Nearest Neighbour, Radius and Box Queries
+
+	Overview:
+	KdTree indexes a fixed array of Vector<coordDataType, dimension> for k-nearest-neighbour,
+	radius and axis-aligned box queries. It is built once (in parallel) and is read-only
+	afterwards, so any number of threads may query it at the same time.
+
+	Layout:
+	- Nodes live in one flat array in depth-first order: the left child of a node is the next
+	  node, the right child is stored by index. A subtree's size depends only on its point count,
+	  which lets independent subtrees be built in parallel straight into their final slots.
+	- Each node splits its points at the median along the axis of largest spread.
+	- Leaves are buckets of at most bucketSize points. The coordinates are copied into the tree in
+	  SoA order (one array per axis), so a bucket is scanned with contiguous, vectorizable loads.
+	- The descent keeps the squared distance from the query to the current cell up to date
+	  incrementally (Arya and Mount) instead of storing bounding boxes.
+
+	Queries and allocation:
+	Results report the index of the point in the array the tree was built from. The single-query
+	functions take a QueryScratch, or an output vector, owned by the caller; reusing one per thread
+	means queries do not allocate once the buffers have grown. The batched functions split the
+	queries over threads, each with its own scratch, and process large batches in Morton order
+	so that consecutive queries hit the same nodes and buckets in cache; results are still
+	written in input order.
+
+	Distances are squared Euclidean distances, computed in float for float coordinates and in
+	double otherwise.
+
+*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "Parallel.h"
+#include "Vector.h"
+#include "VectorOrder.h"
+
+namespace scaleGeom {
+
+	template<class coordDataType, size_t dimension = DIM3>
+	class KdTree
+	{
+	public:
+
+		typedef typename std::conditional<std::is_same<coordDataType, float>::value, float, double>::type distanceType;
+
+		// Index reported for missing results (fewer than k points in the tree).
+		static constexpr uint32_t NONE = 0xffffffffu;
+
+		// Largest supported bucket size.
+		static constexpr size_t MAX_BUCKET_SIZE = 64;
+
+		// A query result: point index and squared distance to the query.
+		struct Neighbour
+		{
+			uint32_t index;
+			distanceType distanceSquared;
+		};
+
+		// Per-thread buffers for k-nearest-neighbour queries.
+		class QueryScratch
+		{
+			friend class KdTree;
+
+			// The best candidates so far, nearest first.
+			std::vector<Neighbour> candidates;
+		};
+
+	private:
+
+		static constexpr uint32_t LEAF = 0xffffffffu;
+
+		struct Node
+		{
+			// Split coordinate: points of the left child are <= split, points of the right child >= split.
+			coordDataType split;
+
+			// Split axis, or LEAF.
+			uint32_t axis;
+
+			// Internal node: index of the right child. Leaf: first point of the bucket.
+			uint32_t first;
+
+			// Leaf: one past the last point of the bucket.
+			uint32_t last;
+		};
+
+		// A point being sorted into the tree during the build.
+		struct Item
+		{
+			std::array<coordDataType, dimension> coords;
+			uint32_t index;
+		};
+
+		// A subtree still to be built: its node slot and its range of the item array.
+		struct Task
+		{
+			uint32_t node;
+			uint32_t begin;
+			uint32_t end;
+		};
+
+		std::vector<Node> nodes;
+		std::array<std::vector<coordDataType>, dimension> coords;
+		std::vector<uint32_t> indices;
+		size_t bucketSize = 16;
+
+		// Number of nodes of a subtree over count points.
+		size_t nodeCount(size_t count) const
+		{
+			if (count <= bucketSize)
+				return 1;
+			return 1 + nodeCount(count / 2) + nodeCount(count - count / 2);
+		}
+
+		// Turn task into a leaf, or split it and return its two child tasks in children. Returns false for a leaf.
+		bool splitTask(std::vector<Item>& items, const Task& task, Task* children)
+		{
+			Node& node = nodes[task.node];
+			if (task.end - task.begin <= bucketSize)
+			{
+				node.split = coordDataType();
+				node.axis = LEAF;
+				node.first = task.begin;
+				node.last = task.end;
+				return false;
+			}
+
+			std::array<coordDataType, dimension> low, high;
+			for (size_t d = 0; d < dimension; d++)
+			{
+				low[d] = high[d] = items[task.begin].coords[d];
+			}
+			for (uint32_t i = task.begin + 1; i < task.end; i++)
+			{
+				for (size_t d = 0; d < dimension; d++)
+				{
+					low[d] = std::min(low[d], items[i].coords[d]);
+					high[d] = std::max(high[d], items[i].coords[d]);
+				}
+			}
+			uint32_t axis = 0;
+			for (uint32_t d = 1; d < dimension; d++)
+			{
+				if (static_cast<double>(high[d]) - low[d] > static_cast<double>(high[axis]) - low[axis])
+					axis = d;
+			}
+
+			uint32_t mid = task.begin + (task.end - task.begin) / 2;
+			std::nth_element(items.begin() + task.begin, items.begin() + mid, items.begin() + task.end, [axis](const Item& a, const Item& b) {
+				return a.coords[axis] < b.coords[axis];
+			});
+
+			node.split = items[mid].coords[axis];
+			node.axis = axis;
+			node.first = static_cast<uint32_t>(task.node + 1 + nodeCount(mid - task.begin));
+			node.last = 0;
+			children[0] = { task.node + 1, task.begin, mid };
+			children[1] = { node.first, mid, task.end };
+			return true;
+		}
+
+		void buildSubtree(std::vector<Item>& items, const Task& task)
+		{
+			Task children[2];
+			if (splitTask(items, task, children))
+			{
+				buildSubtree(items, children[0]);
+				buildSubtree(items, children[1]);
+			}
+		}
+
+		// Order in which the batched functions process their queries: Morton order for large batches, so that
+		// consecutive queries walk the same part of the tree; empty (input order) for small ones.
+		static std::vector<uint32_t> queryOrder(const Vector<coordDataType, dimension>* queries, size_t count, unsigned _threads)
+		{
+			if (count < 4096)
+				return std::vector<uint32_t>();
+			return spatialSortPermutation(queries, count, SpatialOrder::Morton, _threads);
+		}
+
+		void loadQuery(const Vector<coordDataType, dimension>& query, distanceType* q) const
+		{
+			for (size_t d = 0; d < dimension; d++)
+			{
+				q[d] = static_cast<distanceType>(query[d]);
+			}
+		}
+
+		// Squared distances from q to the points of a bucket.
+		void bucketDistances(const Node& leaf, const distanceType* q, distanceType* distances) const
+		{
+			const uint32_t n = leaf.last - leaf.first;
+			for (uint32_t i = 0; i < n; i++)
+			{
+				distances[i] = 0;
+			}
+			for (size_t d = 0; d < dimension; d++)
+			{
+				const coordDataType* axis = coords[d].data() + leaf.first;
+				for (uint32_t i = 0; i < n; i++)
+				{
+					distanceType diff = static_cast<distanceType>(axis[i]) - q[d];
+					distances[i] += diff * diff;
+				}
+			}
+		}
+
+		void searchNearest(uint32_t index, const distanceType* q, distanceType cellDistance, distanceType* offsets, size_t k, std::vector<Neighbour>& candidates) const
+		{
+			const Node& node = nodes[index];
+			if (node.axis == LEAF)
+			{
+				distanceType distances[MAX_BUCKET_SIZE];
+				bucketDistances(node, q, distances);
+				// The candidates are kept sorted: for the small k of typical queries an insertion beats a heap.
+				for (uint32_t i = 0; i < node.last - node.first; i++)
+				{
+					if (candidates.size() == k && !(distances[i] < candidates.back().distanceSquared))
+						continue;
+					if (candidates.size() < k)
+						candidates.push_back(Neighbour());
+					size_t slot = candidates.size() - 1;
+					while (slot > 0 && distances[i] < candidates[slot - 1].distanceSquared)
+					{
+						candidates[slot] = candidates[slot - 1];
+						slot--;
+					}
+					candidates[slot] = { indices[node.first + i], distances[i] };
+				}
+				return;
+			}
+
+			distanceType diff = q[node.axis] - static_cast<distanceType>(node.split);
+			uint32_t nearChild = diff < 0 ? index + 1 : node.first;
+			uint32_t farChild = diff < 0 ? node.first : index + 1;
+			searchNearest(nearChild, q, cellDistance, offsets, k, candidates);
+
+			// Distance to the far cell: replace this axis' contribution by the distance to the split plane.
+			distanceType previous = offsets[node.axis];
+			distanceType farDistance = cellDistance - previous * previous + diff * diff;
+			if (candidates.size() < k || farDistance < candidates.back().distanceSquared)
+			{
+				offsets[node.axis] = diff;
+				searchNearest(farChild, q, farDistance, offsets, k, candidates);
+				offsets[node.axis] = previous;
+			}
+		}
+
+		void searchRadius(uint32_t index, const distanceType* q, distanceType cellDistance, distanceType* offsets, distanceType radiusSquared, std::vector<Neighbour>& out) const
+		{
+			const Node& node = nodes[index];
+			if (node.axis == LEAF)
+			{
+				distanceType distances[MAX_BUCKET_SIZE];
+				bucketDistances(node, q, distances);
+				for (uint32_t i = 0; i < node.last - node.first; i++)
+				{
+					if (distances[i] <= radiusSquared)
+						out.push_back({ indices[node.first + i], distances[i] });
+				}
+				return;
+			}
+
+			distanceType diff = q[node.axis] - static_cast<distanceType>(node.split);
+			uint32_t nearChild = diff < 0 ? index + 1 : node.first;
+			uint32_t farChild = diff < 0 ? node.first : index + 1;
+			searchRadius(nearChild, q, cellDistance, offsets, radiusSquared, out);
+
+			distanceType previous = offsets[node.axis];
+			distanceType farDistance = cellDistance - previous * previous + diff * diff;
+			if (farDistance <= radiusSquared)
+			{
+				offsets[node.axis] = diff;
+				searchRadius(farChild, q, farDistance, offsets, radiusSquared, out);
+				offsets[node.axis] = previous;
+			}
+		}
+
+		void searchBox(uint32_t index, const coordDataType* low, const coordDataType* high, std::vector<uint32_t>& out) const
+		{
+			const Node& node = nodes[index];
+			if (node.axis == LEAF)
+			{
+				for (uint32_t i = node.first; i < node.last; i++)
+				{
+					bool inside = true;
+					for (size_t d = 0; d < dimension; d++)
+					{
+						inside = inside && coords[d][i] >= low[d] && coords[d][i] <= high[d];
+					}
+					if (inside)
+						out.push_back(indices[i]);
+				}
+				return;
+			}
+			if (low[node.axis] <= node.split)
+				searchBox(index + 1, low, high, out);
+			if (high[node.axis] >= node.split)
+				searchBox(node.first, low, high, out);
+		}
+
+	public:
+
+		KdTree() {}
+
+		// Build over points[0, count). See build().
+		KdTree(const Vector<coordDataType, dimension>* points, size_t count, unsigned _threads = 0, size_t _bucketSize = 16)
+		{
+			build(points, count, _threads, _bucketSize);
+		}
+
+		// Build over points[0, count), replacing the current contents. The points are copied; the array is not
+		// referenced afterwards. Throws std::invalid_argument for a bucket size outside [1, MAX_BUCKET_SIZE] and
+		// std::length_error if count does not fit 32-bit indices.
+		void build(const Vector<coordDataType, dimension>* points, size_t count, unsigned _threads = 0, size_t _bucketSize = 16)
+		{
+			if (_bucketSize < 1 || _bucketSize > MAX_BUCKET_SIZE)
+				throw std::invalid_argument("KdTree: bucket size out of range\n");
+			if (count >= NONE)
+				throw std::length_error("KdTree: too many points for 32-bit indices\n");
+
+			const unsigned threads = resolveThreadCount(_threads);
+			bucketSize = _bucketSize;
+
+			// The build partitions copies of the points, so that it reads them sequentially.
+			std::vector<Item> items(count);
+			parallelFor(0, count, threads, 1 << 15, [&](size_t i) {
+				for (size_t d = 0; d < dimension; d++)
+				{
+					items[i].coords[d] = points[i][d];
+				}
+				items[i].index = static_cast<uint32_t>(i);
+			});
+
+			nodes.assign(count ? nodeCount(count) : 0, Node());
+			if (count)
+			{
+				// Split level by level, the tasks of a level in parallel, until there is enough independent
+				// work for every thread; then each thread finishes its subtrees depth-first.
+				std::vector<Task> tasks(1, Task{ 0, 0, static_cast<uint32_t>(count) });
+				while (tasks.size() < 4 * static_cast<size_t>(threads))
+				{
+					std::vector<Task> children(2 * tasks.size());
+					std::vector<char> split(tasks.size());
+					parallelFor(0, tasks.size(), threads, 1, [&](size_t t) {
+						split[t] = splitTask(items, tasks[t], &children[2 * t]);
+					});
+					std::vector<Task> next;
+					for (size_t t = 0; t < tasks.size(); t++)
+					{
+						if (split[t])
+						{
+							next.push_back(children[2 * t]);
+							next.push_back(children[2 * t + 1]);
+						}
+					}
+					tasks.swap(next);
+					if (tasks.empty())
+						break;
+				}
+				parallelFor(0, tasks.size(), threads, 1, [&](size_t t) {
+					buildSubtree(items, tasks[t]);
+				});
+			}
+
+			indices.resize(count);
+			for (size_t d = 0; d < dimension; d++)
+			{
+				coords[d].resize(count);
+			}
+			parallelFor(0, count, threads, 1 << 15, [&](size_t i) {
+				indices[i] = items[i].index;
+				for (size_t d = 0; d < dimension; d++)
+				{
+					coords[d][i] = items[i].coords[d];
+				}
+			});
+		}
+
+		// Number of indexed points.
+		size_t size() const { return indices.size(); }
+
+		// The k nearest points to query, nearest first. Writes min(k, size()) results to out and returns that count.
+		size_t nearest(const Vector<coordDataType, dimension>& query, size_t k, Neighbour* out, QueryScratch& scratch) const
+		{
+			std::vector<Neighbour>& candidates = scratch.candidates;
+			candidates.clear();
+			if (nodes.empty() || k == 0)
+				return 0;
+
+			distanceType q[dimension];
+			distanceType offsets[dimension] = {};
+			loadQuery(query, q);
+			searchNearest(0, q, 0, offsets, k, candidates);
+
+			std::copy(candidates.begin(), candidates.end(), out);
+			return candidates.size();
+		}
+
+		// The nearest point to query; index NONE if the tree is empty.
+		Neighbour nearest(const Vector<coordDataType, dimension>& query, QueryScratch& scratch) const
+		{
+			Neighbour result = { NONE, std::numeric_limits<distanceType>::infinity() };
+			nearest(query, 1, &result, scratch);
+			return result;
+		}
+
+		// Append every point with squared distance to query at most radius^2 to out, in no particular order.
+		void radius(const Vector<coordDataType, dimension>& query, distanceType _radius, std::vector<Neighbour>& out) const
+		{
+			if (nodes.empty() || _radius < 0)
+				return;
+
+			distanceType q[dimension];
+			distanceType offsets[dimension] = {};
+			loadQuery(query, q);
+			searchRadius(0, q, 0, offsets, _radius * _radius, out);
+		}
+
+		// Append the index of every point inside the closed box [lower, upper] to out.
+		void box(const Vector<coordDataType, dimension>& lower, const Vector<coordDataType, dimension>& upper, std::vector<uint32_t>& out) const
+		{
+			if (nodes.empty())
+				return;
+
+			coordDataType low[dimension], high[dimension];
+			for (size_t d = 0; d < dimension; d++)
+			{
+				low[d] = lower[d];
+				high[d] = upper[d];
+			}
+			searchBox(0, low, high, out);
+		}
+
+		// k nearest neighbours of every query: results for query i are out[i * k, i * k + k), nearest first, padded
+		// with { NONE, infinity } when the tree has fewer than k points.
+		void nearestBatch(const Vector<coordDataType, dimension>* queries, size_t count, size_t k, Neighbour* out, unsigned _threads = 0) const
+		{
+			std::vector<uint32_t> order = queryOrder(queries, count, _threads);
+			parallelChunks(0, count, _threads, 1024, [&](unsigned, size_t begin, size_t end) {
+				QueryScratch scratch;
+				scratch.candidates.reserve(k);
+				for (size_t j = begin; j < end; j++)
+				{
+					size_t i = order.empty() ? j : order[j];
+					size_t found = nearest(queries[i], k, out + i * k, scratch);
+					std::fill(out + i * k + found, out + i * k + k, Neighbour{ NONE, std::numeric_limits<distanceType>::infinity() });
+				}
+			});
+		}
+
+		// Radius query for every query in compressed form: the results of query i are
+		// results[offsets[i], offsets[i + 1]). offsets gets count + 1 entries.
+		void radiusBatch(const Vector<coordDataType, dimension>* queries, size_t count, distanceType _radius, std::vector<size_t>& offsets, std::vector<Neighbour>& results, unsigned _threads = 0) const
+		{
+			std::vector<uint32_t> order = queryOrder(queries, count, _threads);
+
+			// Each chunk collects its results in processing order and remembers where each query's run starts.
+			offsets.assign(count + 1, 0);
+			std::vector<size_t> localStart(count);
+			std::vector<std::vector<Neighbour>> chunkResults(resolveThreadCount(_threads));
+			std::vector<unsigned> chunkOf(count);
+			parallelChunks(0, count, _threads, 1024, [&](unsigned chunk, size_t begin, size_t end) {
+				std::vector<Neighbour>& local = chunkResults[chunk];
+				for (size_t j = begin; j < end; j++)
+				{
+					size_t i = order.empty() ? j : order[j];
+					localStart[i] = local.size();
+					chunkOf[i] = chunk;
+					radius(queries[i], _radius, local);
+					offsets[i + 1] = local.size() - localStart[i];
+				}
+			});
+
+			for (size_t i = 0; i < count; i++)
+			{
+				offsets[i + 1] += offsets[i];
+			}
+			results.resize(offsets[count]);
+			parallelFor(0, count, _threads, 1024, [&](size_t i) {
+				const Neighbour* run = chunkResults[chunkOf[i]].data() + localStart[i];
+				std::copy(run, run + (offsets[i + 1] - offsets[i]), results.begin() + offsets[i]);
+			});
+		}
+	};
+
+} // Closing the scaleGeom namespace.
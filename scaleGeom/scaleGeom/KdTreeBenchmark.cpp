@@ -0,0 +1,94 @@
+#include "Benchmark.h"
+#include "KdTree.h"
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    typedef scaleGeom::KdTree<float, scaleGeom::DIM3> Tree;
+
+    std::vector<scaleGeom::Vector3f> randomPoints(size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> dist(0.0f, 100.0f);
+        std::vector<scaleGeom::Vector3f> points(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            points[i] = scaleGeom::Vector3f(dist(rng), dist(rng), dist(rng));
+        }
+        return points;
+    }
+
+    void report(const char* label, unsigned threads, double seconds, size_t count, const char* unit)
+    {
+        std::cout << "  " << std::left << std::setw(32) << label << std::right
+            << std::setw(3) << threads << " threads "
+            << std::setw(9) << std::fixed << std::setprecision(2) << seconds * 1e3 << " ms  "
+            << std::setw(7) << std::setprecision(2) << count / seconds / 1e6 << " " << unit << std::endl;
+    }
+}
+
+SCALEGEOM_BENCHMARK(KdTreeQueries)
+{
+    const size_t count = scaleGeom::bench::problemSize(2000000);
+    const size_t queryCount = count / 2;
+    const unsigned hardware = scaleGeom::resolveThreadCount(0);
+    const std::vector<scaleGeom::Vector3f> points = randomPoints(count, 1);
+    const std::vector<scaleGeom::Vector3f> queries = randomPoints(queryCount, 2);
+    std::cout << "  points: " << count << ", queries: " << queryCount << std::endl;
+
+    Tree tree;
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware))
+    {
+        Timer timer;
+        tree.build(points.data(), count, threads);
+        report("build", threads, timer.seconds(), count, "Mpts/s");
+        if (threads == hardware)
+            break;
+    }
+
+    // One query at a time with a reused scratch: no allocation per query.
+    {
+        Tree::QueryScratch scratch;
+        Tree::Neighbour result[8];
+        double sum = 0;
+        Timer timer;
+        for (size_t i = 0; i < queryCount; i++)
+        {
+            tree.nearest(queries[i], 8, result, scratch);
+            sum += result[0].distanceSquared;
+        }
+        report("8-NN, single queries", 1, timer.seconds(), queryCount, "Mqueries/s");
+        scaleGeom::bench::doNotOptimize(&sum);
+    }
+
+    std::vector<Tree::Neighbour> results(queryCount * 8);
+    for (size_t k : { size_t(1), size_t(8) })
+    {
+        for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware))
+        {
+            Timer timer;
+            tree.nearestBatch(queries.data(), queryCount, k, results.data(), threads);
+            report(k == 1 ? "1-NN, batched" : "8-NN, batched", threads, timer.seconds(), queryCount, "Mqueries/s");
+            if (threads == hardware)
+                break;
+        }
+    }
+
+    std::vector<size_t> offsets;
+    std::vector<Tree::Neighbour> neighbours;
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware))
+    {
+        Timer timer;
+        tree.radiusBatch(queries.data(), queryCount, 1.0f, offsets, neighbours, threads);
+        report("radius 1.0, batched", threads, timer.seconds(), queryCount, "Mqueries/s");
+        if (threads == hardware)
+            break;
+    }
+    std::cout << "  average radius result size: " << std::setprecision(2) << static_cast<double>(neighbours.size()) / queryCount << std::endl;
+}
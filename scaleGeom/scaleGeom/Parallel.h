@@ -0,0 +1,73 @@
+/*
+	Parallel.h - Minimal Fork-Join Helpers
+
+	Overview:
+	The parallel algorithms in scaleGeom only need to split an index range into contiguous
+	chunks and run one chunk per thread, so this header wraps std::thread instead of pulling in a
+	task scheduler. A thread count of 0 means "use every hardware thread".
+
+*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace scaleGeom {
+
+	// Number of threads to use for a request of _threads (0 = hardware concurrency).
+	inline unsigned resolveThreadCount(unsigned _threads)
+	{
+		if (_threads)
+			return _threads;
+		unsigned hardware = std::thread::hardware_concurrency();
+		return hardware ? hardware : 1;
+	}
+
+	// Split [begin, end) into at most _threads contiguous chunks of at least _grain elements and call
+	// fn(chunkIndex, chunkBegin, chunkEnd) for each chunk, one chunk per thread. The calling thread
+	// runs the first chunk. Returns the number of chunks.
+	template<class Function>
+	unsigned parallelChunks(size_t begin, size_t end, unsigned _threads, size_t _grain, Function fn)
+	{
+		size_t count = end > begin ? end - begin : 0;
+		size_t grain = std::max<size_t>(_grain, 1);
+		unsigned chunks = static_cast<unsigned>(std::min<size_t>(resolveThreadCount(_threads), (count + grain - 1) / grain));
+		if (chunks <= 1)
+		{
+			fn(0u, begin, end);
+			return 1;
+		}
+
+		std::vector<std::thread> workers;
+		workers.reserve(chunks - 1);
+		for (unsigned c = 1; c < chunks; c++)
+		{
+			size_t chunkBegin = begin + count * c / chunks;
+			size_t chunkEnd = begin + count * (c + 1) / chunks;
+			workers.emplace_back([=, &fn] { fn(c, chunkBegin, chunkEnd); });
+		}
+		fn(0u, begin, begin + count / chunks);
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+		return chunks;
+	}
+
+	// Call fn(i) for every i in [begin, end) using up to _threads threads.
+	template<class Function>
+	void parallelFor(size_t begin, size_t end, unsigned _threads, size_t _grain, Function fn)
+	{
+		parallelChunks(begin, end, _threads, _grain, [&fn](unsigned, size_t chunkBegin, size_t chunkEnd) {
+			for (size_t i = chunkBegin; i < chunkEnd; i++)
+			{
+				fn(i);
+			}
+		});
+	}
+
+} // Closing the scaleGeom namespace.
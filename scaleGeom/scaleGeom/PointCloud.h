@@ -0,0 +1,403 @@
+/*
+	PointCloud.h - Structure-of-Arrays Point Storage
+
+	Overview:
+	PointCloud stores a large set of points of the same dimension with one contiguous, aligned
+	buffer per axis (x0 x1 x2 ... | y0 y1 y2 ... | z0 z1 z2 ...), instead of interleaving the
+	coordinates the way a std::vector of scaleGeom::Vector does. Passes that only touch one axis
+	read only that axis, and loops over the buffers vectorize without gathers.
+
+	Features:
+	- One SIMD-aligned buffer per axis, padded so that kernels may read whole vector registers.
+	- Lightweight proxies (ConstPointRef / PointRef) that convert to Vector and work with
+	  dotProduct, crossProduct3D and the other Vector utilities.
+	- Non-owning views (ConstPointCloudView / PointCloudView) that batch kernels accept, so the
+	  same kernel can run on a PointCloud or on externally owned buffers.
+	- Bulk conversion to and from arrays of Vector (AoS).
+
+	Usage:
+	scaleGeom::PointCloud<float, 3> cloud = scaleGeom::PointCloud<float, 3>::fromAoS(points.data(), points.size());
+	float d = scaleGeom::dotProduct(cloud[0], cloud[1]);
+	scaleGeom::Vector3f n = scaleGeom::crossProduct3D(cloud[0], cloud[1]);
+
+*/
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	// Byte alignment of every axis buffer. 64 bytes covers a cache line and an AVX-512 register.
+	constexpr size_t POINTCLOUD_ALIGNMENT = 64;
+
+	// Read-only, non-owning view of SoA point data: one pointer per axis plus the point count.
+	template <class coordDataType, size_t dimension = DIM3>
+	struct ConstPointCloudView
+	{
+		std::array<const coordDataType*, dimension> axes;
+		size_t count;
+
+		// Pointer to the first coordinate of the given axis.
+		const coordDataType* axis(size_t dim) const { return axes[dim]; }
+
+		// Number of points in the view.
+		size_t size() const { return count; }
+	};
+
+	// Mutable, non-owning view of SoA point data.
+	template <class coordDataType, size_t dimension = DIM3>
+	struct PointCloudView
+	{
+		std::array<coordDataType*, dimension> axes;
+		size_t count;
+
+		// Pointer to the first coordinate of the given axis.
+		coordDataType* axis(size_t dim) const { return axes[dim]; }
+
+		// Number of points in the view.
+		size_t size() const { return count; }
+
+		// A mutable view can always be used where a read-only view is expected.
+		operator ConstPointCloudView<coordDataType, dimension>() const
+		{
+			ConstPointCloudView<coordDataType, dimension> view;
+			for (size_t i = 0; i < dimension; i++)
+			{
+				view.axes[i] = axes[i];
+			}
+			view.count = count;
+			return view;
+		}
+	};
+
+	// Read-only proxy for a single point stored in SoA form.
+	// It only holds a pointer to the axis table and an index, so it is as cheap to pass around as an iterator.
+	template <class coordDataType, size_t dimension = DIM3>
+	class ConstPointRef
+	{
+	protected:
+		// Table of axis pointers owned by the cloud or view.
+		const coordDataType* const* axes;
+
+		// Index of the referenced point.
+		size_t index;
+
+	public:
+
+		ConstPointRef(const coordDataType* const* _axes, size_t _index) : axes(_axes), index(_index) {}
+
+		// Read the coordinate of the referenced point along the given axis.
+		coordDataType operator[](size_t dim) const { return axes[dim][index]; }
+
+		// Copy the referenced point into a Vector.
+		Vector<coordDataType, dimension> toVector() const
+		{
+			std::array<coordDataType, dimension> coords;
+			for (size_t i = 0; i < dimension; i++)
+			{
+				coords[i] = axes[i][index];
+			}
+			return Vector<coordDataType, dimension>(coords);
+		}
+
+		// Implicit conversion so proxies can be passed to functions taking a Vector (e.g. crossProduct3D).
+		operator Vector<coordDataType, dimension>() const { return toVector(); }
+	};
+
+	// Mutable proxy for a single point stored in SoA form.
+	template <class coordDataType, size_t dimension = DIM3>
+	class PointRef : public ConstPointRef<coordDataType, dimension>
+	{
+		typedef ConstPointRef<coordDataType, dimension> Base;
+
+	public:
+
+		PointRef(coordDataType* const* _axes, size_t _index) : Base(_axes, _index) {}
+
+		// Write all coordinates of the referenced point from a Vector.
+		PointRef& operator=(const Vector<coordDataType, dimension>& _vec)
+		{
+			for (size_t i = 0; i < dimension; i++)
+			{
+				const_cast<coordDataType*>(this->axes[i])[this->index] = _vec[i];
+			}
+			return *this;
+		}
+
+		// Copy the coordinates of another point (not the proxy itself) into the referenced point.
+		PointRef& operator=(const PointRef& _other)
+		{
+			return *this = _other.toVector();
+		}
+
+		// Assign a specific value to a given dimension (coordinate) of the referenced point.
+		void assign(size_t dim, coordDataType value)
+		{
+			const_cast<coordDataType*>(this->axes[dim])[this->index] = value;
+		}
+	};
+
+	// Template class for a structure-of-arrays point container.
+	template <class coordDataType, size_t dimension = DIM3>
+	class PointCloud
+	{
+		// Ensure the coordinate type is either an integer or a floating-point type.
+		static_assert(std::is_arithmetic<coordDataType>::value, "Coordinate type must be arithmetic or float");
+
+		// Ensure the dimension specified is either 2D or higher.
+		static_assert(dimension >= DIM2, "PointCloud Dimensions must be atleast 2D");
+
+		// One aligned buffer per axis.
+		std::array<coordDataType*, dimension> axes;
+
+		// Number of points stored and number of points the buffers can hold.
+		size_t count;
+		size_t capacity;
+
+		// Number of coordinates that fill one alignment block; capacities are rounded up to it.
+		static constexpr size_t BLOCK = POINTCLOUD_ALIGNMENT / sizeof(coordDataType) > 0 ? POINTCLOUD_ALIGNMENT / sizeof(coordDataType) : 1;
+
+		static coordDataType* allocateAxis(size_t _capacity)
+		{
+			if (_capacity == 0)
+				return nullptr;
+			return static_cast<coordDataType*>(::operator new(_capacity * sizeof(coordDataType), std::align_val_t(POINTCLOUD_ALIGNMENT)));
+		}
+
+		static void freeAxis(coordDataType* _axis)
+		{
+			if (_axis)
+				::operator delete(_axis, std::align_val_t(POINTCLOUD_ALIGNMENT));
+		}
+
+		// Reallocate every axis buffer to hold _capacity points, keeping the current contents.
+		// The padding between count and capacity is zero filled so kernels can safely read it.
+		void reallocate(size_t _capacity)
+		{
+			for (size_t i = 0; i < dimension; i++)
+			{
+				coordDataType* axis = allocateAxis(_capacity);
+				if (count)
+					std::memcpy(axis, axes[i], count * sizeof(coordDataType));
+				if (_capacity > count)
+					std::memset(axis + count, 0, (_capacity - count) * sizeof(coordDataType));
+				freeAxis(axes[i]);
+				axes[i] = axis;
+			}
+			capacity = _capacity;
+		}
+
+		static size_t roundUp(size_t _count)
+		{
+			return (_count + BLOCK - 1) / BLOCK * BLOCK;
+		}
+
+	public:
+
+		// Default constructor, creates an empty cloud.
+		PointCloud() : count(0), capacity(0) { axes.fill(nullptr); }
+
+		// Constructor that creates a cloud of _count points with every coordinate set to zero.
+		explicit PointCloud(size_t _count) : count(0), capacity(0)
+		{
+			axes.fill(nullptr);
+			resize(_count);
+		}
+
+		PointCloud(const PointCloud& _other) : count(0), capacity(0)
+		{
+			axes.fill(nullptr);
+			reallocate(roundUp(_other.count));
+			for (size_t i = 0; i < dimension; i++)
+			{
+				if (_other.count)
+					std::memcpy(axes[i], _other.axes[i], _other.count * sizeof(coordDataType));
+			}
+			count = _other.count;
+		}
+
+		PointCloud(PointCloud&& _other) noexcept : axes(_other.axes), count(_other.count), capacity(_other.capacity)
+		{
+			_other.axes.fill(nullptr);
+			_other.count = 0;
+			_other.capacity = 0;
+		}
+
+		PointCloud& operator=(PointCloud _other) noexcept
+		{
+			std::swap(axes, _other.axes);
+			std::swap(count, _other.count);
+			std::swap(capacity, _other.capacity);
+			return *this;
+		}
+
+		~PointCloud()
+		{
+			for (size_t i = 0; i < dimension; i++)
+			{
+				freeAxis(axes[i]);
+			}
+		}
+
+		// Number of points in the cloud.
+		size_t size() const { return count; }
+
+		// True when the cloud holds no points.
+		bool empty() const { return count == 0; }
+
+		// Make room for at least _capacity points without changing the size.
+		void reserve(size_t _capacity)
+		{
+			if (_capacity > capacity)
+				reallocate(roundUp(_capacity));
+		}
+
+		// Change the number of points; new points are zero initialised.
+		void resize(size_t _count)
+		{
+			reserve(_count);
+			if (_count < count)
+			{
+				for (size_t i = 0; i < dimension; i++)
+				{
+					std::memset(axes[i] + _count, 0, (count - _count) * sizeof(coordDataType));
+				}
+			}
+			count = _count;
+		}
+
+		// Remove all points, keeping the allocated buffers.
+		void clear() { resize(0); }
+
+		// Append a point to the end of the cloud.
+		void push_back(const Vector<coordDataType, dimension>& _vec)
+		{
+			if (count == capacity)
+				reallocate(roundUp(capacity ? capacity * 2 : BLOCK));
+			for (size_t i = 0; i < dimension; i++)
+			{
+				axes[i][count] = _vec[i];
+			}
+			count++;
+		}
+
+		// Proxy access to a point.
+		ConstPointRef<coordDataType, dimension> operator[](size_t _index) const { return ConstPointRef<coordDataType, dimension>(axes.data(), _index); }
+		PointRef<coordDataType, dimension> operator[](size_t _index) { return PointRef<coordDataType, dimension>(axes.data(), _index); }
+
+		// Direct access to the contiguous buffer of one axis.
+		const coordDataType* axis(size_t dim) const { return axes[dim]; }
+		coordDataType* axis(size_t dim) { return axes[dim]; }
+
+		// Non-owning views of the whole cloud for batch kernels.
+		ConstPointCloudView<coordDataType, dimension> view() const
+		{
+			ConstPointCloudView<coordDataType, dimension> result;
+			for (size_t i = 0; i < dimension; i++)
+			{
+				result.axes[i] = axes[i];
+			}
+			result.count = count;
+			return result;
+		}
+
+		PointCloudView<coordDataType, dimension> view()
+		{
+			PointCloudView<coordDataType, dimension> result;
+			result.axes = axes;
+			result.count = count;
+			return result;
+		}
+
+		// Replace the contents of the cloud with an array of Vectors (AoS -> SoA).
+		void assignFromAoS(const Vector<coordDataType, dimension>* _points, size_t _count)
+		{
+			resize(_count);
+			for (size_t p = 0; p < _count; p++)
+			{
+				for (size_t i = 0; i < dimension; i++)
+				{
+					axes[i][p] = _points[p][i];
+				}
+			}
+		}
+
+		// Write the cloud into a caller provided array of size() Vectors (SoA -> AoS).
+		void toAoS(Vector<coordDataType, dimension>* _out) const
+		{
+			std::array<coordDataType, dimension> coords;
+			for (size_t p = 0; p < count; p++)
+			{
+				for (size_t i = 0; i < dimension; i++)
+				{
+					coords[i] = axes[i][p];
+				}
+				_out[p] = Vector<coordDataType, dimension>(coords);
+			}
+		}
+
+		// Convenience overload returning a newly allocated array of Vectors.
+		std::vector<Vector<coordDataType, dimension>> toAoS() const
+		{
+			std::vector<Vector<coordDataType, dimension>> result(count);
+			toAoS(result.data());
+			return result;
+		}
+
+		// Build a cloud from an array of Vectors.
+		static PointCloud fromAoS(const Vector<coordDataType, dimension>* _points, size_t _count)
+		{
+			PointCloud result;
+			result.assignFromAoS(_points, _count);
+			return result;
+		}
+
+		static PointCloud fromAoS(const std::vector<Vector<coordDataType, dimension>>& _points)
+		{
+			return fromAoS(_points.data(), _points.size());
+		}
+	};
+
+	typedef PointCloud<float, DIM2> PointCloud2f;
+	typedef PointCloud<float, DIM3> PointCloud3f;
+
+	// Dot product overloads so SoA proxies can be mixed freely with Vectors.
+	template<class coordDataType, size_t dimension>
+	coordDataType dotProduct(const ConstPointRef<coordDataType, dimension>& v1, const ConstPointRef<coordDataType, dimension>& v2)
+	{
+		coordDataType dotProduct = 0;
+		for (size_t i = 0; i < dimension; i++)
+		{
+			dotProduct += v1[i] * v2[i];
+		}
+		return dotProduct;
+	}
+
+	template<class coordDataType, size_t dimension>
+	coordDataType dotProduct(const ConstPointRef<coordDataType, dimension>& v1, const Vector<coordDataType, dimension>& v2)
+	{
+		return dotProduct(v1.toVector(), v2);
+	}
+
+	template<class coordDataType, size_t dimension>
+	coordDataType dotProduct(const Vector<coordDataType, dimension>& v1, const ConstPointRef<coordDataType, dimension>& v2)
+	{
+		return dotProduct(v1, v2.toVector());
+	}
+
+	// Stream insertion for proxies prints the referenced point like a Vector.
+	template<class coordDataType, size_t dimension>
+	std::ostream& operator<<(std::ostream& os, const ConstPointRef<coordDataType, dimension>& ref)
+	{
+		return os << ref.toVector();
+	}
+
+} // Closing the scaleGeom namespace.
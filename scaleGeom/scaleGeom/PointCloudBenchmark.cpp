@@ -0,0 +1,133 @@
+#include "Benchmark.h"
+#include "PointCloud.h"
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    const int REPEATS = 5;
+
+    // Row-major 3x3 matrix plus translation applied by both layouts.
+    const float M[9] = { 0.36f, 0.48f, -0.8f, -0.8f, 0.6f, 0.0f, 0.48f, 0.64f, 0.6f };
+    const float T[3] = { 1.5f, -2.0f, 0.25f };
+
+    std::vector<scaleGeom::Vector3f> randomPoints(size_t count)
+    {
+        std::mt19937 rng(12345);
+        std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+        std::vector<scaleGeom::Vector3f> points(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            points[i] = scaleGeom::Vector3f(dist(rng), dist(rng), dist(rng));
+        }
+        return points;
+    }
+
+    void report(const char* label, double seconds, size_t count, size_t bytesPerPoint)
+    {
+        std::cout << "  " << std::left << std::setw(28) << label << std::right
+            << std::setw(9) << std::fixed << std::setprecision(3) << seconds * 1e3 << " ms  "
+            << std::setw(8) << std::setprecision(2) << seconds * 1e9 / count << " ns/pt  "
+            << std::setw(7) << std::setprecision(2) << count * bytesPerPoint / seconds / 1e9 << " GB/s" << std::endl;
+    }
+
+    // Bulk affine transform over interleaved x/y/z.
+    void transformAoS(std::vector<scaleGeom::Vector3f>& points)
+    {
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            float x = points[i][0], y = points[i][1], z = points[i][2];
+            points[i] = scaleGeom::Vector3f(
+                M[0] * x + M[1] * y + M[2] * z + T[0],
+                M[3] * x + M[4] * y + M[5] * z + T[1],
+                M[6] * x + M[7] * y + M[8] * z + T[2]);
+        }
+    }
+
+    // The same transform over one buffer per axis.
+    void transformSoA(scaleGeom::PointCloud3f& cloud)
+    {
+        float* xs = cloud.axis(0);
+        float* ys = cloud.axis(1);
+        float* zs = cloud.axis(2);
+        const size_t count = cloud.size();
+        for (size_t i = 0; i < count; i++)
+        {
+            float x = xs[i], y = ys[i], z = zs[i];
+            xs[i] = M[0] * x + M[1] * y + M[2] * z + T[0];
+            ys[i] = M[3] * x + M[4] * y + M[5] * z + T[1];
+            zs[i] = M[6] * x + M[7] * y + M[8] * z + T[2];
+        }
+    }
+}
+
+SCALEGEOM_BENCHMARK(PointCloudLayouts)
+{
+    const size_t count = scaleGeom::bench::problemSize(4000000);
+    std::vector<scaleGeom::Vector3f> aos = randomPoints(count);
+    std::cout << "  points: " << count << std::endl;
+
+    Timer timer;
+    scaleGeom::PointCloud3f soa = scaleGeom::PointCloud3f::fromAoS(aos);
+    report("AoS -> SoA conversion", timer.seconds(), count, 2 * sizeof(scaleGeom::Vector3f));
+
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; r++)
+    {
+        timer.reset();
+        transformAoS(aos);
+        best = std::min(best, timer.seconds());
+    }
+    scaleGeom::bench::doNotOptimize(aos.data());
+    report("affine transform (AoS)", best, count, 2 * sizeof(scaleGeom::Vector3f));
+
+    best = 1e30;
+    for (int r = 0; r < REPEATS; r++)
+    {
+        timer.reset();
+        transformSoA(soa);
+        best = std::min(best, timer.seconds());
+    }
+    scaleGeom::bench::doNotOptimize(soa.axis(0));
+    report("affine transform (SoA)", best, count, 2 * sizeof(scaleGeom::Vector3f));
+
+    // Single axis pass: only the z coordinates are needed.
+    float sum = 0;
+    best = 1e30;
+    for (int r = 0; r < REPEATS; r++)
+    {
+        timer.reset();
+        sum = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            sum += aos[i][2];
+        }
+        best = std::min(best, timer.seconds());
+    }
+    scaleGeom::bench::doNotOptimize(&sum);
+    report("z-axis sum (AoS)", best, count, sizeof(scaleGeom::Vector3f));
+
+    best = 1e30;
+    for (int r = 0; r < REPEATS; r++)
+    {
+        timer.reset();
+        sum = 0;
+        const float* zs = soa.axis(2);
+        for (size_t i = 0; i < count; i++)
+        {
+            sum += zs[i];
+        }
+        best = std::min(best, timer.seconds());
+    }
+    scaleGeom::bench::doNotOptimize(&sum);
+    report("z-axis sum (SoA)", best, count, sizeof(float));
+
+    timer.reset();
+    soa.toAoS(aos.data());
+    report("SoA -> AoS conversion", timer.seconds(), count, 2 * sizeof(scaleGeom::Vector3f));
+}
@@ -0,0 +1,252 @@
+#include "PointFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    const char MAGIC[8] = { 'S', 'G', 'P', 'O', 'I', 'N', 'T', 'S' };
+    const uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+    uint64_t roundUp(uint64_t bytes, uint64_t alignment)
+    {
+        return (bytes + alignment - 1) / alignment * alignment;
+    }
+
+    [[noreturn]] void fail(const char* path, const char* what)
+    {
+        throw std::runtime_error(std::string("PointFile: ") + what + ": " + path + "\n");
+    }
+
+    // Number of blocks of a file with the given layout.
+    uint64_t blockCount(const scaleGeom::PointFileHeader& header)
+    {
+        return header.layout == scaleGeom::PointFileLayout::SoA ? header.dimension : 1;
+    }
+
+    // Bytes of point data in one block, or 0 on overflow (count is then known to be nonzero).
+    uint64_t payloadBytes(const scaleGeom::PointFileHeader& header, size_t coordSize)
+    {
+        const uint64_t perPoint = coordSize * (header.layout == scaleGeom::PointFileLayout::AoS ? header.dimension : 1);
+        if (header.count > UINT64_MAX / perPoint)
+            return 0;
+        return header.count * perPoint;
+    }
+
+    // Check a mapped header against the file length; returns the reason it is invalid or null.
+    const char* validate(const scaleGeom::PointFileHeader& header, uint64_t length)
+    {
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+            return "not a point file";
+        if (header.version != scaleGeom::POINTFILE_VERSION)
+            return "unsupported version";
+        if (header.byteOrder != BYTE_ORDER_MARK)
+            return "written with a different byte order";
+        const size_t coordSize = scaleGeom::pointFileCoordSize(header.coordType);
+        if (!coordSize || header.dimension < scaleGeom::DIM2)
+            return "invalid coordinate type or dimension";
+        if (header.layout != scaleGeom::PointFileLayout::SoA && header.layout != scaleGeom::PointFileLayout::AoS)
+            return "invalid layout";
+        if (header.alignment < coordSize || (header.alignment & (header.alignment - 1)) || header.dataOffset % header.alignment
+            || header.blockStride % header.alignment || header.dataOffset < sizeof(scaleGeom::PointFileHeader))
+            return "invalid alignment";
+        const uint64_t payload = payloadBytes(header, coordSize);
+        if ((header.count && !payload) || header.blockStride < payload)
+            return "invalid block size";
+        const uint64_t blocks = blockCount(header);
+        if (header.dataOffset > length || (header.blockStride && blocks > (length - header.dataOffset) / header.blockStride))
+            return "truncated";
+        return nullptr;
+    }
+}
+
+size_t scaleGeom::pointFileCoordSize(PointFileCoord coordType)
+{
+    switch (coordType)
+    {
+    case PointFileCoord::Float32: return 4;
+    case PointFileCoord::Float64: return 8;
+    case PointFileCoord::Int32: return 4;
+    case PointFileCoord::Int64: return 8;
+    }
+    return 0;
+}
+
+void scaleGeom::writePointFile(const char* path, PointFileCoord coordType, uint32_t dimension, PointFileLayout layout,
+    size_t count, const void* const* blocks)
+{
+    PointFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = POINTFILE_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.dimension = dimension;
+    header.coordType = coordType;
+    header.layout = layout;
+    header.alignment = static_cast<uint32_t>(POINTFILE_ALIGNMENT);
+    header.count = count;
+    header.dataOffset = roundUp(sizeof(PointFileHeader), POINTFILE_ALIGNMENT);
+    const size_t coordSize = pointFileCoordSize(coordType);
+    const uint64_t payload = coordSize ? payloadBytes(header, coordSize) : 0;
+    if (!coordSize || dimension < DIM2 || (count && !payload))
+        fail(path, "invalid point data");
+    header.blockStride = roundUp(payload, POINTFILE_ALIGNMENT);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        fail(path, "cannot create file");
+
+    static const char zeros[POINTFILE_ALIGNMENT] = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(zeros, static_cast<std::streamsize>(header.dataOffset - sizeof(header)));
+    const uint64_t blocksToWrite = blockCount(header);
+    for (uint64_t b = 0; b < blocksToWrite && out; b++)
+    {
+        if (payload)
+            out.write(static_cast<const char*>(blocks[b]), static_cast<std::streamsize>(payload));
+        out.write(zeros, static_cast<std::streamsize>(header.blockStride - payload));
+    }
+    out.close();
+    if (!out)
+    {
+        std::remove(path);
+        fail(path, "write failed");
+    }
+}
+
+scaleGeom::MappedPointFile::MappedPointFile(MappedPointFile&& _other) noexcept
+    : base(_other.base), length(_other.length), file(_other.file), mapping(_other.mapping)
+{
+    _other.base = nullptr;
+    _other.length = 0;
+    _other.file = -1;
+    _other.mapping = -1;
+}
+
+scaleGeom::MappedPointFile& scaleGeom::MappedPointFile::operator=(MappedPointFile&& _other) noexcept
+{
+    if (this != &_other)
+    {
+        close();
+        base = _other.base;
+        length = _other.length;
+        file = _other.file;
+        mapping = _other.mapping;
+        _other.base = nullptr;
+        _other.length = 0;
+        _other.file = -1;
+        _other.mapping = -1;
+    }
+    return *this;
+}
+
+void scaleGeom::MappedPointFile::open(const char* path)
+{
+    close();
+    uint64_t fileLength = 0;
+
+#if defined(_WIN32)
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        fail(path, "cannot open file");
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize))
+    {
+        CloseHandle(handle);
+        fail(path, "cannot read file size");
+    }
+    fileLength = static_cast<uint64_t>(fileSize.QuadPart);
+    if (fileLength < sizeof(PointFileHeader) || fileLength > SIZE_MAX)
+    {
+        CloseHandle(handle);
+        fail(path, "not a point file");
+    }
+    HANDLE view = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* address = view ? MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!address)
+    {
+        if (view)
+            CloseHandle(view);
+        CloseHandle(handle);
+        fail(path, "cannot map file");
+    }
+    file = reinterpret_cast<intptr_t>(handle);
+    mapping = reinterpret_cast<intptr_t>(view);
+#else
+    int descriptor = ::open(path, O_RDONLY);
+    if (descriptor < 0)
+        fail(path, "cannot open file");
+    struct stat status;
+    if (fstat(descriptor, &status) != 0)
+    {
+        ::close(descriptor);
+        fail(path, "cannot read file size");
+    }
+    fileLength = static_cast<uint64_t>(status.st_size);
+    if (fileLength < sizeof(PointFileHeader) || fileLength > SIZE_MAX)
+    {
+        ::close(descriptor);
+        fail(path, "not a point file");
+    }
+    void* address = mmap(nullptr, static_cast<size_t>(fileLength), PROT_READ, MAP_SHARED, descriptor, 0);
+    if (address == MAP_FAILED)
+    {
+        ::close(descriptor);
+        fail(path, "cannot map file");
+    }
+    file = descriptor;
+#endif
+
+    base = static_cast<const unsigned char*>(address);
+    length = static_cast<size_t>(fileLength);
+    if (const char* reason = validate(header(), fileLength))
+    {
+        close();
+        fail(path, reason);
+    }
+}
+
+void scaleGeom::MappedPointFile::close()
+{
+    if (!base)
+        return;
+#if defined(_WIN32)
+    UnmapViewOfFile(base);
+    CloseHandle(reinterpret_cast<HANDLE>(mapping));
+    CloseHandle(reinterpret_cast<HANDLE>(file));
+#else
+    munmap(const_cast<unsigned char*>(base), length);
+    ::close(static_cast<int>(file));
+#endif
+    base = nullptr;
+    length = 0;
+    file = -1;
+    mapping = -1;
+}
+
+void scaleGeom::MappedPointFile::require(PointFileCoord coordType, size_t dimension, PointFileLayout layout) const
+{
+    if (!base)
+        throw std::runtime_error("PointFile: no file is open\n");
+    const PointFileHeader& h = header();
+    if (h.coordType != coordType || h.dimension != dimension)
+        throw std::runtime_error("PointFile: requested coordinate type or dimension does not match the file\n");
+    if (h.layout != layout)
+        throw std::runtime_error(layout == PointFileLayout::SoA ? "PointFile: view() needs an SoA file\n"
+            : "PointFile: points() needs an AoS file\n");
+}
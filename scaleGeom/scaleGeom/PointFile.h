@@ -0,0 +1,204 @@
+/*
+	PointFile.h - Memory-Mapped Binary Point Files
+
+	Overview:
+	A simple versioned binary format for large point sets, and a reader that memory-maps the
+	file and hands out views of it directly, so loading a file costs one mapping instead of a
+	parse. Pages are read by the operating system the first time a kernel touches them.
+
+	Format (little-endian):
+	- A 64-byte PointFileHeader: magic, version, byte order mark, dimension, coordinate type,
+	  layout, block alignment, point count, and the offset and stride of the data blocks.
+	- SoA layout: one block per axis, in axis order. Each block holds count coordinates and is
+	  zero padded to a multiple of the alignment (64 bytes), like the axis buffers of a
+	  PointCloud, so SIMD kernels may read whole registers past the last point.
+	- AoS layout: a single block of count interleaved points, binary compatible with an array
+	  of Vector<coordDataType, dimension>, zero padded the same way.
+
+	Views:
+	MappedPointFile::view() returns a ConstPointCloudView for SoA files, accepted by the batch
+	kernels in VectorBatch.h. MappedPointFile::points() returns a Vector array for AoS files,
+	accepted by KdTree, the convex hulls and the other array based functions. Both point into
+	the mapping and stay valid until the file is closed. Errors (I/O failures, malformed files,
+	asking for the wrong type or layout) throw std::runtime_error.
+
+	Usage:
+	scaleGeom::writePointFile("cloud.sgp", cloud);
+	scaleGeom::MappedPointFile file("cloud.sgp");
+	scaleGeom::dotProductBatch(file.view<float, 3>(), normals.view(), out.data());
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "Vector.h"
+#include "PointCloud.h"
+
+namespace scaleGeom {
+
+	constexpr uint32_t POINTFILE_VERSION = 1;
+
+	// Alignment of every data block, relative to the start of the file.
+	constexpr size_t POINTFILE_ALIGNMENT = POINTCLOUD_ALIGNMENT;
+
+	// Coordinate type stored in a point file.
+	enum class PointFileCoord : uint32_t
+	{
+		Float32 = 1,
+		Float64 = 2,
+		Int32 = 3,
+		Int64 = 4
+	};
+
+	// Arrangement of the coordinates in a point file.
+	enum class PointFileLayout : uint32_t
+	{
+		SoA = 1,
+		AoS = 2
+	};
+
+	struct PointFileHeader
+	{
+		// "SGPOINTS".
+		char magic[8];
+
+		uint32_t version;
+
+		// 0x01020304 as written by the producer; files from a machine of the other byte order are rejected.
+		uint32_t byteOrder;
+
+		uint32_t dimension;
+		PointFileCoord coordType;
+		PointFileLayout layout;
+		uint32_t alignment;
+		uint64_t count;
+
+		// Byte offset of the first block from the start of the file.
+		uint64_t dataOffset;
+
+		// Padded size of one block in bytes: an axis for SoA, the whole point array for AoS.
+		uint64_t blockStride;
+
+		uint64_t reserved;
+	};
+
+	static_assert(sizeof(PointFileHeader) == 64, "PointFileHeader must stay 64 bytes");
+
+	// File coordinate type of a C++ coordinate type.
+	template<class coordDataType> struct PointFileCoordOf;
+	template<> struct PointFileCoordOf<float> { static constexpr PointFileCoord value = PointFileCoord::Float32; };
+	template<> struct PointFileCoordOf<double> { static constexpr PointFileCoord value = PointFileCoord::Float64; };
+	template<> struct PointFileCoordOf<int32_t> { static constexpr PointFileCoord value = PointFileCoord::Int32; };
+	template<> struct PointFileCoordOf<int64_t> { static constexpr PointFileCoord value = PointFileCoord::Int64; };
+
+	// Size in bytes of one coordinate of the given type (0 for unknown values).
+	size_t pointFileCoordSize(PointFileCoord coordType);
+
+	// Write a point file. For SoA, blocks holds one pointer per axis to count coordinates; for AoS, blocks[0]
+	// points to count * dimension interleaved coordinates. Prefer the typed overloads below.
+	void writePointFile(const char* path, PointFileCoord coordType, uint32_t dimension, PointFileLayout layout,
+		size_t count, const void* const* blocks);
+
+	// Write SoA point data (e.g. PointCloud::view()) as an SoA file.
+	template<class coordDataType, size_t dimension>
+	void writePointFile(const char* path, ConstPointCloudView<coordDataType, dimension> points)
+	{
+		const void* blocks[dimension];
+		for (size_t i = 0; i < dimension; i++)
+		{
+			blocks[i] = points.axes[i];
+		}
+		writePointFile(path, PointFileCoordOf<coordDataType>::value, static_cast<uint32_t>(dimension), PointFileLayout::SoA,
+			points.count, blocks);
+	}
+
+	// Write a PointCloud as an SoA file.
+	template<class coordDataType, size_t dimension>
+	void writePointFile(const char* path, const PointCloud<coordDataType, dimension>& cloud)
+	{
+		writePointFile(path, cloud.view());
+	}
+
+	// Write an array of Vectors as an AoS file.
+	template<class coordDataType, size_t dimension>
+	void writePointFile(const char* path, const Vector<coordDataType, dimension>* points, size_t count)
+	{
+		static_assert(sizeof(Vector<coordDataType, dimension>) == dimension * sizeof(coordDataType), "Vector must be tightly packed");
+		const void* block = points;
+		writePointFile(path, PointFileCoordOf<coordDataType>::value, static_cast<uint32_t>(dimension), PointFileLayout::AoS,
+			count, &block);
+	}
+
+	// Read-only memory mapping of a point file.
+	class MappedPointFile
+	{
+		const unsigned char* base;
+		size_t length;
+
+		// Platform handles of the mapping (file descriptor, or file and mapping handles on Windows).
+		intptr_t file;
+		intptr_t mapping;
+
+		// Throw unless the file holds dimension coordinates of coordType in the given layout.
+		void require(PointFileCoord coordType, size_t dimension, PointFileLayout layout) const;
+
+	public:
+
+		MappedPointFile() : base(nullptr), length(0), file(-1), mapping(-1) {}
+
+		explicit MappedPointFile(const char* path) : MappedPointFile() { open(path); }
+
+		MappedPointFile(const MappedPointFile&) = delete;
+		MappedPointFile& operator=(const MappedPointFile&) = delete;
+
+		MappedPointFile(MappedPointFile&& _other) noexcept;
+		MappedPointFile& operator=(MappedPointFile&& _other) noexcept;
+
+		~MappedPointFile() { close(); }
+
+		// Map a file, closing the current one. Validates the header and the file size.
+		void open(const char* path);
+
+		// Unmap the file. Views obtained from it become invalid.
+		void close();
+
+		bool isOpen() const { return base != nullptr; }
+
+		const PointFileHeader& header() const { return *reinterpret_cast<const PointFileHeader*>(base); }
+
+		size_t size() const { return static_cast<size_t>(header().count); }
+
+		// Start of the given block: an axis for SoA files, the point array (block 0) for AoS files.
+		const void* block(size_t index) const
+		{
+			return base + header().dataOffset + index * header().blockStride;
+		}
+
+		// SoA view of the mapped points. Throws unless the file is an SoA file of this type and dimension.
+		template<class coordDataType, size_t dimension>
+		ConstPointCloudView<coordDataType, dimension> view() const
+		{
+			require(PointFileCoordOf<coordDataType>::value, dimension, PointFileLayout::SoA);
+			ConstPointCloudView<coordDataType, dimension> result;
+			for (size_t i = 0; i < dimension; i++)
+			{
+				result.axes[i] = static_cast<const coordDataType*>(block(i));
+			}
+			result.count = size();
+			return result;
+		}
+
+		// The mapped points as an array of size() Vectors. Throws unless the file is an AoS file of this type and dimension.
+		template<class coordDataType, size_t dimension>
+		const Vector<coordDataType, dimension>* points() const
+		{
+			static_assert(sizeof(Vector<coordDataType, dimension>) == dimension * sizeof(coordDataType), "Vector must be tightly packed");
+			require(PointFileCoordOf<coordDataType>::value, dimension, PointFileLayout::AoS);
+			return static_cast<const Vector<coordDataType, dimension>*>(block(0));
+		}
+	};
+
+} // Closing the scaleGeom namespace.
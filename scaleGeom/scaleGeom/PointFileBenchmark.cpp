@@ -0,0 +1,115 @@
+#include "Benchmark.h"
+#include "PointFile.h"
+#include "VectorBatch.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    std::vector<scaleGeom::Vector3f> randomPoints(size_t count)
+    {
+        std::mt19937 rng(777);
+        std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+        std::vector<scaleGeom::Vector3f> points(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            points[i] = scaleGeom::Vector3f(dist(rng), dist(rng), dist(rng));
+        }
+        return points;
+    }
+
+    void report(const char* label, double seconds, size_t count)
+    {
+        std::cout << "  " << std::left << std::setw(32) << label << std::right
+            << std::setw(10) << std::fixed << std::setprecision(3) << seconds * 1e3 << " ms  "
+            << std::setw(9) << std::setprecision(2) << count / seconds / 1e6 << " Mpts/s" << std::endl;
+    }
+
+    std::string tempPath(const char* name)
+    {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+}
+
+SCALEGEOM_BENCHMARK(PointFileLoading)
+{
+    const size_t count = scaleGeom::bench::problemSize(4000000);
+    const std::vector<scaleGeom::Vector3f> aos = randomPoints(count);
+    const scaleGeom::PointCloud3f soa = scaleGeom::PointCloud3f::fromAoS(aos);
+    const std::string textPath = tempPath("scaleGeom_bench_points.txt");
+    const std::string soaPath = tempPath("scaleGeom_bench_points_soa.sgp");
+    const std::string aosPath = tempPath("scaleGeom_bench_points_aos.sgp");
+    std::cout << "  points: " << count << std::endl;
+
+    // Baseline: the text format the binary files replace.
+    {
+        std::ofstream text(textPath);
+        text << std::setprecision(9);
+        for (const scaleGeom::Vector3f& p : aos)
+        {
+            text << p[0] << ' ' << p[1] << ' ' << p[2] << '\n';
+        }
+    }
+    Timer timer;
+    {
+        std::ifstream text(textPath);
+        std::vector<scaleGeom::Vector3f> parsed;
+        parsed.reserve(count);
+        float x, y, z;
+        while (text >> x >> y >> z)
+        {
+            parsed.push_back(scaleGeom::Vector3f(x, y, z));
+        }
+        scaleGeom::bench::doNotOptimize(parsed.data());
+    }
+    report("parse text", timer.seconds(), count);
+
+    timer.reset();
+    scaleGeom::writePointFile(soaPath.c_str(), soa);
+    report("write SoA file", timer.seconds(), count);
+
+    timer.reset();
+    scaleGeom::writePointFile(aosPath.c_str(), aos.data(), aos.size());
+    report("write AoS file", timer.seconds(), count);
+
+    std::vector<float> dots(count);
+    {
+        timer.reset();
+        scaleGeom::MappedPointFile file(soaPath.c_str());
+        scaleGeom::ConstPointCloudView<float, scaleGeom::DIM3> view = file.view<float, scaleGeom::DIM3>();
+        report("map SoA file", timer.seconds(), count);
+
+        // The first pass faults the pages in; the second runs on resident memory.
+        timer.reset();
+        scaleGeom::dotProductBatch(view, soa.view(), dots.data());
+        report("dotProductBatch, first pass", timer.seconds(), count);
+        timer.reset();
+        scaleGeom::dotProductBatch(view, soa.view(), dots.data());
+        report("dotProductBatch, second pass", timer.seconds(), count);
+        scaleGeom::bench::doNotOptimize(dots.data());
+    }
+    {
+        timer.reset();
+        scaleGeom::MappedPointFile file(aosPath.c_str());
+        const scaleGeom::Vector3f* points = file.points<float, scaleGeom::DIM3>();
+        report("map AoS file", timer.seconds(), count);
+
+        timer.reset();
+        scaleGeom::dotProductBatch(points, aos.data(), count, dots.data());
+        report("dotProductBatch AoS, first pass", timer.seconds(), count);
+        scaleGeom::bench::doNotOptimize(dots.data());
+    }
+
+    std::remove(textPath.c_str());
+    std::remove(soaPath.c_str());
+    std::remove(aosPath.c_str());
+}
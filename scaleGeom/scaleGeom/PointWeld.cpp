@@ -0,0 +1,472 @@
+#include "PointWeld.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+    const uint32_t NONE = 0xffffffffu;
+
+    // At most this many x bins are histogrammed; with more x cells, a bin spans several cells.
+    const int64_t MAX_BINS = int64_t(1) << 18;
+
+    // Points per chunk of the streaming scans.
+    const size_t SCAN_GRAIN = size_t(1) << 16;
+
+    // Portable population count.
+    unsigned bitCount(uint64_t v)
+    {
+        v = v - ((v >> 1) & 0x5555555555555555ull);
+        v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+        v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0full;
+        return static_cast<unsigned>((v * 0x0101010101010101ull) >> 56);
+    }
+
+    uint64_t hashCell(int64_t x, int64_t y, int64_t z)
+    {
+        uint64_t hash = static_cast<uint64_t>(x) * 0x9e3779b97f4a7c15ull;
+        hash = (hash ^ static_cast<uint64_t>(y)) * 0xff51afd7ed558ccdull;
+        hash = (hash ^ static_cast<uint64_t>(z)) * 0xc4ceb9fe1a85ec53ull;
+        return hash ^ (hash >> 29);
+    }
+
+    template<class coordDataType>
+    struct SoaSource
+    {
+        scaleGeom::ConstPointCloudView<coordDataType, 3> view;
+
+        coordDataType get(size_t i, size_t axis) const { return view.axes[axis][i]; }
+    };
+
+    template<class coordDataType>
+    struct AosSource
+    {
+        const scaleGeom::Vector<coordDataType, 3>* points;
+
+        coordDataType get(size_t i, size_t axis) const { return points[i][axis]; }
+    };
+
+    // The grid: cell coordinates are measured from the lower corner of the finite points' bounding box.
+    struct Grid
+    {
+        std::array<double, 3> lower;
+        double inverseCellSize;
+
+        // Epsilon in cell units, plus a little slack for rounding, for deciding which neighbours to visit.
+        double reach;
+
+        double scaled(double coordinate, size_t axis) const { return (coordinate - lower[axis]) * inverseCellSize; }
+    };
+
+    struct Slab
+    {
+        int64_t firstCell;
+        int64_t endCell;
+        size_t count;
+    };
+
+    // Welds the points of one slab, sequentially in input order. Halo points are representatives from the
+    // adjacent slabs that were processed earlier; they can be matched but are not written.
+    template<class Source>
+    class SlabWelder
+    {
+        struct Entry
+        {
+            int64_t x, y, z;
+            uint32_t first;
+        };
+
+        struct Representative
+        {
+            double coords[3];
+            uint32_t point;
+            uint32_t next;
+        };
+
+        const Source& source;
+        const Grid& grid;
+        double epsilonSquared;
+        std::vector<Entry> table;
+        std::vector<Representative> representatives;
+
+        size_t findSlot(int64_t x, int64_t y, int64_t z) const
+        {
+            const size_t mask = table.size() - 1;
+            size_t slot = static_cast<size_t>(hashCell(x, y, z)) & mask;
+            while (table[slot].first != NONE && (table[slot].x != x || table[slot].y != y || table[slot].z != z))
+            {
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+
+        void insert(const int64_t* cell, const double* coords, uint32_t point)
+        {
+            const size_t slot = findSlot(cell[0], cell[1], cell[2]);
+            Entry& entry = table[slot];
+            if (entry.first == NONE)
+            {
+                entry.x = cell[0];
+                entry.y = cell[1];
+                entry.z = cell[2];
+            }
+            representatives.push_back(Representative{ { coords[0], coords[1], coords[2] }, point, entry.first });
+            entry.first = static_cast<uint32_t>(representatives.size() - 1);
+        }
+
+        bool load(uint32_t point, double* coords, int64_t* cell, double* fraction) const
+        {
+            for (size_t axis = 0; axis < 3; axis++)
+            {
+                coords[axis] = static_cast<double>(source.get(point, axis));
+                if (!std::isfinite(coords[axis]))
+                    return false;
+                const double scaled = grid.scaled(coords[axis], axis);
+                const double floor = std::floor(scaled);
+                cell[axis] = static_cast<int64_t>(floor);
+                fraction[axis] = scaled - floor;
+            }
+            return true;
+        }
+
+    public:
+
+        SlabWelder(const Source& _source, const Grid& _grid, double _epsilon) : source(_source), grid(_grid), epsilonSquared(_epsilon * _epsilon) {}
+
+        void run(const uint32_t* own, size_t ownCount, const uint32_t* halo, size_t haloCount, uint32_t* remap)
+        {
+            size_t capacity = 16;
+            while (capacity < 2 * (ownCount + haloCount))
+            {
+                capacity *= 2;
+            }
+            table.assign(capacity, Entry{ 0, 0, 0, NONE });
+            representatives.clear();
+            representatives.reserve(ownCount + haloCount);
+
+            double coords[3], fraction[3];
+            int64_t cell[3];
+            for (size_t h = 0; h < haloCount; h++)
+            {
+                if (load(halo[h], coords, cell, fraction))
+                    insert(cell, coords, halo[h]);
+            }
+
+            for (size_t o = 0; o < ownCount; o++)
+            {
+                const uint32_t point = own[o];
+                if (!load(point, coords, cell, fraction))
+                {
+                    remap[point] = point;
+                    continue;
+                }
+
+                // Per axis the home cell and, if the point is within epsilon of a cell face, the cell behind it.
+                int64_t offsets[3][3];
+                size_t offsetCount[3];
+                for (size_t axis = 0; axis < 3; axis++)
+                {
+                    offsetCount[axis] = 0;
+                    offsets[axis][offsetCount[axis]++] = 0;
+                    if (fraction[axis] <= grid.reach)
+                        offsets[axis][offsetCount[axis]++] = -1;
+                    if (1.0 - fraction[axis] <= grid.reach)
+                        offsets[axis][offsetCount[axis]++] = 1;
+                }
+
+                uint32_t best = NONE;
+                double bestDistance = epsilonSquared;
+                for (size_t i = 0; i < offsetCount[0]; i++)
+                {
+                    for (size_t j = 0; j < offsetCount[1]; j++)
+                    {
+                        for (size_t k = 0; k < offsetCount[2]; k++)
+                        {
+                            const size_t slot = findSlot(cell[0] + offsets[0][i], cell[1] + offsets[1][j], cell[2] + offsets[2][k]);
+                            for (uint32_t r = table[slot].first; r != NONE; r = representatives[r].next)
+                            {
+                                const Representative& candidate = representatives[r];
+                                const double dx = coords[0] - candidate.coords[0];
+                                const double dy = coords[1] - candidate.coords[1];
+                                const double dz = coords[2] - candidate.coords[2];
+                                const double distance = dx * dx + dy * dy + dz * dz;
+                                if (distance < bestDistance || (distance == bestDistance && candidate.point < best))
+                                {
+                                    best = candidate.point;
+                                    bestDistance = distance;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                if (best != NONE)
+                {
+                    remap[point] = best;
+                }
+                else
+                {
+                    remap[point] = point;
+                    insert(cell, coords, point);
+                }
+            }
+        }
+    };
+
+    template<class coordDataType, class Source>
+    size_t weld(const Source& source, size_t count, coordDataType _epsilon, uint32_t* remap, std::vector<scaleGeom::Vector<coordDataType, 3>>& unique,
+        unsigned _threads, size_t _batchPoints)
+    {
+        if (count >= NONE)
+            throw std::length_error("PointWeld: more than 2^32 - 1 points\n");
+        unique.clear();
+        if (!count)
+            return 0;
+        const unsigned threads = scaleGeom::resolveThreadCount(_threads);
+
+        // Bounding box of the finite points. Points with a non-finite coordinate are their own representatives.
+        std::vector<std::array<double, 6>> chunkBounds(threads);
+        const unsigned boundChunks = scaleGeom::parallelChunks(0, count, threads, SCAN_GRAIN, [&](unsigned chunk, size_t begin, size_t end) {
+            std::array<double, 6> bounds = { { HUGE_VAL, HUGE_VAL, HUGE_VAL, -HUGE_VAL, -HUGE_VAL, -HUGE_VAL } };
+            for (size_t i = begin; i < end; i++)
+            {
+                const double x = static_cast<double>(source.get(i, 0)), y = static_cast<double>(source.get(i, 1)), z = static_cast<double>(source.get(i, 2));
+                if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(z))
+                {
+                    remap[i] = static_cast<uint32_t>(i);
+                    continue;
+                }
+                bounds[0] = std::min(bounds[0], x);
+                bounds[1] = std::min(bounds[1], y);
+                bounds[2] = std::min(bounds[2], z);
+                bounds[3] = std::max(bounds[3], x);
+                bounds[4] = std::max(bounds[4], y);
+                bounds[5] = std::max(bounds[5], z);
+            }
+            chunkBounds[chunk] = bounds;
+        });
+        std::array<double, 6> bounds = chunkBounds[0];
+        for (unsigned chunk = 1; chunk < boundChunks; chunk++)
+        {
+            for (size_t axis = 0; axis < 3; axis++)
+            {
+                bounds[axis] = std::min(bounds[axis], chunkBounds[chunk][axis]);
+                bounds[axis + 3] = std::max(bounds[axis + 3], chunkBounds[chunk][axis + 3]);
+            }
+        }
+
+        const double epsilon = _epsilon > 0 ? static_cast<double>(_epsilon) : 0.0;
+        Grid grid;
+        double extent = 0.0;
+        for (size_t axis = 0; axis < 3; axis++)
+        {
+            grid.lower[axis] = bounds[axis] <= bounds[axis + 3] ? bounds[axis] : 0.0;
+            extent = std::max(extent, bounds[axis + 3] - grid.lower[axis]);
+        }
+        double cellSize = std::max(3.0 * epsilon, std::ldexp(extent, -40));
+        if (!(cellSize > 0) || !std::isfinite(cellSize))
+            cellSize = 1.0;
+        grid.inverseCellSize = 1.0 / cellSize;
+        grid.reach = epsilon * grid.inverseCellSize + 1e-6;
+
+        // Histogram of the x cells, in bins of binCells cells.
+        const int64_t cellsX = bounds[0] <= bounds[3] ? static_cast<int64_t>(std::floor(grid.scaled(bounds[3], 0))) + 1 : 1;
+        const int64_t binCells = (cellsX + MAX_BINS - 1) / MAX_BINS;
+        const size_t bins = static_cast<size_t>((cellsX + binCells - 1) / binCells);
+        auto cellOf = [&](double x) {
+            return std::min(cellsX - 1, std::max<int64_t>(0, static_cast<int64_t>(std::floor(grid.scaled(x, 0)))));
+        };
+
+        std::vector<std::vector<uint32_t>> chunkHistograms(threads);
+        const unsigned histogramChunks = scaleGeom::parallelChunks(0, count, threads, SCAN_GRAIN, [&](unsigned chunk, size_t begin, size_t end) {
+            std::vector<uint32_t>& histogram = chunkHistograms[chunk];
+            histogram.assign(bins, 0);
+            for (size_t i = begin; i < end; i++)
+            {
+                const double x = static_cast<double>(source.get(i, 0));
+                if (std::isfinite(x))
+                    histogram[static_cast<size_t>(cellOf(x) / binCells)]++;
+            }
+        });
+        std::vector<size_t> histogram(bins, 0);
+        for (unsigned chunk = 0; chunk < histogramChunks; chunk++)
+        {
+            for (size_t b = 0; b < bins; b++)
+            {
+                histogram[b] += chunkHistograms[chunk][b];
+            }
+            std::vector<uint32_t>().swap(chunkHistograms[chunk]);
+        }
+
+        // Slabs of consecutive bins with at least slabPoints points each (the last one may have fewer).
+        const size_t slabPoints = std::min<size_t>(std::max<size_t>(count / 256, 4096), size_t(1) << 20);
+        std::vector<Slab> slabs;
+        std::vector<uint32_t> binSlab(bins);
+        for (size_t b = 0; b < bins; b++)
+        {
+            if (slabs.empty() || slabs.back().count >= slabPoints)
+                slabs.push_back(Slab{ static_cast<int64_t>(b) * binCells, 0, 0 });
+            slabs.back().endCell = std::min(cellsX, static_cast<int64_t>(b + 1) * binCells);
+            slabs.back().count += histogram[b];
+            binSlab[b] = static_cast<uint32_t>(slabs.size() - 1);
+        }
+        std::vector<size_t>().swap(histogram);
+
+        // Even slabs first, then odd slabs, in passes of about _batchPoints points.
+        const size_t batchPoints = std::max<size_t>(_batchPoints, 1);
+        std::vector<uint32_t> members, counts, offsets;
+        for (size_t parity = 0; parity < 2; parity++)
+        {
+            for (size_t first = parity; first < slabs.size();)
+            {
+                size_t last = first, passPoints = slabs[first].count;
+                while (last + 2 < slabs.size() && passPoints + slabs[last + 2].count <= batchPoints)
+                {
+                    last += 2;
+                    passPoints += slabs[last].count;
+                }
+                const size_t passSlabs = (last - first) / 2 + 1;
+
+                // Bucket index of point i for this pass: 2 * local slab (+1 for halo), or NONE. A halo point
+                // (a representative in the boundary column of an even neighbour) can border two odd slabs.
+                auto classify = [&](size_t i, uint32_t* buckets) -> size_t {
+                    const double x = static_cast<double>(source.get(i, 0));
+                    if (!std::isfinite(x))
+                        return 0;
+                    const int64_t cell = cellOf(x);
+                    const size_t s = binSlab[static_cast<size_t>(cell / binCells)];
+                    if (s % 2 == parity)
+                    {
+                        if (s < first || s > last)
+                            return 0;
+                        buckets[0] = static_cast<uint32_t>(2 * ((s - first) / 2));
+                        return 1;
+                    }
+                    if (parity == 0 || remap[i] != i)
+                        return 0;
+                    size_t found = 0;
+                    if (cell == slabs[s].firstCell && s >= first + 1 && s - 1 <= last)
+                        buckets[found++] = static_cast<uint32_t>(2 * ((s - 1 - first) / 2) + 1);
+                    if (cell == slabs[s].endCell - 1 && s + 1 >= first && s + 1 <= last)
+                        buckets[found++] = static_cast<uint32_t>(2 * ((s + 1 - first) / 2) + 1);
+                    return found;
+                };
+
+                // Count per chunk and bucket, then scatter in input order.
+                const size_t bucketCount = 2 * passSlabs;
+                const unsigned chunks = static_cast<unsigned>(std::min<size_t>(threads, (count + SCAN_GRAIN - 1) / SCAN_GRAIN));
+                counts.assign(static_cast<size_t>(chunks) * bucketCount, 0);
+                scaleGeom::parallelChunks(0, count, chunks, SCAN_GRAIN, [&](unsigned chunk, size_t begin, size_t end) {
+                    uint32_t* chunkCounts = &counts[chunk * bucketCount];
+                    uint32_t buckets[2];
+                    for (size_t i = begin; i < end; i++)
+                    {
+                        const size_t found = classify(i, buckets);
+                        for (size_t f = 0; f < found; f++)
+                        {
+                            chunkCounts[buckets[f]]++;
+                        }
+                    }
+                });
+                offsets.assign(bucketCount + 1, 0);
+                uint32_t total = 0;
+                for (size_t bucket = 0; bucket < bucketCount; bucket++)
+                {
+                    offsets[bucket] = total;
+                    for (unsigned chunk = 0; chunk < chunks; chunk++)
+                    {
+                        const uint32_t n = counts[chunk * bucketCount + bucket];
+                        counts[chunk * bucketCount + bucket] = total;
+                        total += n;
+                    }
+                }
+                offsets[bucketCount] = total;
+                members.resize(total);
+                scaleGeom::parallelChunks(0, count, chunks, SCAN_GRAIN, [&](unsigned chunk, size_t begin, size_t end) {
+                    uint32_t* next = &counts[chunk * bucketCount];
+                    uint32_t buckets[2];
+                    for (size_t i = begin; i < end; i++)
+                    {
+                        const size_t found = classify(i, buckets);
+                        for (size_t f = 0; f < found; f++)
+                        {
+                            members[next[buckets[f]]++] = static_cast<uint32_t>(i);
+                        }
+                    }
+                });
+
+                scaleGeom::parallelChunks(0, passSlabs, threads, 1, [&](unsigned, size_t begin, size_t end) {
+                    SlabWelder<Source> welder(source, grid, epsilon);
+                    for (size_t local = begin; local < end; local++)
+                    {
+                        const uint32_t* own = members.data() + offsets[2 * local];
+                        const uint32_t* halo = members.data() + offsets[2 * local + 1];
+                        welder.run(own, offsets[2 * local + 1] - offsets[2 * local], halo, offsets[2 * local + 2] - offsets[2 * local + 1], remap);
+                    }
+                });
+                first = last + 2;
+            }
+        }
+
+        // Number the representatives in input order: a bitmap of representatives with a running count per
+        // 64-bit word turns a representative's point index into its unique index.
+        const size_t words = (count + 63) / 64;
+        std::vector<uint64_t> isRepresentative(words, 0);
+        std::vector<uint32_t> before(words);
+        scaleGeom::parallelFor(0, words, threads, 1 << 12, [&](size_t w) {
+            uint64_t bits = 0;
+            const size_t end = std::min(count, 64 * w + 64);
+            for (size_t i = 64 * w; i < end; i++)
+            {
+                bits |= static_cast<uint64_t>(remap[i] == i) << (i - 64 * w);
+            }
+            isRepresentative[w] = bits;
+        });
+        uint32_t uniqueCount = 0;
+        for (size_t w = 0; w < words; w++)
+        {
+            before[w] = uniqueCount;
+            uniqueCount += bitCount(isRepresentative[w]);
+        }
+
+        unique.resize(uniqueCount);
+        scaleGeom::parallelFor(0, count, threads, SCAN_GRAIN, [&](size_t i) {
+            const uint32_t representative = remap[i];
+            const size_t w = representative / 64;
+            const uint64_t below = (uint64_t(1) << (representative % 64)) - 1;
+            const uint32_t id = before[w] + bitCount(isRepresentative[w] & below);
+            remap[i] = id;
+            if (representative == i)
+                unique[id] = scaleGeom::Vector<coordDataType, 3>(source.get(i, 0), source.get(i, 1), source.get(i, 2));
+        });
+        return uniqueCount;
+    }
+}
+
+size_t scaleGeom::weldPoints(ConstPointCloudView<float, DIM3> points, float epsilon, uint32_t* remap, std::vector<Vector3f>& unique,
+    unsigned _threads, size_t _batchPoints)
+{
+    return weld(SoaSource<float>{ points }, points.count, epsilon, remap, unique, _threads, _batchPoints);
+}
+
+size_t scaleGeom::weldPoints(ConstPointCloudView<double, DIM3> points, double epsilon, uint32_t* remap, std::vector<Vector3d>& unique,
+    unsigned _threads, size_t _batchPoints)
+{
+    return weld(SoaSource<double>{ points }, points.count, epsilon, remap, unique, _threads, _batchPoints);
+}
+
+size_t scaleGeom::weldPoints(const Vector3f* points, size_t count, float epsilon, uint32_t* remap, std::vector<Vector3f>& unique,
+    unsigned _threads, size_t _batchPoints)
+{
+    return weld(AosSource<float>{ points }, count, epsilon, remap, unique, _threads, _batchPoints);
+}
+
+size_t scaleGeom::weldPoints(const Vector3d* points, size_t count, double epsilon, uint32_t* remap, std::vector<Vector3d>& unique,
+    unsigned _threads, size_t _batchPoints)
+{
+    return weld(AosSource<double>{ points }, count, epsilon, remap, unique, _threads, _batchPoints);
+}
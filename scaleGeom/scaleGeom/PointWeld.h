@@ -0,0 +1,65 @@
+/*
+	PointWeld.h - Parallel Point Welding
+
+	Overview:
+	weldPoints merges points that lie within epsilon (Euclidean distance) of each other, as when
+	the shared boundary vertices of many mesh tiles are stitched together. It writes a remap table
+	(remap[i] is the index of the unique point that point i was welded to) and the unique points.
+	Each unique point is the input point that represents its group, and they are ordered by the
+	input index of that point.
+
+	Method:
+	Points are hashed into a uniform grid of cells three times epsilon wide, and a point is only
+	compared with the representatives in its own cell and, per axis, the neighbouring cell on the
+	side it is closer to (when that side is within epsilon). A point is welded to the nearest
+	representative within epsilon (the lower index on ties) or becomes a representative itself.
+
+	Space is cut into slabs of whole cells along the x axis, each holding a few thousand points
+	or more. All even slabs are processed first, in parallel, then all odd slabs, which see the
+	representatives of their even neighbours; inside a slab points are taken in input order. The
+	slabs depend only on the data, so the result does not depend on the thread count or on the
+	batch size below.
+
+	Memory:
+	Slabs are processed in passes of about _batchPoints points; each pass streams over the x
+	coordinates of the input to collect its points, so the input can be a memory-mapped file
+	(MappedPointFile::view) much larger than the working set. Besides the outputs, the memory used
+	is proportional to _batchPoints plus a few bits per input point.
+
+	Points with a NaN or infinite coordinate are never welded and stay unique. Inputs are limited
+	to 2^32 - 1 points (32-bit remap entries); larger inputs throw std::length_error.
+
+	Usage:
+	std::vector<uint32_t> remap(points.size());
+	std::vector<scaleGeom::Vector3f> unique;
+	scaleGeom::weldPoints(points.data(), points.size(), 1e-4f, remap.data(), unique);
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "PointCloud.h"
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	// Default number of points processed per pass.
+	constexpr size_t WELD_BATCH_POINTS = size_t(1) << 24;
+
+	// Weld SoA points. Returns the number of unique points.
+	size_t weldPoints(ConstPointCloudView<float, DIM3> points, float epsilon, uint32_t* remap, std::vector<Vector3f>& unique,
+		unsigned _threads = 0, size_t _batchPoints = WELD_BATCH_POINTS);
+	size_t weldPoints(ConstPointCloudView<double, DIM3> points, double epsilon, uint32_t* remap, std::vector<Vector3d>& unique,
+		unsigned _threads = 0, size_t _batchPoints = WELD_BATCH_POINTS);
+
+	// Weld an array of Vectors. Returns the number of unique points.
+	size_t weldPoints(const Vector3f* points, size_t count, float epsilon, uint32_t* remap, std::vector<Vector3f>& unique,
+		unsigned _threads = 0, size_t _batchPoints = WELD_BATCH_POINTS);
+	size_t weldPoints(const Vector3d* points, size_t count, double epsilon, uint32_t* remap, std::vector<Vector3d>& unique,
+		unsigned _threads = 0, size_t _batchPoints = WELD_BATCH_POINTS);
+
+} // Closing the scaleGeom namespace.
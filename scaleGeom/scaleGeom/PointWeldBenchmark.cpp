@@ -0,0 +1,90 @@
+#include "Benchmark.h"
+#include "Dedup.h"
+#include "Parallel.h"
+#include "PointWeld.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    // Vertices of a terrain mesh cut into square tiles. Every tile carries its own copy of its border
+    // vertices, moved by a little noise, so vertices on tile edges appear two or four times.
+    std::vector<scaleGeom::Vector3f> makeTiles(size_t targetCount, int tileSize)
+    {
+        const int perTile = (tileSize + 1) * (tileSize + 1);
+        const int tilesPerSide = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(targetCount) / perTile)));
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> noise(-1e-5f, 1e-5f);
+        std::vector<scaleGeom::Vector3f> points;
+        points.reserve(static_cast<size_t>(tilesPerSide) * tilesPerSide * perTile);
+        for (int ty = 0; ty < tilesPerSide; ty++)
+        {
+            for (int tx = 0; tx < tilesPerSide; tx++)
+            {
+                for (int y = 0; y <= tileSize; y++)
+                {
+                    for (int x = 0; x <= tileSize; x++)
+                    {
+                        const float gx = 0.01f * static_cast<float>(tx * tileSize + x), gy = 0.01f * static_cast<float>(ty * tileSize + y);
+                        const float height = std::sin(gx) * std::cos(gy);
+                        points.push_back(scaleGeom::Vector3f(gx + noise(rng), gy + noise(rng), height + noise(rng)));
+                    }
+                }
+            }
+        }
+        return points;
+    }
+
+    void report(const char* label, unsigned threads, double seconds, size_t count, size_t unique, const char* note)
+    {
+        std::cout << "  " << std::left << std::setw(28) << label << std::right
+            << std::setw(3) << threads << " threads "
+            << std::setw(9) << std::fixed << std::setprecision(2) << seconds * 1e3 << " ms  "
+            << std::setw(7) << std::setprecision(2) << count / seconds / 1e6 << " Mpts/s  "
+            << std::setw(9) << unique << " unique" << note << std::endl;
+    }
+}
+
+SCALEGEOM_BENCHMARK(PointWeld)
+{
+    const std::vector<scaleGeom::Vector3f> points = makeTiles(scaleGeom::bench::problemSize(4000000), 64);
+    const size_t count = points.size();
+    const float epsilon = 1e-4f;
+    const unsigned hardware = scaleGeom::resolveThreadCount(0);
+    std::cout << "  points: " << count << ", epsilon: " << std::scientific << std::setprecision(1) << epsilon << std::fixed << std::endl;
+
+    std::vector<uint32_t> reference(count), remap(count);
+    std::vector<scaleGeom::Vector3f> unique;
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware))
+    {
+        Timer timer;
+        size_t uniqueCount = scaleGeom::weldPoints(points.data(), count, epsilon, threads == 1 ? reference.data() : remap.data(), unique, threads);
+        double seconds = timer.seconds();
+        report("weldPoints", threads, seconds, count, uniqueCount, threads == 1 || remap == reference ? "" : "  MISMATCH");
+        if (threads == hardware)
+            break;
+    }
+
+    // Bounded memory: passes of 1/16 of the input, streaming over it 32 times.
+    {
+        Timer timer;
+        size_t uniqueCount = scaleGeom::weldPoints(points.data(), count, epsilon, remap.data(), unique, hardware, count / 16 + 1);
+        double seconds = timer.seconds();
+        report("weldPoints, batch n/16", hardware, seconds, count, uniqueCount, remap == reference ? "" : "  MISMATCH");
+    }
+
+    // The serial hashed dedup with a per-axis tolerance, for comparison.
+    {
+        std::vector<size_t> dedupRemap(count);
+        Timer timer;
+        size_t uniqueCount = scaleGeom::deduplicatePoints(points.data(), count, dedupRemap.data(), scaleGeom::AbsoluteTolerance<float>{ epsilon }).size();
+        report("deduplicatePoints", 1, timer.seconds(), count, uniqueCount, "");
+    }
+}
@@ -0,0 +1,689 @@
+#include "PolygonBoolean.h"
+#include "Parallel.h"
+#include "Predicates.h"
+#include "SegmentIntersection.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+    using scaleGeom::BooleanOperation;
+
+    const uint32_t NONE = 0xffffffffu;
+
+    // Noding passes after which the input is considered pathological.
+    const size_t MAX_NODING_PASSES = 32;
+
+    // Distance in ulps of the coordinates within which a crossing is moved onto an endpoint.
+    const double SNAP_ULPS = 16.0;
+
+    // Edges per strip when the number of strips is automatic.
+    const size_t TILE_EDGES = size_t(1) << 16;
+
+    // Edge centres sampled to place the strip lines.
+    const size_t STRIP_SAMPLE = size_t(1) << 16;
+
+    // Points compare lexicographically (x, then y), the order of the sweeps.
+    typedef std::array<double, 2> Point;
+
+    // An edge from its lexicographically smaller endpoint a to b. Crossing it from below (the right of a -> b)
+    // to above changes the winding number of operand k by winding[k]. Result edges use winding[0] for their
+    // direction: 1 if the result is above the edge (it runs from a to b with the result on its left), -1 if below.
+    struct Edge
+    {
+        Point a;
+        Point b;
+        int32_t winding[2];
+    };
+
+    inline int signOf(double value)
+    {
+        return (value > 0.0) - (value < 0.0);
+    }
+
+    inline int orientation(const Point& a, const Point& b, const Point& c)
+    {
+        return signOf(scaleGeom::orient2d(a.data(), b.data(), c.data()));
+    }
+
+    inline bool edgeLess(const Edge& e, const Edge& f)
+    {
+        return std::tie(e.a, e.b) < std::tie(f.a, f.b);
+    }
+
+    // Append the edge p -> q carrying winding (w0, w1) in that direction, unless it has no length.
+    inline void appendEdge(std::vector<Edge>& edges, const Point& p, const Point& q, int32_t w0, int32_t w1)
+    {
+        if (p == q)
+            return;
+        if (p < q)
+            edges.push_back({ p, q, { w0, w1 } });
+        else
+            edges.push_back({ q, p, { -w0, -w1 } });
+    }
+
+    // Coordinates in the units of the computation: multiples of the snap grid, or unchanged.
+    struct Frame
+    {
+        bool integer = false;
+        double grid = 1.0;
+
+        double in(double value) const
+        {
+            return integer ? std::nearbyint(value / grid) : value;
+        }
+
+        double round(double value) const
+        {
+            return integer ? std::nearbyint(value) : value;
+        }
+
+        double out(double value) const
+        {
+            return integer ? value * grid : value;
+        }
+    };
+
+    // Edges of the rings of one operand, outer rings counterclockwise and holes clockwise.
+    void addOperand(const std::vector<scaleGeom::Polygon>& polygons, int operand, const Frame& frame, std::vector<Edge>& edges)
+    {
+        std::vector<Point> points;
+        auto addRing = [&](const scaleGeom::PolygonRing& ring, bool counterclockwise) {
+            points.resize(ring.size());
+            double area = 0.0;
+            for (size_t i = 0; i < ring.size(); i++)
+            {
+                points[i] = { frame.in(ring[i][0]), frame.in(ring[i][1]) };
+            }
+            for (size_t i = 0; i < points.size(); i++)
+            {
+                const Point& p = points[i];
+                const Point& q = points[(i + 1) % points.size()];
+                area += p[0] * q[1] - q[0] * p[1];
+            }
+            const int32_t direction = (area < 0.0) == counterclockwise ? -1 : 1;
+            for (size_t i = 0; i < points.size(); i++)
+            {
+                appendEdge(edges, points[i], points[(i + 1) % points.size()], operand == 0 ? direction : 0, operand == 1 ? direction : 0);
+            }
+        };
+        for (const scaleGeom::Polygon& polygon : polygons)
+        {
+            addRing(polygon.outer, true);
+            for (const scaleGeom::PolygonRing& hole : polygon.holes)
+            {
+                addRing(hole, false);
+            }
+        }
+    }
+
+    // Sort the edges and merge coincident ones, dropping those that no longer change any winding number.
+    void mergeEdges(std::vector<Edge>& edges)
+    {
+        std::sort(edges.begin(), edges.end(), edgeLess);
+        size_t kept = 0;
+        for (size_t i = 0; i < edges.size(); )
+        {
+            Edge merged = edges[i];
+            size_t j = i + 1;
+            for (; j < edges.size() && edges[j].a == merged.a && edges[j].b == merged.b; j++)
+            {
+                merged.winding[0] += edges[j].winding[0];
+                merged.winding[1] += edges[j].winding[1];
+            }
+            if (merged.winding[0] != 0 || merged.winding[1] != 0)
+                edges[kept++] = merged;
+            i = j;
+        }
+        edges.resize(kept);
+    }
+
+    // Split the edges at the points in splits (edge index, point) and merge the pieces.
+    void splitEdges(std::vector<Edge>& edges, std::vector<std::pair<uint32_t, Point>>& splits)
+    {
+        std::sort(splits.begin(), splits.end());
+        std::vector<Edge> pieces;
+        pieces.reserve(edges.size() + 2 * splits.size());
+        size_t k = 0;
+        for (size_t i = 0; i < edges.size(); i++)
+        {
+            const Edge& edge = edges[i];
+            if (k == splits.size() || splits[k].first != i)
+            {
+                pieces.push_back(edge);
+                continue;
+            }
+            Point from = edge.a;
+            for (; k < splits.size() && splits[k].first == i; k++)
+            {
+                appendEdge(pieces, from, splits[k].second, edge.winding[0], edge.winding[1]);
+                from = splits[k].second;
+            }
+            appendEdge(pieces, from, edge.b, edge.winding[0], edge.winding[1]);
+        }
+        edges.swap(pieces);
+        mergeEdges(edges);
+    }
+
+    // Split the edges until they only meet at shared endpoints. Returns the number of sweeps.
+    size_t nodeEdges(std::vector<Edge>& edges, const Frame& frame, unsigned threads)
+    {
+        mergeEdges(edges);
+        std::vector<scaleGeom::Vector2d> endpoints;
+        std::vector<std::pair<uint32_t, Point>> splits;
+        for (size_t pass = 1; ; pass++)
+        {
+            endpoints.resize(2 * edges.size());
+            for (size_t i = 0; i < edges.size(); i++)
+            {
+                endpoints[2 * i] = scaleGeom::Vector2d(edges[i].a[0], edges[i].a[1]);
+                endpoints[2 * i + 1] = scaleGeom::Vector2d(edges[i].b[0], edges[i].b[1]);
+            }
+            splits.clear();
+            auto splitInside = [&](uint32_t e, const Point& p) {
+                if (edges[e].a < p && p < edges[e].b)
+                    splits.push_back({ e, p });
+            };
+            scaleGeom::intersectSegments(endpoints.data(), edges.size(), [&](uint32_t s, uint32_t t, const scaleGeom::Vector2d& point) {
+                const Edge& first = edges[s];
+                const Edge& second = edges[t];
+                if (orientation(first.a, first.b, second.a) == 0 && orientation(first.a, first.b, second.b) == 0)
+                {
+                    // Overlap: each edge is split at the endpoints of the other that lie inside it.
+                    splitInside(s, second.a);
+                    splitInside(s, second.b);
+                    splitInside(t, first.a);
+                    splitInside(t, first.b);
+                }
+                else
+                {
+                    // A crossing rounded next to an endpoint is moved onto it. Splitting there makes the edges meet
+                    // at that vertex, where a point a few ulps off would be crossed again by the pieces, one ulp
+                    // further along each pass.
+                    Point p = { frame.round(point[0]), frame.round(point[1]) };
+                    const double tolerance = SNAP_ULPS * std::numeric_limits<double>::epsilon() * (std::fabs(p[0]) + std::fabs(p[1]));
+                    for (const Point* q : { &first.a, &first.b, &second.a, &second.b })
+                    {
+                        if (std::fabs(p[0] - (*q)[0]) <= tolerance && std::fabs(p[1] - (*q)[1]) <= tolerance)
+                        {
+                            p = *q;
+                            break;
+                        }
+                    }
+                    if (p != first.a && p != first.b)
+                        splits.push_back({ s, p });
+                    if (p != second.a && p != second.b)
+                        splits.push_back({ t, p });
+                }
+            }, false, threads);
+            if (splits.empty())
+                return pass;
+            if (pass == MAX_NODING_PASSES)
+                throw std::runtime_error("polygonBoolean: edges still cross after splitting; use a snap grid\n");
+            splitEdges(edges, splits);
+        }
+    }
+
+    // Sweep over edges sorted by a that meet only at endpoints, calling visit(e, below) for every edge with the
+    // edge just below its start in the status (NONE if there is none). Edges starting at one point are visited
+    // bottom to top, so below has always been visited before.
+    template<class Visit>
+    void sweepEdges(const std::vector<Edge>& edges, const Visit& visit)
+    {
+        // Edges in the status overlap in x, and the later of their starts lies on the other one only if the
+        // starts are shared.
+        struct Below
+        {
+            const std::vector<Edge>* edges;
+
+            bool operator()(uint32_t e, uint32_t f) const
+            {
+                if (e == f)
+                    return false;
+                const Edge& first = (*edges)[e];
+                const Edge& second = (*edges)[f];
+                if (first.a < second.a)
+                {
+                    int side = orientation(first.a, first.b, second.a);
+                    return (side != 0 ? side : orientation(first.a, first.b, second.b)) > 0;
+                }
+                int side = orientation(second.a, second.b, first.a);
+                return (side != 0 ? side : orientation(second.a, second.b, first.b)) < 0;
+            }
+        };
+        typedef std::set<uint32_t, Below> Status;
+
+        Status status(Below{ &edges });
+        std::vector<typename Status::iterator> position(edges.size());
+        std::vector<uint32_t> byEnd(edges.size());
+        std::iota(byEnd.begin(), byEnd.end(), 0u);
+        std::sort(byEnd.begin(), byEnd.end(), [&](uint32_t e, uint32_t f) { return edges[e].b < edges[f].b; });
+
+        size_t removed = 0;
+        for (size_t begin = 0; begin < edges.size(); )
+        {
+            const Point p = edges[begin].a;
+            size_t end = begin + 1;
+            while (end < edges.size() && edges[end].a == p)
+                end++;
+            for (; removed < edges.size() && !(p < edges[byEnd[removed]].b); removed++)
+            {
+                status.erase(position[byEnd[removed]]);
+            }
+            for (size_t e = begin; e < end; e++)
+            {
+                position[e] = status.insert(static_cast<uint32_t>(e)).first;
+            }
+
+            // The edges starting at p are contiguous in the status.
+            typename Status::iterator at = position[begin];
+            while (at != status.begin() && edges[*std::prev(at)].a == p)
+                --at;
+            for (size_t k = begin; k < end; k++, ++at)
+            {
+                visit(*at, at == status.begin() ? NONE : *std::prev(at));
+            }
+            begin = end;
+        }
+    }
+
+    inline bool inside(BooleanOperation operation, const int32_t* winding)
+    {
+        const bool subject = winding[0] != 0, clip = winding[1] != 0;
+        switch (operation)
+        {
+        case BooleanOperation::Union:
+            return subject || clip;
+        case BooleanOperation::Intersection:
+            return subject && clip;
+        case BooleanOperation::Difference:
+            return subject && !clip;
+        default:
+            return subject != clip;
+        }
+    }
+
+    // Append the noded edges that separate the inside of the result from the outside to result.
+    void labelEdges(const std::vector<Edge>& edges, BooleanOperation operation, std::vector<Edge>& result)
+    {
+        std::vector<int32_t> below(2 * edges.size());
+        sweepEdges(edges, [&](uint32_t e, uint32_t under) {
+            int32_t* lower = &below[2 * e];
+            lower[0] = under == NONE ? 0 : below[2 * under] + edges[under].winding[0];
+            lower[1] = under == NONE ? 0 : below[2 * under + 1] + edges[under].winding[1];
+            const int32_t upper[2] = { lower[0] + edges[e].winding[0], lower[1] + edges[e].winding[1] };
+            const bool insideBelow = inside(operation, lower), insideAbove = inside(operation, upper);
+            if (insideBelow != insideAbove)
+                result.push_back({ edges[e].a, edges[e].b, { insideAbove ? 1 : -1, 0 } });
+        });
+    }
+
+    // Strip lines near quantiles of the edge centres (of a sample of the edges), so that the strips hold about
+    // the same number of edges. Lines are put halfway between the vertices on either side: a vertical edge or a
+    // vertex on a line is where the strips are most likely to disagree, and the rounded crossings next to it most
+    // likely to keep splitting each other.
+    std::vector<double> stripLines(const std::vector<Edge>& edges, size_t strips, const Frame& frame)
+    {
+        const size_t step = std::max<size_t>(1, edges.size() / STRIP_SAMPLE);
+        std::vector<double> centres;
+        for (size_t i = 0; i < edges.size(); i += step)
+        {
+            centres.push_back(0.5 * (edges[i].a[0] + edges[i].b[0]));
+        }
+        std::sort(centres.begin(), centres.end());
+        std::vector<double> targets;
+        for (size_t k = 1; k < strips; k++)
+        {
+            const double x = centres[k * centres.size() / strips];
+            if (targets.empty() || x > targets.back())
+                targets.push_back(x);
+        }
+
+        // The nearest vertices left of each target and at or right of it.
+        std::vector<double> left(targets.size(), -std::numeric_limits<double>::infinity());
+        std::vector<double> right(targets.size(), std::numeric_limits<double>::infinity());
+        for (const Edge& edge : edges)
+        {
+            for (double x : { edge.a[0], edge.b[0] })
+            {
+                const size_t k = std::upper_bound(targets.begin(), targets.end(), x) - targets.begin();
+                if (k < targets.size())
+                    left[k] = std::max(left[k], x);
+                if (k > 0)
+                    right[k - 1] = std::min(right[k - 1], x);
+            }
+        }
+        std::vector<double> lines;
+        for (size_t k = 0; k < targets.size(); k++)
+        {
+            if (!std::isfinite(left[k]) || !std::isfinite(right[k]))
+                continue;
+            const double x = frame.round(0.5 * (left[k] + right[k]));
+            if (lines.empty() || x > lines.back())
+                lines.push_back(x);
+        }
+        return lines;
+    }
+
+    // The point of the edge at the strip line x, rounded like a crossing. Both strips get the same point.
+    Point cutEdge(const Edge& edge, double x, const Frame& frame)
+    {
+        if (x == edge.b[0])
+            return edge.b;
+        const double y = edge.a[1] + (edge.b[1] - edge.a[1]) * ((x - edge.a[0]) / (edge.b[0] - edge.a[0]));
+        return { x, frame.round(std::min(std::max(y, std::min(edge.a[1], edge.b[1])), std::max(edge.a[1], edge.b[1]))) };
+    }
+
+    // Strip k covers [lines[k - 1], lines[k]).
+    std::vector<std::vector<Edge>> cutStrips(const std::vector<Edge>& edges, const std::vector<double>& lines, const Frame& frame)
+    {
+        std::vector<std::vector<Edge>> strips(lines.size() + 1);
+        auto stripOf = [&](double x) { return static_cast<size_t>(std::upper_bound(lines.begin(), lines.end(), x) - lines.begin()); };
+        for (const Edge& edge : edges)
+        {
+            const size_t first = stripOf(edge.a[0]), last = stripOf(edge.b[0]);
+            Point from = edge.a;
+            for (size_t k = first; k < last; k++)
+            {
+                const Point to = cutEdge(edge, lines[k], frame);
+                appendEdge(strips[k], from, to, edge.winding[0], edge.winding[1]);
+                from = to;
+            }
+            appendEdge(strips[last], from, edge.b, edge.winding[0], edge.winding[1]);
+        }
+        return strips;
+    }
+
+    // Rebuild the result edges on the strip lines. The strips do not agree there: a vertex on a line may come
+    // from the strip on its left only, and two edges crossing right at a line can have their cut points in the
+    // wrong order, so a crossing lands on the line. The vertical edges the strips found on the lines are dropped
+    // and replaced by the ones that balance the edges arriving at and leaving every point of the line, which
+    // are unique and close the rings whichever strip the points came from.
+    void stitchStrips(std::vector<Edge>& edges, const std::vector<double>& lines)
+    {
+        auto onLine = [&](double x) { return std::binary_search(lines.begin(), lines.end(), x); };
+        std::vector<std::pair<Point, int>> flow;
+        size_t kept = 0;
+        for (size_t i = 0; i < edges.size(); i++)
+        {
+            const Edge& edge = edges[i];
+            if (edge.a[0] == edge.b[0] && onLine(edge.a[0]))
+                continue;
+            if (onLine(edge.a[0]))
+                flow.push_back({ edge.a, edge.winding[0] });
+            if (onLine(edge.b[0]))
+                flow.push_back({ edge.b, -edge.winding[0] });
+            edges[kept++] = edge;
+        }
+        edges.resize(kept);
+        std::sort(flow.begin(), flow.end());
+
+        // Going up a line, more edges leaving than arriving below a gap is made up by edges coming down it.
+        int carried = 0;
+        for (size_t i = 0; i < flow.size(); )
+        {
+            const Point p = flow[i].first;
+            for (; i < flow.size() && flow[i].first == p; i++)
+            {
+                carried += flow[i].second;
+            }
+            if (i == flow.size() || flow[i].first[0] != p[0])
+            {
+                carried = 0;
+                continue;
+            }
+            for (int k = 0; k < std::abs(carried); k++)
+            {
+                edges.push_back({ p, flow[i].first, { carried > 0 ? -1 : 1, 0 } });
+            }
+        }
+    }
+
+    // Angular order of the points p and q around v, counterclockwise from the positive x axis.
+    inline bool angleLess(const Point& v, const Point& p, const Point& q)
+    {
+        const bool upperP = p[1] > v[1] || (p[1] == v[1] && p[0] > v[0]);
+        const bool upperQ = q[1] > v[1] || (q[1] == v[1] && q[0] > v[0]);
+        if (upperP != upperQ)
+            return upperP;
+        return orientation(v, p, q) > 0;
+    }
+
+    // Link the result edges into rings and the rings into polygons.
+    std::vector<scaleGeom::Polygon> assemble(std::vector<Edge>& edges, const Frame& frame, size_t& ringCount)
+    {
+        std::sort(edges.begin(), edges.end(), edgeLess);
+        const size_t count = edges.size();
+
+        std::vector<Point> vertices;
+        vertices.reserve(2 * count);
+        for (const Edge& edge : edges)
+        {
+            vertices.push_back(edge.a);
+            vertices.push_back(edge.b);
+        }
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+        auto vertexOf = [&](const Point& p) { return static_cast<uint32_t>(std::lower_bound(vertices.begin(), vertices.end(), p) - vertices.begin()); };
+
+        // Directed edges, with the result on their left, and the outgoing edges of every vertex in angular order.
+        std::vector<uint32_t> from(count), to(count), offsets(vertices.size() + 1, 0), outgoing(count);
+        for (size_t e = 0; e < count; e++)
+        {
+            const uint32_t a = vertexOf(edges[e].a), b = vertexOf(edges[e].b);
+            from[e] = edges[e].winding[0] > 0 ? a : b;
+            to[e] = edges[e].winding[0] > 0 ? b : a;
+            offsets[from[e] + 1]++;
+        }
+        for (size_t v = 0; v < vertices.size(); v++)
+        {
+            offsets[v + 1] += offsets[v];
+        }
+        {
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (uint32_t e = 0; e < count; e++)
+            {
+                outgoing[fill[from[e]]++] = e;
+            }
+        }
+        for (size_t v = 0; v < vertices.size(); v++)
+        {
+            std::sort(outgoing.begin() + offsets[v], outgoing.begin() + offsets[v + 1], [&](uint32_t e, uint32_t f) {
+                return angleLess(vertices[v], vertices[to[e]], vertices[to[f]]);
+            });
+        }
+
+        // The next edge turns as sharply as possible: the first outgoing edge clockwise from the way back.
+        std::vector<uint32_t> next(count);
+        for (size_t e = 0; e < count; e++)
+        {
+            const uint32_t v = to[e];
+            const Point& back = vertices[from[e]];
+            const std::vector<uint32_t>::iterator first = outgoing.begin() + offsets[v], last = outgoing.begin() + offsets[v + 1];
+            const std::vector<uint32_t>::iterator after = std::partition_point(first, last, [&](uint32_t f) {
+                return angleLess(vertices[v], vertices[to[f]], back);
+            });
+            next[e] = after == first ? *(last - 1) : *(after - 1);
+        }
+
+        // Closed walks, split into simple rings where they pass a vertex twice.
+        std::vector<std::vector<uint32_t>> rings;
+        std::vector<uint32_t> ringOf(count, NONE), stack, stackPosition(vertices.size(), NONE);
+        auto closeRing = [&](size_t begin) {
+            for (size_t k = begin; k < stack.size(); k++)
+            {
+                ringOf[stack[k]] = static_cast<uint32_t>(rings.size());
+                stackPosition[from[stack[k]]] = NONE;
+            }
+            rings.emplace_back(stack.begin() + begin, stack.end());
+            stack.resize(begin);
+        };
+        for (uint32_t start = 0; start < count; start++)
+        {
+            if (ringOf[start] != NONE)
+                continue;
+            uint32_t e = start;
+            do
+            {
+                if (ringOf[e] != NONE)
+                    throw std::runtime_error("polygonBoolean: result edges do not close into rings\n");
+                if (stackPosition[from[e]] != NONE)
+                    closeRing(stackPosition[from[e]]);
+                stackPosition[from[e]] = static_cast<uint32_t>(stack.size());
+                stack.push_back(e);
+                ringOf[e] = static_cast<uint32_t>(rings.size());
+                e = next[e];
+            } while (e != start);
+            closeRing(0);
+        }
+
+        // Every hole belongs to the polygon of the result edge just below its lowest edge at its first vertex.
+        std::vector<uint32_t> below(count);
+        sweepEdges(edges, [&](uint32_t e, uint32_t under) { below[e] = under; });
+
+        std::vector<scaleGeom::Polygon> polygons;
+        std::vector<uint32_t> polygonOf(rings.size(), NONE);
+        std::vector<int> ringSide(rings.size(), 0);
+        std::vector<scaleGeom::PolygonRing> ringPoints(rings.size());
+        std::vector<Point> points;
+        for (size_t r = 0; r < rings.size(); r++)
+        {
+            // Drop collinear vertices, including across the start.
+            points.clear();
+            for (uint32_t e : rings[r])
+            {
+                points.push_back(vertices[from[e]]);
+                while (points.size() >= 3 && orientation(points[points.size() - 3], points[points.size() - 2], points.back()) == 0)
+                    points.erase(points.end() - 2);
+            }
+            size_t first = 0;
+            while (points.size() - first >= 3)
+            {
+                if (orientation(points[points.size() - 2], points.back(), points[first]) == 0)
+                    points.pop_back();
+                else if (orientation(points.back(), points[first], points[first + 1]) == 0)
+                    first++;
+                else
+                    break;
+            }
+            if (points.size() - first < 3)
+                continue;
+            const size_t n = points.size() - first;
+            const size_t lowest = std::min_element(points.begin() + first, points.end()) - points.begin() - first;
+            ringSide[r] = orientation(points[first + (lowest + n - 1) % n], points[first + lowest], points[first + (lowest + 1) % n]);
+            scaleGeom::PolygonRing& ring = ringPoints[r];
+            ring.reserve(n);
+            for (size_t k = first; k < points.size(); k++)
+            {
+                ring.push_back(scaleGeom::Vector2d(frame.out(points[k][0]), frame.out(points[k][1])));
+            }
+            if (ringSide[r] > 0)
+            {
+                polygonOf[r] = static_cast<uint32_t>(polygons.size());
+                polygons.emplace_back();
+                polygons.back().outer.swap(ring);
+            }
+        }
+        auto ownerOf = [&](size_t r) -> uint32_t {
+            // The lower of the two edges of the hole at its lexicographically smallest vertex.
+            uint32_t lowest = NONE;
+            for (uint32_t e : rings[r])
+            {
+                if (lowest == NONE || edges[e].a < edges[lowest].a
+                    || (edges[e].a == edges[lowest].a && orientation(edges[e].a, edges[e].b, edges[lowest].b) > 0))
+                    lowest = e;
+            }
+            const uint32_t under = below[lowest];
+            return under == NONE || edges[under].winding[0] < 0 ? NONE : ringOf[under];
+        };
+        for (size_t r = 0; r < rings.size(); r++)
+        {
+            if (ringSide[r] >= 0)
+                continue;
+            // Holes below holes share their polygon; follow them down to an outer ring.
+            uint32_t owner = ownerOf(r);
+            for (size_t steps = 0; owner != NONE && ringSide[owner] < 0 && polygonOf[owner] == NONE && steps < rings.size(); steps++)
+                owner = ownerOf(owner);
+            if (owner == NONE || polygonOf[owner] == NONE)
+                continue;
+            polygonOf[r] = polygonOf[owner];
+            polygons[polygonOf[r]].holes.push_back(std::move(ringPoints[r]));
+        }
+        ringCount = rings.size();
+        return polygons;
+    }
+}
+
+std::vector<scaleGeom::Polygon> scaleGeom::polygonBoolean(const std::vector<Polygon>& subject, const std::vector<Polygon>& clip,
+    BooleanOperation operation, double _snapGrid, unsigned _tiles, unsigned _threads, PolygonBooleanStats* _stats)
+{
+    Frame frame;
+    frame.integer = _snapGrid > 0.0;
+    frame.grid = frame.integer ? _snapGrid : 1.0;
+
+    std::vector<Edge> edges;
+    addOperand(subject, 0, frame, edges);
+    addOperand(clip, 1, frame, edges);
+    if (edges.size() >= NONE / 2)
+        throw std::length_error("polygonBoolean supports at most 2^31 - 1 edges\n");
+
+    PolygonBooleanStats stats;
+    stats.inputEdges = edges.size();
+    const unsigned threadCount = resolveThreadCount(_threads);
+    size_t tiles = _tiles;
+    if (tiles == 0)
+        tiles = threadCount == 1 ? 1 : std::min<size_t>(4 * threadCount, edges.size() / TILE_EDGES + 1);
+
+    std::vector<Edge> result;
+    std::vector<double> lines;
+    if (tiles <= 1 || edges.size() < 2 * tiles)
+    {
+        stats.nodingPasses = nodeEdges(edges, frame, threadCount);
+        stats.nodedEdges = edges.size();
+        stats.tiles = 1;
+        labelEdges(edges, operation, result);
+    }
+    else
+    {
+        lines = stripLines(edges, tiles, frame);
+        std::vector<std::vector<Edge>> strips = cutStrips(edges, lines, frame);
+        edges = std::vector<Edge>();
+
+        // Strips are taken from a shared counter, since their cost varies with the crossings in them.
+        std::vector<std::vector<Edge>> results(strips.size());
+        std::vector<size_t> passes(strips.size(), 0), noded(strips.size(), 0);
+        std::atomic<size_t> nextStrip(0);
+        parallelChunks(0, std::min<size_t>(threadCount, strips.size()), threadCount, 1, [&](unsigned, size_t, size_t) {
+            for (size_t k = nextStrip++; k < strips.size(); k = nextStrip++)
+            {
+                passes[k] = nodeEdges(strips[k], frame, 1);
+                noded[k] = strips[k].size();
+                labelEdges(strips[k], operation, results[k]);
+                strips[k] = std::vector<Edge>();
+            }
+        });
+        stats.tiles = strips.size();
+        for (size_t k = 0; k < strips.size(); k++)
+        {
+            stats.nodingPasses = std::max(stats.nodingPasses, passes[k]);
+            stats.nodedEdges += noded[k];
+            result.insert(result.end(), results[k].begin(), results[k].end());
+        }
+        stitchStrips(result, lines);
+    }
+    stats.resultEdges = result.size();
+
+    std::vector<Polygon> polygons = assemble(result, frame, stats.rings);
+    if (_stats)
+        *_stats = stats;
+    return polygons;
+}
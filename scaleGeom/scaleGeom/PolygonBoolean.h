@@ -0,0 +1,101 @@
+/*
+	PolygonBoolean.h - Boolean Operations on Polygons with Holes
+
+	Overview:
+	polygonBoolean computes the union, intersection, difference or exclusive or of two sets of
+	polygons with holes (multipolygons), in three steps:
+
+	- Noding: the edges of both operands are split wherever they touch or cross, with the
+	  Bentley-Ottmann sweep of SegmentIntersection.h, until no two edges meet except at shared
+	  endpoints; coincident edges are merged and edges whose contributions cancel (the common
+	  border of two adjacent parcels) are dropped. Splitting at a rounded crossing can bend an
+	  edge into a new crossing, so the sweep is repeated until nothing is split; this takes
+	  two or three passes in practice.
+	- Labelling: a second sweep in the style of Martinez-Rueda keeps the noded edges, which no
+	  longer cross, in bottom-to-top order and gives each edge the winding numbers of both
+	  operands just below it from the edge below it. An edge is part of the result when the
+	  operation is inside on one side of it and outside on the other.
+	- Assembly: the result edges are linked into rings by taking the sharpest turn at every
+	  vertex; rings that touch themselves are split at the touching vertex, and every hole is
+	  given to the polygon directly below it in the sweep.
+
+	Operands:
+	Within each operand the polygons are combined by the nonzero rule: outer rings are
+	reoriented counterclockwise and holes clockwise, so overlapping polygons of one operand
+	simply overlap (polygonUnion of a set of parcels is its dissolve), whatever orientation the
+	rings were given in. Rings are open (the first point is not repeated; a repeated closing
+	point is ignored). Self-intersecting rings are accepted and resolved by the same rule.
+
+	Exactness:
+	Every decision is made with the exact predicates of Predicates.h; only new crossing points
+	are rounded. With _snapGrid > 0 the whole computation runs on the integer lattice of that
+	spacing: input coordinates and crossings are rounded to multiples of _snapGrid, so the output
+	has all its vertices on the grid and the same input gives the same output on every platform.
+	This is the mode for overlays whose inputs share borders, such as cadastral parcels.
+
+	Tiled mode:
+	With _tiles > 1 the bounds are cut into that many vertical strips holding about the same
+	number of edges, and the edges are clipped to the strips. A strip covers [x0, x1): its
+	windings are those of the whole overlay, because a sweep line at x only sees edges that
+	cross x. The strips are noded and labelled concurrently on _threads threads, and their
+	result edges are stitched along the strip lines before one final assembly. The result is the
+	same region as the untiled one, but edges that cross a strip line keep a vertex there.
+	_tiles = 0 picks one strip per 64K edges, up to four per thread, and no tiling with one thread.
+
+	Output:
+	Polygons with counterclockwise outer rings and clockwise holes, no two of which overlap.
+	Collinear vertices are removed, and rings meet only at vertices. Coordinates must be finite
+	(std::runtime_error if the edges cannot be noded, which takes pathological input without a
+	snap grid).
+
+	Usage:
+	std::vector<scaleGeom::Polygon> dissolved = scaleGeom::polygonUnion(parcels, 0.001);
+	std::vector<scaleGeom::Polygon> clipped = scaleGeom::polygonBoolean(parcels, mask, scaleGeom::BooleanOperation::Intersection);
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	typedef std::vector<Vector2d> PolygonRing;
+
+	struct Polygon
+	{
+		PolygonRing outer;
+		std::vector<PolygonRing> holes;
+	};
+
+	enum class BooleanOperation { Union, Intersection, Difference, Xor };
+
+	struct PolygonBooleanStats
+	{
+		size_t inputEdges = 0;
+
+		// Edges after noding (summed over the strips), and sweeps needed to node them (the most of any strip).
+		size_t nodedEdges = 0;
+		size_t nodingPasses = 0;
+
+		size_t tiles = 0;
+		size_t resultEdges = 0;
+		size_t rings = 0;
+	};
+
+	// subject <operation> clip.
+	std::vector<Polygon> polygonBoolean(const std::vector<Polygon>& subject, const std::vector<Polygon>& clip, BooleanOperation operation,
+		double _snapGrid = 0.0, unsigned _tiles = 0, unsigned _threads = 0, PolygonBooleanStats* _stats = nullptr);
+
+	// The union of all the polygons.
+	inline std::vector<Polygon> polygonUnion(const std::vector<Polygon>& polygons, double _snapGrid = 0.0, unsigned _tiles = 0, unsigned _threads = 0,
+		PolygonBooleanStats* _stats = nullptr)
+	{
+		return polygonBoolean(polygons, std::vector<Polygon>(), BooleanOperation::Union, _snapGrid, _tiles, _threads, _stats);
+	}
+
+} // Closing the scaleGeom namespace.
@@ -0,0 +1,129 @@
+#include "Benchmark.h"
+#include "Parallel.h"
+#include "PolygonBoolean.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    // Parcels: the cells of a jittered lattice, so neighbouring parcels share their borders exactly, with one
+    // cell in 20 left empty.
+    std::vector<scaleGeom::Polygon> makeParcels(size_t count)
+    {
+        const size_t side = std::max<size_t>(2, static_cast<size_t>(std::sqrt(static_cast<double>(count))));
+        std::mt19937 rng(23);
+        std::uniform_real_distribution<double> jitter(-0.3, 0.3);
+        std::vector<scaleGeom::Vector2d> lattice((side + 1) * (side + 1));
+        for (size_t y = 0; y <= side; y++)
+        {
+            for (size_t x = 0; x <= side; x++)
+            {
+                const bool border = x == 0 || y == 0 || x == side || y == side;
+                lattice[y * (side + 1) + x] = scaleGeom::Vector2d(x + (border ? 0.0 : jitter(rng)), y + (border ? 0.0 : jitter(rng)));
+            }
+        }
+        std::vector<scaleGeom::Polygon> parcels;
+        parcels.reserve(side * side);
+        for (size_t y = 0; y < side; y++)
+        {
+            for (size_t x = 0; x < side; x++)
+            {
+                if (rng() % 20 == 0)
+                    continue;
+                const size_t corner = y * (side + 1) + x;
+                scaleGeom::Polygon parcel;
+                parcel.outer = { lattice[corner], lattice[corner + 1], lattice[corner + side + 2], lattice[corner + side + 1] };
+                parcels.push_back(parcel);
+            }
+        }
+        return parcels;
+    }
+
+    // Zones: overlapping discs of 32 vertices, each with a hole, spread over the parcels.
+    std::vector<scaleGeom::Polygon> makeZones(size_t count, double extent)
+    {
+        std::mt19937 rng(24);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::vector<scaleGeom::Polygon> zones(count);
+        for (scaleGeom::Polygon& zone : zones)
+        {
+            const double cx = extent * uniform(rng), cy = extent * uniform(rng), radius = extent * (0.02 + 0.05 * uniform(rng));
+            scaleGeom::PolygonRing hole;
+            for (int k = 0; k < 32; k++)
+            {
+                const double angle = 6.283185307179586 * k / 32;
+                zone.outer.push_back(scaleGeom::Vector2d(cx + radius * std::cos(angle), cy + radius * std::sin(angle)));
+                hole.push_back(scaleGeom::Vector2d(cx + 0.3 * radius * std::cos(angle), cy + 0.3 * radius * std::sin(angle)));
+            }
+            zone.holes.push_back(hole);
+        }
+        return zones;
+    }
+
+    void report(const char* label, unsigned threads, double seconds, const scaleGeom::PolygonBooleanStats& stats,
+        const std::vector<scaleGeom::Polygon>& result)
+    {
+        size_t holes = 0;
+        for (const scaleGeom::Polygon& polygon : result)
+        {
+            holes += polygon.holes.size();
+        }
+        std::cout << "  " << std::left << std::setw(26) << label << std::right
+            << std::setw(4) << stats.tiles << " strips " << std::setw(3) << threads << " threads "
+            << std::setw(9) << std::fixed << std::setprecision(2) << seconds * 1e3 << " ms  "
+            << std::setw(6) << std::setprecision(2) << stats.inputEdges / seconds / 1e6 << " Medges/s  "
+            << std::setw(2) << stats.nodingPasses << " passes  "
+            << std::setw(7) << result.size() << " polygons  "
+            << std::setw(6) << holes << " holes" << std::endl;
+    }
+}
+
+SCALEGEOM_BENCHMARK(PolygonBoolean)
+{
+    const std::vector<scaleGeom::Polygon> parcels = makeParcels(scaleGeom::bench::problemSize(250000));
+    const double extent = std::sqrt(static_cast<double>(scaleGeom::bench::problemSize(250000)));
+    const std::vector<scaleGeom::Polygon> zones = makeZones(std::max<size_t>(8, parcels.size() / 500), extent);
+    const unsigned hardware = scaleGeom::resolveThreadCount(0);
+    std::cout << "  parcels: " << parcels.size() << ", zones: " << zones.size() << std::endl;
+
+    // Dissolve on one thread, untiled, then tiled on every thread count.
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware))
+    {
+        scaleGeom::PolygonBooleanStats stats;
+        Timer timer;
+        const std::vector<scaleGeom::Polygon> dissolved = scaleGeom::polygonUnion(parcels, 0.0, 0, threads, &stats);
+        report("union (dissolve)", threads, timer.seconds(), stats, dissolved);
+        if (threads == hardware)
+            break;
+    }
+    {
+        scaleGeom::PolygonBooleanStats stats;
+        Timer timer;
+        const std::vector<scaleGeom::Polygon> dissolved = scaleGeom::polygonUnion(parcels, 1e-6, 0, hardware, &stats);
+        report("union, snap 1e-6", hardware, timer.seconds(), stats, dissolved);
+    }
+    {
+        scaleGeom::PolygonBooleanStats stats;
+        Timer timer;
+        const std::vector<scaleGeom::Polygon> dissolved = scaleGeom::polygonUnion(parcels, 0.0, 4 * hardware, hardware, &stats);
+        report("union, 4 strips per thread", hardware, timer.seconds(), stats, dissolved);
+    }
+
+    // Overlay: parcels inside the zones, and outside them.
+    const scaleGeom::BooleanOperation operations[] = { scaleGeom::BooleanOperation::Intersection, scaleGeom::BooleanOperation::Difference };
+    const char* labels[] = { "parcels AND zones", "parcels NOT zones" };
+    for (int k = 0; k < 2; k++)
+    {
+        scaleGeom::PolygonBooleanStats stats;
+        Timer timer;
+        const std::vector<scaleGeom::Polygon> overlay = scaleGeom::polygonBoolean(parcels, zones, operations[k], 0.0, 0, hardware, &stats);
+        report(labels[k], hardware, timer.seconds(), stats, overlay);
+    }
+}
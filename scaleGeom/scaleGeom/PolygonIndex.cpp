@@ -0,0 +1,606 @@
+#include "PolygonIndex.h"
+#include "CpuFeatures.h"
+#include "Parallel.h"
+#include "Predicates.h"
+#include "VectorOrder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(SCALEGEOM_X86)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// The float filter's error bound assumes every product and difference is rounded on its own.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize ("fp-contract=off")
+#elif defined(_MSC_VER)
+#pragma fp_contract (off)
+#endif
+
+namespace {
+
+    const uint32_t NONE = scaleGeom::PolygonIndex::NONE;
+
+    // The grid aims at this many edge references per cell, with at most MAX_CELLS cells.
+    const double REFERENCES_PER_CELL = 4.0;
+    const double MAX_CELLS = 1 << 24;
+
+    // Cells are at least this many float ulps of the largest coordinate wide, so that the rounded borders
+    // increase strictly and every centre lies strictly inside its cell.
+    const double MIN_CELL_ULPS = 16.0;
+
+    // Chunks smaller than this are not worth a thread of their own.
+    const size_t MIN_CHUNK = 1 << 12;
+
+    // Forward error bound of a float orientation (p - r) x (q - r): Shewchuk's ccwerrboundA for 24-bit
+    // mantissas, rounded up, plus an absolute term that covers products in the subnormal range.
+    const float FILTER_BOUND = 1.8e-7f;
+    const float FILTER_FLOOR = 1e-37f;
+
+    typedef scaleGeom::Vector2f Point;
+
+    // Centre of [lo, hi]: computed the same way at build and query time.
+    inline float centre(float lo, float hi)
+    {
+        return static_cast<float>((static_cast<double>(lo) + hi) / 2);
+    }
+
+    // The query points are moved by (e^2, e) for an infinitesimal e, which puts them in general position: no
+    // orientation involving one of them is zero.
+
+    // Side of the line through a and b that p + (e^2, e) lies on: +1 left, -1 right.
+    inline int edgeSide(const Point& a, const Point& b, const Point& p)
+    {
+        const double side = scaleGeom::orient2d(a, b, p);
+        if (side != 0)
+            return side > 0 ? 1 : -1;
+        if (b[0] != a[0])
+            return b[0] > a[0] ? 1 : -1;
+        return a[1] > b[1] ? 1 : -1;
+    }
+
+    // Side of the line through c + (e^2, e) and q + (e^2, e) that v lies on; c != q.
+    inline int segmentSide(const Point& c, const Point& q, const Point& v)
+    {
+        const double side = scaleGeom::orient2d(c, q, v);
+        if (side != 0)
+            return side > 0 ? 1 : -1;
+        if (q[0] != c[0])
+            return c[0] > q[0] ? 1 : -1;
+        return q[1] > c[1] ? 1 : -1;
+    }
+
+    // The moved segment from c to q crosses the edge ab; centerSide is edgeSide(a, b, c).
+    inline bool crosses(const Point& c, const Point& q, const Point& a, const Point& b, int centerSide)
+    {
+        if (c[0] == q[0] && c[1] == q[1])
+            return false;
+        return segmentSide(c, q, a) != segmentSide(c, q, b) && edgeSide(a, b, q) != centerSide;
+    }
+
+    // Sign of the orientation of p, q, r evaluated in float, or 0 if the error bound cannot tell.
+    inline int filteredSide(const Point& p, const Point& q, const Point& r)
+    {
+        const Point u(p[0] - r[0], p[1] - r[1]), w(q[0] - r[0], q[1] - r[1]);
+        const float det = scaleGeom::crossProduct2D(u, w);
+        const float bound = FILTER_BOUND * (std::fabs(u[0] * w[1]) + std::fabs(u[1] * w[0])) + FILTER_FLOOR;
+        return det > bound ? 1 : det < -bound ? -1 : 0;
+    }
+
+    // The edges of one cell in the SoA arrays of the index.
+    struct CellEdges
+    {
+        const float* ax;
+        const float* ay;
+        const float* bx;
+        const float* by;
+        const float* side;
+        const uint32_t* slot;
+        size_t begin, end;
+
+        Point a(size_t i) const { return Point(ax[i], ay[i]); }
+        Point b(size_t i) const { return Point(bx[i], by[i]); }
+    };
+
+    // Index of the lowest set bit; bits != 0.
+    inline unsigned lowestBit(uint64_t bits)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctzll(bits));
+#endif
+    }
+
+    inline void toggle(uint64_t* parity, uint32_t slot)
+    {
+        parity[slot >> 6] ^= 1ull << (slot & 63);
+    }
+
+    inline bool crossesExactly(const CellEdges& edges, size_t i, const Point& c, const Point& q)
+    {
+        return crosses(c, q, edges.a(i), edges.b(i), edges.side[i] > 0 ? 1 : -1);
+    }
+
+    // Toggle the slots of the edges that cross the segment from c to q, from edge begin on.
+    void toggleScalar(const CellEdges& edges, size_t begin, const Point& c, const Point& q, uint64_t* parity)
+    {
+        for (size_t i = begin; i < edges.end; i++)
+        {
+            const Point a = edges.a(i), b = edges.b(i);
+            const int sideA = filteredSide(c, q, a), sideB = filteredSide(c, q, b), sideQ = filteredSide(a, b, q);
+            bool crossing;
+            if (sideA && sideB && sideQ)
+                crossing = sideA != sideB && sideQ != (edges.side[i] > 0 ? 1 : -1);
+            else
+                crossing = crossesExactly(edges, i, c, q);
+            if (crossing)
+                toggle(parity, edges.slot[i]);
+        }
+    }
+
+    // Lanes the filter decided to be crossings, and lanes it could not decide.
+    inline void resolveLanes(const CellEdges& edges, size_t i, unsigned crossing, unsigned unsure, const Point& c, const Point& q, uint64_t* parity)
+    {
+        for (; crossing; crossing &= crossing - 1)
+        {
+            toggle(parity, edges.slot[i + lowestBit(crossing)]);
+        }
+        for (; unsure; unsure &= unsure - 1)
+        {
+            const size_t lane = i + lowestBit(unsure);
+            if (crossesExactly(edges, lane, c, q))
+                toggle(parity, edges.slot[lane]);
+        }
+    }
+
+#if defined(SCALEGEOM_X86)
+
+    // The SIMD kernels evaluate, per edge ab, the orientations of c, q, a and c, q, b and a, b, q in the form
+    // (p - r) x (q - r) of filteredSide, with the same bound.
+
+    SCALEGEOM_TARGET_SSE41 void toggleSse(const CellEdges& edges, const Point& c, const Point& q, uint64_t* parity)
+    {
+        const __m128 cx = _mm_set1_ps(c[0]), cy = _mm_set1_ps(c[1]), qx = _mm_set1_ps(q[0]), qy = _mm_set1_ps(q[1]);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)), error = _mm_set1_ps(FILTER_BOUND), floor = _mm_set1_ps(FILTER_FLOOR);
+        const __m128 zero = _mm_setzero_ps();
+        auto orient = [&](__m128 px, __m128 py, __m128 qx, __m128 qy, __m128 rx, __m128 ry, __m128& certain) {
+            const __m128 left = _mm_mul_ps(_mm_sub_ps(px, rx), _mm_sub_ps(qy, ry)), right = _mm_mul_ps(_mm_sub_ps(py, ry), _mm_sub_ps(qx, rx));
+            const __m128 det = _mm_sub_ps(left, right);
+            const __m128 bound = _mm_add_ps(_mm_mul_ps(error, _mm_add_ps(_mm_and_ps(left, absMask), _mm_and_ps(right, absMask))), floor);
+            certain = _mm_and_ps(certain, _mm_cmpgt_ps(_mm_and_ps(det, absMask), bound));
+            return _mm_cmpgt_ps(det, zero);
+        };
+        size_t i = edges.begin;
+        for (; i + 4 <= edges.end; i += 4)
+        {
+            const __m128 ax = _mm_loadu_ps(edges.ax + i), ay = _mm_loadu_ps(edges.ay + i), bx = _mm_loadu_ps(edges.bx + i), by = _mm_loadu_ps(edges.by + i);
+            __m128 certain = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            const __m128 sideA = orient(cx, cy, qx, qy, ax, ay, certain), sideB = orient(cx, cy, qx, qy, bx, by, certain);
+            const __m128 sideQ = orient(ax, ay, bx, by, qx, qy, certain);
+            const __m128 apart = _mm_xor_ps(sideQ, _mm_cmpgt_ps(_mm_loadu_ps(edges.side + i), zero));
+            const __m128 crossing = _mm_and_ps(_mm_and_ps(_mm_xor_ps(sideA, sideB), apart), certain);
+            const unsigned decided = static_cast<unsigned>(_mm_movemask_ps(certain));
+            resolveLanes(edges, i, static_cast<unsigned>(_mm_movemask_ps(crossing)), decided ^ 0xfu, c, q, parity);
+        }
+        toggleScalar(edges, i, c, q, parity);
+    }
+
+    SCALEGEOM_TARGET_AVX2 void toggleAvx2(const CellEdges& edges, const Point& c, const Point& q, uint64_t* parity)
+    {
+        const __m256 cx = _mm256_set1_ps(c[0]), cy = _mm256_set1_ps(c[1]), qx = _mm256_set1_ps(q[0]), qy = _mm256_set1_ps(q[1]);
+        const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)), error = _mm256_set1_ps(FILTER_BOUND), floor = _mm256_set1_ps(FILTER_FLOOR);
+        const __m256 zero = _mm256_setzero_ps();
+        auto orient = [&](__m256 px, __m256 py, __m256 qx, __m256 qy, __m256 rx, __m256 ry, __m256& certain) {
+            const __m256 left = _mm256_mul_ps(_mm256_sub_ps(px, rx), _mm256_sub_ps(qy, ry)), right = _mm256_mul_ps(_mm256_sub_ps(py, ry), _mm256_sub_ps(qx, rx));
+            const __m256 det = _mm256_sub_ps(left, right);
+            const __m256 bound = _mm256_add_ps(_mm256_mul_ps(error, _mm256_add_ps(_mm256_and_ps(left, absMask), _mm256_and_ps(right, absMask))), floor);
+            certain = _mm256_and_ps(certain, _mm256_cmp_ps(_mm256_and_ps(det, absMask), bound, _CMP_GT_OQ));
+            return _mm256_cmp_ps(det, zero, _CMP_GT_OQ);
+        };
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        for (size_t i = edges.begin; i < edges.end; i += 8)
+        {
+            // The last group loads only the edges that are left.
+            const __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(std::min<size_t>(edges.end - i, 8))), lanes);
+            const __m256 ax = _mm256_maskload_ps(edges.ax + i, valid), ay = _mm256_maskload_ps(edges.ay + i, valid);
+            const __m256 bx = _mm256_maskload_ps(edges.bx + i, valid), by = _mm256_maskload_ps(edges.by + i, valid);
+            __m256 certain = _mm256_castsi256_ps(valid);
+            const __m256 sideA = orient(cx, cy, qx, qy, ax, ay, certain), sideB = orient(cx, cy, qx, qy, bx, by, certain);
+            const __m256 sideQ = orient(ax, ay, bx, by, qx, qy, certain);
+            const __m256 apart = _mm256_xor_ps(sideQ, _mm256_cmp_ps(_mm256_maskload_ps(edges.side + i, valid), zero, _CMP_GT_OQ));
+            const __m256 crossing = _mm256_and_ps(_mm256_and_ps(_mm256_xor_ps(sideA, sideB), apart), certain);
+            const unsigned decided = static_cast<unsigned>(_mm256_movemask_ps(certain));
+            resolveLanes(edges, i, static_cast<unsigned>(_mm256_movemask_ps(crossing)), decided ^ static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(valid))), c, q, parity);
+        }
+    }
+
+    SCALEGEOM_TARGET_AVX512 void toggleAvx512(const CellEdges& edges, const Point& c, const Point& q, uint64_t* parity)
+    {
+        const __m512 cx = _mm512_set1_ps(c[0]), cy = _mm512_set1_ps(c[1]), qx = _mm512_set1_ps(q[0]), qy = _mm512_set1_ps(q[1]);
+        const __m512 error = _mm512_set1_ps(FILTER_BOUND), floor = _mm512_set1_ps(FILTER_FLOOR), zero = _mm512_setzero_ps();
+        auto orient = [&](__m512 px, __m512 py, __m512 qx, __m512 qy, __m512 rx, __m512 ry, __mmask16& certain) {
+            const __m512 left = _mm512_mul_ps(_mm512_sub_ps(px, rx), _mm512_sub_ps(qy, ry)), right = _mm512_mul_ps(_mm512_sub_ps(py, ry), _mm512_sub_ps(qx, rx));
+            const __m512 det = _mm512_sub_ps(left, right);
+            const __m512 bound = _mm512_add_ps(_mm512_mul_ps(error, _mm512_add_ps(_mm512_abs_ps(left), _mm512_abs_ps(right))), floor);
+            certain &= _mm512_cmp_ps_mask(_mm512_abs_ps(det), bound, _CMP_GT_OQ);
+            return _mm512_cmp_ps_mask(det, zero, _CMP_GT_OQ);
+        };
+        for (size_t i = edges.begin; i < edges.end; i += 16)
+        {
+            // The last group loads only the edges that are left.
+            const __mmask16 valid = edges.end - i >= 16 ? 0xffff : static_cast<__mmask16>((1u << (edges.end - i)) - 1);
+            const __m512 ax = _mm512_maskz_loadu_ps(valid, edges.ax + i), ay = _mm512_maskz_loadu_ps(valid, edges.ay + i);
+            const __m512 bx = _mm512_maskz_loadu_ps(valid, edges.bx + i), by = _mm512_maskz_loadu_ps(valid, edges.by + i);
+            __mmask16 certain = valid;
+            const __mmask16 sideA = orient(cx, cy, qx, qy, ax, ay, certain), sideB = orient(cx, cy, qx, qy, bx, by, certain);
+            const __mmask16 sideQ = orient(ax, ay, bx, by, qx, qy, certain);
+            const __mmask16 apart = sideQ ^ _mm512_cmp_ps_mask(_mm512_maskz_loadu_ps(valid, edges.side + i), zero, _CMP_GT_OQ);
+            resolveLanes(edges, i, (sideA ^ sideB) & apart & certain, certain ^ valid, c, q, parity);
+        }
+    }
+
+#endif // SCALEGEOM_X86
+
+    void toggleCrossings(const CellEdges& edges, const Point& c, const Point& q, uint64_t* parity)
+    {
+        switch (scaleGeom::activeSimdLevel())
+        {
+#if defined(SCALEGEOM_X86)
+        case scaleGeom::SimdLevel::AVX512: toggleAvx512(edges, c, q, parity); return;
+        case scaleGeom::SimdLevel::AVX2: toggleAvx2(edges, c, q, parity); return;
+        case scaleGeom::SimdLevel::SSE41: toggleSse(edges, c, q, parity); return;
+#endif
+        default: toggleScalar(edges, edges.begin, c, q, parity); return;
+        }
+    }
+
+    // Polygons containing the current point of a walk, with constant time toggling.
+    struct OddSet
+    {
+        std::vector<uint32_t> members, position;
+
+        explicit OddSet(size_t polygons) : position(polygons, NONE) {}
+
+        void toggle(uint32_t polygon)
+        {
+            if (position[polygon] == NONE)
+            {
+                position[polygon] = static_cast<uint32_t>(members.size());
+                members.push_back(polygon);
+                return;
+            }
+            const uint32_t last = members.back();
+            members[position[polygon]] = last;
+            position[last] = position[polygon];
+            members.pop_back();
+            position[polygon] = NONE;
+        }
+
+        bool contains(uint32_t polygon) const { return position[polygon] != NONE; }
+    };
+}
+
+scaleGeom::PolygonIndex::PolygonIndex(const Vector2f* vertices, const uint32_t* ringStarts, const uint32_t* ringPolygons, size_t ringCount, unsigned _threads)
+{
+    if (ringCount >= NONE)
+        throw std::length_error("PolygonIndex supports at most 2^32 - 1 rings\n");
+    const unsigned threads = resolveThreadCount(_threads);
+
+    // Polygon IDs, renumbered densely in increasing order.
+    std::vector<uint32_t> ids(ringPolygons, ringPolygons + ringCount);
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    if (!ids.empty() && ids.back() == NONE)
+        throw std::invalid_argument("PolygonIndex: polygon IDs must be below 2^32 - 1\n");
+
+    // Edges of all rings, without zero-length ones, and the bounds.
+    std::vector<uint32_t> edgeFrom, edgeTo, edgePolygon;
+    float minX = std::numeric_limits<float>::infinity(), minY = minX, maxX = -minX, maxY = -minX;
+    for (size_t r = 0; r < ringCount; r++)
+    {
+        const uint32_t begin = ringStarts[r], end = ringStarts[r + 1];
+        const uint32_t polygon = static_cast<uint32_t>(std::lower_bound(ids.begin(), ids.end(), ringPolygons[r]) - ids.begin());
+        for (uint32_t v = begin; v < end; v++)
+        {
+            const uint32_t w = v + 1 < end ? v + 1 : begin;
+            minX = std::min(minX, vertices[v][0]);
+            minY = std::min(minY, vertices[v][1]);
+            maxX = std::max(maxX, vertices[v][0]);
+            maxY = std::max(maxY, vertices[v][1]);
+            if (vertices[v][0] == vertices[w][0] && vertices[v][1] == vertices[w][1])
+                continue;
+            edgeFrom.push_back(v);
+            edgeTo.push_back(w);
+            edgePolygon.push_back(polygon);
+        }
+    }
+    const size_t edgeCount = edgeFrom.size();
+    if (edgeCount >= NONE)
+        throw std::length_error("PolygonIndex supports at most 2^32 - 1 edges\n");
+    statistics.polygons = ids.size();
+    statistics.edges = edgeCount;
+    if (edgeCount == 0)
+        return;
+
+    // Square cells with half a cell of padding around the bounds, so the left border of the grid lies outside
+    // every polygon.
+    const double width = static_cast<double>(maxX) - minX, height = static_cast<double>(maxY) - minY;
+    const double largest = std::max(std::max(std::fabs(minX), std::fabs(maxX)), std::max(std::fabs(minY), std::fabs(maxY)));
+    const double targetCells = std::max(1.0, static_cast<double>(edgeCount) / REFERENCES_PER_CELL);
+    double cellSize = width * height > 0 ? std::sqrt(width * height / targetCells) : std::max(width, height) / targetCells;
+    cellSize = std::max(cellSize, std::max(MIN_CELL_ULPS * std::ldexp(largest, -23), static_cast<double>(std::numeric_limits<float>::min())));
+    while ((width / cellSize + 2) * (height / cellSize + 2) > MAX_CELLS)
+        cellSize *= 1.25;
+    const size_t cols = static_cast<size_t>(width / cellSize) + 2, rows = static_cast<size_t>(height / cellSize) + 2;
+    originX = minX - cellSize / 2;
+    originY = minY - cellSize / 2;
+    inverseCell = 1.0 / cellSize;
+    borderX.resize(cols + 1);
+    borderY.resize(rows + 1);
+    for (size_t i = 0; i <= cols; i++)
+    {
+        borderX[i] = static_cast<float>(originX + i * cellSize);
+    }
+    for (size_t j = 0; j <= rows; j++)
+    {
+        borderY[j] = static_cast<float>(originY + j * cellSize);
+    }
+    const size_t cellCount = cols * rows;
+    statistics.cellSize = cellSize;
+    statistics.cells = cellCount;
+
+    // Cells the edge from a to b passes through: row by row, the columns its part in the row spans. The span is
+    // widened by far more than the rounding error of the interpolation, so no cell the edge touches is missed.
+    auto forEachCell = [&](const Point& a, const Point& b, auto&& visit) {
+        const float lowY = std::min(a[1], b[1]), highY = std::max(a[1], b[1]);
+        const float lowX = std::min(a[0], b[0]), highX = std::max(a[0], b[0]);
+        const size_t firstRow = std::lower_bound(borderY.begin() + 1, borderY.end(), lowY) - (borderY.begin() + 1);
+        const size_t lastRow = std::upper_bound(borderY.begin(), borderY.end() - 1, highY) - borderY.begin() - 1;
+        for (size_t j = firstRow; j <= lastRow; j++)
+        {
+            double x0 = lowX, x1 = highX;
+            if (a[1] != b[1])
+            {
+                const double slope = (static_cast<double>(b[0]) - a[0]) / (static_cast<double>(b[1]) - a[1]);
+                const double xa = a[0] + (std::max<double>(lowY, borderY[j]) - a[1]) * slope;
+                const double xb = a[0] + (std::min<double>(highY, borderY[j + 1]) - a[1]) * slope;
+                const double slack = 1e-12 * (std::fabs(xa) + std::fabs(xb) + highX - lowX);
+                x0 = std::max<double>(lowX, std::min(xa, xb) - slack);
+                x1 = std::min<double>(highX, std::max(xa, xb) + slack);
+            }
+            const size_t firstCol = std::lower_bound(borderX.begin() + 1, borderX.end(), x0) - (borderX.begin() + 1);
+            const size_t lastCol = std::upper_bound(borderX.begin(), borderX.end() - 1, x1) - borderX.begin() - 1;
+            for (size_t i = firstCol; i <= lastCol; i++)
+            {
+                visit(j * cols + i);
+            }
+        }
+    };
+
+    // References from the cells to the edges, sorted by cell (stably, so by edge within a cell).
+    std::vector<size_t> offsets(edgeCount + 1, 0);
+    parallelFor(0, edgeCount, threads, MIN_CHUNK, [&](size_t e) {
+        size_t cells = 0;
+        forEachCell(vertices[edgeFrom[e]], vertices[edgeTo[e]], [&](size_t) { cells++; });
+        offsets[e + 1] = cells;
+    });
+    for (size_t e = 0; e < edgeCount; e++)
+    {
+        offsets[e + 1] += offsets[e];
+    }
+    const size_t references = offsets[edgeCount];
+    if (references >= NONE)
+        throw std::length_error("PolygonIndex: more than 2^32 - 1 edge references\n");
+    std::vector<uint64_t> keys(references);
+    std::vector<uint32_t> values(references);
+    parallelFor(0, edgeCount, threads, MIN_CHUNK, [&](size_t e) {
+        size_t r = offsets[e];
+        forEachCell(vertices[edgeFrom[e]], vertices[edgeTo[e]], [&](size_t cell) {
+            keys[r] = cell;
+            values[r++] = static_cast<uint32_t>(e);
+        });
+    });
+    unsigned keyBits = 1;
+    while (keyBits < 64 && (cellCount - 1) >> keyBits)
+        keyBits++;
+    radixSort(keys.data(), values.data(), references, keyBits, threads);
+    statistics.references = references;
+
+    edgeStart.assign(cellCount + 1, 0);
+    for (size_t r = 0; r < references; r++)
+    {
+        edgeStart[keys[r] + 1]++;
+    }
+    for (size_t c = 0; c < cellCount; c++)
+    {
+        edgeStart[c + 1] += edgeStart[c];
+    }
+    ax.resize(references);
+    ay.resize(references);
+    bx.resize(references);
+    by.resize(references);
+    centerSide.resize(references);
+    edgeSlot.resize(references);
+    parallelFor(0, references, threads, MIN_CHUNK, [&](size_t r) {
+        const Point& a = vertices[edgeFrom[values[r]]];
+        const Point& b = vertices[edgeTo[values[r]]];
+        ax[r] = a[0];
+        ay[r] = a[1];
+        bx[r] = b[0];
+        by[r] = b[1];
+    });
+
+    // Walk every row along its centres, from the left border of the grid, which is outside every polygon: a
+    // polygon contains a centre when the walk has crossed its edges an odd number of times. Each step stays in
+    // one cell (border to centre, centre to the next border), so only that cell's edges can be crossed.
+    std::vector<uint32_t> slotCount(cellCount), wordCount(cellCount);
+    std::vector<std::vector<uint32_t>> rowSlots(rows);
+    std::vector<std::vector<uint64_t>> rowWords(rows);
+    parallelChunks(0, rows, threads, 1, [&](unsigned, size_t rowBegin, size_t rowEnd) {
+        OddSet odd(ids.size());
+        std::vector<uint32_t> present;
+        for (size_t j = rowBegin; j < rowEnd; j++)
+        {
+            const float y = centre(borderY[j], borderY[j + 1]);
+            for (size_t i = 0; i < cols; i++)
+            {
+                const size_t cell = j * cols + i;
+                const Point left(borderX[i], y), c(centre(borderX[i], borderX[i + 1]), y), right(borderX[i + 1], y);
+                for (size_t r = edgeStart[cell]; r < edgeStart[cell + 1]; r++)
+                {
+                    const Point a(ax[r], ay[r]), b(bx[r], by[r]);
+                    if (crosses(left, c, a, b, edgeSide(a, b, left)))
+                        odd.toggle(edgePolygon[values[r]]);
+                }
+
+                // The cell's slots: the polygons containing the centre and those with edges in the cell.
+                present.assign(odd.members.begin(), odd.members.end());
+                for (size_t r = edgeStart[cell]; r < edgeStart[cell + 1]; r++)
+                {
+                    present.push_back(edgePolygon[values[r]]);
+                }
+                std::sort(present.begin(), present.end());
+                present.erase(std::unique(present.begin(), present.end()), present.end());
+                const size_t words = (present.size() + 63) / 64;
+                slotCount[cell] = static_cast<uint32_t>(present.size());
+                wordCount[cell] = static_cast<uint32_t>(words);
+                rowWords[j].resize(rowWords[j].size() + words, 0);
+                uint64_t* inside = rowWords[j].data() + rowWords[j].size() - words;
+                for (size_t k = 0; k < present.size(); k++)
+                {
+                    rowSlots[j].push_back(ids[present[k]]);
+                    if (odd.contains(present[k]))
+                        inside[k >> 6] |= 1ull << (k & 63);
+                }
+
+                for (size_t r = edgeStart[cell]; r < edgeStart[cell + 1]; r++)
+                {
+                    const Point a(ax[r], ay[r]), b(bx[r], by[r]);
+                    edgeSlot[r] = static_cast<uint32_t>(std::lower_bound(present.begin(), present.end(), edgePolygon[values[r]]) - present.begin());
+                    centerSide[r] = static_cast<float>(edgeSide(a, b, c));
+                    if (crosses(c, right, a, b, centerSide[r] > 0 ? 1 : -1))
+                        odd.toggle(edgePolygon[values[r]]);
+                }
+            }
+        }
+    });
+
+    slotStart.assign(cellCount + 1, 0);
+    wordStart.assign(cellCount + 1, 0);
+    for (size_t c = 0; c < cellCount; c++)
+    {
+        slotStart[c + 1] = slotStart[c] + slotCount[c];
+        wordStart[c + 1] = wordStart[c] + wordCount[c];
+        maxWords = std::max<size_t>(maxWords, wordCount[c]);
+    }
+    slotPolygon.resize(slotStart[cellCount]);
+    insideWords.resize(wordStart[cellCount]);
+    parallelFor(0, rows, threads, 1, [&](size_t j) {
+        std::copy(rowSlots[j].begin(), rowSlots[j].end(), slotPolygon.begin() + slotStart[j * cols]);
+        std::copy(rowWords[j].begin(), rowWords[j].end(), insideWords.begin() + wordStart[j * cols]);
+    });
+    statistics.slots = slotPolygon.size();
+}
+
+uint32_t scaleGeom::PolygonIndex::cellOf(float x, float y) const
+{
+    if (borderX.empty() || !(x >= borderX.front() && x <= borderX.back() && y >= borderY.front() && y <= borderY.back()))
+        return NONE;
+    const size_t cols = borderX.size() - 1, rows = borderY.size() - 1;
+    size_t i = std::min(cols - 1, static_cast<size_t>((x - originX) * inverseCell));
+    size_t j = std::min(rows - 1, static_cast<size_t>((y - originY) * inverseCell));
+    while (i > 0 && x < borderX[i])
+        i--;
+    while (i + 1 < cols && x > borderX[i + 1])
+        i++;
+    while (j > 0 && y < borderY[j])
+        j--;
+    while (j + 1 < rows && y > borderY[j + 1])
+        j++;
+    return static_cast<uint32_t>(j * cols + i);
+}
+
+uint32_t scaleGeom::PolygonIndex::query(float x, float y, uint64_t* parity) const
+{
+    const uint32_t cell = cellOf(x, y);
+    if (cell == NONE || slotStart[cell] == slotStart[cell + 1])
+        return NONE;
+    std::copy(insideWords.begin() + wordStart[cell], insideWords.begin() + wordStart[cell + 1], parity);
+    if (edgeStart[cell] == edgeStart[cell + 1])
+        return cell;
+
+    const size_t cols = borderX.size() - 1, i = cell % cols, j = cell / cols;
+    const Point c(centre(borderX[i], borderX[i + 1]), centre(borderY[j], borderY[j + 1])), q(x, y);
+    const CellEdges edges = { ax.data(), ay.data(), bx.data(), by.data(), centerSide.data(), edgeSlot.data(), edgeStart[cell], edgeStart[cell + 1] };
+    toggleCrossings(edges, c, q, parity);
+    return cell;
+}
+
+uint32_t scaleGeom::PolygonIndex::locate(const Vector2f& point) const
+{
+    uint64_t local[16];
+    std::vector<uint64_t> heap(maxWords > 16 ? maxWords : 0);
+    uint64_t* parity = maxWords > 16 ? heap.data() : local;
+    const uint32_t cell = query(point[0], point[1], parity);
+    if (cell == NONE)
+        return NONE;
+    for (uint32_t w = 0; w < wordStart[cell + 1] - wordStart[cell]; w++)
+    {
+        if (parity[w])
+            return slotPolygon[slotStart[cell] + 64 * w + lowestBit(parity[w])];
+    }
+    return NONE;
+}
+
+void scaleGeom::PolygonIndex::locate(ConstPointCloudView<float, DIM2> points, uint32_t* out, unsigned _threads) const
+{
+    parallelChunks(0, points.count, _threads, MIN_CHUNK, [&](unsigned, size_t begin, size_t end) {
+        std::vector<uint64_t> parity(std::max<size_t>(1, maxWords));
+        for (size_t p = begin; p < end; p++)
+        {
+            out[p] = NONE;
+            const uint32_t cell = query(points.axes[0][p], points.axes[1][p], parity.data());
+            if (cell == NONE)
+                continue;
+            for (uint32_t w = 0; w < wordStart[cell + 1] - wordStart[cell]; w++)
+            {
+                if (parity[w])
+                {
+                    out[p] = slotPolygon[slotStart[cell] + 64 * w + lowestBit(parity[w])];
+                    break;
+                }
+            }
+        }
+    });
+}
+
+void scaleGeom::PolygonIndex::forEachContaining(ConstPointCloudView<float, DIM2> points, const PolygonHitCallback& fn, unsigned _threads) const
+{
+    parallelChunks(0, points.count, _threads, MIN_CHUNK, [&](unsigned, size_t begin, size_t end) {
+        std::vector<uint64_t> parity(std::max<size_t>(1, maxWords));
+        for (size_t p = begin; p < end; p++)
+        {
+            const uint32_t cell = query(points.axes[0][p], points.axes[1][p], parity.data());
+            if (cell == NONE)
+                continue;
+            for (uint32_t w = 0; w < wordStart[cell + 1] - wordStart[cell]; w++)
+            {
+                for (uint64_t bits = parity[w]; bits; bits &= bits - 1)
+                {
+                    fn(p, slotPolygon[slotStart[cell] + 64 * w + lowestBit(bits)]);
+                }
+            }
+        }
+    });
+}
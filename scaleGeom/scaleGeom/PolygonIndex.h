@@ -0,0 +1,123 @@
+/*
+	PolygonIndex.h - Batch Point-in-Polygon Queries
+
+	Overview:
+	PolygonIndex preprocesses a fixed set of Vector2f polygons into an edge grid and then answers
+	containment queries for batches of points: which polygons contain each point. It is built for
+	geofencing workloads, where billions of points are tested against the same fences.
+
+	- Grid: a uniform grid over the padded bounds of the polygons, about four edge references per
+	  cell. Every edge is listed in each cell its segment passes through. The cell borders are
+	  floats, so a cell is an exact box, and its centre is a float point strictly inside it.
+	- Cell state: for every cell, the polygons that contain its centre, found at build time by
+	  walking each row of centres from a point left of all the polygons and counting edge
+	  crossings. Cells store their polygons as a list of slots sorted by ID, together with the
+	  inside bit of each slot.
+	- Query: a point in a cell is inside a polygon when the segment from the cell centre to the
+	  point crosses the polygon's edges an odd number of times, if the centre is outside, or an
+	  even number of times if it is inside. Only the cell's own edges can cross that segment.
+
+	Crossing test:
+	Each crossing is decided by four orientations: the two endpoints of the edge against the
+	segment, and the centre and the point against the edge. The one of the centre is stored with
+	the edge. The others are evaluated for 4, 8 or 16 edges at once (SSE4.1, AVX2 or AVX-512,
+	see CpuFeatures.h) as crossProduct2D of float differences, with a forward error bound. The
+	bound decides almost every lane; the rest go to the exact orient2d of Predicates.h. The results
+	are the same on every SIMD level.
+
+	Rings and boundaries:
+	A polygon is the even-odd combination of its rings, so holes are simply further rings with
+	the same ID, and the orientation of the rings does not matter. A point exactly on an edge or
+	vertex is treated as if it were moved up by an infinitesimal amount, and to the right by an
+	even smaller one. So a point on the common edge of two adjacent polygons is in exactly one of
+	them, and a tiling of the plane gives every point exactly one polygon.
+
+	Queries run in parallel over the points and report, per point, the lowest ID of the polygons
+	containing it (locate) or every one of them (forEachContaining). The index is read-only after
+	construction. Coordinates must be finite. IDs must be below 2^32 - 1 (std::invalid_argument
+	otherwise), and vertex, ring and edge reference counts below 2^32 (std::length_error).
+
+	Usage:
+	scaleGeom::PolygonIndex fences(vertices.data(), ringStarts.data(), ringPolygons.data(), ringPolygons.size());
+	std::vector<uint32_t> ids(points.size());
+	fences.locate(points.view(), ids.data());
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "PointCloud.h"
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	typedef std::function<void(size_t point, uint32_t polygon)> PolygonHitCallback;
+
+	struct PolygonIndexStats
+	{
+		size_t polygons = 0;
+		size_t edges = 0;
+
+		double cellSize = 0.0;
+		size_t cells = 0;
+
+		// Edge references from the cells, and polygon slots of the cells.
+		size_t references = 0;
+		size_t slots = 0;
+	};
+
+	class PolygonIndex
+	{
+	public:
+
+		static constexpr uint32_t NONE = 0xffffffffu;
+
+		// Ring r is vertices[ringStarts[r], ringStarts[r + 1]) (ringStarts has ringCount + 1 entries) and belongs
+		// to the polygon ringPolygons[r]. _threads = 0 uses every hardware thread for the build.
+		PolygonIndex(const Vector2f* vertices, const uint32_t* ringStarts, const uint32_t* ringPolygons, size_t ringCount, unsigned _threads = 0);
+
+		// Lowest ID of the polygons containing point, or NONE.
+		uint32_t locate(const Vector2f& point) const;
+
+		// out[i] = locate(points[i]) for every point.
+		void locate(ConstPointCloudView<float, DIM2> points, uint32_t* out, unsigned _threads = 0) const;
+
+		// fn(i, polygon) for every point i and every polygon containing it, in increasing polygon order per point.
+		// The callback is called concurrently from several threads unless _threads is 1.
+		void forEachContaining(ConstPointCloudView<float, DIM2> points, const PolygonHitCallback& fn, unsigned _threads = 0) const;
+
+		const PolygonIndexStats& stats() const { return statistics; }
+
+	private:
+
+		// Cell borders: column i spans [borderX[i], borderX[i + 1]], row j [borderY[j], borderY[j + 1]].
+		std::vector<float> borderX, borderY;
+		double originX = 0.0, originY = 0.0, inverseCell = 0.0;
+
+		// Edges of cell c: [edgeStart[c], edgeStart[c + 1]) in the SoA arrays below. centerSide is +1 or -1,
+		// the side of the cell centre of the edge; slot indexes the cell's slots.
+		std::vector<uint32_t> edgeStart;
+		std::vector<float> ax, ay, bx, by, centerSide;
+		std::vector<uint32_t> edgeSlot;
+
+		// Slots of cell c: [slotStart[c], slotStart[c + 1]) in slotPolygon, sorted by ID, and their inside bits
+		// from wordStart[c], one bit per slot.
+		std::vector<uint32_t> slotStart, slotPolygon, wordStart;
+		std::vector<uint64_t> insideWords;
+		size_t maxWords = 0;
+
+		PolygonIndexStats statistics;
+
+		// Cell of (x, y), or NONE outside the grid.
+		uint32_t cellOf(float x, float y) const;
+
+		// Leave in parity the inside bits of the slots of the cell of (x, y). Returns the cell, or NONE.
+		uint32_t query(float x, float y, uint64_t* parity) const;
+	};
+
+} // Closing the scaleGeom namespace.
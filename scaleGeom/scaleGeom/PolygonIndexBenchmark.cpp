@@ -0,0 +1,188 @@
+#include "Benchmark.h"
+#include "CpuFeatures.h"
+#include "Parallel.h"
+#include "PolygonIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    // Rings packed into one vertex array, in the layout PolygonIndex takes.
+    struct Fences
+    {
+        std::vector<scaleGeom::Vector2f> vertices;
+        std::vector<uint32_t> ringStarts{ 0 }, ringPolygons;
+
+        void closeRing(uint32_t polygon)
+        {
+            ringStarts.push_back(static_cast<uint32_t>(vertices.size()));
+            ringPolygons.push_back(polygon);
+        }
+    };
+
+    // Districts: a side x side grid with jittered corners and wiggly inner borders of detail vertices per side,
+    // shared exactly by the neighbours, so the districts tile the square [0, side]^2. Zones: discs with 64 to 256
+    // vertices on top, every third one with a hole, overlapping the districts and each other.
+    Fences makeFences(size_t side, size_t detail, size_t zones)
+    {
+        std::mt19937 rng(25);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::vector<double> cornerX((side + 1) * (side + 1)), cornerY(cornerX.size()), wiggle(2 * cornerX.size());
+        for (size_t j = 0; j <= side; j++)
+        {
+            for (size_t i = 0; i <= side; i++)
+            {
+                const bool inner = i > 0 && i < side && j > 0 && j < side;
+                cornerX[j * (side + 1) + i] = i + (inner ? 0.6 * uniform(rng) - 0.3 : 0.0);
+                cornerY[j * (side + 1) + i] = j + (inner ? 0.6 * uniform(rng) - 0.3 : 0.0);
+            }
+        }
+        for (size_t b = 0; b < wiggle.size(); b++)
+        {
+            const size_t i = b / 2 % (side + 1), j = b / 2 / (side + 1);
+            const bool outer = b % 2 ? i == 0 || i == side : j == 0 || j == side;
+            wiggle[b] = outer ? 0.0 : 0.1 * uniform(rng) - 0.05;
+        }
+
+        Fences fences;
+        // The border from corner u to corner v, without v; computed from the lower corner so both sides agree.
+        auto addBorder = [&](size_t u, size_t v, size_t border) {
+            const size_t from = std::min(u, v), to = std::max(u, v);
+            std::vector<scaleGeom::Vector2f> points;
+            for (size_t k = 0; k < detail; k++)
+            {
+                const double t = static_cast<double>(k) / detail, dx = cornerX[to] - cornerX[from], dy = cornerY[to] - cornerY[from];
+                const double offset = wiggle[border] * std::sin(3.141592653589793 * t * 3);
+                points.push_back(scaleGeom::Vector2f(static_cast<float>(cornerX[from] + t * dx - offset * dy), static_cast<float>(cornerY[from] + t * dy + offset * dx)));
+            }
+            points.push_back(scaleGeom::Vector2f(static_cast<float>(cornerX[to]), static_cast<float>(cornerY[to])));
+            if (u != from)
+                std::reverse(points.begin(), points.end());
+            fences.vertices.insert(fences.vertices.end(), points.begin(), points.end() - 1);
+        };
+        for (size_t j = 0; j < side; j++)
+        {
+            for (size_t i = 0; i < side; i++)
+            {
+                const size_t c = j * (side + 1) + i, horizontal = 2 * c, vertical = 2 * c + 1;
+                addBorder(c, c + 1, horizontal);
+                addBorder(c + 1, c + side + 2, vertical + 2);
+                addBorder(c + side + 2, c + side + 1, horizontal + 2 * (side + 1));
+                addBorder(c + side + 1, c, vertical);
+                fences.closeRing(static_cast<uint32_t>(j * side + i));
+            }
+        }
+
+        for (size_t z = 0; z < zones; z++)
+        {
+            const uint32_t id = static_cast<uint32_t>(side * side + z);
+            const double cx = uniform(rng) * side, cy = uniform(rng) * side, radius = 0.5 + 2.0 * uniform(rng);
+            const size_t count = 64 + rng() % 193;
+            for (int ring = 0; ring < (z % 3 == 0 ? 2 : 1); ring++)
+            {
+                for (size_t k = 0; k < count; k++)
+                {
+                    const double angle = 6.283185307179586 * k / count, r = radius * (ring ? 0.3 : 1.0) * (0.8 + 0.2 * uniform(rng));
+                    fences.vertices.push_back(scaleGeom::Vector2f(static_cast<float>(cx + r * std::cos(angle)), static_cast<float>(cy + r * std::sin(angle))));
+                }
+                fences.closeRing(id);
+            }
+        }
+        return fences;
+    }
+
+    void report(const char* label, unsigned threads, double seconds, size_t count, const char* note)
+    {
+        std::cout << "  " << std::left << std::setw(30) << label << std::right
+            << std::setw(3) << threads << " threads "
+            << std::setw(9) << std::fixed << std::setprecision(2) << seconds * 1e3 << " ms  "
+            << std::setw(8) << std::setprecision(2) << count / seconds / 1e6 << " Mpoints/s" << note << std::endl;
+    }
+}
+
+SCALEGEOM_BENCHMARK(PolygonIndex)
+{
+    const unsigned hardware = scaleGeom::resolveThreadCount(0);
+    const size_t side = 32, count = scaleGeom::bench::problemSize(4000000);
+    const Fences fences = makeFences(side, 32, 256);
+
+    Timer buildTimer;
+    const scaleGeom::PolygonIndex index(fences.vertices.data(), fences.ringStarts.data(), fences.ringPolygons.data(), fences.ringPolygons.size());
+    const double buildSeconds = buildTimer.seconds();
+    const scaleGeom::PolygonIndexStats& stats = index.stats();
+    std::cout << "  polygons: " << stats.polygons << ", edges: " << stats.edges << ", cells: " << stats.cells << ", references: " << stats.references
+        << ", slots: " << stats.slots << ", build: " << std::fixed << std::setprecision(2) << buildSeconds * 1e3 << " ms" << std::endl;
+
+    std::mt19937 rng(26);
+    std::uniform_real_distribution<float> uniform(-0.5f, side + 0.5f);
+    scaleGeom::PointCloud2f points(count);
+    for (size_t p = 0; p < count; p++)
+    {
+        points.axis(0)[p] = uniform(rng);
+        points.axis(1)[p] = uniform(rng);
+    }
+    std::cout << "  points: " << count << ", detected SIMD level: " << scaleGeom::simdLevelName(scaleGeom::detectedSimdLevel()) << std::endl;
+
+    // Every SIMD level single-threaded, checked against the scalar kernel and against the tiling: a point in
+    // [0, side)^2 lies in exactly one district.
+    std::vector<uint32_t> ids(count), reference(count);
+    const scaleGeom::SimdLevel levels[] = { scaleGeom::SimdLevel::Scalar, scaleGeom::SimdLevel::SSE41, scaleGeom::SimdLevel::AVX2, scaleGeom::SimdLevel::AVX512 };
+    for (scaleGeom::SimdLevel requested : levels)
+    {
+        if (requested > scaleGeom::detectedSimdLevel())
+            break;
+        const scaleGeom::SimdLevel level = scaleGeom::forceSimdLevel(requested);
+        Timer timer;
+        index.locate(points.view(), ids.data(), 1);
+        const double seconds = timer.seconds();
+        if (level == scaleGeom::SimdLevel::Scalar)
+            reference = ids;
+        const std::string label = std::string("locate [") + scaleGeom::simdLevelName(level) + "]";
+        report(label.c_str(), 1, seconds, count, ids == reference ? "" : "  MISMATCH");
+    }
+    scaleGeom::forceSimdLevel(scaleGeom::detectedSimdLevel());
+    size_t tilingErrors = 0;
+    for (size_t p = 0; p < count; p++)
+    {
+        const float x = points.axis(0)[p], y = points.axis(1)[p];
+        const bool inTiling = x >= 0 && y >= 0 && x < side && y < side;
+        tilingErrors += inTiling != (reference[p] < side * side);
+    }
+    if (tilingErrors)
+        std::cout << "  TILING MISMATCH: " << tilingErrors << " points" << std::endl;
+
+    for (unsigned threads = 2; threads <= hardware; threads *= 2)
+    {
+        Timer timer;
+        index.locate(points.view(), ids.data(), threads);
+        const double seconds = timer.seconds();
+        report("locate", threads, seconds, count, ids == reference ? "" : "  MISMATCH");
+    }
+
+    // All containing polygons, counted per point: every point is visited by one thread only.
+    std::vector<uint32_t> hits(count);
+    for (unsigned threads = 1; threads <= hardware; threads *= 2)
+    {
+        std::fill(hits.begin(), hits.end(), 0);
+        Timer timer;
+        index.forEachContaining(points.view(), [&](size_t point, uint32_t) { hits[point]++; }, threads);
+        const double seconds = timer.seconds();
+        size_t total = 0;
+        for (uint32_t h : hits)
+        {
+            total += h;
+        }
+        char note[64];
+        std::snprintf(note, sizeof(note), "  %.2f hits/point", static_cast<double>(total) / count);
+        report("forEachContaining", threads, seconds, count, note);
+    }
+}
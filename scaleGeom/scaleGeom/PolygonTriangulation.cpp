@@ -0,0 +1,1037 @@
+#include "PolygonTriangulation.h"
+#include "Predicates.h"
+#include "VectorOrder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+    const uint32_t NONE = 0xffffffffu;
+
+    // TriangulationMethod::Auto clips the ears of polygons up to this many vertices.
+    const size_t EAR_CLIPPING_LIMIT = 256;
+
+    // Above this many vertices, ear clipping searches for vertices inside an ear in Morton order.
+    const size_t MORTON_SEARCH_LIMIT = 16;
+
+    typedef scaleGeom::TriangulationScratch::Node Node;
+
+    // Triangles written to the caller's buffer, never more than it holds.
+    struct TriangleWriter
+    {
+        uint32_t* indices;
+        size_t capacity;
+        size_t count = 0;
+
+        TriangleWriter(uint32_t* _indices, size_t _capacity) : indices(_indices), capacity(_capacity) {}
+
+        void add(uint32_t a, uint32_t b, uint32_t c)
+        {
+            if (count == capacity)
+                return;
+            indices[3 * count] = a;
+            indices[3 * count + 1] = b;
+            indices[3 * count + 2] = c;
+            count++;
+        }
+    };
+
+    // Twice the signed area of the ring vertices[begin, end), positive when counterclockwise.
+    double ringArea(const scaleGeom::Vector2f* vertices, size_t begin, size_t end)
+    {
+        double area = 0.0;
+        for (size_t i = begin, j = end - 1; i < end; j = i++)
+        {
+            area += static_cast<double>(vertices[j][0]) * vertices[i][1] - static_cast<double>(vertices[i][0]) * vertices[j][1];
+        }
+        return area;
+    }
+
+    inline bool inTriangle(const double* a, const double* b, const double* c, const double* p)
+    {
+        return scaleGeom::orient2d(a, b, p) >= 0 && scaleGeom::orient2d(b, c, p) >= 0 && scaleGeom::orient2d(c, a, p) >= 0;
+    }
+
+    // Ear clipping of a linked ring, after earcut: the holes are bridged into the outer ring, then ears are cut
+    // off until three vertices are left. Node indices stay valid when nodes grows; references do not.
+    class EarClipper
+    {
+        std::vector<Node>& nodes;
+        std::vector<uint32_t>& sorted;
+        TriangleWriter& out;
+        const bool hashed;
+        const scaleGeom::SpatialKeyEncoder<double, scaleGeom::DIM2> encoder;
+
+        double orient(uint32_t p, uint32_t q, uint32_t r) const
+        {
+            return scaleGeom::orient2d(nodes[p].xy, nodes[q].xy, nodes[r].xy);
+        }
+
+        bool equal(uint32_t p, uint32_t q) const
+        {
+            return nodes[p].xy[0] == nodes[q].xy[0] && nodes[p].xy[1] == nodes[q].xy[1];
+        }
+
+        uint64_t zOrder(double x, double y) const
+        {
+            return encoder.morton(scaleGeom::Vector2d(x, y));
+        }
+
+        uint32_t insert(uint32_t index, const scaleGeom::Vector2f& point, uint32_t last)
+        {
+            const uint32_t p = static_cast<uint32_t>(nodes.size());
+            nodes.push_back(Node{ { point[0], point[1] }, 0, index, p, p, NONE, NONE });
+            if (last != NONE)
+            {
+                nodes[p].next = nodes[last].next;
+                nodes[p].prev = last;
+                nodes[nodes[last].next].prev = p;
+                nodes[last].next = p;
+            }
+            return p;
+        }
+
+        // Unlink p; p keeps its own links, so the walk can go on from it.
+        void remove(uint32_t p)
+        {
+            Node& node = nodes[p];
+            nodes[node.next].prev = node.prev;
+            nodes[node.prev].next = node.next;
+            if (node.prevZ != NONE)
+                nodes[node.prevZ].nextZ = node.nextZ;
+            if (node.nextZ != NONE)
+                nodes[node.nextZ].prevZ = node.prevZ;
+        }
+
+        // Remove duplicate and collinear vertices between start and end. Returns a vertex still in the ring.
+        uint32_t filter(uint32_t start, uint32_t end = NONE)
+        {
+            if (end == NONE)
+                end = start;
+            uint32_t p = start;
+            bool again;
+            do
+            {
+                again = false;
+                if (equal(p, nodes[p].next) || orient(nodes[p].prev, p, nodes[p].next) == 0)
+                {
+                    remove(p);
+                    p = end = nodes[p].prev;
+                    if (p == nodes[p].next)
+                        break;
+                    again = true;
+                }
+                else
+                {
+                    p = nodes[p].next;
+                }
+            } while (again || p != end);
+            return end;
+        }
+
+        // Link the Morton neighbours of the ring from start.
+        void indexCurve(uint32_t start)
+        {
+            sorted.clear();
+            uint32_t p = start;
+            do
+            {
+                nodes[p].z = zOrder(nodes[p].xy[0], nodes[p].xy[1]);
+                sorted.push_back(p);
+                p = nodes[p].next;
+            } while (p != start);
+            std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) { return nodes[a].z < nodes[b].z; });
+            for (size_t k = 0; k < sorted.size(); k++)
+            {
+                nodes[sorted[k]].prevZ = k ? sorted[k - 1] : NONE;
+                nodes[sorted[k]].nextZ = k + 1 < sorted.size() ? sorted[k + 1] : NONE;
+            }
+        }
+
+        // A reflex vertex other than the ear's own corners inside the ear.
+        bool blocks(uint32_t p, uint32_t a, uint32_t b, uint32_t c) const
+        {
+            return p != a && p != c && inTriangle(nodes[a].xy, nodes[b].xy, nodes[c].xy, nodes[p].xy)
+                && orient(nodes[p].prev, p, nodes[p].next) <= 0;
+        }
+
+        bool isEar(uint32_t ear) const
+        {
+            const uint32_t a = nodes[ear].prev, b = ear, c = nodes[ear].next;
+            if (orient(a, b, c) <= 0)
+                return false;
+            for (uint32_t p = nodes[c].next; p != a; p = nodes[p].next)
+            {
+                if (blocks(p, a, b, c))
+                    return false;
+            }
+            return true;
+        }
+
+        // isEar, looking only at the vertices whose Morton keys lie between those of the ear's bounding box corners.
+        bool isEarHashed(uint32_t ear) const
+        {
+            const uint32_t a = nodes[ear].prev, b = ear, c = nodes[ear].next;
+            if (orient(a, b, c) <= 0)
+                return false;
+            const double* pa = nodes[a].xy;
+            const double* pb = nodes[b].xy;
+            const double* pc = nodes[c].xy;
+            const double x0 = std::min(pa[0], std::min(pb[0], pc[0])), y0 = std::min(pa[1], std::min(pb[1], pc[1]));
+            const double x1 = std::max(pa[0], std::max(pb[0], pc[0])), y1 = std::max(pa[1], std::max(pb[1], pc[1]));
+            const uint64_t minZ = zOrder(x0, y0), maxZ = zOrder(x1, y1);
+            auto inBox = [&](uint32_t p) {
+                return nodes[p].xy[0] >= x0 && nodes[p].xy[0] <= x1 && nodes[p].xy[1] >= y0 && nodes[p].xy[1] <= y1;
+            };
+
+            uint32_t p = nodes[ear].prevZ, n = nodes[ear].nextZ;
+            while (p != NONE && nodes[p].z >= minZ && n != NONE && nodes[n].z <= maxZ)
+            {
+                if (inBox(p) && blocks(p, a, b, c))
+                    return false;
+                p = nodes[p].prevZ;
+                if (inBox(n) && blocks(n, a, b, c))
+                    return false;
+                n = nodes[n].nextZ;
+            }
+            for (; p != NONE && nodes[p].z >= minZ; p = nodes[p].prevZ)
+            {
+                if (inBox(p) && blocks(p, a, b, c))
+                    return false;
+            }
+            for (; n != NONE && nodes[n].z <= maxZ; n = nodes[n].nextZ)
+            {
+                if (inBox(n) && blocks(n, a, b, c))
+                    return false;
+            }
+            return true;
+        }
+
+        static bool onSegment(const double* p, const double* q, const double* r)
+        {
+            return q[0] <= std::max(p[0], r[0]) && q[0] >= std::min(p[0], r[0]) && q[1] <= std::max(p[1], r[1]) && q[1] >= std::min(p[1], r[1]);
+        }
+
+        static int sign(double value)
+        {
+            return (value > 0) - (value < 0);
+        }
+
+        // Segments p1q1 and p2q2 touch or cross.
+        bool intersects(uint32_t p1, uint32_t q1, uint32_t p2, uint32_t q2) const
+        {
+            const int o1 = sign(orient(p1, q1, p2)), o2 = sign(orient(p1, q1, q2));
+            const int o3 = sign(orient(p2, q2, p1)), o4 = sign(orient(p2, q2, q1));
+            if (o1 != o2 && o3 != o4)
+                return true;
+            return (o1 == 0 && onSegment(nodes[p1].xy, nodes[p2].xy, nodes[q1].xy)) || (o2 == 0 && onSegment(nodes[p1].xy, nodes[q2].xy, nodes[q1].xy))
+                || (o3 == 0 && onSegment(nodes[p2].xy, nodes[p1].xy, nodes[q2].xy)) || (o4 == 0 && onSegment(nodes[p2].xy, nodes[q1].xy, nodes[q2].xy));
+        }
+
+        // The segment ab crosses an edge of the ring that does not end at a or b.
+        bool intersectsRing(uint32_t a, uint32_t b) const
+        {
+            uint32_t p = a;
+            do
+            {
+                const uint32_t q = nodes[p].next;
+                if (nodes[p].index != nodes[a].index && nodes[q].index != nodes[a].index && nodes[p].index != nodes[b].index
+                    && nodes[q].index != nodes[b].index && intersects(p, q, a, b))
+                    return true;
+                p = q;
+            } while (p != a);
+            return false;
+        }
+
+        // The diagonal from a towards b starts into the inside of the ring.
+        bool locallyInside(uint32_t a, uint32_t b) const
+        {
+            const uint32_t prev = nodes[a].prev, next = nodes[a].next;
+            return orient(prev, a, next) > 0 ? orient(a, b, next) <= 0 && orient(a, prev, b) <= 0
+                : orient(a, b, prev) > 0 || orient(a, next, b) > 0;
+        }
+
+        // The midpoint of ab lies inside the ring.
+        bool middleInside(uint32_t a, uint32_t b) const
+        {
+            const double px = (nodes[a].xy[0] + nodes[b].xy[0]) / 2, py = (nodes[a].xy[1] + nodes[b].xy[1]) / 2;
+            bool inside = false;
+            uint32_t p = a;
+            do
+            {
+                const double* s = nodes[p].xy;
+                const double* t = nodes[nodes[p].next].xy;
+                if ((s[1] > py) != (t[1] > py) && t[1] != s[1] && px < (t[0] - s[0]) * (py - s[1]) / (t[1] - s[1]) + s[0])
+                    inside = !inside;
+                p = nodes[p].next;
+            } while (p != a);
+            return inside;
+        }
+
+        bool isValidDiagonal(uint32_t a, uint32_t b) const
+        {
+            const Node& na = nodes[a];
+            const Node& nb = nodes[b];
+            if (nodes[na.next].index == nb.index || nodes[na.prev].index == nb.index || intersectsRing(a, b))
+                return false;
+
+            // Locally visible and not creating opposite-facing sectors, or a zero-length diagonal between convex vertices.
+            return (locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) && (orient(na.prev, a, nb.prev) != 0 || orient(a, nb.prev, b) != 0))
+                || (equal(a, b) && orient(na.prev, a, na.next) < 0 && orient(nb.prev, b, nb.next) < 0);
+        }
+
+        // Split the ring along ab into two: a -> b and a copy of b -> a copy of a. Returns the copy of b.
+        uint32_t split(uint32_t a, uint32_t b)
+        {
+            const uint32_t a2 = static_cast<uint32_t>(nodes.size()), b2 = a2 + 1;
+            nodes.push_back(Node{ { nodes[a].xy[0], nodes[a].xy[1] }, 0, nodes[a].index, NONE, NONE, NONE, NONE });
+            nodes.push_back(Node{ { nodes[b].xy[0], nodes[b].xy[1] }, 0, nodes[b].index, NONE, NONE, NONE, NONE });
+            const uint32_t an = nodes[a].next, bp = nodes[b].prev;
+
+            nodes[a].next = b;
+            nodes[b].prev = a;
+            nodes[a2].next = an;
+            nodes[an].prev = a2;
+            nodes[b2].next = a2;
+            nodes[a2].prev = b2;
+            nodes[bp].next = b2;
+            nodes[b2].prev = bp;
+            return b2;
+        }
+
+        // Try diagonals until one splits the ring into two that can be clipped separately.
+        void splitClip(uint32_t start)
+        {
+            uint32_t a = start;
+            do
+            {
+                for (uint32_t b = nodes[nodes[a].next].next; b != nodes[a].prev; b = nodes[b].next)
+                {
+                    if (nodes[a].index != nodes[b].index && isValidDiagonal(a, b))
+                    {
+                        uint32_t c = split(a, b);
+                        a = filter(a, nodes[a].next);
+                        c = filter(c, nodes[c].next);
+                        clip(a, 0);
+                        clip(c, 0);
+                        return;
+                    }
+                }
+                a = nodes[a].next;
+            } while (a != start);
+        }
+
+        // Cut off the triangles of small self-intersections p.prev, p, p.next, p.next.next.
+        uint32_t cureLocalIntersections(uint32_t start)
+        {
+            uint32_t p = start;
+            do
+            {
+                const uint32_t a = nodes[p].prev, b = nodes[nodes[p].next].next;
+                if (!equal(a, b) && intersects(a, p, nodes[p].next, b) && locallyInside(a, b) && locallyInside(b, a))
+                {
+                    out.add(nodes[a].index, nodes[p].index, nodes[b].index);
+                    remove(p);
+                    remove(nodes[p].next);
+                    p = start = b;
+                }
+                p = nodes[p].next;
+            } while (p != start);
+            return filter(p);
+        }
+
+        // The vertex of the outer ring to bridge the hole's leftmost vertex to.
+        uint32_t findHoleBridge(uint32_t hole, uint32_t outer) const
+        {
+            const double hx = nodes[hole].xy[0], hy = nodes[hole].xy[1];
+            double qx = -std::numeric_limits<double>::infinity();
+            uint32_t m = NONE;
+
+            // The ring edge hit first by a ray from the hole to the left; its endpoint with the smaller x is the candidate.
+            uint32_t p = outer;
+            do
+            {
+                const double* s = nodes[p].xy;
+                const double* t = nodes[nodes[p].next].xy;
+                if (hy <= s[1] && hy >= t[1] && t[1] != s[1])
+                {
+                    const double x = s[0] + (hy - s[1]) * (t[0] - s[0]) / (t[1] - s[1]);
+                    if (x <= hx && x > qx)
+                    {
+                        qx = x;
+                        m = s[0] < t[0] ? p : nodes[p].next;
+                        if (x == hx)
+                            return m;
+                    }
+                }
+                p = nodes[p].next;
+            } while (p != outer);
+            if (m == NONE)
+                return NONE;
+
+            // Vertices inside the triangle of the hole, the hit and the candidate would block the bridge: take the
+            // one at the smallest angle to the ray instead.
+            const uint32_t stop = m;
+            const double mx = nodes[m].xy[0], my = nodes[m].xy[1];
+            const double first[2] = { hy < my ? hx : qx, hy }, apex[2] = { mx, my }, last[2] = { hy < my ? qx : hx, hy };
+            double tanMin = std::numeric_limits<double>::infinity();
+            p = m;
+            do
+            {
+                const double* q = nodes[p].xy;
+                if (hx >= q[0] && q[0] >= mx && hx != q[0] && inTriangle(first, apex, last, q))
+                {
+                    const double tangent = std::fabs(hy - q[1]) / (hx - q[0]);
+                    if (locallyInside(p, hole) && (tangent < tanMin || (tangent == tanMin && (q[0] > nodes[m].xy[0]
+                        || (q[0] == nodes[m].xy[0] && sectorContainsSector(m, p))))))
+                    {
+                        m = p;
+                        tanMin = tangent;
+                    }
+                }
+                p = nodes[p].next;
+            } while (p != stop);
+            return m;
+        }
+
+        // The sector of m contains the sector of p, which lies at the same place.
+        bool sectorContainsSector(uint32_t m, uint32_t p) const
+        {
+            return orient(nodes[m].prev, m, nodes[p].prev) > 0 && orient(nodes[p].next, m, nodes[m].next) > 0;
+        }
+
+    public:
+
+        EarClipper(std::vector<Node>& _nodes, std::vector<uint32_t>& _sorted, TriangleWriter& _out, bool _hashed,
+            const scaleGeom::Vector2d& lower, const scaleGeom::Vector2d& upper)
+            : nodes(_nodes), sorted(_sorted), out(_out), hashed(_hashed), encoder(lower, upper)
+        {
+        }
+
+        // Link the ring vertices[begin, end), counterclockwise or clockwise. Returns a vertex of it.
+        uint32_t link(const scaleGeom::Vector2f* vertices, size_t begin, size_t end, bool counterclockwise)
+        {
+            uint32_t last = NONE;
+            if (counterclockwise == (ringArea(vertices, begin, end) > 0))
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    last = insert(static_cast<uint32_t>(i), vertices[i], last);
+                }
+            }
+            else
+            {
+                for (size_t i = end; i-- > begin;)
+                {
+                    last = insert(static_cast<uint32_t>(i), vertices[i], last);
+                }
+            }
+            if (last != NONE && equal(last, nodes[last].next))
+            {
+                remove(last);
+                last = nodes[last].next;
+            }
+            return last;
+        }
+
+        bool single(uint32_t p) const
+        {
+            return nodes[p].next == p;
+        }
+
+        bool degenerate(uint32_t p) const
+        {
+            return nodes[p].next == nodes[p].prev;
+        }
+
+        // Bridge the holes, given by their leftmost vertices, into the outer ring, from left to right.
+        uint32_t eliminateHoles(std::vector<uint32_t>& holes, uint32_t outer)
+        {
+            std::sort(holes.begin(), holes.end(), [&](uint32_t a, uint32_t b) { return nodes[a].xy[0] < nodes[b].xy[0]; });
+            for (uint32_t hole : holes)
+            {
+                const uint32_t bridge = findHoleBridge(hole, outer);
+                if (bridge == NONE)
+                    continue;
+                const uint32_t reverse = split(bridge, hole);
+                filter(reverse, nodes[reverse].next);
+                outer = filter(bridge, nodes[bridge].next);
+            }
+            return outer;
+        }
+
+        uint32_t leftmost(uint32_t start) const
+        {
+            uint32_t p = start, best = start;
+            do
+            {
+                if (nodes[p].xy[0] < nodes[best].xy[0] || (nodes[p].xy[0] == nodes[best].xy[0] && nodes[p].xy[1] < nodes[best].xy[1]))
+                    best = p;
+                p = nodes[p].next;
+            } while (p != start);
+            return best;
+        }
+
+        // Cut off ears from ear on. When none is left, pass 1 removes collinear vertices, pass 2 cures local
+        // self-intersections, and pass 3 splits the ring in two.
+        void clip(uint32_t ear, int pass)
+        {
+            if (ear == NONE)
+                return;
+            if (pass == 0 && hashed)
+                indexCurve(ear);
+
+            uint32_t stop = ear;
+            while (nodes[ear].prev != nodes[ear].next)
+            {
+                const uint32_t prev = nodes[ear].prev, next = nodes[ear].next;
+                if (hashed ? isEarHashed(ear) : isEar(ear))
+                {
+                    out.add(nodes[prev].index, nodes[ear].index, nodes[next].index);
+                    remove(ear);
+                    ear = stop = nodes[next].next;
+                    continue;
+                }
+                ear = next;
+                if (ear == stop)
+                {
+                    if (pass == 0)
+                        clip(filter(ear), 1);
+                    else if (pass == 1)
+                        clip(cureLocalIntersections(filter(ear)), 2);
+                    else
+                        splitClip(ear);
+                    break;
+                }
+            }
+        }
+    };
+
+    size_t clipEars(const scaleGeom::Vector2f* vertices, size_t count, const uint32_t* holeStarts, size_t holeCount,
+        scaleGeom::TriangulationScratch& scratch, TriangleWriter& out)
+    {
+        scaleGeom::Vector2d lower(vertices[0][0], vertices[0][1]), upper = lower;
+        const bool hashed = count > MORTON_SEARCH_LIMIT;
+        if (hashed)
+        {
+            for (size_t i = 1; i < count; i++)
+            {
+                lower = scaleGeom::Vector2d(std::min<double>(lower[0], vertices[i][0]), std::min<double>(lower[1], vertices[i][1]));
+                upper = scaleGeom::Vector2d(std::max<double>(upper[0], vertices[i][0]), std::max<double>(upper[1], vertices[i][1]));
+            }
+        }
+        scratch.nodes.clear();
+        EarClipper clipper(scratch.nodes, scratch.order, out, hashed, lower, upper);
+
+        uint32_t outer = clipper.link(vertices, 0, holeCount ? holeStarts[0] : count, true);
+        if (outer == NONE || clipper.degenerate(outer))
+            return out.count;
+        scratch.stack.clear();
+        for (size_t k = 0; k < holeCount; k++)
+        {
+            const uint32_t hole = clipper.link(vertices, holeStarts[k], k + 1 < holeCount ? holeStarts[k + 1] : count, false);
+            if (hole != NONE && !clipper.single(hole) && !clipper.degenerate(hole))
+                scratch.stack.push_back(clipper.leftmost(hole));
+        }
+        if (!scratch.stack.empty())
+            outer = clipper.eliminateHoles(scratch.stack, outer);
+        clipper.clip(outer, 0);
+        return out.count;
+    }
+
+    // Vertex kinds of the monotone partition sweep.
+    enum : uint8_t { REGULAR, START, END, SPLIT, MERGE };
+
+    // Chains of a monotone piece.
+    enum : uint8_t { LEFT_CHAIN, RIGHT_CHAIN };
+
+    // Monotone partition: one sweep from top to bottom adds the diagonals that remove split and merge vertices, then
+    // every piece is triangulated along its two chains. Edge e runs from vertex e to next[e], interior on its left.
+    class MonotonePartition
+    {
+        const scaleGeom::Vector2f* vertices;
+        scaleGeom::TriangulationScratch& s;
+        TriangleWriter& out;
+        uint32_t root = NONE;
+
+        // Sweep order: higher y first, then smaller x.
+        bool above(uint32_t a, uint32_t b) const
+        {
+            const scaleGeom::Vector2f& p = vertices[a];
+            const scaleGeom::Vector2f& q = vertices[b];
+            if (p[1] != q[1])
+                return p[1] > q[1];
+            if (p[0] != q[0])
+                return p[0] < q[0];
+            return a < b;
+        }
+
+        double orient(uint32_t a, uint32_t b, uint32_t c) const
+        {
+            return scaleGeom::orient2d(vertices[a], vertices[b], vertices[c]);
+        }
+
+        // Descending edges in the status, ordered from left to right where the sweep line crosses them. The edge
+        // that starts lower is compared against the other's line.
+        bool edgeLess(uint32_t a, uint32_t b) const
+        {
+            const uint32_t a1 = s.next[a], b1 = s.next[b];
+            if (above(a, b))
+            {
+                double side = orient(a, a1, b);
+                if (side == 0)
+                    side = orient(a, a1, b1);
+                return side != 0 ? side > 0 : a < b;
+            }
+            double side = orient(b, b1, a);
+            if (side == 0)
+                side = orient(b, b1, a1);
+            return side != 0 ? side < 0 : a < b;
+        }
+
+        static uint32_t priority(uint32_t e)
+        {
+            e ^= e >> 16;
+            e *= 0x7feb352du;
+            e ^= e >> 15;
+            e *= 0x846ca68bu;
+            return e ^ (e >> 16);
+        }
+
+        // Move c above its parent.
+        void rotateUp(uint32_t c)
+        {
+            const uint32_t p = s.parent[c], g = s.parent[p];
+            if (s.left[p] == c)
+            {
+                s.left[p] = s.right[c];
+                if (s.right[c] != NONE)
+                    s.parent[s.right[c]] = p;
+                s.right[c] = p;
+            }
+            else
+            {
+                s.right[p] = s.left[c];
+                if (s.left[c] != NONE)
+                    s.parent[s.left[c]] = p;
+                s.left[c] = p;
+            }
+            s.parent[p] = c;
+            s.parent[c] = g;
+            if (g == NONE)
+                root = c;
+            else if (s.left[g] == p)
+                s.left[g] = c;
+            else
+                s.right[g] = c;
+        }
+
+        void insertEdge(uint32_t e)
+        {
+            s.left[e] = s.right[e] = NONE;
+            s.parent[e] = NONE;
+            if (root == NONE)
+            {
+                root = e;
+                return;
+            }
+            uint32_t node = root;
+            for (;;)
+            {
+                uint32_t& child = edgeLess(e, node) ? s.left[node] : s.right[node];
+                if (child == NONE)
+                {
+                    child = e;
+                    s.parent[e] = node;
+                    break;
+                }
+                node = child;
+            }
+            while (s.parent[e] != NONE && priority(e) > priority(s.parent[e]))
+            {
+                rotateUp(e);
+            }
+        }
+
+        // Rotate e down to a leaf and unlink it; no comparisons needed.
+        void eraseEdge(uint32_t e)
+        {
+            while (s.left[e] != NONE || s.right[e] != NONE)
+            {
+                const uint32_t l = s.left[e], r = s.right[e];
+                rotateUp(r == NONE || (l != NONE && priority(l) > priority(r)) ? l : r);
+            }
+            const uint32_t p = s.parent[e];
+            if (p == NONE)
+                root = NONE;
+            else if (s.left[p] == e)
+                s.left[p] = NONE;
+            else
+                s.right[p] = NONE;
+        }
+
+        // The status edge directly left of vertex v.
+        uint32_t edgeLeftOf(uint32_t v) const
+        {
+            uint32_t best = NONE;
+            for (uint32_t node = root; node != NONE;)
+            {
+                if (orient(node, s.next[node], v) > 0)
+                {
+                    best = node;
+                    node = s.right[node];
+                }
+                else
+                {
+                    node = s.left[node];
+                }
+            }
+            return best;
+        }
+
+        void addDiagonal(uint32_t a, uint32_t b)
+        {
+            s.diagonals.push_back(a);
+            s.diagonals.push_back(b);
+        }
+
+        // End the edge into v: connect a merge vertex left as its helper.
+        void closeEdge(uint32_t e, uint32_t v)
+        {
+            if (s.helper[e] != NONE && s.kind[s.helper[e]] == MERGE)
+                addDiagonal(v, s.helper[e]);
+            eraseEdge(e);
+        }
+
+        // v becomes the helper of the edge to its left, connected to a merge vertex helper before.
+        void helpLeft(uint32_t v)
+        {
+            const uint32_t e = edgeLeftOf(v);
+            if (e == NONE)
+                return;
+            if (s.kind[s.helper[e]] == MERGE)
+                addDiagonal(v, s.helper[e]);
+            s.helper[e] = v;
+        }
+
+        void sweep()
+        {
+            for (uint32_t v : s.order)
+            {
+                const uint32_t u = s.prev[v], w = s.next[v];
+                const bool uBelow = above(v, u), wBelow = above(v, w);
+                const bool convex = orient(u, v, w) > 0;
+                uint8_t kind = REGULAR;
+                if (uBelow && wBelow)
+                    kind = convex ? START : SPLIT;
+                else if (!uBelow && !wBelow)
+                    kind = convex ? END : MERGE;
+                s.kind[v] = kind;
+
+                switch (kind)
+                {
+                case START:
+                    insertEdge(v);
+                    s.helper[v] = v;
+                    break;
+                case END:
+                    closeEdge(u, v);
+                    break;
+                case SPLIT:
+                {
+                    const uint32_t e = edgeLeftOf(v);
+                    if (e != NONE)
+                    {
+                        addDiagonal(v, s.helper[e]);
+                        s.helper[e] = v;
+                    }
+                    insertEdge(v);
+                    s.helper[v] = v;
+                    break;
+                }
+                case MERGE:
+                    closeEdge(u, v);
+                    helpLeft(v);
+                    break;
+                default:
+                    // Descending boundary: the interior lies right of v.
+                    if (wBelow)
+                    {
+                        closeEdge(u, v);
+                        insertEdge(v);
+                        s.helper[v] = v;
+                    }
+                    else
+                    {
+                        helpLeft(v);
+                    }
+                    break;
+                }
+            }
+        }
+
+        // Around vertex v, p comes before q counterclockwise from the positive x axis.
+        bool angleLess(uint32_t v, uint32_t p, uint32_t q) const
+        {
+            const bool upperP = vertices[p][1] > vertices[v][1] || (vertices[p][1] == vertices[v][1] && vertices[p][0] > vertices[v][0]);
+            const bool upperQ = vertices[q][1] > vertices[v][1] || (vertices[q][1] == vertices[v][1] && vertices[q][0] > vertices[v][0]);
+            if (upperP != upperQ)
+                return upperP;
+            return orient(v, p, q) > 0;
+        }
+
+        // Triangulate the monotone piece s.face, counterclockwise.
+        void triangulatePiece()
+        {
+            const std::vector<uint32_t>& face = s.face;
+            const size_t count = face.size();
+            if (count < 3)
+                return;
+            size_t top = 0, bottom = 0;
+            for (size_t k = 1; k < count; k++)
+            {
+                if (above(face[k], face[top]))
+                    top = k;
+                if (above(face[bottom], face[k]))
+                    bottom = k;
+            }
+
+            // Merge the chains top to bottom. Counterclockwise from the top runs down the left chain.
+            std::vector<uint32_t>& chain = s.chain;
+            chain.clear();
+            chain.push_back(face[top]);
+            size_t l = top + 1 == count ? 0 : top + 1, r = top == 0 ? count - 1 : top - 1;
+            while (l != bottom || r != bottom)
+            {
+                if (r == bottom || (l != bottom && above(face[l], face[r])))
+                {
+                    s.kind[face[l]] = LEFT_CHAIN;
+                    chain.push_back(face[l]);
+                    l = l + 1 == count ? 0 : l + 1;
+                }
+                else
+                {
+                    s.kind[face[r]] = RIGHT_CHAIN;
+                    chain.push_back(face[r]);
+                    r = r == 0 ? count - 1 : r - 1;
+                }
+            }
+            chain.push_back(face[bottom]);
+
+            std::vector<uint32_t>& stack = s.stack;
+            stack.assign(chain.begin(), chain.begin() + 2);
+            for (size_t j = 2; j + 1 < chain.size(); j++)
+            {
+                const uint32_t v = chain[j];
+                const bool leftChain = s.kind[v] == LEFT_CHAIN;
+                if (s.kind[v] != s.kind[stack.back()])
+                {
+                    // Opposite chains: fan from v to the whole stack.
+                    for (size_t k = 0; k + 1 < stack.size(); k++)
+                    {
+                        if (leftChain)
+                            out.add(stack[k + 1], stack[k], v);
+                        else
+                            out.add(stack[k], stack[k + 1], v);
+                    }
+                    stack.assign({ chain[j - 1], v });
+                }
+                else
+                {
+                    // Same chain: cut off the triangles v sees across the convex part of the stack.
+                    uint32_t last = stack.back();
+                    stack.pop_back();
+                    while (!stack.empty())
+                    {
+                        const uint32_t t = stack.back();
+                        if (leftChain ? orient(t, last, v) <= 0 : orient(v, last, t) <= 0)
+                            break;
+                        if (leftChain)
+                            out.add(t, last, v);
+                        else
+                            out.add(v, last, t);
+                        last = t;
+                        stack.pop_back();
+                    }
+                    stack.push_back(last);
+                    stack.push_back(v);
+                }
+            }
+            const uint32_t v = chain.back();
+            const bool leftChain = s.kind[stack.back()] == LEFT_CHAIN;
+            for (size_t k = 0; k + 1 < stack.size(); k++)
+            {
+                if (leftChain)
+                    out.add(stack[k], stack[k + 1], v);
+                else
+                    out.add(stack[k + 1], stack[k], v);
+            }
+        }
+
+        // Trace the pieces cut off by the diagonals and triangulate them.
+        void triangulatePieces(size_t count)
+        {
+            // Outgoing half-edges of every vertex, counterclockwise: the ring edge and both directions of each diagonal.
+            std::vector<uint32_t>& offsets = s.offsets;
+            offsets.assign(count + 1, 0);
+            for (uint32_t v : s.order)
+            {
+                offsets[v + 1]++;
+            }
+            for (uint32_t d : s.diagonals)
+            {
+                offsets[d + 1]++;
+            }
+            for (size_t v = 0; v < count; v++)
+            {
+                offsets[v + 1] += offsets[v];
+            }
+            std::vector<uint32_t>& fill = s.helper;
+            std::copy(offsets.begin(), offsets.end() - 1, fill.begin());
+            s.targets.resize(offsets[count]);
+            for (uint32_t v : s.order)
+            {
+                s.targets[fill[v]++] = s.next[v];
+            }
+            for (size_t k = 0; k < s.diagonals.size(); k += 2)
+            {
+                const uint32_t a = s.diagonals[k], b = s.diagonals[k + 1];
+                s.targets[fill[a]++] = b;
+                s.targets[fill[b]++] = a;
+            }
+            for (size_t k = 0; k < s.diagonals.size(); k++)
+            {
+                const uint32_t v = s.diagonals[k];
+                if (offsets[v + 1] - offsets[v] > 1 && fill[v] != NONE)
+                {
+                    std::sort(s.targets.begin() + offsets[v], s.targets.begin() + offsets[v + 1], [&](uint32_t p, uint32_t q) {
+                        return angleLess(v, p, q);
+                    });
+                    fill[v] = NONE;
+                }
+            }
+
+            // Walk every piece counterclockwise, taking the first outgoing half-edge clockwise from the way back.
+            const size_t halfEdges = s.targets.size();
+            s.visited.assign(halfEdges, 0);
+            for (uint32_t start : s.order)
+            {
+                for (uint32_t h = offsets[start]; h < offsets[start + 1]; h++)
+                {
+                    if (s.visited[h])
+                        continue;
+                    s.face.clear();
+                    uint32_t from = start, edge = h;
+                    while (!s.visited[edge] && s.face.size() < halfEdges)
+                    {
+                        s.visited[edge] = 1;
+                        s.face.push_back(from);
+                        const uint32_t to = s.targets[edge];
+                        const std::vector<uint32_t>::iterator first = s.targets.begin() + offsets[to], last = s.targets.begin() + offsets[to + 1];
+                        uint32_t chosen = offsets[to];
+                        if (last - first > 1)
+                        {
+                            const std::vector<uint32_t>::iterator after = std::partition_point(first, last, [&](uint32_t f) {
+                                return angleLess(to, f, from);
+                            });
+                            chosen = static_cast<uint32_t>((after == first ? last : after) - 1 - s.targets.begin());
+                        }
+                        from = to;
+                        edge = chosen;
+                    }
+                    if (edge == h)
+                        triangulatePiece();
+                }
+            }
+        }
+
+    public:
+
+        MonotonePartition(const scaleGeom::Vector2f* _vertices, scaleGeom::TriangulationScratch& _scratch, TriangleWriter& _out)
+            : vertices(_vertices), s(_scratch), out(_out)
+        {
+        }
+
+        void run(size_t count, const uint32_t* holeStarts, size_t holeCount)
+        {
+            // Link the rings, the outer one counterclockwise and the holes clockwise, without repeated vertices.
+            s.next.assign(count, NONE);
+            s.prev.assign(count, NONE);
+            s.order.clear();
+            for (size_t k = 0; k <= holeCount; k++)
+            {
+                const size_t begin = k ? holeStarts[k - 1] : 0, end = k < holeCount ? holeStarts[k] : count;
+                if (end - begin < 3)
+                {
+                    if (k == 0)
+                        return;
+                    continue;
+                }
+                const bool forward = (ringArea(vertices, begin, end) > 0) == (k == 0);
+                const size_t first = s.order.size();
+                for (size_t i = 0; i < end - begin; i++)
+                {
+                    const uint32_t v = static_cast<uint32_t>(forward ? begin + i : end - 1 - i);
+                    if (s.order.size() == first || vertices[v][0] != vertices[s.order.back()][0] || vertices[v][1] != vertices[s.order.back()][1])
+                        s.order.push_back(v);
+                }
+                while (s.order.size() - first > 1 && vertices[s.order.back()][0] == vertices[s.order[first]][0]
+                    && vertices[s.order.back()][1] == vertices[s.order[first]][1])
+                {
+                    s.order.pop_back();
+                }
+                if (s.order.size() - first < 3)
+                {
+                    s.order.resize(first);
+                    if (k == 0)
+                        return;
+                    continue;
+                }
+                for (size_t i = first; i < s.order.size(); i++)
+                {
+                    const uint32_t v = s.order[i], w = s.order[i + 1 < s.order.size() ? i + 1 : first];
+                    s.next[v] = w;
+                    s.prev[w] = v;
+                }
+            }
+
+            std::sort(s.order.begin(), s.order.end(), [&](uint32_t a, uint32_t b) { return above(a, b); });
+            s.helper.assign(count, NONE);
+            s.left.resize(count);
+            s.right.resize(count);
+            s.parent.resize(count);
+            s.kind.resize(count);
+            s.diagonals.clear();
+            root = NONE;
+            sweep();
+            triangulatePieces(count);
+        }
+    };
+}
+
+size_t scaleGeom::triangulatePolygon(const Vector2f* vertices, size_t count, const uint32_t* holeStarts, size_t holeCount, uint32_t* indices,
+    TriangulationScratch& scratch, TriangulationMethod _method)
+{
+    if (count >= NONE)
+        throw std::length_error("triangulatePolygon supports at most 2^32 - 1 vertices\n");
+    for (size_t k = 0; k < holeCount; k++)
+    {
+        if (holeStarts[k] > count || (k && holeStarts[k] < holeStarts[k - 1]))
+            throw std::invalid_argument("triangulatePolygon: holeStarts must be increasing and at most count\n");
+    }
+    TriangleWriter out(indices, triangulationIndexCount(count, holeCount) / 3);
+    if (count < 3)
+        return 0;
+
+    if (_method == TriangulationMethod::Auto)
+        _method = count <= EAR_CLIPPING_LIMIT ? TriangulationMethod::EarClipping : TriangulationMethod::MonotonePartition;
+    if (_method == TriangulationMethod::EarClipping)
+        return clipEars(vertices, count, holeStarts, holeCount, scratch, out);
+
+    MonotonePartition partition(vertices, scratch, out);
+    partition.run(count, holeStarts, holeCount);
+    return out.count;
+}
@@ -0,0 +1,97 @@
+/*
+	PolygonTriangulation.h - Triangulation of Simple Polygons with Holes
+
+	Overview:
+	triangulatePolygon splits a simple polygon with holes, given as Vector2f rings, into
+	triangles. It has two algorithms:
+
+	- Monotone partition, O(n log n) for every input: a sweep from top to bottom classifies the
+	  vertices as start, end, split, merge or regular and adds a diagonal at every split and merge
+	  vertex, which cuts the polygon into y-monotone pieces (de Berg et al., chapter 3). The sweep
+	  status is a treap in the scratch arrays. Every piece is then triangulated in linear time
+	  with a stack of reflex vertices.
+	- Ear clipping, for small polygons: the holes are bridged into the outer ring and ears are
+	  cut off a linked list, as in Mapbox's earcut. Above 16 vertices the search for vertices
+	  inside a candidate ear walks the ring in Morton (z-order) order from the ear in both
+	  directions, and stops at the Morton keys of the corners of the ear's bounding box. The worst
+	  case is O(n^2), but it needs far less setup than the sweep and wins for small polygons.
+	  When no ear is left (degenerate input) it removes collinear vertices, cures small
+	  self-intersections and finally splits the ring along a valid diagonal, so it also copes
+	  with input that is not quite simple.
+
+	TriangulationMethod::Auto clips ears up to 256 vertices and partitions larger polygons.
+
+	All orientation and in-triangle decisions use the exact orient2d of Predicates.h. Rings are
+	reoriented as needed (the outer ring counterclockwise, holes clockwise), consecutive
+	duplicate vertices are skipped and holes with fewer than three distinct vertices ignored.
+
+	Memory:
+	Nothing is allocated per call once a TriangulationScratch has grown to the largest polygon it
+	has seen: keep one scratch per thread and reuse it. The indices are written to memory owned
+	by the caller, which must hold triangulationIndexCount(count, holeCount) values.
+
+	Output:
+	Counterclockwise triangles, three indices into vertices each; the return value is the number
+	of triangles. A simple polygon with n vertices and h holes has n + 2h - 2 triangles; ear
+	clipping leaves out collinear vertices and so may write fewer. The monotone partition expects
+	valid input (holes strictly inside the outer ring and not touching each other); on invalid
+	input it writes some triangles but never more than the buffer holds. count must be below
+	2^32 (std::length_error otherwise).
+
+	Usage:
+	scaleGeom::TriangulationScratch scratch;
+	std::vector<uint32_t> indices(scaleGeom::triangulationIndexCount(points.size(), holeStarts.size()));
+	size_t triangles = scaleGeom::triangulatePolygon(points.data(), points.size(), holeStarts.data(), holeStarts.size(), indices.data(), scratch);
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	enum class TriangulationMethod { Auto, EarClipping, MonotonePartition };
+
+	// Working buffers of one thread.
+	struct TriangulationScratch
+	{
+		// Ring vertex of ear clipping, linked along the ring and in Morton order.
+		struct Node
+		{
+			double xy[2];
+			uint64_t z;
+			uint32_t index, prev, next, prevZ, nextZ;
+		};
+
+		std::vector<Node> nodes;
+
+		// Monotone partition: the rings, the sweep order and status, the diagonals and the monotone pieces.
+		std::vector<uint32_t> next, prev, order, helper, left, right, parent;
+		std::vector<uint32_t> diagonals, offsets, targets, face, chain, stack;
+		std::vector<uint8_t> kind, visited;
+	};
+
+	// Number of indices triangulatePolygon writes at most.
+	inline size_t triangulationIndexCount(size_t count, size_t holeCount)
+	{
+		return count + 2 * holeCount >= 3 ? 3 * (count + 2 * holeCount - 2) : 0;
+	}
+
+	// Triangulate the polygon vertices[0, count). The outer ring runs up to holeStarts[0] (to count without
+	// holes), hole k from holeStarts[k] up to holeStarts[k + 1] or count; holeStarts must be increasing.
+	// Writes three indices per triangle to indices and returns the number of triangles.
+	size_t triangulatePolygon(const Vector2f* vertices, size_t count, const uint32_t* holeStarts, size_t holeCount, uint32_t* indices,
+		TriangulationScratch& scratch, TriangulationMethod _method = TriangulationMethod::Auto);
+
+	inline size_t triangulatePolygon(const std::vector<Vector2f>& vertices, const std::vector<uint32_t>& holeStarts, uint32_t* indices,
+		TriangulationScratch& scratch, TriangulationMethod _method = TriangulationMethod::Auto)
+	{
+		return triangulatePolygon(vertices.data(), vertices.size(), holeStarts.data(), holeStarts.size(), indices, scratch, _method);
+	}
+
+} // Closing the scaleGeom namespace.
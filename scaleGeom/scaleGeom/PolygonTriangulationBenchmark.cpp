@@ -0,0 +1,169 @@
+#include "Benchmark.h"
+#include "Parallel.h"
+#include "PolygonTriangulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    // Polygons packed into one vertex array: polygon p has the vertices [vertexStart[p], vertexStart[p + 1]) and
+    // the holes holeStarts[holeStart[p], holeStart[p + 1]), relative to its first vertex.
+    struct PolygonSet
+    {
+        std::vector<scaleGeom::Vector2f> vertices;
+        std::vector<size_t> vertexStart{ 0 }, holeStart{ 0 }, indexStart{ 0 };
+        std::vector<uint32_t> holeStarts;
+        double area = 0.0;
+
+        size_t size() const { return vertexStart.size() - 1; }
+
+        // Add a star-shaped ring around (cx, cy) with count vertices at radii in [inner, outer].
+        void addRing(std::mt19937& rng, double cx, double cy, size_t count, double inner, double outer, bool hole)
+        {
+            std::uniform_real_distribution<double> uniform(0.0, 1.0);
+            const size_t first = vertices.size();
+            for (size_t k = 0; k < count; k++)
+            {
+                const double angle = 6.283185307179586 * (hole ? count - k : k) / count, radius = inner + (outer - inner) * uniform(rng);
+                vertices.push_back(scaleGeom::Vector2f(static_cast<float>(cx + radius * std::cos(angle)), static_cast<float>(cy + radius * std::sin(angle))));
+            }
+            double twice = 0.0;
+            for (size_t i = first, j = vertices.size() - 1; i < vertices.size(); j = i++)
+            {
+                twice += static_cast<double>(vertices[j][0]) * vertices[i][1] - static_cast<double>(vertices[i][0]) * vertices[j][1];
+            }
+            area += twice / 2;
+            if (hole)
+                holeStarts.push_back(static_cast<uint32_t>(first - vertexStart.back()));
+        }
+
+        void close()
+        {
+            vertexStart.push_back(vertices.size());
+            holeStart.push_back(holeStarts.size());
+            indexStart.push_back(indexStart.back() + scaleGeom::triangulationIndexCount(vertexStart.back() - vertexStart[vertexStart.size() - 2],
+                holeStart.back() - holeStart[holeStart.size() - 2]));
+        }
+    };
+
+    // Building footprints and similar: 6 to 64 vertices, every fourth polygon with a hole.
+    PolygonSet makeSmallPolygons(size_t count)
+    {
+        std::mt19937 rng(24);
+        PolygonSet set;
+        for (size_t p = 0; p < count; p++)
+        {
+            const double cx = static_cast<double>(p % 1000) * 3.0, cy = static_cast<double>(p / 1000) * 3.0;
+            set.addRing(rng, cx, cy, 6 + rng() % 59, 0.6, 1.0, false);
+            if (p % 4 == 0)
+                set.addRing(rng, cx, cy, 6, 0.1, 0.2, true);
+            set.close();
+        }
+        return set;
+    }
+
+    // One large star-shaped polygon with a grid of holes.
+    PolygonSet makeLargePolygon(size_t count)
+    {
+        std::mt19937 rng(25);
+        PolygonSet set;
+        const size_t side = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(count) / 1024.0)));
+        set.addRing(rng, 0.0, 0.0, count, 0.9, 1.0, false);
+        for (size_t y = 0; y < side; y++)
+        {
+            for (size_t x = 0; x < side; x++)
+            {
+                const double spacing = 1.0 / side;
+                set.addRing(rng, -0.5 + (x + 0.5) * spacing, -0.5 + (y + 0.5) * spacing, 16, 0.2 * spacing, 0.4 * spacing, true);
+            }
+        }
+        set.close();
+        return set;
+    }
+
+    // Triangulate every polygon of the set, each thread with its own scratch. Returns the number of triangles.
+    size_t triangulateAll(const PolygonSet& set, std::vector<uint32_t>& indices, scaleGeom::TriangulationMethod method, unsigned threads)
+    {
+        std::vector<size_t> chunkTriangles(threads, 0);
+        std::vector<scaleGeom::TriangulationScratch> scratch(threads);
+        scaleGeom::parallelChunks(0, set.size(), threads, 1, [&](unsigned chunk, size_t begin, size_t end) {
+            for (size_t p = begin; p < end; p++)
+            {
+                chunkTriangles[chunk] += scaleGeom::triangulatePolygon(set.vertices.data() + set.vertexStart[p], set.vertexStart[p + 1] - set.vertexStart[p],
+                    set.holeStarts.data() + set.holeStart[p], set.holeStart[p + 1] - set.holeStart[p], indices.data() + set.indexStart[p], scratch[chunk], method);
+            }
+        });
+        size_t triangles = 0;
+        for (size_t t : chunkTriangles)
+        {
+            triangles += t;
+        }
+        return triangles;
+    }
+
+    // Total area of the triangles. Slots left unused (ear clipping may write fewer triangles) hold degenerate triangles.
+    double triangleArea(const PolygonSet& set, const std::vector<uint32_t>& indices)
+    {
+        double area = 0.0;
+        for (size_t p = 0; p < set.size(); p++)
+        {
+            const scaleGeom::Vector2f* v = set.vertices.data() + set.vertexStart[p];
+            for (size_t k = set.indexStart[p]; k < set.indexStart[p + 1]; k += 3)
+            {
+                const scaleGeom::Vector2f& a = v[indices[k]];
+                const scaleGeom::Vector2f& b = v[indices[k + 1]];
+                const scaleGeom::Vector2f& c = v[indices[k + 2]];
+                area += ((static_cast<double>(b[0]) - a[0]) * (static_cast<double>(c[1]) - a[1]) - (static_cast<double>(b[1]) - a[1]) * (static_cast<double>(c[0]) - a[0])) / 2;
+            }
+        }
+        return area;
+    }
+
+    void run(const char* label, const PolygonSet& set, scaleGeom::TriangulationMethod method, unsigned threads)
+    {
+        std::vector<uint32_t> indices(set.indexStart.back(), 0);
+        Timer timer;
+        const size_t triangles = triangulateAll(set, indices, method, threads);
+        const double seconds = timer.seconds();
+        const bool match = std::fabs(triangleArea(set, indices) - set.area) <= 1e-6 * std::fabs(set.area);
+        std::cout << "  " << std::left << std::setw(34) << label << std::right
+            << std::setw(3) << threads << " threads "
+            << std::setw(9) << std::fixed << std::setprecision(2) << seconds * 1e3 << " ms  "
+            << std::setw(7) << std::setprecision(2) << triangles / seconds / 1e6 << " Mtris/s  "
+            << std::setw(9) << triangles << " triangles" << (match ? "" : "  AREA MISMATCH") << std::endl;
+    }
+}
+
+SCALEGEOM_BENCHMARK(PolygonTriangulation)
+{
+    const unsigned hardware = scaleGeom::resolveThreadCount(0);
+    const scaleGeom::TriangulationMethod methods[] = { scaleGeom::TriangulationMethod::EarClipping, scaleGeom::TriangulationMethod::MonotonePartition,
+        scaleGeom::TriangulationMethod::Auto };
+
+    {
+        const PolygonSet small = makeSmallPolygons(scaleGeom::bench::problemSize(1000000) / 8);
+        std::cout << "  small polygons: " << small.size() << ", vertices: " << small.vertices.size() << std::endl;
+        const char* labels[] = { "small, ear clipping", "small, monotone partition", "small, auto" };
+        for (int m = 0; m < 3; m++)
+        {
+            run(labels[m], small, methods[m], 1);
+        }
+        for (unsigned threads = 2; threads <= hardware; threads *= 2)
+        {
+            run(labels[2], small, methods[2], threads);
+        }
+    }
+    {
+        const PolygonSet large = makeLargePolygon(scaleGeom::bench::problemSize(1000000) / 4);
+        std::cout << "  large polygon: " << large.vertices.size() << " vertices, " << large.holeStarts.size() << " holes" << std::endl;
+        run("large, ear clipping (Morton search)", large, methods[0], 1);
+        run("large, monotone partition", large, methods[1], 1);
+    }
+}
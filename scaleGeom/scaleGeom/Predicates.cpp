@@ -0,0 +1,468 @@
+#include "Predicates.h"
+#include "ExactArithmetic.h"
+
+#include <cmath>
+
+namespace {
+
+    using namespace scaleGeom::exact;
+
+    // ---------------------------------------------------------------------------------------
+    // Error bounds (Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast Robust
+    // Geometric Predicates", 1997) for IEEE double: epsilon = 2^-53, splitter = 2^27 + 1.
+    // The error-free transformations and expansion arithmetic are in ExactArithmetic.h.
+    // ---------------------------------------------------------------------------------------
+
+    const double RESULT_ERRBOUND = (3.0 + 8.0 * EPSILON) * EPSILON;
+    const double CCW_ERRBOUND_A = (3.0 + 16.0 * EPSILON) * EPSILON;
+    const double CCW_ERRBOUND_B = (2.0 + 12.0 * EPSILON) * EPSILON;
+    const double CCW_ERRBOUND_C = (9.0 + 64.0 * EPSILON) * EPSILON * EPSILON;
+    const double O3D_ERRBOUND_A = (7.0 + 56.0 * EPSILON) * EPSILON;
+    const double O3D_ERRBOUND_B = (3.0 + 28.0 * EPSILON) * EPSILON;
+    const double O3D_ERRBOUND_C = (26.0 + 288.0 * EPSILON) * EPSILON * EPSILON;
+    const double ICC_ERRBOUND_A = (10.0 + 96.0 * EPSILON) * EPSILON;
+    const double ISP_ERRBOUND_A = (16.0 + 224.0 * EPSILON) * EPSILON;
+
+#if !defined(SCALEGEOM_NO_PREDICATE_STATS)
+    thread_local scaleGeom::PredicateStats stats = {};
+#define SCALEGEOM_COUNT(counter, field) (stats.counter.field++)
+#else
+#define SCALEGEOM_COUNT(counter, field) ((void)0)
+#endif
+
+    // Exact determinants over exact coordinate differences. Each returns a value with the sign
+    // of the determinant.
+
+    double orient2dExact(const Expansion& acx, const Expansion& acy, const Expansion& bcx, const Expansion& bcy)
+    {
+        return (acx * bcy - acy * bcx).sign();
+    }
+
+    double orient3dExact(const Expansion& adx, const Expansion& ady, const Expansion& adz,
+        const Expansion& bdx, const Expansion& bdy, const Expansion& bdz,
+        const Expansion& cdx, const Expansion& cdy, const Expansion& cdz)
+    {
+        return (adz * (bdx * cdy - cdx * bdy) + bdz * (cdx * ady - adx * cdy) + cdz * (adx * bdy - bdx * ady)).sign();
+    }
+
+    double inCircleExact(const Expansion& adx, const Expansion& ady, const Expansion& bdx, const Expansion& bdy,
+        const Expansion& cdx, const Expansion& cdy)
+    {
+        Expansion alift = adx * adx + ady * ady;
+        Expansion blift = bdx * bdx + bdy * bdy;
+        Expansion clift = cdx * cdx + cdy * cdy;
+        return (alift * (bdx * cdy - cdx * bdy) + blift * (cdx * ady - adx * cdy) + clift * (adx * bdy - bdx * ady)).sign();
+    }
+
+    // Differences are taken against the fifth point e, index 0..3 = a..d.
+    double inSphereExact(const Expansion* ex, const Expansion* ey, const Expansion* ez)
+    {
+        Expansion ab = ex[0] * ey[1] - ex[1] * ey[0];
+        Expansion bc = ex[1] * ey[2] - ex[2] * ey[1];
+        Expansion cd = ex[2] * ey[3] - ex[3] * ey[2];
+        Expansion da = ex[3] * ey[0] - ex[0] * ey[3];
+        Expansion ac = ex[0] * ey[2] - ex[2] * ey[0];
+        Expansion bd = ex[1] * ey[3] - ex[3] * ey[1];
+
+        Expansion abc = ez[0] * bc - ez[1] * ac + ez[2] * ab;
+        Expansion bcd = ez[1] * cd - ez[2] * bd + ez[3] * bc;
+        Expansion cda = ez[2] * da + ez[3] * ac + ez[0] * cd;
+        Expansion dab = ez[3] * ab + ez[0] * bd + ez[1] * da;
+
+        Expansion lift[4];
+        for (int i = 0; i < 4; i++)
+        {
+            lift[i] = ex[i] * ex[i] + ey[i] * ey[i] + ez[i] * ez[i];
+        }
+        return ((lift[3] * abc - lift[2] * dab) + (lift[1] * cda - lift[0] * bcd)).sign();
+    }
+
+    // Exact evaluation from the original coordinates.
+    template<class inputType>
+    double orient3dExact(const inputType* pa, const inputType* pb, const inputType* pc, const inputType* pd)
+    {
+        arena.reset();
+        return orient3dExact(difference(pa[0], pd[0]), difference(pa[1], pd[1]), difference(pa[2], pd[2]),
+            difference(pb[0], pd[0]), difference(pb[1], pd[1]), difference(pb[2], pd[2]),
+            difference(pc[0], pd[0]), difference(pc[1], pd[1]), difference(pc[2], pd[2]));
+    }
+
+    template<class inputType>
+    double inCircleExact(const inputType* pa, const inputType* pb, const inputType* pc, const inputType* pd)
+    {
+        arena.reset();
+        return inCircleExact(difference(pa[0], pd[0]), difference(pa[1], pd[1]), difference(pb[0], pd[0]), difference(pb[1], pd[1]),
+            difference(pc[0], pd[0]), difference(pc[1], pd[1]));
+    }
+
+    template<class inputType>
+    double inSphereExact(const inputType* pa, const inputType* pb, const inputType* pc, const inputType* pd, const inputType* pe)
+    {
+        arena.reset();
+        const inputType* points[4] = { pa, pb, pc, pd };
+        Expansion ex[4], ey[4], ez[4];
+        for (int i = 0; i < 4; i++)
+        {
+            ex[i] = difference(points[i][0], pe[0]);
+            ey[i] = difference(points[i][1], pe[1]);
+            ez[i] = difference(points[i][2], pe[2]);
+        }
+        return inSphereExact(ex, ey, ez);
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Floating-point filters shared by the double and 64-bit integer entry points. They take
+    // coordinate differences rounded once to double and return false when the sign of the
+    // approximate determinant det cannot be trusted.
+    // ---------------------------------------------------------------------------------------
+
+    inline bool inCircleFilter(double adx, double ady, double bdx, double bdy, double cdx, double cdy, double& det)
+    {
+        double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+        double cdxady = cdx * ady, adxcdy = adx * cdy;
+        double adxbdy = adx * bdy, bdxady = bdx * ady;
+        double alift = adx * adx + ady * ady;
+        double blift = bdx * bdx + bdy * bdy;
+        double clift = cdx * cdx + cdy * cdy;
+
+        det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+        double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * alift
+            + (std::fabs(cdxady) + std::fabs(adxcdy)) * blift
+            + (std::fabs(adxbdy) + std::fabs(bdxady)) * clift;
+        double errbound = ICC_ERRBOUND_A * permanent;
+        return det > errbound || -det > errbound;
+    }
+
+    // Differences are taken against the fifth point e, index 0..3 = a..d.
+    inline bool inSphereFilter(const double* ex, const double* ey, const double* ez, double& det)
+    {
+        double aexbey = ex[0] * ey[1], bexaey = ex[1] * ey[0];
+        double bexcey = ex[1] * ey[2], cexbey = ex[2] * ey[1];
+        double cexdey = ex[2] * ey[3], dexcey = ex[3] * ey[2];
+        double dexaey = ex[3] * ey[0], aexdey = ex[0] * ey[3];
+        double aexcey = ex[0] * ey[2], cexaey = ex[2] * ey[0];
+        double bexdey = ex[1] * ey[3], dexbey = ex[3] * ey[1];
+        double ab = aexbey - bexaey, bc = bexcey - cexbey, cd = cexdey - dexcey;
+        double da = dexaey - aexdey, ac = aexcey - cexaey, bd = bexdey - dexbey;
+
+        double abc = ez[0] * bc - ez[1] * ac + ez[2] * ab;
+        double bcd = ez[1] * cd - ez[2] * bd + ez[3] * bc;
+        double cda = ez[2] * da + ez[3] * ac + ez[0] * cd;
+        double dab = ez[3] * ab + ez[0] * bd + ez[1] * da;
+
+        double alift = ex[0] * ex[0] + ey[0] * ey[0] + ez[0] * ez[0];
+        double blift = ex[1] * ex[1] + ey[1] * ey[1] + ez[1] * ez[1];
+        double clift = ex[2] * ex[2] + ey[2] * ey[2] + ez[2] * ez[2];
+        double dlift = ex[3] * ex[3] + ey[3] * ey[3] + ez[3] * ez[3];
+
+        det = (dlift * abc - clift * dab) + (blift * cda - alift * bcd);
+
+        double aez = std::fabs(ez[0]), bez = std::fabs(ez[1]), cez = std::fabs(ez[2]), dez = std::fabs(ez[3]);
+        aexbey = std::fabs(aexbey); bexaey = std::fabs(bexaey);
+        bexcey = std::fabs(bexcey); cexbey = std::fabs(cexbey);
+        cexdey = std::fabs(cexdey); dexcey = std::fabs(dexcey);
+        dexaey = std::fabs(dexaey); aexdey = std::fabs(aexdey);
+        aexcey = std::fabs(aexcey); cexaey = std::fabs(cexaey);
+        bexdey = std::fabs(bexdey); dexbey = std::fabs(dexbey);
+        double permanent = ((cexdey + dexcey) * bez + (dexbey + bexdey) * cez + (bexcey + cexbey) * dez) * alift
+            + ((dexaey + aexdey) * cez + (aexcey + cexaey) * dez + (cexdey + dexcey) * aez) * blift
+            + ((aexbey + bexaey) * dez + (bexdey + dexbey) * aez + (dexaey + aexdey) * bez) * clift
+            + ((bexcey + cexbey) * aez + (cexaey + aexcey) * bez + (aexbey + bexaey) * cez) * dlift;
+        double errbound = ISP_ERRBOUND_A * permanent;
+        return det > errbound || -det > errbound;
+    }
+
+    // Difference of two 64-bit integers rounded once to double.
+    inline double roundedDifference(int64_t a, int64_t b)
+    {
+        return static_cast<double>(a - b);
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Adaptive stages.
+    // ---------------------------------------------------------------------------------------
+
+    double orient2dAdapt(const double* pa, const double* pb, const double* pc, double detsum)
+    {
+        double acx = pa[0] - pc[0];
+        double bcx = pb[0] - pc[0];
+        double acy = pa[1] - pc[1];
+        double bcy = pb[1] - pc[1];
+
+        double detleft, detlefttail, detright, detrighttail;
+        twoProduct(acx, bcy, detleft, detlefttail);
+        twoProduct(acy, bcx, detright, detrighttail);
+
+        double b[4];
+        twoTwoDiff(detleft, detlefttail, detright, detrighttail, b);
+
+        // Stage B: exact determinant of the rounded differences.
+        double det = estimate(4, b);
+        double errbound = CCW_ERRBOUND_B * detsum;
+        if (det >= errbound || -det >= errbound)
+            return det;
+
+        double acxtail = twoDiffTail(pa[0], pc[0], acx);
+        double bcxtail = twoDiffTail(pb[0], pc[0], bcx);
+        double acytail = twoDiffTail(pa[1], pc[1], acy);
+        double bcytail = twoDiffTail(pb[1], pc[1], bcy);
+
+        if (acxtail == 0.0 && acytail == 0.0 && bcxtail == 0.0 && bcytail == 0.0)
+            return det;
+
+        // Stage C: first order correction for the rounding of the differences.
+        errbound = CCW_ERRBOUND_C * detsum + RESULT_ERRBOUND * std::fabs(det);
+        det += (acx * bcytail + bcy * acxtail) - (acy * bcxtail + bcx * acytail);
+        if (det >= errbound || -det >= errbound)
+            return det;
+
+        // Stage D: exact.
+        double s1, s0, t1, t0, u[4];
+        double c1[8], c2[12], d[16];
+
+        twoProduct(acxtail, bcy, s1, s0);
+        twoProduct(acytail, bcx, t1, t0);
+        twoTwoDiff(s1, s0, t1, t0, u);
+        int c1length = expansionSum(4, b, 4, u, c1);
+
+        twoProduct(acx, bcytail, s1, s0);
+        twoProduct(acy, bcxtail, t1, t0);
+        twoTwoDiff(s1, s0, t1, t0, u);
+        int c2length = expansionSum(c1length, c1, 4, u, c2);
+
+        twoProduct(acxtail, bcytail, s1, s0);
+        twoProduct(acytail, bcxtail, t1, t0);
+        twoTwoDiff(s1, s0, t1, t0, u);
+        int dlength = expansionSum(c2length, c2, 4, u, d);
+
+        return d[dlength - 1];
+    }
+
+    double orient3dAdapt(const double* pa, const double* pb, const double* pc, const double* pd, double permanent)
+    {
+        double adx = pa[0] - pd[0], bdx = pb[0] - pd[0], cdx = pc[0] - pd[0];
+        double ady = pa[1] - pd[1], bdy = pb[1] - pd[1], cdy = pc[1] - pd[1];
+        double adz = pa[2] - pd[2], bdz = pb[2] - pd[2], cdz = pc[2] - pd[2];
+
+        double s1, s0, t1, t0;
+        double bc[4], ca[4], ab[4];
+        double adet[8], bdet[8], cdet[8], abdet[16], fin[24];
+
+        twoProduct(bdx, cdy, s1, s0);
+        twoProduct(cdx, bdy, t1, t0);
+        twoTwoDiff(s1, s0, t1, t0, bc);
+        int alen = expansionScale(4, bc, adz, adet);
+
+        twoProduct(cdx, ady, s1, s0);
+        twoProduct(adx, cdy, t1, t0);
+        twoTwoDiff(s1, s0, t1, t0, ca);
+        int blen = expansionScale(4, ca, bdz, bdet);
+
+        twoProduct(adx, bdy, s1, s0);
+        twoProduct(bdx, ady, t1, t0);
+        twoTwoDiff(s1, s0, t1, t0, ab);
+        int clen = expansionScale(4, ab, cdz, cdet);
+
+        int ablen = expansionSum(alen, adet, blen, bdet, abdet);
+        int finlength = expansionSum(ablen, abdet, clen, cdet, fin);
+
+        // Stage B: exact determinant of the rounded differences.
+        double det = estimate(finlength, fin);
+        double errbound = O3D_ERRBOUND_B * permanent;
+        if (det >= errbound || -det >= errbound)
+            return det;
+
+        double adxtail = twoDiffTail(pa[0], pd[0], adx);
+        double bdxtail = twoDiffTail(pb[0], pd[0], bdx);
+        double cdxtail = twoDiffTail(pc[0], pd[0], cdx);
+        double adytail = twoDiffTail(pa[1], pd[1], ady);
+        double bdytail = twoDiffTail(pb[1], pd[1], bdy);
+        double cdytail = twoDiffTail(pc[1], pd[1], cdy);
+        double adztail = twoDiffTail(pa[2], pd[2], adz);
+        double bdztail = twoDiffTail(pb[2], pd[2], bdz);
+        double cdztail = twoDiffTail(pc[2], pd[2], cdz);
+
+        if (adxtail == 0.0 && bdxtail == 0.0 && cdxtail == 0.0
+            && adytail == 0.0 && bdytail == 0.0 && cdytail == 0.0
+            && adztail == 0.0 && bdztail == 0.0 && cdztail == 0.0)
+            return det;
+
+        // Stage C: first order correction for the rounding of the differences.
+        errbound = O3D_ERRBOUND_C * permanent + RESULT_ERRBOUND * std::fabs(det);
+        det += (adz * ((bdx * cdytail + cdy * bdxtail) - (bdy * cdxtail + cdx * bdytail)) + adztail * (bdx * cdy - bdy * cdx))
+            + (bdz * ((cdx * adytail + ady * cdxtail) - (cdy * adxtail + adx * cdytail)) + bdztail * (cdx * ady - cdy * adx))
+            + (cdz * ((adx * bdytail + bdy * adxtail) - (ady * bdxtail + bdx * adytail)) + cdztail * (adx * bdy - ady * bdx));
+        if (det >= errbound || -det >= errbound)
+            return det;
+
+        // Stage D: exact.
+        return orient3dExact(pa, pb, pc, pd);
+    }
+}
+
+scaleGeom::PredicateStats scaleGeom::predicateStats()
+{
+#if !defined(SCALEGEOM_NO_PREDICATE_STATS)
+    return stats;
+#else
+    return PredicateStats();
+#endif
+}
+
+void scaleGeom::resetPredicateStats()
+{
+#if !defined(SCALEGEOM_NO_PREDICATE_STATS)
+    stats = PredicateStats();
+#endif
+}
+
+double scaleGeom::orient2d(const double* pa, const double* pb, const double* pc)
+{
+    SCALEGEOM_COUNT(orient2d, calls);
+
+    double detleft = (pa[0] - pc[0]) * (pb[1] - pc[1]);
+    double detright = (pa[1] - pc[1]) * (pb[0] - pc[0]);
+    double det = detleft - detright;
+
+    // Branch-light form of the filter: when the products have different signs |det| already
+    // equals detsum up to rounding and the test passes, so no separate sign test is needed.
+    double detsum = std::fabs(detleft) + std::fabs(detright);
+    double errbound = CCW_ERRBOUND_A * detsum;
+    if (det >= errbound || -det >= errbound)
+        return det;
+
+    SCALEGEOM_COUNT(orient2d, slowPath);
+    return orient2dAdapt(pa, pb, pc, detsum);
+}
+
+double scaleGeom::orient3d(const double* pa, const double* pb, const double* pc, const double* pd)
+{
+    SCALEGEOM_COUNT(orient3d, calls);
+
+    double adx = pa[0] - pd[0], bdx = pb[0] - pd[0], cdx = pc[0] - pd[0];
+    double ady = pa[1] - pd[1], bdy = pb[1] - pd[1], cdy = pc[1] - pd[1];
+    double adz = pa[2] - pd[2], bdz = pb[2] - pd[2], cdz = pc[2] - pd[2];
+
+    double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    double cdxady = cdx * ady, adxcdy = adx * cdy;
+    double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+    double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+
+    double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * std::fabs(adz)
+        + (std::fabs(cdxady) + std::fabs(adxcdy)) * std::fabs(bdz)
+        + (std::fabs(adxbdy) + std::fabs(bdxady)) * std::fabs(cdz);
+    double errbound = O3D_ERRBOUND_A * permanent;
+    if (det > errbound || -det > errbound)
+        return det;
+
+    SCALEGEOM_COUNT(orient3d, slowPath);
+    return orient3dAdapt(pa, pb, pc, pd, permanent);
+}
+
+double scaleGeom::inCircle(const double* pa, const double* pb, const double* pc, const double* pd)
+{
+    SCALEGEOM_COUNT(inCircle, calls);
+
+    double det;
+    if (inCircleFilter(pa[0] - pd[0], pa[1] - pd[1], pb[0] - pd[0], pb[1] - pd[1], pc[0] - pd[0], pc[1] - pd[1], det))
+        return det;
+
+    SCALEGEOM_COUNT(inCircle, slowPath);
+    return inCircleExact(pa, pb, pc, pd);
+}
+
+double scaleGeom::inSphere(const double* pa, const double* pb, const double* pc, const double* pd, const double* pe)
+{
+    SCALEGEOM_COUNT(inSphere, calls);
+
+    const double* points[4] = { pa, pb, pc, pd };
+    double ex[4], ey[4], ez[4];
+    for (int i = 0; i < 4; i++)
+    {
+        ex[i] = points[i][0] - pe[0];
+        ey[i] = points[i][1] - pe[1];
+        ez[i] = points[i][2] - pe[2];
+    }
+    double det;
+    if (inSphereFilter(ex, ey, ez, det))
+        return det;
+
+    SCALEGEOM_COUNT(inSphere, slowPath);
+    return inSphereExact(pa, pb, pc, pd, pe);
+}
+
+double scaleGeom::orient2d(const int64_t* pa, const int64_t* pb, const int64_t* pc)
+{
+    SCALEGEOM_COUNT(orient2d, calls);
+
+    double acx = roundedDifference(pa[0], pc[0]), bcx = roundedDifference(pb[0], pc[0]);
+    double acy = roundedDifference(pa[1], pc[1]), bcy = roundedDifference(pb[1], pc[1]);
+    double detleft = acx * bcy;
+    double detright = acy * bcx;
+    double det = detleft - detright;
+    double errbound = CCW_ERRBOUND_A * (std::fabs(detleft) + std::fabs(detright));
+    if (det >= errbound || -det >= errbound)
+        return det;
+
+    SCALEGEOM_COUNT(orient2d, slowPath);
+    arena.reset();
+    return orient2dExact(difference(pa[0], pc[0]), difference(pa[1], pc[1]), difference(pb[0], pc[0]), difference(pb[1], pc[1]));
+}
+
+double scaleGeom::orient3d(const int64_t* pa, const int64_t* pb, const int64_t* pc, const int64_t* pd)
+{
+    SCALEGEOM_COUNT(orient3d, calls);
+
+    double adx = roundedDifference(pa[0], pd[0]), bdx = roundedDifference(pb[0], pd[0]), cdx = roundedDifference(pc[0], pd[0]);
+    double ady = roundedDifference(pa[1], pd[1]), bdy = roundedDifference(pb[1], pd[1]), cdy = roundedDifference(pc[1], pd[1]);
+    double adz = roundedDifference(pa[2], pd[2]), bdz = roundedDifference(pb[2], pd[2]), cdz = roundedDifference(pc[2], pd[2]);
+
+    double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    double cdxady = cdx * ady, adxcdy = adx * cdy;
+    double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+    double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+    double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * std::fabs(adz)
+        + (std::fabs(cdxady) + std::fabs(adxcdy)) * std::fabs(bdz)
+        + (std::fabs(adxbdy) + std::fabs(bdxady)) * std::fabs(cdz);
+    double errbound = O3D_ERRBOUND_A * permanent;
+    if (det > errbound || -det > errbound)
+        return det;
+
+    SCALEGEOM_COUNT(orient3d, slowPath);
+    return orient3dExact(pa, pb, pc, pd);
+}
+
+double scaleGeom::inCircle(const int64_t* pa, const int64_t* pb, const int64_t* pc, const int64_t* pd)
+{
+    SCALEGEOM_COUNT(inCircle, calls);
+
+    double det;
+    if (inCircleFilter(roundedDifference(pa[0], pd[0]), roundedDifference(pa[1], pd[1]), roundedDifference(pb[0], pd[0]),
+        roundedDifference(pb[1], pd[1]), roundedDifference(pc[0], pd[0]), roundedDifference(pc[1], pd[1]), det))
+        return det;
+
+    SCALEGEOM_COUNT(inCircle, slowPath);
+    return inCircleExact(pa, pb, pc, pd);
+}
+
+double scaleGeom::inSphere(const int64_t* pa, const int64_t* pb, const int64_t* pc, const int64_t* pd, const int64_t* pe)
+{
+    SCALEGEOM_COUNT(inSphere, calls);
+
+    const int64_t* points[4] = { pa, pb, pc, pd };
+    double ex[4], ey[4], ez[4];
+    for (int i = 0; i < 4; i++)
+    {
+        ex[i] = roundedDifference(points[i][0], pe[0]);
+        ey[i] = roundedDifference(points[i][1], pe[1]);
+        ez[i] = roundedDifference(points[i][2], pe[2]);
+    }
+    double det;
+    if (inSphereFilter(ex, ey, ez, det))
+        return det;
+
+    SCALEGEOM_COUNT(inSphere, slowPath);
+    return inSphereExact(pa, pb, pc, pd, pe);
+}
@@ -0,0 +1,184 @@
+/*
+	Predicates.h - Robust Geometric Predicates
+
+	Overview:
+	crossProduct2D and scalarTripleProduct evaluated in float (or even double) can return the
+	wrong sign for nearly collinear or nearly coplanar input, which makes hull and triangulation
+	code inconsistent. The predicates in this header return a value whose SIGN is always exact,
+	following Shewchuk's adaptive-precision scheme:
+
+	1. A fast double precision evaluation with a dynamic error bound (the filter). This decides
+	   the vast majority of calls.
+	2. If the filter cannot certify the sign, the determinant is re-evaluated with expansion
+	   arithmetic in stages of increasing precision, stopping as soon as the sign is certain and
+	   ending with an exact evaluation.
+
+	Float inputs are promoted to double, which is exact. The magnitude of the returned value is
+	only an approximation of the determinant; use it for the sign.
+
+	The same filter-then-exact design is used for the in-circle and in-sphere tests that Delaunay
+	construction needs. The Vector templates pick the cheapest exact path for the coordinate
+	type: float, double and integers of up to 32 bits are exactly representable in double and go
+	through the adaptive double path; 64-bit integers are differenced exactly in integer
+	arithmetic and the exact stage works on the split differences. 64-bit coordinates must lie
+	in [-2^61, 2^61] so that their differences do not overflow.
+
+	Sign conventions:
+	- orient2d(a, b, c) > 0 if a, b, c are in counterclockwise order, < 0 if clockwise and 0 if
+	  collinear. It has the sign of crossProduct2D(b - a, c - a).
+	- orient3d(a, b, c, d) > 0 if d lies below the plane through a, b, c, where "below" is the
+	  side from which a, b, c appear clockwise. It has the sign of
+	  -scalarTripleProduct(b - a, c - a, d - a).
+	- inCircle(a, b, c, d) > 0 if d lies inside the circle through a, b, c, < 0 if outside and
+	  0 if the four points are cocircular, provided a, b, c are counterclockwise. The sign is
+	  reversed when they are clockwise.
+	- inSphere(a, b, c, d, e) > 0 if e lies inside the sphere through a, b, c, d, provided
+	  orient3d(a, b, c, d) > 0. The sign is reversed when orient3d(a, b, c, d) < 0.
+
+	Counters:
+	Every call is counted per thread together with the number of calls that needed the slow
+	(adaptive) path, see predicateStats(). Define SCALEGEOM_NO_PREDICATE_STATS to compile the
+	counters out.
+
+	Requirements:
+	IEEE 754 double arithmetic with round-to-nearest. Do not build with -ffast-math / fp:fast,
+	which breaks the error-free transformations the exact stages rely on.
+
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	// Call counts of one predicate.
+	struct PredicateCounter
+	{
+		// Total number of evaluations.
+		uint64_t calls;
+
+		// Evaluations the floating-point filter could not decide.
+		uint64_t slowPath;
+
+		// Fraction of calls that took the slow path.
+		double slowPathRatio() const { return calls ? static_cast<double>(slowPath) / calls : 0.0; }
+	};
+
+	// Counters of all predicates for the calling thread.
+	struct PredicateStats
+	{
+		PredicateCounter orient2d;
+		PredicateCounter orient3d;
+		PredicateCounter inCircle;
+		PredicateCounter inSphere;
+	};
+
+	// Counters accumulated by the calling thread since it started or since the last reset.
+	PredicateStats predicateStats();
+
+	// Reset the counters of the calling thread.
+	void resetPredicateStats();
+
+	// Orientation of three 2D points given as {x, y} arrays.
+	double orient2d(const double* pa, const double* pb, const double* pc);
+	double orient2d(const int64_t* pa, const int64_t* pb, const int64_t* pc);
+
+	// Orientation of four 3D points given as {x, y, z} arrays.
+	double orient3d(const double* pa, const double* pb, const double* pc, const double* pd);
+	double orient3d(const int64_t* pa, const int64_t* pb, const int64_t* pc, const int64_t* pd);
+
+	// Position of pd relative to the circle through pa, pb, pc.
+	double inCircle(const double* pa, const double* pb, const double* pc, const double* pd);
+	double inCircle(const int64_t* pa, const int64_t* pb, const int64_t* pc, const int64_t* pd);
+
+	// Position of pe relative to the sphere through pa, pb, pc, pd.
+	double inSphere(const double* pa, const double* pb, const double* pc, const double* pd, const double* pe);
+	double inSphere(const int64_t* pa, const int64_t* pb, const int64_t* pc, const int64_t* pd, const int64_t* pe);
+
+	// Coordinate type used to evaluate predicates on Vectors of a given coordinate type:
+	// int64_t for 64-bit integers, double for everything else.
+	template<class coordDataType>
+	struct PredicateInput
+	{
+		typedef typename std::conditional<std::is_integral<coordDataType>::value && (sizeof(coordDataType) > 4), int64_t, double>::type type;
+	};
+
+	// Copy the coordinates of a Vector into the array form the predicates take.
+	template<class coordDataType, size_t dimension>
+	void toPredicateInput(const Vector<coordDataType, dimension>& v, typename PredicateInput<coordDataType>::type* out)
+	{
+		for (size_t i = 0; i < dimension; i++)
+		{
+			out[i] = static_cast<typename PredicateInput<coordDataType>::type>(v[i]);
+		}
+	}
+
+	// Orientation of three 2D points.
+	template<class coordDataType>
+	double orient2d(const Vector<coordDataType, DIM2>& a, const Vector<coordDataType, DIM2>& b, const Vector<coordDataType, DIM2>& c)
+	{
+		typename PredicateInput<coordDataType>::type pa[2], pb[2], pc[2];
+		toPredicateInput(a, pa);
+		toPredicateInput(b, pb);
+		toPredicateInput(c, pc);
+		return orient2d(pa, pb, pc);
+	}
+
+	// Orientation of four 3D points.
+	template<class coordDataType>
+	double orient3d(const Vector<coordDataType, DIM3>& a, const Vector<coordDataType, DIM3>& b, const Vector<coordDataType, DIM3>& c, const Vector<coordDataType, DIM3>& d)
+	{
+		typename PredicateInput<coordDataType>::type pa[3], pb[3], pc[3], pd[3];
+		toPredicateInput(a, pa);
+		toPredicateInput(b, pb);
+		toPredicateInput(c, pc);
+		toPredicateInput(d, pd);
+		return orient3d(pa, pb, pc, pd);
+	}
+
+	// Position of d relative to the circle through a, b, c.
+	template<class coordDataType>
+	double inCircle(const Vector<coordDataType, DIM2>& a, const Vector<coordDataType, DIM2>& b, const Vector<coordDataType, DIM2>& c, const Vector<coordDataType, DIM2>& d)
+	{
+		typename PredicateInput<coordDataType>::type pa[2], pb[2], pc[2], pd[2];
+		toPredicateInput(a, pa);
+		toPredicateInput(b, pb);
+		toPredicateInput(c, pc);
+		toPredicateInput(d, pd);
+		return inCircle(pa, pb, pc, pd);
+	}
+
+	// Position of e relative to the sphere through a, b, c, d.
+	template<class coordDataType>
+	double inSphere(const Vector<coordDataType, DIM3>& a, const Vector<coordDataType, DIM3>& b, const Vector<coordDataType, DIM3>& c, const Vector<coordDataType, DIM3>& d, const Vector<coordDataType, DIM3>& e)
+	{
+		typename PredicateInput<coordDataType>::type pa[3], pb[3], pc[3], pd[3], pe[3];
+		toPredicateInput(a, pa);
+		toPredicateInput(b, pb);
+		toPredicateInput(c, pc);
+		toPredicateInput(d, pd);
+		toPredicateInput(e, pe);
+		return inSphere(pa, pb, pc, pd, pe);
+	}
+
+	// Exact sign (-1, 0 or +1) of the 2D orientation.
+	template<class coordDataType>
+	int orient2dSign(const Vector<coordDataType, DIM2>& a, const Vector<coordDataType, DIM2>& b, const Vector<coordDataType, DIM2>& c)
+	{
+		double det = orient2d(a, b, c);
+		return (det > 0) - (det < 0);
+	}
+
+	// Exact sign (-1, 0 or +1) of the 3D orientation.
+	template<class coordDataType>
+	int orient3dSign(const Vector<coordDataType, DIM3>& a, const Vector<coordDataType, DIM3>& b, const Vector<coordDataType, DIM3>& c, const Vector<coordDataType, DIM3>& d)
+	{
+		double det = orient3d(a, b, c, d);
+		return (det > 0) - (det < 0);
+	}
+
+} // Closing the scaleGeom namespace.
@@ -0,0 +1,254 @@
+#include "Benchmark.h"
+#include "Predicates.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+using scaleGeom::DIM2;
+using scaleGeom::DIM3;
+using scaleGeom::X;
+using scaleGeom::Y;
+using scaleGeom::Z;
+
+namespace {
+
+    void report(const char* label, double seconds, size_t calls, const scaleGeom::PredicateCounter& counter)
+    {
+        std::cout << "  " << std::left << std::setw(40) << label << std::right
+            << std::setw(8) << std::fixed << std::setprecision(1) << calls / seconds / 1e6 << " Mcalls/s";
+        if (counter.calls)
+            std::cout << "  slow path " << std::setw(8) << std::setprecision(4) << counter.slowPathRatio() * 100.0 << " %";
+        std::cout << std::endl;
+    }
+
+    // Input families: independent random points, points rounded onto a line/plane (float rounding
+    // keeps them slightly off it) and points placed exactly on it.
+    enum Mode { RANDOM, NEARLY_DEGENERATE, EXACTLY_DEGENERATE };
+    const char* const MODE_NAMES[] = { "random", "nearly degenerate", "exactly degenerate" };
+
+    std::vector<scaleGeom::Vector2f> makeTriples(size_t count, Mode mode)
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+        std::uniform_real_distribution<float> param(0.0f, 1.0f);
+        std::vector<scaleGeom::Vector2f> points(3 * count);
+        for (size_t i = 0; i < count; i++)
+        {
+            scaleGeom::Vector2f a(dist(rng), dist(rng)), b(dist(rng), dist(rng));
+            scaleGeom::Vector2f c(dist(rng), dist(rng));
+            if (mode == NEARLY_DEGENERATE)
+            {
+                float t = param(rng);
+                c = scaleGeom::Vector2f(a[X] + t * (b[X] - a[X]), a[Y] + t * (b[Y] - a[Y]));
+            }
+            else if (mode == EXACTLY_DEGENERATE)
+            {
+                // Integer coordinates and a dyadic parameter make every operation exact.
+                a = scaleGeom::Vector2f(std::floor(a[X]), std::floor(a[Y]));
+                b = scaleGeom::Vector2f(std::floor(b[X]), std::floor(b[Y]));
+                float t = std::floor(param(rng) * 8.0f) * 0.125f;
+                c = scaleGeom::Vector2f(a[X] + t * (b[X] - a[X]), a[Y] + t * (b[Y] - a[Y]));
+            }
+            points[3 * i] = a;
+            points[3 * i + 1] = b;
+            points[3 * i + 2] = c;
+        }
+        return points;
+    }
+
+    std::vector<scaleGeom::Vector3f> makeQuads(size_t count, Mode mode)
+    {
+        std::mt19937 rng(43);
+        std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+        std::uniform_real_distribution<float> param(0.0f, 1.0f);
+        std::vector<scaleGeom::Vector3f> points(4 * count);
+        for (size_t i = 0; i < count; i++)
+        {
+            scaleGeom::Vector3f a(dist(rng), dist(rng), dist(rng)), b(dist(rng), dist(rng), dist(rng)), c(dist(rng), dist(rng), dist(rng));
+            scaleGeom::Vector3f d(dist(rng), dist(rng), dist(rng));
+            if (mode == EXACTLY_DEGENERATE)
+            {
+                a = scaleGeom::Vector3f(std::floor(a[X]), std::floor(a[Y]), std::floor(a[Z]));
+                b = scaleGeom::Vector3f(std::floor(b[X]), std::floor(b[Y]), std::floor(b[Z]));
+                c = scaleGeom::Vector3f(std::floor(c[X]), std::floor(c[Y]), std::floor(c[Z]));
+            }
+            if (mode != RANDOM)
+            {
+                float s = param(rng), t = param(rng);
+                if (mode == EXACTLY_DEGENERATE)
+                {
+                    s = std::floor(s * 8.0f) * 0.125f;
+                    t = std::floor(t * 8.0f) * 0.125f;
+                }
+                d = scaleGeom::Vector3f(a[X] + s * (b[X] - a[X]) + t * (c[X] - a[X]),
+                    a[Y] + s * (b[Y] - a[Y]) + t * (c[Y] - a[Y]),
+                    a[Z] + s * (b[Z] - a[Z]) + t * (c[Z] - a[Z]));
+            }
+            points[4 * i] = a;
+            points[4 * i + 1] = b;
+            points[4 * i + 2] = c;
+            points[4 * i + 3] = d;
+        }
+        return points;
+    }
+}
+
+SCALEGEOM_BENCHMARK(OrientationPredicates)
+{
+    const size_t count = scaleGeom::bench::problemSize(2000000);
+    std::cout << "  calls per case: " << count << std::endl;
+    double sum = 0;
+
+    for (int mode = RANDOM; mode <= EXACTLY_DEGENERATE; mode++)
+    {
+        std::vector<scaleGeom::Vector2f> triples = makeTriples(count, static_cast<Mode>(mode));
+
+        Timer timer;
+        for (size_t i = 0; i < count; i++)
+        {
+            sum += scaleGeom::crossProduct2D(triples[3 * i + 1] - triples[3 * i], triples[3 * i + 2] - triples[3 * i]);
+        }
+        double seconds = timer.seconds();
+        scaleGeom::PredicateCounter none = { 0, 0 };
+        report(("crossProduct2D, " + std::string(MODE_NAMES[mode])).c_str(), seconds, count, none);
+
+        scaleGeom::resetPredicateStats();
+        timer.reset();
+        for (size_t i = 0; i < count; i++)
+        {
+            sum += scaleGeom::orient2d(triples[3 * i], triples[3 * i + 1], triples[3 * i + 2]);
+        }
+        seconds = timer.seconds();
+        report(("orient2d, " + std::string(MODE_NAMES[mode])).c_str(), seconds, count, scaleGeom::predicateStats().orient2d);
+    }
+
+    for (int mode = RANDOM; mode <= EXACTLY_DEGENERATE; mode++)
+    {
+        std::vector<scaleGeom::Vector3f> quads = makeQuads(count, static_cast<Mode>(mode));
+
+        Timer timer;
+        for (size_t i = 0; i < count; i++)
+        {
+            const scaleGeom::Vector3f& a = quads[4 * i];
+            sum += scaleGeom::scalarTripleProduct(quads[4 * i + 1] - a, quads[4 * i + 2] - a, quads[4 * i + 3] - a);
+        }
+        double seconds = timer.seconds();
+        scaleGeom::PredicateCounter none = { 0, 0 };
+        report(("scalarTripleProduct, " + std::string(MODE_NAMES[mode])).c_str(), seconds, count, none);
+
+        scaleGeom::resetPredicateStats();
+        timer.reset();
+        for (size_t i = 0; i < count; i++)
+        {
+            sum += scaleGeom::orient3d(quads[4 * i], quads[4 * i + 1], quads[4 * i + 2], quads[4 * i + 3]);
+        }
+        seconds = timer.seconds();
+        report(("orient3d, " + std::string(MODE_NAMES[mode])).c_str(), seconds, count, scaleGeom::predicateStats().orient3d);
+    }
+    scaleGeom::bench::doNotOptimize(&sum);
+}
+
+namespace {
+
+    // Quadruples from an integer grid: the corners of every grid cell (exactly cocircular), mixed
+    // with random grid points (mostly in general position, some cocircular by chance).
+    template<class coordDataType>
+    std::vector<scaleGeom::Vector<coordDataType, DIM2>> makeGridQuadruples(size_t count, int gridSize)
+    {
+        typedef scaleGeom::Vector<coordDataType, DIM2> Point;
+        std::mt19937 rng(44);
+        std::uniform_int_distribution<int> cell(0, gridSize - 2), any(0, gridSize - 1);
+        std::vector<Point> points(4 * count);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i % 2 == 0)
+            {
+                coordDataType x = static_cast<coordDataType>(cell(rng)), y = static_cast<coordDataType>(cell(rng));
+                points[4 * i] = Point(x, y);
+                points[4 * i + 1] = Point(x + 1, y);
+                points[4 * i + 2] = Point(x + 1, y + 1);
+                points[4 * i + 3] = Point(x, y + 1);
+            }
+            else
+            {
+                for (int k = 0; k < 4; k++)
+                {
+                    points[4 * i + k] = Point(static_cast<coordDataType>(any(rng)), static_cast<coordDataType>(any(rng)));
+                }
+            }
+        }
+        return points;
+    }
+
+    // Quintuples from an integer grid: five corners of a grid cube (exactly cospherical), mixed with random grid points.
+    template<class coordDataType>
+    std::vector<scaleGeom::Vector<coordDataType, DIM3>> makeGridQuintuples(size_t count, int gridSize)
+    {
+        typedef scaleGeom::Vector<coordDataType, DIM3> Point;
+        std::mt19937 rng(45);
+        std::uniform_int_distribution<int> cell(0, gridSize - 2), any(0, gridSize - 1);
+        const int corners[5][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, { 1, 1, 1 } };
+        std::vector<Point> points(5 * count);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i % 2 == 0)
+            {
+                int x = cell(rng), y = cell(rng), z = cell(rng);
+                for (int k = 0; k < 5; k++)
+                {
+                    points[5 * i + k] = Point(static_cast<coordDataType>(x + corners[k][0]), static_cast<coordDataType>(y + corners[k][1]), static_cast<coordDataType>(z + corners[k][2]));
+                }
+            }
+            else
+            {
+                for (int k = 0; k < 5; k++)
+                {
+                    points[5 * i + k] = Point(static_cast<coordDataType>(any(rng)), static_cast<coordDataType>(any(rng)), static_cast<coordDataType>(any(rng)));
+                }
+            }
+        }
+        return points;
+    }
+
+    template<class coordDataType>
+    void runGridCase(const char* typeName, size_t count)
+    {
+        std::vector<scaleGeom::Vector<coordDataType, DIM2>> quads = makeGridQuadruples<coordDataType>(count, 1024);
+        double sum = 0;
+        scaleGeom::resetPredicateStats();
+        Timer timer;
+        for (size_t i = 0; i < count; i++)
+        {
+            sum += scaleGeom::inCircle(quads[4 * i], quads[4 * i + 1], quads[4 * i + 2], quads[4 * i + 3]);
+        }
+        double seconds = timer.seconds();
+        report(("inCircle<" + std::string(typeName) + ">, cocircular grid").c_str(), seconds, count, scaleGeom::predicateStats().inCircle);
+
+        std::vector<scaleGeom::Vector<coordDataType, DIM3>> quints = makeGridQuintuples<coordDataType>(count, 256);
+        scaleGeom::resetPredicateStats();
+        timer.reset();
+        for (size_t i = 0; i < count; i++)
+        {
+            sum += scaleGeom::inSphere(quints[5 * i], quints[5 * i + 1], quints[5 * i + 2], quints[5 * i + 3], quints[5 * i + 4]);
+        }
+        seconds = timer.seconds();
+        report(("inSphere<" + std::string(typeName) + ">, cospherical grid").c_str(), seconds, count, scaleGeom::predicateStats().inSphere);
+        scaleGeom::bench::doNotOptimize(&sum);
+    }
+}
+
+SCALEGEOM_BENCHMARK(InCircleInSphereDegenerateGrids)
+{
+    // Half of the queries are exactly degenerate, so the slow path ratio is close to 50 %;
+    // every other query must be settled by the filter.
+    const size_t count = scaleGeom::bench::problemSize(1000000);
+    std::cout << "  calls per case: " << count << std::endl;
+    runGridCase<float>("float", count);
+    runGridCase<double>("double", count);
+    runGridCase<int64_t>("int64_t", count);
+}
@@ -0,0 +1,703 @@
+#include "SegmentIntersection.h"
+#include "ExactArithmetic.h"
+#include "Parallel.h"
+#include "Predicates.h"
+#include "VectorOrder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+    using namespace scaleGeom::exact;
+
+    const uint32_t NONE = 0xffffffffu;
+
+    // Chunks smaller than this are not worth a thread of their own when preparing the input.
+    const size_t MIN_CHUNK = 1 << 16;
+
+    // Relative error bound of a 2x2 determinant of coordinate differences rounded to double,
+    // with a factor of two to spare.
+    const double DETERMINANT_ERRBOUND = 8.0 * EPSILON;
+
+    // Crossings whose parameter along the first segment is less certain than this are computed exactly.
+    const double REFINE_THRESHOLD = 1e-6;
+
+    // Segment roles at the current event point.
+    const uint8_t STARTS = 1;
+    const uint8_t ENDS = 2;
+
+    inline bool samePoint(const double* p, const double* q)
+    {
+        return p[0] == q[0] && p[1] == q[1];
+    }
+
+    inline bool lexicographicLess(const double* p, const double* q)
+    {
+        return p[0] < q[0] || (p[0] == q[0] && p[1] < q[1]);
+    }
+
+    inline int signOf(double value)
+    {
+        return (value > 0.0) - (value < 0.0);
+    }
+
+    // A crossing of two segments waiting in the event queue: its point rounded to double and a bound
+    // on the error of each coordinate.
+    struct Crossing
+    {
+        double point[2];
+        double error[2];
+        uint32_t s, t;
+    };
+
+    inline int signOf(const Expansion& e)
+    {
+        return signOf(e.sign());
+    }
+
+    // Exact coordinate along axis of the crossing of a-b and c-d as numerator / denominator:
+    // a + (b - a) * cross(c - a, d - c) / cross(b - a, d - c).
+    void crossingFraction(const double* a, const double* b, const double* c, const double* d, int axis, Expansion& numerator, Expansion& denominator)
+    {
+        Expansion ex = difference(b[0], a[0]), ey = difference(b[1], a[1]);
+        Expansion fx = difference(d[0], c[0]), fy = difference(d[1], c[1]);
+        denominator = ex * fy - ey * fx;
+        Expansion n = difference(c[0], a[0]) * fy - difference(c[1], a[1]) * fx;
+        numerator = value(a[axis]) * denominator + (axis == 0 ? ex : ey) * n;
+    }
+
+    // Crossing of the segments a-b and c-d, which must cross properly. Nearly parallel segments, whose
+    // crossing the double computation cannot place, are computed from the exact fraction.
+    Crossing estimateCrossing(const double* a, const double* b, const double* c, const double* d, uint32_t s, uint32_t t)
+    {
+        const double ex = b[0] - a[0], ey = b[1] - a[1];
+        const double fx = d[0] - c[0], fy = d[1] - c[1];
+        const double gx = c[0] - a[0], gy = c[1] - a[1];
+        const double den = ex * fy - ey * fx;
+        const double num = gx * fy - gy * fx;
+        const double denError = DETERMINANT_ERRBOUND * (std::fabs(ex * fy) + std::fabs(ey * fx));
+        const double numError = DETERMINANT_ERRBOUND * (std::fabs(gx * fy) + std::fabs(gy * fx));
+
+        Crossing result;
+        result.s = s;
+        result.t = t;
+        const double u = std::min(std::max(num / den, 0.0), 1.0);
+        const double slack = std::fabs(den) - denError;
+        const double uError = slack > 0.0 ? (std::fabs(num) * denError + std::fabs(den) * numError) / (std::fabs(den) * slack) + 2.0 * EPSILON * u
+            : std::numeric_limits<double>::infinity();
+        for (int axis = 0; axis < 2; axis++)
+        {
+            const double e = axis == 0 ? ex : ey;
+            double p, error;
+            if (uError < REFINE_THRESHOLD)
+            {
+                p = a[axis] + e * u;
+                error = (e != 0.0 ? std::fabs(e) * uError : 0.0) + 4.0 * EPSILON * (std::fabs(e * u) + std::fabs(p));
+            }
+            else
+            {
+                arena.reset();
+                Expansion numerator, denominator;
+                crossingFraction(a, b, c, d, axis, numerator, denominator);
+                p = estimate(numerator.length, numerator.terms) / estimate(denominator.length, denominator.terms);
+                error = 8.0 * EPSILON * std::fabs(p);
+            }
+            const double low = std::max(std::min(a[axis], b[axis]), std::min(c[axis], d[axis]));
+            const double high = std::min(std::max(a[axis], b[axis]), std::max(c[axis], d[axis]));
+            result.point[axis] = std::min(std::max(p, low), high);
+            result.error[axis] = error;
+        }
+        return result;
+    }
+
+    // Blocked list of segment indices, bottom to top. Positions are (rank of the block, index in it).
+    class SweepStatus
+    {
+        static const uint32_t CAPACITY = 128;
+
+        // Blocks below this size are merged with a neighbour; rebuilt blocks are filled to about 3/4.
+        static const uint32_t MIN_FILL = CAPACITY / 8;
+        static const uint32_t TARGET_FILL = CAPACITY * 3 / 4;
+
+        struct Block
+        {
+            uint32_t count;
+            uint32_t rank;
+            uint32_t items[CAPACITY];
+        };
+
+        std::vector<Block> blocks;
+        std::vector<uint32_t> freeBlocks;
+        std::vector<uint32_t> order;
+        std::vector<uint32_t> blockOf;
+        std::vector<uint32_t> buffer;
+        size_t total = 0;
+
+        uint32_t newBlock()
+        {
+            if (!freeBlocks.empty())
+            {
+                uint32_t id = freeBlocks.back();
+                freeBlocks.pop_back();
+                return id;
+            }
+            blocks.emplace_back();
+            return static_cast<uint32_t>(blocks.size() - 1);
+        }
+
+    public:
+
+        struct Position
+        {
+            uint32_t rank, index;
+
+            bool operator<(const Position& other) const
+            {
+                return rank < other.rank || (rank == other.rank && index < other.index);
+            }
+        };
+
+        explicit SweepStatus(size_t segmentCount) : blockOf(segmentCount, NONE) {}
+
+        size_t size() const { return total; }
+
+        bool valid(Position p) const { return p.rank < order.size(); }
+
+        uint32_t at(Position p) const { return blocks[order[p.rank]].items[p.index]; }
+
+        Position next(Position p) const
+        {
+            if (++p.index == blocks[order[p.rank]].count)
+            {
+                p.rank++;
+                p.index = 0;
+            }
+            return p;
+        }
+
+        // Step p back by one; false at the bottom.
+        bool previous(Position& p) const
+        {
+            if (p.index > 0)
+            {
+                p.index--;
+                return true;
+            }
+            if (p.rank == 0)
+                return false;
+            p.rank--;
+            p.index = blocks[order[p.rank]].count - 1;
+            return true;
+        }
+
+        Position locate(uint32_t segment) const
+        {
+            const Block& block = blocks[blockOf[segment]];
+            const uint32_t index = static_cast<uint32_t>(std::find(block.items, block.items + block.count, segment) - block.items);
+            return { block.rank, index };
+        }
+
+        // First position whose segment is not below(segment); below must be true on a prefix of the status.
+        template<class Below>
+        Position lowerBound(Below below) const
+        {
+            size_t low = 0, high = order.size();
+            while (low < high)
+            {
+                const size_t middle = (low + high) / 2;
+                const Block& block = blocks[order[middle]];
+                if (below(block.items[block.count - 1]))
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            if (low == order.size())
+                return { static_cast<uint32_t>(low), 0 };
+            const Block& block = blocks[order[low]];
+            uint32_t first = 0, last = block.count - 1;
+            while (first < last)
+            {
+                const uint32_t middle = (first + last) / 2;
+                if (below(block.items[middle]))
+                    first = middle + 1;
+                else
+                    last = middle;
+            }
+            return { static_cast<uint32_t>(low), first };
+        }
+
+        // Replace the eraseCount segments from first on by items[0, count).
+        void replace(Position first, size_t eraseCount, const uint32_t* items, size_t count)
+        {
+            if (eraseCount == 0 && count == 0)
+                return;
+            total += count;
+            total -= eraseCount;
+
+            // Appending at the top goes into the last block.
+            if (!valid(first))
+            {
+                if (order.empty())
+                {
+                    const uint32_t id = newBlock();
+                    blocks[id].count = 0;
+                    blocks[id].rank = 0;
+                    order.push_back(id);
+                }
+                first.rank = static_cast<uint32_t>(order.size() - 1);
+                first.index = blocks[order.back()].count;
+            }
+
+            // Common case: the change stays inside one block that neither overflows nor gets too small.
+            const uint32_t id = order[first.rank];
+            Block& block = blocks[id];
+            if (first.index + eraseCount <= block.count)
+            {
+                const size_t newCount = block.count - eraseCount + count;
+                if (newCount <= CAPACITY && newCount > 0 && (newCount >= MIN_FILL || order.size() == 1))
+                {
+                    std::copy(block.items + first.index + eraseCount, block.items + block.count, block.items + first.index + count);
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        block.items[first.index + i] = items[i];
+                        blockOf[items[i]] = id;
+                    }
+                    block.count = static_cast<uint32_t>(newCount);
+                    return;
+                }
+            }
+
+            // Otherwise rebuild the blocks the change touches, with a neighbour if they would be too small.
+            size_t firstRank = first.rank, lastRank = first.rank;
+            size_t tail = first.index + eraseCount;
+            while (tail > blocks[order[lastRank]].count)
+            {
+                tail -= blocks[order[lastRank]].count;
+                lastRank++;
+            }
+            buffer.assign(block.items, block.items + first.index);
+            buffer.insert(buffer.end(), items, items + count);
+            const Block& last = blocks[order[lastRank]];
+            buffer.insert(buffer.end(), last.items + tail, last.items + last.count);
+            if (buffer.size() < MIN_FILL)
+            {
+                if (lastRank + 1 < order.size())
+                {
+                    lastRank++;
+                    const Block& next = blocks[order[lastRank]];
+                    buffer.insert(buffer.end(), next.items, next.items + next.count);
+                }
+                else if (firstRank > 0)
+                {
+                    firstRank--;
+                    const Block& previous = blocks[order[firstRank]];
+                    buffer.insert(buffer.begin(), previous.items, previous.items + previous.count);
+                }
+            }
+
+            for (size_t rank = firstRank; rank <= lastRank; rank++)
+            {
+                freeBlocks.push_back(order[rank]);
+            }
+            const size_t pieces = (buffer.size() + TARGET_FILL - 1) / TARGET_FILL;
+            std::vector<uint32_t> rebuilt(pieces);
+            for (size_t piece = 0, begin = 0; piece < pieces; piece++)
+            {
+                const size_t end = buffer.size() * (piece + 1) / pieces;
+                const uint32_t rebuiltId = newBlock();
+                Block& target = blocks[rebuiltId];
+                target.count = static_cast<uint32_t>(end - begin);
+                for (size_t i = begin; i < end; i++)
+                {
+                    target.items[i - begin] = buffer[i];
+                    blockOf[buffer[i]] = rebuiltId;
+                }
+                rebuilt[piece] = rebuiltId;
+                begin = end;
+            }
+            order.erase(order.begin() + firstRank, order.begin() + lastRank + 1);
+            order.insert(order.begin() + firstRank, rebuilt.begin(), rebuilt.end());
+            for (size_t rank = firstRank; rank < order.size(); rank++)
+            {
+                blocks[order[rank]].rank = static_cast<uint32_t>(rank);
+            }
+        }
+    };
+
+    class Sweep
+    {
+    public:
+
+        Sweep(const double* xy, size_t count, const scaleGeom::SegmentIntersectionCallback& fn, bool reportSharedEndpoints)
+            : xy(xy), fn(fn), reportSharedEndpoints(reportSharedEndpoints), status(count), roles(count, 0)
+        {
+        }
+
+        void run(const std::vector<uint32_t>& events, scaleGeom::SegmentIntersectionStats& stats);
+
+    private:
+
+        const double* start(uint32_t segment) const { return xy + 4 * static_cast<size_t>(segment); }
+        const double* end(uint32_t segment) const { return xy + 4 * static_cast<size_t>(segment) + 2; }
+        const double* endpoint(uint32_t event) const { return xy + 2 * static_cast<size_t>(event); }
+
+        bool degenerate(uint32_t segment) const { return samePoint(start(segment), end(segment)); }
+
+        bool collinear(uint32_t s, uint32_t t) const
+        {
+            if (degenerate(s) || degenerate(t))
+                return true;
+            return scaleGeom::orient2d(start(s), end(s), start(t)) == 0.0 && scaleGeom::orient2d(start(s), end(s), end(t)) == 0.0;
+        }
+
+        // Order of segments through the same point just after it: s below t.
+        bool below(uint32_t s, uint32_t t) const
+        {
+            const double orientation = scaleGeom::orient2d(start(s), end(s), end(t));
+            return orientation != 0.0 ? orientation > 0.0 : s < t;
+        }
+
+        // Signs of crossing - q and crossing - other, lexicographically.
+        int compare(const Crossing& crossing, const double* q) const;
+        int compare(const Crossing& crossing, const Crossing& other) const;
+
+        // Queue the crossing of the neighbours lower and upper if it lies ahead of the sweep.
+        void check(uint32_t lower, uint32_t upper);
+
+        // Report the pairs through the event point and reorder the status around it. The segments
+        // through it are the run of runLength segments from first and the ones in starting.
+        void process(const double* exact, const double* point, SweepStatus::Position first, size_t runLength);
+
+        // Heap order of the queue: the earliest crossing on top.
+        struct Later
+        {
+            const Sweep* sweep;
+
+            bool operator()(const Crossing& x, const Crossing& y) const { return sweep->compare(x, y) > 0; }
+        };
+
+        void popQueue()
+        {
+            std::pop_heap(queue.begin(), queue.end(), Later{ this });
+            queue.pop_back();
+        }
+
+        const double* xy;
+        const scaleGeom::SegmentIntersectionCallback& fn;
+        const bool reportSharedEndpoints;
+
+        SweepStatus status;
+
+        // Pending crossings, a binary heap with the earliest on top. Crossings of segments that are no
+        // longer neighbours are left in place and merged with the event when it comes.
+        std::vector<Crossing> queue;
+
+        std::vector<uint8_t> roles;
+        std::vector<uint32_t> starting, through, reinserted, crossing;
+        size_t intersections = 0;
+    };
+
+    int Sweep::compare(const Crossing& crossing, const double* q) const
+    {
+        for (int axis = 0; axis < 2; axis++)
+        {
+            const double difference = crossing.point[axis] - q[axis];
+            if (difference > crossing.error[axis])
+                return 1;
+            if (difference < -crossing.error[axis])
+                return -1;
+            arena.reset();
+            Expansion numerator, denominator;
+            crossingFraction(start(crossing.s), end(crossing.s), start(crossing.t), end(crossing.t), axis, numerator, denominator);
+            const int sign = signOf(numerator - value(q[axis]) * denominator) * signOf(denominator);
+            if (sign != 0)
+                return sign;
+        }
+        return 0;
+    }
+
+    int Sweep::compare(const Crossing& crossing, const Crossing& other) const
+    {
+        // A pair that became neighbours again is queued once more; its copies are equal.
+        if ((crossing.s == other.s && crossing.t == other.t) || (crossing.s == other.t && crossing.t == other.s))
+            return 0;
+        for (int axis = 0; axis < 2; axis++)
+        {
+            const double difference = crossing.point[axis] - other.point[axis];
+            const double error = crossing.error[axis] + other.error[axis];
+            if (difference > error)
+                return 1;
+            if (difference < -error)
+                return -1;
+            arena.reset();
+            Expansion numerator, denominator, otherNumerator, otherDenominator;
+            crossingFraction(start(crossing.s), end(crossing.s), start(crossing.t), end(crossing.t), axis, numerator, denominator);
+            crossingFraction(start(other.s), end(other.s), start(other.t), end(other.t), axis, otherNumerator, otherDenominator);
+            const int sign = signOf(numerator * otherDenominator - otherNumerator * denominator) * signOf(denominator) * signOf(otherDenominator);
+            if (sign != 0)
+                return sign;
+        }
+        return 0;
+    }
+
+    void Sweep::check(uint32_t lower, uint32_t upper)
+    {
+        if (lower == NONE || upper == NONE)
+            return;
+
+        // upper is above lower just after the sweep line, so they cross ahead exactly when upper ends
+        // below the line of lower and the crossing is proper; touching points are endpoint events anyway.
+        if (!(scaleGeom::orient2d(start(lower), end(lower), end(upper)) < 0.0 && scaleGeom::orient2d(start(lower), end(lower), start(upper)) > 0.0))
+            return;
+        const int first = signOf(scaleGeom::orient2d(start(upper), end(upper), start(lower)));
+        const int second = signOf(scaleGeom::orient2d(start(upper), end(upper), end(lower)));
+        if (first * second >= 0)
+            return;
+        queue.push_back(estimateCrossing(start(lower), end(lower), start(upper), end(upper), lower, upper));
+        std::push_heap(queue.begin(), queue.end(), Later{ this });
+    }
+
+    void Sweep::process(const double* exact, const double* point, SweepStatus::Position first, size_t runLength)
+    {
+        through.clear();
+        SweepStatus::Position after = first;
+        for (size_t i = 0; i < runLength; i++)
+        {
+            const uint32_t segment = status.at(after);
+            through.push_back(segment);
+            if (exact && samePoint(end(segment), exact))
+                roles[segment] = ENDS;
+            after = status.next(after);
+        }
+        for (uint32_t segment : starting)
+        {
+            through.push_back(segment);
+            roles[segment] = degenerate(segment) ? STARTS | ENDS : STARTS;
+        }
+
+        // Every pair through the point meets there. Collinear overlaps are reported once, at the first
+        // point they share, where one of the two starts.
+        const scaleGeom::Vector2d location(point[0], point[1]);
+        for (size_t i = 0; i < through.size(); i++)
+        {
+            for (size_t j = i + 1; j < through.size(); j++)
+            {
+                const uint32_t s = through[i], t = through[j];
+                const uint8_t either = roles[s] | roles[t];
+                const bool overlap = collinear(s, t);
+                if (overlap && !(either & STARTS))
+                    continue;
+                if (!reportSharedEndpoints && roles[s] && roles[t] && (!overlap || (either & ENDS)))
+                    continue;
+                fn(std::min(s, t), std::max(s, t), location);
+                intersections++;
+            }
+        }
+
+        reinserted.clear();
+        for (uint32_t segment : through)
+        {
+            if (!(roles[segment] & ENDS))
+                reinserted.push_back(segment);
+            roles[segment] = 0;
+        }
+        std::sort(reinserted.begin(), reinserted.end(), [this](uint32_t s, uint32_t t) { return below(s, t); });
+
+        uint32_t lower = NONE, upper = NONE;
+        SweepStatus::Position previous = first;
+        if (status.previous(previous))
+            lower = status.at(previous);
+        if (status.valid(after))
+            upper = status.at(after);
+        status.replace(first, runLength, reinserted.data(), reinserted.size());
+        if (reinserted.empty())
+        {
+            check(lower, upper);
+        }
+        else
+        {
+            check(lower, reinserted.front());
+            check(reinserted.back(), upper);
+        }
+    }
+
+    void Sweep::run(const std::vector<uint32_t>& events, scaleGeom::SegmentIntersectionStats& stats)
+    {
+        size_t next = 0;
+        while (next < events.size() || !queue.empty())
+        {
+            stats.events++;
+            stats.peakQueue = std::max(stats.peakQueue, queue.size());
+            const double* exact = next < events.size() ? endpoint(events[next]) : nullptr;
+            if (exact && (queue.empty() || compare(queue.front(), exact) >= 0))
+            {
+                // Endpoint event, with any crossings that fall on it.
+                starting.clear();
+                while (next < events.size() && samePoint(endpoint(events[next]), exact))
+                {
+                    if (!(events[next] & 1))
+                        starting.push_back(events[next] >> 1);
+                    next++;
+                }
+                while (!queue.empty() && compare(queue.front(), exact) == 0)
+                {
+                    popQueue();
+                }
+
+                // The segments through the point are the ones it is neither above nor below.
+                const SweepStatus::Position first = status.lowerBound([&](uint32_t segment) {
+                    return scaleGeom::orient2d(start(segment), end(segment), exact) > 0.0;
+                });
+                size_t runLength = 0;
+                for (SweepStatus::Position p = first; status.valid(p) && scaleGeom::orient2d(start(status.at(p)), end(status.at(p)), exact) == 0.0; p = status.next(p))
+                {
+                    runLength++;
+                }
+                process(exact, exact, first, runLength);
+            }
+            else
+            {
+                // Crossing event: all the queued crossings at the same point, then the status between
+                // their segments, extended by segments overlapping the ends of that range.
+                stats.crossingEvents++;
+                const Crossing event = queue.front();
+                crossing.clear();
+                while (!queue.empty() && compare(queue.front(), event) == 0)
+                {
+                    crossing.push_back(queue.front().s);
+                    crossing.push_back(queue.front().t);
+                    popQueue();
+                }
+                SweepStatus::Position low = status.locate(crossing[0]), high = low;
+                for (uint32_t segment : crossing)
+                {
+                    const SweepStatus::Position p = status.locate(segment);
+                    low = std::min(low, p);
+                    high = std::max(high, p);
+                }
+                for (SweepStatus::Position p = low; status.previous(p) && collinear(status.at(p), status.at(low)); )
+                {
+                    low = p;
+                }
+                for (SweepStatus::Position p = status.next(high); status.valid(p) && collinear(status.at(p), status.at(high)); p = status.next(p))
+                {
+                    high = p;
+                }
+                size_t runLength = 1;
+                for (SweepStatus::Position p = low; p < high; p = status.next(p))
+                {
+                    runLength++;
+                }
+                starting.clear();
+                process(nullptr, event.point, low, runLength);
+            }
+            stats.peakStatus = std::max(stats.peakStatus, status.size());
+        }
+        stats.intersections = intersections;
+    }
+
+    void intersect(const double* xy, size_t count, const scaleGeom::SegmentIntersectionCallback& fn, bool reportSharedEndpoints,
+        unsigned threads, scaleGeom::SegmentIntersectionStats* _stats)
+    {
+        const std::vector<uint32_t> events = scaleGeom::spatialSortPermutation(reinterpret_cast<const scaleGeom::Vector2d*>(xy), 2 * count,
+            scaleGeom::SpatialOrder::Lexicographic, threads);
+        scaleGeom::SegmentIntersectionStats stats;
+        Sweep sweep(xy, count, fn, reportSharedEndpoints);
+        sweep.run(events, stats);
+        if (_stats)
+            *_stats = stats;
+    }
+
+    // Copy the endpoints to double, each segment starting at its lexicographically smaller end.
+    template<class coordType>
+    std::vector<double> orientedSegments(const coordType* raw, size_t count, unsigned threads)
+    {
+        if (count >= 0x80000000ull)
+            throw std::length_error("intersectSegments supports at most 2^31 - 1 segments\n");
+        std::vector<double> xy(4 * count);
+        scaleGeom::parallelFor(0, count, threads, MIN_CHUNK, [&](size_t i) {
+            const coordType* p = raw + 4 * i;
+            const bool swap = p[2] < p[0] || (p[2] == p[0] && p[3] < p[1]);
+            double* out = xy.data() + 4 * i;
+            for (int k = 0; k < 4; k++)
+            {
+                out[k] = p[swap ? (k + 2) % 4 : k];
+            }
+        });
+        return xy;
+    }
+}
+
+void scaleGeom::intersectSegments(const Vector2f* endpoints, size_t count, const SegmentIntersectionCallback& fn,
+    bool _reportSharedEndpoints, unsigned _threads, SegmentIntersectionStats* _stats)
+{
+    const std::vector<double> xy = orientedSegments(reinterpret_cast<const float*>(endpoints), count, _threads);
+    intersect(xy.data(), count, fn, _reportSharedEndpoints, _threads, _stats);
+}
+
+void scaleGeom::intersectSegments(const Vector2d* endpoints, size_t count, const SegmentIntersectionCallback& fn,
+    bool _reportSharedEndpoints, unsigned _threads, SegmentIntersectionStats* _stats)
+{
+    const std::vector<double> xy = orientedSegments(reinterpret_cast<const double*>(endpoints), count, _threads);
+    intersect(xy.data(), count, fn, _reportSharedEndpoints, _threads, _stats);
+}
+
+bool scaleGeom::segmentsIntersect(const Vector2d& a, const Vector2d& b, const Vector2d& c, const Vector2d& d, Vector2d* _point, bool _reportSharedEndpoints)
+{
+    // Both segments start at their lexicographically smaller end.
+    double s[4] = { a[0], a[1], b[0], b[1] }, t[4] = { c[0], c[1], d[0], d[1] };
+    if (lexicographicLess(s + 2, s))
+    {
+        std::swap(s[0], s[2]);
+        std::swap(s[1], s[3]);
+    }
+    if (lexicographicLess(t + 2, t))
+    {
+        std::swap(t[0], t[2]);
+        std::swap(t[1], t[3]);
+    }
+    const bool sPoint = samePoint(s, s + 2), tPoint = samePoint(t, t + 2);
+    auto endpointOfBoth = [&](const double* p) {
+        return (samePoint(p, s) || samePoint(p, s + 2)) && (samePoint(p, t) || samePoint(p, t + 2));
+    };
+
+    const double* contact;
+    Crossing crossing;
+    const int o1 = signOf(orient2d(s, s + 2, t)), o2 = signOf(orient2d(s, s + 2, t + 2));
+    const int o3 = signOf(orient2d(t, t + 2, s)), o4 = signOf(orient2d(t, t + 2, s + 2));
+    if (sPoint || tPoint || (o1 == 0 && o2 == 0))
+    {
+        // On a common line (or a point on the other segment): the overlap runs from the later start to the earlier end.
+        if ((sPoint && !tPoint && o3 != 0) || (tPoint && !sPoint && o1 != 0))
+            return false;
+        contact = lexicographicLess(s, t) ? t : s;
+        const double* last = lexicographicLess(s + 2, t + 2) ? s + 2 : t + 2;
+        if (lexicographicLess(last, contact))
+            return false;
+        if (!_reportSharedEndpoints && samePoint(contact, last) && endpointOfBoth(contact))
+            return false;
+    }
+    else
+    {
+        if (o1 * o2 > 0 || o3 * o4 > 0)
+            return false;
+        if (o1 != 0 && o2 != 0 && o3 != 0 && o4 != 0)
+        {
+            // In the order the sweep meets them, lower segment first, so both round the point the same way.
+            crossing = o1 > 0 ? estimateCrossing(s, s + 2, t, t + 2, 0, 0) : estimateCrossing(t, t + 2, s, s + 2, 0, 0);
+            contact = crossing.point;
+        }
+        else
+        {
+            contact = o1 == 0 ? t : o2 == 0 ? t + 2 : o3 == 0 ? s : s + 2;
+            if (!_reportSharedEndpoints && endpointOfBoth(contact))
+                return false;
+        }
+    }
+    if (_point)
+        *_point = Vector2d(contact[0], contact[1]);
+    return true;
+}
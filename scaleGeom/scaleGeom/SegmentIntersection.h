@@ -0,0 +1,109 @@
+/*
+	SegmentIntersection.h - Sweep-Line Segment Intersection
+
+	Overview:
+	intersectSegments reports every intersecting pair of a set of 2D segments with the
+	Bentley-Ottmann sweep, in O((n + k) log n) time for n segments and k intersections instead of
+	the O(n^2) of testing all pairs:
+
+	- Events are the segment endpoints, sorted once in lexicographic order (x, then y) with the
+	  parallel radix sort of VectorOrder.h, and the crossings found on the way, kept in a binary
+	  heap in one pooled array that is reused across the whole sweep.
+	- The status (the segments cut by the sweep line, bottom to top) is a two-level blocked list:
+	  a short array of blocks of up to 128 segment indices each. Locating an event is a binary
+	  search over the blocks and then inside one block, and an update moves a few contiguous
+	  indices, so the whole status stays in a few cache lines per level instead of a pointer tree.
+	- Vertical segments need no special case: in lexicographic order the sweep line is tilted by
+	  an infinitesimal angle, so a vertical segment is swept from its lower to its upper end.
+
+	Robustness:
+	Every decision is exact. Orientation tests are orient2d from Predicates.h, and crossing
+	points, which are not representable in double, are compared with each other and with
+	endpoints by a floating-point filter backed by exact expansion arithmetic (ExactArithmetic.h).
+	Degenerate input is handled: any number of segments through one point, collinear overlaps,
+	segments touching at endpoints or at an interior point, duplicate segments, and zero-length
+	segments, which are reported against everything through their point.
+
+	Output:
+	The callback fn(first, second, point) is called once per intersecting pair of segment indices,
+	with first < second, in sweep order of the point. point is the intersection point; for
+	collinear overlaps it is the lexicographically smallest common point. Endpoints and points
+	where segments touch are exact; proper crossings are rounded to double, clamped to the
+	bounding boxes of both segments. With _reportSharedEndpoints false, pairs whose only common
+	point is an endpoint of both (consecutive segments of a polyline) are skipped.
+
+	Segment i runs from endpoints[2i] to endpoints[2i + 1]. Vector2f and Vector2d input are both
+	swept in double precision. Coordinates must be finite, and count must be below 2^31
+	(std::length_error otherwise). The sweep itself is sequential; only the event sort uses
+	_threads (0 = every hardware thread).
+
+	Usage:
+	scaleGeom::intersectSegments(endpoints.data(), endpoints.size() / 2,
+		[&](uint32_t first, uint32_t second, const scaleGeom::Vector2d& point) { ... });
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	struct SegmentIntersection
+	{
+		uint32_t first = 0;
+		uint32_t second = 0;
+		Vector2d point{};
+	};
+
+	typedef std::function<void(uint32_t first, uint32_t second, const Vector2d& point)> SegmentIntersectionCallback;
+
+	struct SegmentIntersectionStats
+	{
+		size_t intersections = 0;
+
+		// Event points processed, and how many of them were crossings rather than endpoints.
+		size_t events = 0;
+		size_t crossingEvents = 0;
+
+		// Largest number of segments in the status and of pending crossings in the queue.
+		size_t peakStatus = 0;
+		size_t peakQueue = 0;
+	};
+
+	// Report every intersecting pair among the segments (endpoints[2i], endpoints[2i + 1]), i < count.
+	void intersectSegments(const Vector2f* endpoints, size_t count, const SegmentIntersectionCallback& fn,
+		bool _reportSharedEndpoints = true, unsigned _threads = 0, SegmentIntersectionStats* _stats = nullptr);
+	void intersectSegments(const Vector2d* endpoints, size_t count, const SegmentIntersectionCallback& fn,
+		bool _reportSharedEndpoints = true, unsigned _threads = 0, SegmentIntersectionStats* _stats = nullptr);
+
+	// Exact test of the closed segments a-b and c-d, with the same rules as intersectSegments. If they intersect, _point
+	// receives their intersection point as defined above.
+	bool segmentsIntersect(const Vector2d& a, const Vector2d& b, const Vector2d& c, const Vector2d& d, Vector2d* _point = nullptr,
+		bool _reportSharedEndpoints = true);
+
+	// intersectSegments collecting the intersections in sweep order. endpoints holds two points per segment.
+	inline std::vector<SegmentIntersection> intersectSegments(const std::vector<Vector2f>& endpoints, bool _reportSharedEndpoints = true, unsigned _threads = 0)
+	{
+		std::vector<SegmentIntersection> result;
+		intersectSegments(endpoints.data(), endpoints.size() / 2, [&](uint32_t first, uint32_t second, const Vector2d& point) {
+			result.push_back({ first, second, point });
+		}, _reportSharedEndpoints, _threads);
+		return result;
+	}
+
+	inline std::vector<SegmentIntersection> intersectSegments(const std::vector<Vector2d>& endpoints, bool _reportSharedEndpoints = true, unsigned _threads = 0)
+	{
+		std::vector<SegmentIntersection> result;
+		intersectSegments(endpoints.data(), endpoints.size() / 2, [&](uint32_t first, uint32_t second, const Vector2d& point) {
+			result.push_back({ first, second, point });
+		}, _reportSharedEndpoints, _threads);
+		return result;
+	}
+
+} // Closing the scaleGeom namespace.
@@ -0,0 +1,95 @@
+#include "Benchmark.h"
+#include "SegmentIntersection.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    enum class Layout { Roads, Scattered, Grid };
+
+    // Roads: random-walk polylines whose consecutive segments share endpoints. Scattered: short segments
+    // of random direction. Grid: axis-aligned segments on an integer lattice, so most crossings are
+    // exactly representable and many segments overlap.
+    template<class coordDataType>
+    std::vector<scaleGeom::Vector<coordDataType, scaleGeom::DIM2>> makeSegments(size_t count, Layout layout)
+    {
+        typedef scaleGeom::Vector<coordDataType, scaleGeom::DIM2> Point;
+        std::mt19937 rng(21);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        const double length = 2.0 / std::sqrt(static_cast<double>(count));
+        std::vector<Point> endpoints;
+        endpoints.reserve(2 * count);
+        double x = 0.0, y = 0.0;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (layout == Layout::Roads)
+            {
+                if (i % 64 == 0)
+                {
+                    x = uniform(rng);
+                    y = uniform(rng);
+                }
+                const double angle = 6.283185307179586 * uniform(rng);
+                const double nx = x + length * std::cos(angle), ny = y + length * std::sin(angle);
+                endpoints.push_back(Point(static_cast<coordDataType>(x), static_cast<coordDataType>(y)));
+                endpoints.push_back(Point(static_cast<coordDataType>(nx), static_cast<coordDataType>(ny)));
+                x = nx;
+                y = ny;
+            }
+            else if (layout == Layout::Scattered)
+            {
+                x = uniform(rng);
+                y = uniform(rng);
+                const double angle = 6.283185307179586 * uniform(rng);
+                endpoints.push_back(Point(static_cast<coordDataType>(x), static_cast<coordDataType>(y)));
+                endpoints.push_back(Point(static_cast<coordDataType>(x + length * std::cos(angle)), static_cast<coordDataType>(y + length * std::sin(angle))));
+            }
+            else
+            {
+                const double cells = std::floor(std::sqrt(static_cast<double>(count)));
+                x = std::floor(uniform(rng) * cells);
+                y = std::floor(uniform(rng) * cells);
+                const double span = 1.0 + std::floor(uniform(rng) * 4.0);
+                endpoints.push_back(Point(static_cast<coordDataType>(x), static_cast<coordDataType>(y)));
+                endpoints.push_back(i % 2 ? Point(static_cast<coordDataType>(x + span), static_cast<coordDataType>(y))
+                    : Point(static_cast<coordDataType>(x), static_cast<coordDataType>(y + span)));
+            }
+        }
+        return endpoints;
+    }
+
+    template<class coordDataType>
+    void run(const char* label, Layout layout, bool reportSharedEndpoints)
+    {
+        const std::vector<scaleGeom::Vector<coordDataType, scaleGeom::DIM2>> endpoints = makeSegments<coordDataType>(scaleGeom::bench::problemSize(1000000), layout);
+        const size_t count = endpoints.size() / 2;
+        scaleGeom::SegmentIntersectionStats stats;
+        double checksum = 0.0;
+        Timer timer;
+        scaleGeom::intersectSegments(endpoints.data(), count, [&](uint32_t, uint32_t, const scaleGeom::Vector2d& point) {
+            checksum += point[0];
+        }, reportSharedEndpoints, 0, &stats);
+        const double seconds = timer.seconds();
+        std::cout << "  " << std::left << std::setw(24) << label << std::right
+            << std::setw(9) << std::fixed << std::setprecision(2) << seconds * 1e3 << " ms  "
+            << std::setw(6) << std::setprecision(2) << count / seconds / 1e6 << " Msegments/s  "
+            << std::setw(9) << stats.intersections << " intersections  "
+            << std::setw(9) << stats.crossingEvents << " crossing events  "
+            << std::setw(6) << stats.peakStatus << " peak status"
+            << (std::isfinite(checksum) ? "" : "  NOT FINITE") << std::endl;
+    }
+}
+
+SCALEGEOM_BENCHMARK(SegmentIntersection)
+{
+    run<float>("roads, Vector2f", Layout::Roads, false);
+    run<double>("roads, Vector2d", Layout::Roads, false);
+    run<float>("scattered, Vector2f", Layout::Scattered, true);
+    run<float>("grid, Vector2f", Layout::Grid, true);
+}
@@ -0,0 +1,172 @@
+/*
+	Tolerance.h - Tolerance Policies for Coordinate Comparisons
+
+	Overview:
+	Approximate equality used to be a single absolute tolerance (TOLERANCE, 1e-7) applied in double
+	precision to every coordinate type. That is too strict for float data far from the origin,
+	too loose for tiny coordinates, and pays a float to double conversion per comparison. The
+	tolerance is now a policy, chosen per coordinate type through ToleranceTraits:
+
+	- ExactComparison<T>:    a == b.
+	- AbsoluteTolerance<T>:  |a - b| <= absolute.
+	- RelativeTolerance<T>:  |a - b| <= max(absolute, relative * max(|a|, |b|)); the absolute
+	                         floor handles values near zero.
+	- UlpTolerance<T>:       a and b at most maxUlps representable values apart (floating point).
+
+	Every policy also treats a == b as equal (so infinities equal themselves) and never matches NaN.
+	A policy is a small value type, so tolerances can be passed per call:
+
+		a.equals(b, scaleGeom::RelativeTolerance<float>{ 1e-6f, 1e-5f });
+
+	Vector::operator== uses ToleranceTraits<T>::DefaultPolicy with the trait's default values:
+	exact for integer coordinates and an absolute tolerance in the coordinate precision for
+	floating point (1e-7 for double and long double, as before, and 1e-6 for float). Specialize
+	ToleranceTraits for a coordinate type, before it is compared, to change the defaults.
+
+	reach(magnitude) is the largest difference that can compare equal among values of at most that
+	magnitude; the spatial hashing in Dedup.h sizes its cells with it. Batch comparisons are in
+	VectorBatch.h (equalBatch).
+
+*/
+
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace scaleGeom {
+
+	template<class coordDataType> struct ExactComparison;
+	template<class coordDataType> struct AbsoluteTolerance;
+
+	// Default tolerances per coordinate type. Integer types compare exactly.
+	template<class coordDataType>
+	struct ToleranceTraits
+	{
+		typedef ExactComparison<coordDataType> DefaultPolicy;
+		static constexpr coordDataType absolute = 0;
+		static constexpr coordDataType relative = 0;
+		static constexpr uint32_t ulps = 0;
+	};
+
+	template<>
+	struct ToleranceTraits<float>
+	{
+		typedef AbsoluteTolerance<float> DefaultPolicy;
+		static constexpr float absolute = 1e-6f;
+		static constexpr float relative = 4 * std::numeric_limits<float>::epsilon();
+		static constexpr uint32_t ulps = 4;
+	};
+
+	template<>
+	struct ToleranceTraits<double>
+	{
+		typedef AbsoluteTolerance<double> DefaultPolicy;
+		static constexpr double absolute = 1e-7;
+		static constexpr double relative = 4 * std::numeric_limits<double>::epsilon();
+		static constexpr uint32_t ulps = 4;
+	};
+
+	// Kept at the 1e-7 every floating-point type compared with before the policies.
+	template<>
+	struct ToleranceTraits<long double>
+	{
+		typedef AbsoluteTolerance<long double> DefaultPolicy;
+		static constexpr long double absolute = 1e-7L;
+		static constexpr long double relative = 4 * std::numeric_limits<long double>::epsilon();
+		static constexpr uint32_t ulps = 4;
+	};
+
+	// Position of a floating-point value on the number line, counted in representable values
+	// (+0 and -0 both map to 0), so that the ulp distance of a and b is |ordered(a) - ordered(b)|.
+	inline int32_t orderedBits(float v)
+	{
+		int32_t bits;
+		std::memcpy(&bits, &v, sizeof(bits));
+		return bits < 0 ? std::numeric_limits<int32_t>::min() - bits : bits;
+	}
+
+	inline int64_t orderedBits(double v)
+	{
+		int64_t bits;
+		std::memcpy(&bits, &v, sizeof(bits));
+		return bits < 0 ? std::numeric_limits<int64_t>::min() - bits : bits;
+	}
+
+	// Number of representable values between a and b; both must be non-NaN.
+	inline uint64_t ulpDistance(float a, float b)
+	{
+		const int64_t difference = static_cast<int64_t>(orderedBits(a)) - orderedBits(b);
+		return static_cast<uint64_t>(difference < 0 ? -difference : difference);
+	}
+
+	inline uint64_t ulpDistance(double a, double b)
+	{
+		const int64_t oa = orderedBits(a), ob = orderedBits(b);
+		return oa > ob ? static_cast<uint64_t>(oa) - static_cast<uint64_t>(ob) : static_cast<uint64_t>(ob) - static_cast<uint64_t>(oa);
+	}
+
+	template<class coordDataType>
+	struct ExactComparison
+	{
+		constexpr bool operator()(coordDataType a, coordDataType b) const { return a == b; }
+
+		constexpr coordDataType reach(coordDataType) const { return 0; }
+	};
+
+	template<class coordDataType>
+	struct AbsoluteTolerance
+	{
+		static_assert(std::is_floating_point<coordDataType>::value, "AbsoluteTolerance needs floating-point coordinates");
+
+		coordDataType absolute = ToleranceTraits<coordDataType>::absolute;
+
+		bool operator()(coordDataType a, coordDataType b) const { return a == b || std::fabs(a - b) <= absolute; }
+
+		coordDataType reach(coordDataType) const { return absolute; }
+	};
+
+	template<class coordDataType>
+	struct RelativeTolerance
+	{
+		static_assert(std::is_floating_point<coordDataType>::value, "RelativeTolerance needs floating-point coordinates");
+
+		coordDataType absolute = ToleranceTraits<coordDataType>::absolute;
+		coordDataType relative = ToleranceTraits<coordDataType>::relative;
+
+		// The difference must also be finite, so that an infinity never matches a finite value.
+		bool operator()(coordDataType a, coordDataType b) const
+		{
+			const coordDataType difference = std::fabs(a - b);
+			const coordDataType bound = std::fmax(absolute, relative * std::fmax(std::fabs(a), std::fabs(b)));
+			return a == b || (difference <= bound && difference < std::numeric_limits<coordDataType>::infinity());
+		}
+
+		coordDataType reach(coordDataType magnitude) const { return std::fmax(absolute, relative * magnitude); }
+	};
+
+	template<class coordDataType>
+	struct UlpTolerance
+	{
+		static_assert(std::is_floating_point<coordDataType>::value, "UlpTolerance needs floating-point coordinates");
+
+		uint32_t maxUlps = ToleranceTraits<coordDataType>::ulps;
+
+		bool operator()(coordDataType a, coordDataType b) const
+		{
+			return a == b || (a == a && b == b && ulpDistance(a, b) <= maxUlps);
+		}
+
+		// maxUlps steps at the spacing of the next binade up bound the difference.
+		coordDataType reach(coordDataType magnitude) const
+		{
+			const coordDataType spacing = std::nextafter(magnitude, std::numeric_limits<coordDataType>::infinity()) - magnitude;
+			return 2 * static_cast<coordDataType>(maxUlps) * spacing;
+		}
+	};
+
+} // Closing the scaleGeom namespace.
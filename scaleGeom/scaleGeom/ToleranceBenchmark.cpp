@@ -0,0 +1,149 @@
+#include "Benchmark.h"
+#include "CpuFeatures.h"
+#include "Dedup.h"
+#include "VectorBatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    const int REPEATS = 5;
+
+    // Pairs of points where b is a copy of a, a copy moved by a few ulps, or an unrelated point.
+    void makePairs(size_t count, std::vector<scaleGeom::Vector3f>& a, std::vector<scaleGeom::Vector3f>& b)
+    {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+        std::uniform_int_distribution<int> kind(0, 3);
+        a.resize(count);
+        b.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            a[i] = scaleGeom::Vector3f(dist(rng), dist(rng), dist(rng));
+            switch (kind(rng))
+            {
+            case 0: b[i] = a[i]; break;
+            case 1: b[i] = scaleGeom::Vector3f(std::nextafter(a[i][0], 2000.0f), a[i][1], std::nextafter(a[i][2], -2000.0f)); break;
+            case 2: b[i] = scaleGeom::Vector3f(a[i][0], a[i][1] + 1e-3f, a[i][2]); break;
+            default: b[i] = scaleGeom::Vector3f(dist(rng), dist(rng), dist(rng)); break;
+            }
+        }
+    }
+
+    template<class Function>
+    double bestOf(Function function)
+    {
+        double best = 1e30;
+        for (int r = 0; r < REPEATS; r++)
+        {
+            Timer timer;
+            function();
+            best = std::min(best, timer.seconds());
+        }
+        return best;
+    }
+
+    size_t countEqual(const std::vector<uint8_t>& flags)
+    {
+        size_t equal = 0;
+        for (uint8_t flag : flags)
+        {
+            equal += flag;
+        }
+        return equal;
+    }
+
+    void report(const char* label, double seconds, size_t count, size_t equal)
+    {
+        std::cout << "  " << std::left << std::setw(34) << label << std::right
+            << std::setw(9) << std::fixed << std::setprecision(3) << seconds * 1e3 << " ms  "
+            << std::setw(9) << std::setprecision(1) << count / seconds / 1e6 << " Mpairs/s  "
+            << std::setw(9) << equal << " equal" << std::endl;
+    }
+}
+
+// Pairwise equality of float points: the old double-precision IsEqualD loop, the float policies
+// one pair at a time, and the SIMD batch kernels.
+SCALEGEOM_BENCHMARK(ToleranceEquality)
+{
+    const size_t count = scaleGeom::bench::problemSize(4000000);
+    std::vector<scaleGeom::Vector3f> a, b;
+    makePairs(count, a, b);
+    const scaleGeom::PointCloud3f cloudA = scaleGeom::PointCloud3f::fromAoS(a.data(), count);
+    const scaleGeom::PointCloud3f cloudB = scaleGeom::PointCloud3f::fromAoS(b.data(), count);
+    std::vector<uint8_t> flags(count);
+    std::cout << "  pairs: " << count << ", SIMD level: " << scaleGeom::simdLevelName(scaleGeom::activeSimdLevel()) << std::endl;
+
+    double seconds = bestOf([&]() {
+        for (size_t i = 0; i < count; i++)
+        {
+            flags[i] = IsEqualD(a[i][0], b[i][0]) && IsEqualD(a[i][1], b[i][1]) && IsEqualD(a[i][2], b[i][2]);
+        }
+    });
+    report("IsEqualD (double)", seconds, count, countEqual(flags));
+
+    seconds = bestOf([&]() {
+        for (size_t i = 0; i < count; i++)
+        {
+            flags[i] = a[i] == b[i];
+        }
+    });
+    report("operator== (float absolute)", seconds, count, countEqual(flags));
+
+    const scaleGeom::AbsoluteTolerance<float> absolute;
+    const scaleGeom::RelativeTolerance<float> relative;
+    const scaleGeom::UlpTolerance<float> ulps;
+    seconds = bestOf([&]() {
+        for (size_t i = 0; i < count; i++)
+        {
+            flags[i] = a[i].equals(b[i], ulps);
+        }
+    });
+    report("equals (ulps)", seconds, count, countEqual(flags));
+
+    seconds = bestOf([&]() { scaleGeom::equalBatch(cloudA.view(), cloudB.view(), flags.data(), absolute); });
+    report("equalBatch (absolute)", seconds, count, countEqual(flags));
+    seconds = bestOf([&]() { scaleGeom::equalBatch(cloudA.view(), cloudB.view(), flags.data(), relative); });
+    report("equalBatch (relative)", seconds, count, countEqual(flags));
+    seconds = bestOf([&]() { scaleGeom::equalBatch(cloudA.view(), cloudB.view(), flags.data(), ulps); });
+    report("equalBatch (ulps)", seconds, count, countEqual(flags));
+    scaleGeom::bench::doNotOptimize(flags.data());
+}
+
+// Hashed deduplication of points where every point appears about four times, slightly perturbed.
+SCALEGEOM_BENCHMARK(SpatialDedup)
+{
+    const size_t distinct = scaleGeom::bench::problemSize(1000000) / 4;
+    std::mt19937 rng(8);
+    std::uniform_real_distribution<float> dist(0.0f, 100.0f), jitter(-2e-5f, 2e-5f);
+    std::vector<scaleGeom::Vector3f> points;
+    points.reserve(4 * distinct);
+    for (size_t i = 0; i < distinct; i++)
+    {
+        const scaleGeom::Vector3f p(dist(rng), dist(rng), dist(rng));
+        for (int copy = 0; copy < 4; copy++)
+        {
+            points.push_back(scaleGeom::Vector3f(p[0] + jitter(rng), p[1] + jitter(rng), p[2] + jitter(rng)));
+        }
+    }
+    std::shuffle(points.begin(), points.end(), rng);
+    std::vector<size_t> remap(points.size());
+    std::cout << "  points: " << points.size() << ", distinct: " << distinct << std::endl;
+
+    const scaleGeom::AbsoluteTolerance<float> tolerance{ 1e-4f };
+    size_t unique = 0;
+    const double seconds = bestOf([&]() {
+        unique = scaleGeom::deduplicatePoints(points.data(), points.size(), remap.data(), tolerance).size();
+    });
+    std::cout << "  " << std::left << std::setw(34) << "deduplicatePoints (1e-4)" << std::right
+        << std::setw(9) << std::fixed << std::setprecision(3) << seconds * 1e3 << " ms  "
+        << std::setw(9) << std::setprecision(1) << points.size() / seconds / 1e6 << " Mpts/s  "
+        << std::setw(9) << unique << " unique" << std::endl;
+}
@@ -10,14 +10,25 @@
 	Features:
 	- Representation of vectors in 2D, 3D, and N-dimensional spaces.
 	- Support for different coordinate data types, including integer and floating-point types.
-	- Overloaded operators facilitating vector arithmetic and comparisons.
+	- Overloaded operators facilitating vector arithmetic and comparisons. Arithmetic is lazy
+	  (see VectorExpression.h), so compound expressions are evaluated in a single pass.
 	- Geometric query functions like dot product and cross product.
-	- Utility functions such as normalization and magnitude computation.
+	- Constructors, arithmetic, dotProduct, crossProduct2D/3D and scalarTripleProduct are constexpr,
+	  so lookup tables of Vectors can be computed at compile time.
+	- Utility functions such as normalization and magnitude computation, in the precision of the
+	  coordinate type (double for integer vectors). Batch normalization is in VectorBatch.h.
 	- Strong encapsulation using the scaleGeom namespace to avoid naming conflicts.
 	- Forward declarations and friend functions to maintain a clean and modular structure.
 
+	Element access:
+	operator[] does not check its index in release builds, so loops over coordinates (dotProduct
+	and the like) compile to straight-line or vectorized code. Defining SCALEGEOM_CHECKED_ACCESS to 1
+	turns the range check back on (it is on by default when _DEBUG is defined); out of range indices
+	then throw std::out_of_range. at() always checks, and get<index>(vec) checks at compile time.
+
 	Dependencies:
-	- Requires the "Core.h" for certain utility functions and definitions.
+	- Requires the "Core.h" for certain utility functions and definitions, and "Tolerance.h" for
+	  the tolerance policies used by operator== and equals().
 
 	Usage:
 	The utility can be directly included in computational geometry projects, and the vectors can be
@@ -34,21 +45,35 @@
 
 #include <iostream>
 #include <array>
+#include <cmath>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
 #include "Core.h"
+#include "Tolerance.h"
+#include "VectorExpression.h"
+
+// Range checks in Vector::operator[]: on by default in debug builds, off otherwise.
+#ifndef SCALEGEOM_CHECKED_ACCESS
+#if defined(_DEBUG)
+#define SCALEGEOM_CHECKED_ACCESS 1
+#else
+#define SCALEGEOM_CHECKED_ACCESS 0
+#endif
+#endif
 
 // This header provides the definition for the Vector class within the scaleGeom namespace.
 // The scaleGeom namespace encapsulates all geometric constructs and related utilities.
 namespace scaleGeom {
 
 	// Constants for specifying the number of dimensions in 2D and 3D vectors.
-#define DIM2 2
-#define DIM3 3
+	constexpr size_t DIM2 = 2;
+	constexpr size_t DIM3 = 3;
 
-// Define index constants for easier access to vector components.
-#define X 0
-#define Y 1
-#define Z 2
+	// Index constants for easier access to vector components.
+	constexpr size_t X = 0;
+	constexpr size_t Y = 1;
+	constexpr size_t Z = 2;
 
 	// Forward declaration of the Vector template class without its default argument.
 	template <class coordDataType, size_t dimension>
@@ -60,7 +85,7 @@ namespace scaleGeom {
 
 	// Template class for a vector, allowing for different coordinate data types (like int, float) and dimensions.
 	template <class coordDataType, size_t dimension = DIM3>
-	class Vector 
+	class Vector : public VectorExpression<Vector<coordDataType, dimension>, coordDataType, dimension>
 	{
 		// Allow the stream insertion operator to access private members of the Vector class.
 		friend std::ostream& operator<< <>(std::ostream& os, const Vector& vec);
@@ -74,61 +99,123 @@ namespace scaleGeom {
 		// Array to store the coordinates of the vector.
 		std::array<coordDataType, dimension> coords;
 
+		// The coordinates of an expression, evaluated in index order.
+		template <class Expression, size_t... index>
+		static constexpr std::array<coordDataType, dimension> evaluate(const VectorExpression<Expression, coordDataType, dimension>& _expression, std::index_sequence<index...>)
+		{
+			return { { _expression.eval(index)... } };
+		}
+
 		//Dot product of two vectors
-		template<class coordDataType, size_t dimension>
-		friend coordDataType dotProduct(const Vector<coordDataType, dimension>&, const Vector<coordDataType, dimension>&);
+		template<class otherCoordDataType, size_t otherDimension>
+		friend constexpr otherCoordDataType dotProduct(const Vector<otherCoordDataType, otherDimension>&, const Vector<otherCoordDataType, otherDimension>&);
 
 
 	public:
 
-		// Default constructor.
-		Vector() {}
+		// Type of magnitude(): the coordinate type for floating-point vectors, double for integer vectors.
+		typedef typename std::conditional<std::is_floating_point<coordDataType>::value, coordDataType, double>::type magnitudeType;
+
+		// Default constructor. Leaves the coordinates uninitialised; Vector v{} zero-initialises them.
+		Vector() = default;
 
 		// Constructor that initializes the vector with an array of coordinates.
-		Vector(std::array<coordDataType, dimension> _coords) : coords(_coords) {}
+		constexpr Vector(std::array<coordDataType, dimension> _coords) : coords(_coords) {}
 
 		// Constructor for a 3D vector, initializes the vector with x, y, and z coordinates.
-		Vector(coordDataType _x, coordDataType _y, coordDataType _z) : coords({ _x, _y, _z }) {}
+		constexpr Vector(coordDataType _x, coordDataType _y, coordDataType _z) : coords({ _x, _y, _z }) {}
 
 		// Constructor for a 2D vector, initializes the vector with x and y coordinates.
-		Vector(coordDataType _x, coordDataType _y) : coords({ _x, _y }) {}
+		constexpr Vector(coordDataType _x, coordDataType _y) : coords({ _x, _y }) {}
+
+		// Constructor that evaluates an arithmetic expression such as a + b * s (see VectorExpression.h).
+		template <class Expression>
+		constexpr Vector(const VectorExpression<Expression, coordDataType, dimension>& _expression) : coords()
+		{
+			*this = _expression;
+		}
+
+		// Evaluate an arithmetic expression into this vector. All coordinates are computed before any is stored,
+		// as straight-line code: stored one by one from a loop, each store could change an operand of the next,
+		// and the compiler would have to reload them instead of keeping the coordinates in registers.
+		template <class Expression>
+		constexpr Vector& operator=(const VectorExpression<Expression, coordDataType, dimension>& _expression)
+		{
+			coords = evaluate(_expression, std::make_index_sequence<dimension>());
+			return *this;
+		}
+
+		// Compound assignment with a vector or an expression.
+		template <class Expression>
+		constexpr Vector& operator+=(const VectorExpression<Expression, coordDataType, dimension>& _expression)
+		{
+			return *this = *this + _expression;
+		}
+
+		template <class Expression>
+		constexpr Vector& operator-=(const VectorExpression<Expression, coordDataType, dimension>& _expression)
+		{
+			return *this = *this - _expression;
+		}
+
+		// Compound scaling by a scalar.
+		constexpr Vector& operator*=(coordDataType _scalar) { return *this = *this * _scalar; }
+		constexpr Vector& operator/=(coordDataType _scalar) { return *this = *this / _scalar; }
+
+		// Coordinate read without a range check, used when evaluating expressions.
+		constexpr coordDataType eval(size_t _index) const { return coords[_index]; }
 
 		
-		// Equality check
+		// Equality check with the default tolerance policy of the coordinate type (see Tolerance.h):
+		// exact for integer coordinates, a small absolute tolerance otherwise.
 		bool operator==(const Vector<coordDataType, dimension>&) const;
+
+		// Equality check with an explicit tolerance policy, applied to every coordinate.
+		template<class Policy>
+		bool equals(const Vector<coordDataType, dimension>&, const Policy&) const;
 		
 		// Not Equal
 		bool operator!=(const Vector<coordDataType, dimension>&) const;
 
-		// Addition
-		Vector <coordDataType, dimension> operator+(const Vector<coordDataType, dimension>&) const;
-
-		// Subtraction
-		Vector <coordDataType, dimension> operator-(const Vector<coordDataType, dimension>&) const;
+		// Addition, subtraction, negation and scalar multiplication/division are the expression operators
+		// declared in VectorExpression.h.
 
-		// Less than
-		bool operator<(const Vector<coordDataType, dimension>&) const;
+		// Less than (every coordinate strictly less). Not a strict weak ordering, so not usable for sorting;
+		// see the comparators in VectorOrder.h.
+		constexpr bool operator<(const Vector<coordDataType, dimension>&) const;
 
 		// Greater than
-		bool operator>(const Vector<coordDataType, dimension>&) const;
+		constexpr bool operator>(const Vector<coordDataType, dimension>&) const;
 		
 		// Index operator to access the vector's coordinates by index.
-		coordDataType operator[](size_t ) const;
+		// Range checked only when SCALEGEOM_CHECKED_ACCESS is set.
+		constexpr coordDataType operator[](size_t ) const;
+
+		// Mutable access to a coordinate, checked like the const version.
+		constexpr coordDataType& operator[](size_t );
+
+		// Index operator that always checks the index and throws std::out_of_range.
+		constexpr coordDataType at(size_t ) const;
 
 		//Assign a specific value to a given dimension (coordinate) of the Vector.
-		void assign(int dim, coordDataType value);
+		constexpr void assign(int dim, coordDataType value);
 
-		// Get the magnitude of the vector.
-		float magnitude() const;
+		// Get the magnitude of the vector, accumulated and returned in magnitudeType.
+		magnitudeType magnitude() const;
 
-		//Normalize the vector
+		//Normalize the vector (divide every coordinate by the magnitude). A zero vector becomes NaN.
 		void normalize();
 
+		// Normalized copy of the vector.
+		Vector normalized() const;
+
 
 };
 
 	typedef Vector<float, DIM2> Vector2f;
 	typedef Vector<float, DIM3> Vector3f;
+	typedef Vector<double, DIM2> Vector2d;
+	typedef Vector<double, DIM3> Vector3d;
 
 	// Implementation for the overloaded << (stream insertion) operator for the Vector class
 	template<class coordDataType, size_t dimension>
@@ -148,13 +235,20 @@ namespace scaleGeom {
 	// Overloaded '==' operator to compare two Vectors for equality.
 	template<class coordDataType, size_t dimension>
 	inline bool Vector<coordDataType, dimension>::operator==(const Vector<coordDataType, dimension>& _other) const
+	{
+		// The default policy compares integer coordinates exactly.
+		return equals(_other, typename ToleranceTraits<coordDataType>::DefaultPolicy());
+	}
+
+	// Compare two Vectors coordinate by coordinate with the given tolerance policy.
+	template<class coordDataType, size_t dimension>
+	template<class Policy>
+	inline bool Vector<coordDataType, dimension>::equals(const Vector<coordDataType, dimension>& _other, const Policy& _policy) const
 	{
 		// Iterate through each coordinate of the Vector.
 		for (size_t i = 0; i < dimension; i++)
 		{
-			// Use the IsEqualD function to check for approximate equality 
-			// (useful for float/double types to account for precision issues).
-			if (!IsEqualD(coords[i], _other.coords[i]))
+			if (!_policy(coords[i], _other.coords[i]))
 			{
 				// If any coordinate does not match, the Vectors are not equal.
 				return false;
@@ -172,42 +266,9 @@ namespace scaleGeom {
 		return !(*this == _other);
 	}
 
-	// Overloaded '+' operator to add two Vectors.
-	template<class coordDataType, size_t dimension>
-	inline Vector<coordDataType, dimension> Vector<coordDataType, dimension>::operator+(const Vector<coordDataType, dimension>& _other) const
-	{
-		// Create an array to store the result of the addition.
-		std::array<coordDataType, dimension> result;
-		// Iterate through each coordinate.
-		for (size_t i = 0; i < dimension; i++)
-		{
-			// Add corresponding coordinates of the two Vectors.
-			result[i] = coords[i] + _other.coords[i];
-		}
-		// Return a new Vector initialized with the result.
-		return Vector<coordDataType, dimension>(result);
-	}
-
-	// Overloaded '-' operator to subtract one Vector from another.
-	template<class coordDataType, size_t dimension>
-	inline Vector<coordDataType, dimension> Vector<coordDataType, dimension>::operator-(const Vector<coordDataType, dimension>& _other) const
-	{
-		// Create an array to store the result of the subtraction.
-		std::array<coordDataType, dimension> result;
-		// Iterate through each coordinate.
-		for (size_t i = 0; i < dimension; i++)
-		{
-			// Subtract corresponding coordinates of the two Vectors.
-			result[i] = coords[i] - _other.coords[i];
-		}
-		// Return a new Vector initialized with the result.
-		return Vector<coordDataType, dimension>(result);
-	}
-
-
 	// Overloaded '<' operator for the Vector class to determine if one vector is "less than" another.
 	template<class coordDataType, size_t dimension>
-	inline bool Vector<coordDataType, dimension>::operator<(const Vector<coordDataType, dimension>& _other) const
+	constexpr bool Vector<coordDataType, dimension>::operator<(const Vector<coordDataType, dimension>& _other) const
 	{
 		// Iterate through each dimension of the vector.
 		for (size_t i = 0; i < dimension; i++)
@@ -228,7 +289,7 @@ namespace scaleGeom {
 
 	// Overloaded '>' operator for the Vector class to determine if one vector is "greater than" another.
 	template<class coordDataType, size_t dimension>
-	inline bool Vector<coordDataType, dimension>::operator>(const Vector<coordDataType, dimension>& _other) const
+	constexpr bool Vector<coordDataType, dimension>::operator>(const Vector<coordDataType, dimension>& _other) const
 	{
 		// Iterate through each dimension of the vector.
 		for (size_t i = 0; i < dimension; i++)
@@ -250,25 +311,57 @@ namespace scaleGeom {
 
 	// Overloaded '[]' operator to access the coordinates of the Vector by index.
 	template<class coordDataType, size_t dimension>
-	inline coordDataType Vector<coordDataType, dimension>::operator[](size_t _index) const
+	constexpr coordDataType Vector<coordDataType, dimension>::operator[](size_t _index) const
+	{
+#if SCALEGEOM_CHECKED_ACCESS
+		return at(_index);
+#else
+		return coords[_index];
+#endif
+	}
+
+	template<class coordDataType, size_t dimension>
+	constexpr coordDataType& Vector<coordDataType, dimension>::operator[](size_t _index)
+	{
+#if SCALEGEOM_CHECKED_ACCESS
+		if (_index >= dimension)
+			throw std::out_of_range("Index out of range\n");
+#endif
+		return coords[_index];
+	}
+
+	template<class coordDataType, size_t dimension>
+	constexpr coordDataType Vector<coordDataType, dimension>::at(size_t _index) const
 	{
 		// Check if the provided index is within the valid range [0, dimension).
 		if (_index >= dimension)
 		{
 			// If the index is out of range, throw an exception.
 			throw std::out_of_range("Index out of range\n");
-			// The return statement below can be used as an alternative to throwing an exception.
-			// It would return a default-constructed value of the coordDataType (e.g., 0 for int).
-			// return coordDataType();
 		}
 
 		// If the index is valid, return the coordinate at the specified index.
 		return coords[_index];
 	}
 
+	// Coordinate with an index fixed at compile time; an out of range index does not compile.
+	template<size_t index, class coordDataType, size_t dimension>
+	constexpr coordDataType& get(Vector<coordDataType, dimension>& vec)
+	{
+		static_assert(index < dimension, "Vector index out of range");
+		return vec[index];
+	}
+
+	template<size_t index, class coordDataType, size_t dimension>
+	constexpr coordDataType get(const Vector<coordDataType, dimension>& vec)
+	{
+		static_assert(index < dimension, "Vector index out of range");
+		return vec.eval(index);
+	}
+
 	// Method to assign a specific value to a given dimension (coordinate) of the Vector.
 	template<class coordDataType, size_t dimension>
-	inline void Vector<coordDataType, dimension>::assign(int dim, coordDataType value)
+	constexpr void Vector<coordDataType, dimension>::assign(int dim, coordDataType value)
 	{
 		if(dim>=dimension)
 			throw std::out_of_range("Index out of range\n");
@@ -278,31 +371,39 @@ namespace scaleGeom {
 	}
 
 	template<class coordDataType, size_t dimension>
-	inline float Vector<coordDataType, dimension>::magnitude() const
+	inline typename Vector<coordDataType, dimension>::magnitudeType Vector<coordDataType, dimension>::magnitude() const
 	{
-		float result = 0;
+		magnitudeType result = 0;
 		for (size_t i = 0; i < dimension; i++)
 		{
-			result += coords[i] * coords[i];
+			result += static_cast<magnitudeType>(coords[i]) * static_cast<magnitudeType>(coords[i]);
 		}
-		return sqrt(result);
+		return std::sqrt(result);
 	}
 
 	template<class coordDataType, size_t dimension>
 	inline void Vector<coordDataType, dimension>::normalize()
 	{
-		float mag = magnitude();
+		magnitudeType mag = magnitude();
 		for (size_t i = 0; i < dimension; i++)
 		{
-			coords[i] /= mag;
+			coords[i] = static_cast<coordDataType>(coords[i] / mag);
 		}
 	}
 
+	template<class coordDataType, size_t dimension>
+	inline Vector<coordDataType, dimension> Vector<coordDataType, dimension>::normalized() const
+	{
+		Vector result(*this);
+		result.normalize();
+		return result;
+	}
+
 	
 	// Template function to calculate the dot product of two vectors.
     // The vectors can be of any dimension and the coordinate data type can be any arithmetic type (e.g., int, float, double).
 	template<class coordDataType, size_t dimension>
-	coordDataType dotProduct(const Vector<coordDataType, dimension>& v1, const Vector<coordDataType, dimension>& v2)
+	constexpr coordDataType dotProduct(const Vector<coordDataType, dimension>& v1, const Vector<coordDataType, dimension>& v2)
 	{		
 		// Initialize the dot product result to zero. 
 		// The type of the result is the same as the coordinate type of the vectors.
@@ -321,11 +422,29 @@ namespace scaleGeom {
 	}
 
 	//Cross Product in 2D
-	float crossProduct2D(Vector2f v1, Vector2f v2);
+	constexpr float crossProduct2D(const Vector2f& v1, const Vector2f& v2)
+	{
+		return v1[X] * v2[Y] - v1[Y] * v2[X];
+	}
+
 	//Cross Product in 3D
-	Vector3f crossProduct3D(Vector3f v1, Vector3f v2);
+	constexpr Vector3f crossProduct3D(const Vector3f& v1, const Vector3f& v2)
+	{
+		float x = v1[Y] * v2[Z] - v1[Z] * v2[Y];
+		float y = v1[Z] * v2[X] - v1[X] * v2[Z];
+		float z = v1[X] * v2[Y] - v1[Y] * v2[X];
+
+		return Vector3f(x, y, z);
+	}
+
 	//Scalar Triple Product
-	float scalarTripleProduct(Vector3f v1, Vector3f v2, Vector3f v3);
+	constexpr float scalarTripleProduct(const Vector3f& v1, const Vector3f& v2, const Vector3f& v3)
+	{
+		//scalar triple product is the dot product of the cross product of two vectors and a third vector
+		return dotProduct(crossProduct3D(v1, v2), v3);
+	}
+
+	// Batched versions of the above over whole point arrays are declared in VectorBatch.h.
 
 
 
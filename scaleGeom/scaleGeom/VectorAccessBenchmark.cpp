@@ -0,0 +1,158 @@
+#include "Benchmark.h"
+#include "Vector.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    const int REPEATS = 5;
+
+    // Pairs per block. The kernels run over one block again and again, so the figures are those of the
+    // arithmetic and not of memory bandwidth (16D: 2 x 64 KB); the trip count is a compile time constant.
+    const size_t BLOCK = 1024;
+
+    template<size_t dimension>
+    std::vector<scaleGeom::Vector<float, dimension>> randomVectors(size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        std::vector<scaleGeom::Vector<float, dimension>> vectors(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            for (size_t dim = 0; dim < dimension; dim++)
+            {
+                vectors[i][dim] = dist(rng);
+            }
+        }
+        return vectors;
+    }
+
+    // dotProduct written with at(), i.e. with the range check operator[] used to perform on every access.
+    template<size_t dimension>
+    float checkedDotProduct(const scaleGeom::Vector<float, dimension>& v1, const scaleGeom::Vector<float, dimension>& v2)
+    {
+        float dotProduct = 0;
+        for (size_t i = 0; i < dimension; i++)
+        {
+            dotProduct += v1.at(i) * v2.at(i);
+        }
+        return dotProduct;
+    }
+
+    // Split keys of a kd-tree node: the coordinates of a block along an axis picked at run time. The index is not
+    // known to the compiler, so the range check of at() stays in the loop unless the compiler unswitches it, and
+    // its throw keeps the loop scalar; unchecked, it is a strided load that can vectorize.
+    template<size_t dimension>
+    void splitKeys(const scaleGeom::Vector<float, dimension>* __restrict points, size_t axis, float* __restrict keys)
+    {
+        for (size_t i = 0; i < BLOCK; i++)
+        {
+            keys[i] = points[i][axis];
+        }
+    }
+
+    template<size_t dimension>
+    void checkedSplitKeys(const scaleGeom::Vector<float, dimension>* __restrict points, size_t axis, float* __restrict keys)
+    {
+        for (size_t i = 0; i < BLOCK; i++)
+        {
+            keys[i] = points[i].at(axis);
+        }
+    }
+
+    template<class Function>
+    double bestOf(Function function)
+    {
+        double best = 1e30;
+        for (int r = 0; r < REPEATS; r++)
+        {
+            Timer timer;
+            function();
+            best = std::min(best, timer.seconds());
+        }
+        return best;
+    }
+
+    // Kernels without arithmetic (flopsPerPair 0) get no GFLOP/s figure.
+    void report(const char* label, size_t dimension, double seconds, size_t count, size_t flopsPerPair)
+    {
+        std::cout << "  " << std::left << std::setw(20) << label << std::right
+            << std::setw(4) << dimension << "D "
+            << std::setw(9) << std::fixed << std::setprecision(3) << seconds * 1e3 << " ms  "
+            << std::setw(8) << std::setprecision(2) << seconds * 1e9 / count << " ns/pair";
+        if (flopsPerPair)
+            std::cout << "  " << std::setw(7) << std::setprecision(2) << static_cast<double>(flopsPerPair) * count / seconds / 1e9 << " GFLOP/s";
+        std::cout << std::endl;
+    }
+
+    template<size_t dimension>
+    void run(size_t count)
+    {
+        typedef scaleGeom::Vector<float, dimension> Vec;
+        const std::vector<Vec> a = randomVectors<dimension>(BLOCK, 1), b = randomVectors<dimension>(BLOCK, 2);
+        const size_t rounds = std::max<size_t>(1, count / BLOCK);
+        count = rounds * BLOCK;
+        std::vector<float> out(BLOCK), reference(BLOCK);
+
+        // With the index bounded by the dimension, the compiler proves the check of at() false and drops it,
+        // so both loops compile to the same code; the unchecked operator[] costs nothing here either way.
+        report("dotProduct", dimension, bestOf([&] {
+            for (size_t r = 0; r < rounds; r++)
+            {
+                for (size_t i = 0; i < BLOCK; i++)
+                {
+                    out[i] = scaleGeom::dotProduct(a[i], b[i]);
+                }
+                scaleGeom::bench::doNotOptimize(out.data());
+            }
+        }), count, 2 * dimension);
+        reference = out;
+        report("checked (at)", dimension, bestOf([&] {
+            for (size_t r = 0; r < rounds; r++)
+            {
+                for (size_t i = 0; i < BLOCK; i++)
+                {
+                    out[i] = checkedDotProduct(a[i], b[i]);
+                }
+                scaleGeom::bench::doNotOptimize(out.data());
+            }
+        }), count, 2 * dimension);
+        if (out != reference)
+            std::cout << "  MISMATCH" << std::endl;
+
+        // A runtime axis, as in kd-tree splitting: here the check cannot be folded away.
+        volatile size_t picked = dimension - 1;
+        const size_t axis = picked;
+        report("split keys", dimension, bestOf([&] {
+            for (size_t r = 0; r < rounds; r++)
+            {
+                splitKeys(a.data(), axis, out.data());
+                scaleGeom::bench::doNotOptimize(out.data());
+            }
+        }), count, 0);
+        report("split keys (at)", dimension, bestOf([&] {
+            for (size_t r = 0; r < rounds; r++)
+            {
+                checkedSplitKeys(a.data(), axis, reference.data());
+                scaleGeom::bench::doNotOptimize(reference.data());
+            }
+        }), count, 0);
+        if (out != reference)
+            std::cout << "  MISMATCH" << std::endl;
+    }
+}
+
+SCALEGEOM_BENCHMARK(VectorElementAccess)
+{
+    const size_t count = scaleGeom::bench::problemSize(2000000);
+    std::cout << "  pairs: " << count << " (blocks of " << BLOCK << "), operator[] range checks: " << (SCALEGEOM_CHECKED_ACCESS ? "on" : "off") << std::endl;
+    run<3>(count);
+    run<8>(count);
+    run<16>(count);
+}
@@ -0,0 +1,730 @@
+#include "VectorBatch.h"
+#include "CpuFeatures.h"
+
+#include <cmath>
+
+#if defined(SCALEGEOM_X86)
+#include <immintrin.h>
+#endif
+
+// Keep the compiler from contracting mul/add pairs into FMA, which would make the
+// results depend on the selected instruction set.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize ("fp-contract=off")
+#elif defined(_MSC_VER)
+#pragma fp_contract (off)
+#endif
+
+using scaleGeom::ConstPointCloudView;
+using scaleGeom::PointCloudView;
+
+namespace {
+
+    typedef ConstPointCloudView<float, 2> View2;
+    typedef ConstPointCloudView<float, 3> View3;
+    typedef PointCloudView<float, 3> OutView3;
+
+    // ---------------------------------------------------------------------------------------
+    // Scalar kernels. They also finish the tails of the SIMD kernels, starting at index begin.
+    // ---------------------------------------------------------------------------------------
+
+    void dot2Scalar(const View2& a, const View2& b, float* out, size_t begin)
+    {
+        for (size_t i = begin; i < a.count; i++)
+        {
+            out[i] = a.axes[0][i] * b.axes[0][i] + a.axes[1][i] * b.axes[1][i];
+        }
+    }
+
+    void dot3Scalar(const View3& a, const View3& b, float* out, size_t begin)
+    {
+        for (size_t i = begin; i < a.count; i++)
+        {
+            out[i] = a.axes[0][i] * b.axes[0][i] + a.axes[1][i] * b.axes[1][i] + a.axes[2][i] * b.axes[2][i];
+        }
+    }
+
+    void cross3Scalar(const View3& a, const View3& b, const OutView3& out, size_t begin)
+    {
+        for (size_t i = begin; i < a.count; i++)
+        {
+            out.axes[0][i] = a.axes[1][i] * b.axes[2][i] - a.axes[2][i] * b.axes[1][i];
+            out.axes[1][i] = a.axes[2][i] * b.axes[0][i] - a.axes[0][i] * b.axes[2][i];
+            out.axes[2][i] = a.axes[0][i] * b.axes[1][i] - a.axes[1][i] * b.axes[0][i];
+        }
+    }
+
+    void triple3Scalar(const View3& a, const View3& b, const View3& c, float* out, size_t begin)
+    {
+        for (size_t i = begin; i < a.count; i++)
+        {
+            float x = a.axes[1][i] * b.axes[2][i] - a.axes[2][i] * b.axes[1][i];
+            float y = a.axes[2][i] * b.axes[0][i] - a.axes[0][i] * b.axes[2][i];
+            float z = a.axes[0][i] * b.axes[1][i] - a.axes[1][i] * b.axes[0][i];
+            out[i] = x * c.axes[0][i] + y * c.axes[1][i] + z * c.axes[2][i];
+        }
+    }
+
+    // The normalization kernels load a point completely before storing it, so in and out may alias.
+    void normalize3Scalar(const View3& in, const OutView3& out, size_t begin)
+    {
+        for (size_t i = begin; i < in.count; i++)
+        {
+            float x = in.axes[0][i], y = in.axes[1][i], z = in.axes[2][i];
+            float length = std::sqrt(x * x + y * y + z * z);
+            out.axes[0][i] = x / length;
+            out.axes[1][i] = y / length;
+            out.axes[2][i] = z / length;
+        }
+    }
+
+    void normalize3FastScalar(const View3& in, const OutView3& out, size_t begin)
+    {
+        for (size_t i = begin; i < in.count; i++)
+        {
+            float x = in.axes[0][i], y = in.axes[1][i], z = in.axes[2][i];
+            float inverse = 1.0f / std::sqrt(x * x + y * y + z * z);
+            out.axes[0][i] = x * inverse;
+            out.axes[1][i] = y * inverse;
+            out.axes[2][i] = z * inverse;
+        }
+    }
+
+    template<class Policy>
+    void equal3Scalar(const View3& a, const View3& b, uint8_t* out, const Policy& policy, size_t begin)
+    {
+        for (size_t i = begin; i < a.count; i++)
+        {
+            out[i] = policy(a.axes[0][i], b.axes[0][i]) && policy(a.axes[1][i], b.axes[1][i]) && policy(a.axes[2][i], b.axes[2][i]) ? 1 : 0;
+        }
+    }
+
+#if defined(SCALEGEOM_X86)
+
+    // ---------------------------------------------------------------------------------------
+    // SSE4.1 kernels, 4 points per iteration.
+    // ---------------------------------------------------------------------------------------
+
+    SCALEGEOM_TARGET_SSE41 void dot2Sse(const View2& a, const View2& b, float* out)
+    {
+        size_t i = 0;
+        for (; i + 4 <= a.count; i += 4)
+        {
+            __m128 x = _mm_mul_ps(_mm_loadu_ps(a.axes[0] + i), _mm_loadu_ps(b.axes[0] + i));
+            __m128 y = _mm_mul_ps(_mm_loadu_ps(a.axes[1] + i), _mm_loadu_ps(b.axes[1] + i));
+            _mm_storeu_ps(out + i, _mm_add_ps(x, y));
+        }
+        dot2Scalar(a, b, out, i);
+    }
+
+    SCALEGEOM_TARGET_SSE41 void dot3Sse(const View3& a, const View3& b, float* out)
+    {
+        size_t i = 0;
+        for (; i + 4 <= a.count; i += 4)
+        {
+            __m128 x = _mm_mul_ps(_mm_loadu_ps(a.axes[0] + i), _mm_loadu_ps(b.axes[0] + i));
+            __m128 y = _mm_mul_ps(_mm_loadu_ps(a.axes[1] + i), _mm_loadu_ps(b.axes[1] + i));
+            __m128 z = _mm_mul_ps(_mm_loadu_ps(a.axes[2] + i), _mm_loadu_ps(b.axes[2] + i));
+            _mm_storeu_ps(out + i, _mm_add_ps(_mm_add_ps(x, y), z));
+        }
+        dot3Scalar(a, b, out, i);
+    }
+
+    SCALEGEOM_TARGET_SSE41 void cross3Sse(const View3& a, const View3& b, const OutView3& out)
+    {
+        size_t i = 0;
+        for (; i + 4 <= a.count; i += 4)
+        {
+            __m128 ax = _mm_loadu_ps(a.axes[0] + i), ay = _mm_loadu_ps(a.axes[1] + i), az = _mm_loadu_ps(a.axes[2] + i);
+            __m128 bx = _mm_loadu_ps(b.axes[0] + i), by = _mm_loadu_ps(b.axes[1] + i), bz = _mm_loadu_ps(b.axes[2] + i);
+            _mm_storeu_ps(out.axes[0] + i, _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by)));
+            _mm_storeu_ps(out.axes[1] + i, _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz)));
+            _mm_storeu_ps(out.axes[2] + i, _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx)));
+        }
+        cross3Scalar(a, b, out, i);
+    }
+
+    SCALEGEOM_TARGET_SSE41 void triple3Sse(const View3& a, const View3& b, const View3& c, float* out)
+    {
+        size_t i = 0;
+        for (; i + 4 <= a.count; i += 4)
+        {
+            __m128 ax = _mm_loadu_ps(a.axes[0] + i), ay = _mm_loadu_ps(a.axes[1] + i), az = _mm_loadu_ps(a.axes[2] + i);
+            __m128 bx = _mm_loadu_ps(b.axes[0] + i), by = _mm_loadu_ps(b.axes[1] + i), bz = _mm_loadu_ps(b.axes[2] + i);
+            __m128 x = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+            __m128 y = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+            __m128 z = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+            __m128 dot = _mm_add_ps(_mm_mul_ps(x, _mm_loadu_ps(c.axes[0] + i)), _mm_mul_ps(y, _mm_loadu_ps(c.axes[1] + i)));
+            _mm_storeu_ps(out + i, _mm_add_ps(dot, _mm_mul_ps(z, _mm_loadu_ps(c.axes[2] + i))));
+        }
+        triple3Scalar(a, b, c, out, i);
+    }
+
+    SCALEGEOM_TARGET_SSE41 void normalize3Sse(const View3& in, const OutView3& out)
+    {
+        size_t i = 0;
+        for (; i + 4 <= in.count; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(in.axes[0] + i), y = _mm_loadu_ps(in.axes[1] + i), z = _mm_loadu_ps(in.axes[2] + i);
+            __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+            _mm_storeu_ps(out.axes[0] + i, _mm_div_ps(x, length));
+            _mm_storeu_ps(out.axes[1] + i, _mm_div_ps(y, length));
+            _mm_storeu_ps(out.axes[2] + i, _mm_div_ps(z, length));
+        }
+        normalize3Scalar(in, out, i);
+    }
+
+    // Reciprocal square root estimate (12 bits) refined by one Newton-Raphson step: r * (1.5 - 0.5 * s * r * r).
+    SCALEGEOM_TARGET_SSE41 void normalize3FastSse(const View3& in, const OutView3& out)
+    {
+        const __m128 half = _mm_set1_ps(0.5f), threeHalves = _mm_set1_ps(1.5f);
+        size_t i = 0;
+        for (; i + 4 <= in.count; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(in.axes[0] + i), y = _mm_loadu_ps(in.axes[1] + i), z = _mm_loadu_ps(in.axes[2] + i);
+            __m128 squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+            __m128 estimate = _mm_rsqrt_ps(squared);
+            __m128 step = _mm_sub_ps(threeHalves, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(half, squared), estimate), estimate));
+            __m128 inverse = _mm_mul_ps(estimate, step);
+            _mm_storeu_ps(out.axes[0] + i, _mm_mul_ps(x, inverse));
+            _mm_storeu_ps(out.axes[1] + i, _mm_mul_ps(y, inverse));
+            _mm_storeu_ps(out.axes[2] + i, _mm_mul_ps(z, inverse));
+        }
+        normalize3FastScalar(in, out, i);
+    }
+
+    // Lane masks of the tolerance policies. They evaluate the same expressions as the policies in
+    // Tolerance.h; the ulp version takes the difference of the ordered bit patterns modulo 2^32,
+    // which is exact for maxUlps below 2^24.
+    SCALEGEOM_TARGET_SSE41 __m128 equalLanesSse(__m128 a, __m128 b, const scaleGeom::AbsoluteTolerance<float>& policy)
+    {
+        __m128 difference = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(a, b));
+        return _mm_or_ps(_mm_cmpeq_ps(a, b), _mm_cmple_ps(difference, _mm_set1_ps(policy.absolute)));
+    }
+
+    SCALEGEOM_TARGET_SSE41 __m128 equalLanesSse(__m128 a, __m128 b, const scaleGeom::RelativeTolerance<float>& policy)
+    {
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        __m128 difference = _mm_andnot_ps(signMask, _mm_sub_ps(a, b));
+        __m128 largest = _mm_max_ps(_mm_andnot_ps(signMask, a), _mm_andnot_ps(signMask, b));
+        __m128 bound = _mm_max_ps(_mm_set1_ps(policy.absolute), _mm_mul_ps(_mm_set1_ps(policy.relative), largest));
+        __m128 within = _mm_and_ps(_mm_cmple_ps(difference, bound), _mm_cmplt_ps(difference, _mm_set1_ps(HUGE_VALF)));
+        return _mm_or_ps(_mm_cmpeq_ps(a, b), within);
+    }
+
+    SCALEGEOM_TARGET_SSE41 __m128i orderedBitsSse(__m128 v)
+    {
+        __m128i bits = _mm_castps_si128(v);
+        __m128i sign = _mm_srai_epi32(bits, 31);
+        __m128i magnitude = _mm_and_si128(bits, _mm_set1_epi32(0x7fffffff));
+        return _mm_sub_epi32(_mm_xor_si128(magnitude, sign), sign);
+    }
+
+    SCALEGEOM_TARGET_SSE41 __m128 equalLanesSse(__m128 a, __m128 b, const scaleGeom::UlpTolerance<float>& policy)
+    {
+        __m128i distance = _mm_abs_epi32(_mm_sub_epi32(orderedBitsSse(a), orderedBitsSse(b)));
+        __m128i within = _mm_cmpeq_epi32(_mm_min_epu32(distance, _mm_set1_epi32(static_cast<int>(policy.maxUlps))), distance);
+        return _mm_or_ps(_mm_cmpeq_ps(a, b), _mm_and_ps(_mm_castsi128_ps(within), _mm_cmpord_ps(a, b)));
+    }
+
+    template<class Policy>
+    SCALEGEOM_TARGET_SSE41 void equal3Sse(const View3& a, const View3& b, uint8_t* out, const Policy& policy)
+    {
+        size_t i = 0;
+        for (; i + 4 <= a.count; i += 4)
+        {
+            __m128 x = equalLanesSse(_mm_loadu_ps(a.axes[0] + i), _mm_loadu_ps(b.axes[0] + i), policy);
+            __m128 y = equalLanesSse(_mm_loadu_ps(a.axes[1] + i), _mm_loadu_ps(b.axes[1] + i), policy);
+            __m128 z = equalLanesSse(_mm_loadu_ps(a.axes[2] + i), _mm_loadu_ps(b.axes[2] + i), policy);
+            int mask = _mm_movemask_ps(_mm_and_ps(_mm_and_ps(x, y), z));
+            for (int lane = 0; lane < 4; lane++)
+            {
+                out[i + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+            }
+        }
+        equal3Scalar(a, b, out, policy, i);
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // AVX2 kernels, 8 points per iteration.
+    // ---------------------------------------------------------------------------------------
+
+    SCALEGEOM_TARGET_AVX2 void dot2Avx2(const View2& a, const View2& b, float* out)
+    {
+        size_t i = 0;
+        for (; i + 8 <= a.count; i += 8)
+        {
+            __m256 x = _mm256_mul_ps(_mm256_loadu_ps(a.axes[0] + i), _mm256_loadu_ps(b.axes[0] + i));
+            __m256 y = _mm256_mul_ps(_mm256_loadu_ps(a.axes[1] + i), _mm256_loadu_ps(b.axes[1] + i));
+            _mm256_storeu_ps(out + i, _mm256_add_ps(x, y));
+        }
+        dot2Scalar(a, b, out, i);
+    }
+
+    SCALEGEOM_TARGET_AVX2 void dot3Avx2(const View3& a, const View3& b, float* out)
+    {
+        size_t i = 0;
+        for (; i + 8 <= a.count; i += 8)
+        {
+            __m256 x = _mm256_mul_ps(_mm256_loadu_ps(a.axes[0] + i), _mm256_loadu_ps(b.axes[0] + i));
+            __m256 y = _mm256_mul_ps(_mm256_loadu_ps(a.axes[1] + i), _mm256_loadu_ps(b.axes[1] + i));
+            __m256 z = _mm256_mul_ps(_mm256_loadu_ps(a.axes[2] + i), _mm256_loadu_ps(b.axes[2] + i));
+            _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_add_ps(x, y), z));
+        }
+        dot3Scalar(a, b, out, i);
+    }
+
+    SCALEGEOM_TARGET_AVX2 void cross3Avx2(const View3& a, const View3& b, const OutView3& out)
+    {
+        size_t i = 0;
+        for (; i + 8 <= a.count; i += 8)
+        {
+            __m256 ax = _mm256_loadu_ps(a.axes[0] + i), ay = _mm256_loadu_ps(a.axes[1] + i), az = _mm256_loadu_ps(a.axes[2] + i);
+            __m256 bx = _mm256_loadu_ps(b.axes[0] + i), by = _mm256_loadu_ps(b.axes[1] + i), bz = _mm256_loadu_ps(b.axes[2] + i);
+            _mm256_storeu_ps(out.axes[0] + i, _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by)));
+            _mm256_storeu_ps(out.axes[1] + i, _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz)));
+            _mm256_storeu_ps(out.axes[2] + i, _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx)));
+        }
+        cross3Scalar(a, b, out, i);
+    }
+
+    SCALEGEOM_TARGET_AVX2 void triple3Avx2(const View3& a, const View3& b, const View3& c, float* out)
+    {
+        size_t i = 0;
+        for (; i + 8 <= a.count; i += 8)
+        {
+            __m256 ax = _mm256_loadu_ps(a.axes[0] + i), ay = _mm256_loadu_ps(a.axes[1] + i), az = _mm256_loadu_ps(a.axes[2] + i);
+            __m256 bx = _mm256_loadu_ps(b.axes[0] + i), by = _mm256_loadu_ps(b.axes[1] + i), bz = _mm256_loadu_ps(b.axes[2] + i);
+            __m256 x = _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by));
+            __m256 y = _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz));
+            __m256 z = _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx));
+            __m256 dot = _mm256_add_ps(_mm256_mul_ps(x, _mm256_loadu_ps(c.axes[0] + i)), _mm256_mul_ps(y, _mm256_loadu_ps(c.axes[1] + i)));
+            _mm256_storeu_ps(out + i, _mm256_add_ps(dot, _mm256_mul_ps(z, _mm256_loadu_ps(c.axes[2] + i))));
+        }
+        triple3Scalar(a, b, c, out, i);
+    }
+
+    SCALEGEOM_TARGET_AVX2 void normalize3Avx2(const View3& in, const OutView3& out)
+    {
+        size_t i = 0;
+        for (; i + 8 <= in.count; i += 8)
+        {
+            __m256 x = _mm256_loadu_ps(in.axes[0] + i), y = _mm256_loadu_ps(in.axes[1] + i), z = _mm256_loadu_ps(in.axes[2] + i);
+            __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z)));
+            _mm256_storeu_ps(out.axes[0] + i, _mm256_div_ps(x, length));
+            _mm256_storeu_ps(out.axes[1] + i, _mm256_div_ps(y, length));
+            _mm256_storeu_ps(out.axes[2] + i, _mm256_div_ps(z, length));
+        }
+        normalize3Scalar(in, out, i);
+    }
+
+    // Reciprocal square root estimate (12 bits) refined by one Newton-Raphson step: r * (1.5 - 0.5 * s * r * r).
+    SCALEGEOM_TARGET_AVX2 void normalize3FastAvx2(const View3& in, const OutView3& out)
+    {
+        const __m256 half = _mm256_set1_ps(0.5f), threeHalves = _mm256_set1_ps(1.5f);
+        size_t i = 0;
+        for (; i + 8 <= in.count; i += 8)
+        {
+            __m256 x = _mm256_loadu_ps(in.axes[0] + i), y = _mm256_loadu_ps(in.axes[1] + i), z = _mm256_loadu_ps(in.axes[2] + i);
+            __m256 squared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+            __m256 estimate = _mm256_rsqrt_ps(squared);
+            __m256 step = _mm256_sub_ps(threeHalves, _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(half, squared), estimate), estimate));
+            __m256 inverse = _mm256_mul_ps(estimate, step);
+            _mm256_storeu_ps(out.axes[0] + i, _mm256_mul_ps(x, inverse));
+            _mm256_storeu_ps(out.axes[1] + i, _mm256_mul_ps(y, inverse));
+            _mm256_storeu_ps(out.axes[2] + i, _mm256_mul_ps(z, inverse));
+        }
+        normalize3FastScalar(in, out, i);
+    }
+
+    SCALEGEOM_TARGET_AVX2 __m256 equalLanesAvx2(__m256 a, __m256 b, const scaleGeom::AbsoluteTolerance<float>& policy)
+    {
+        __m256 difference = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_sub_ps(a, b));
+        return _mm256_or_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ), _mm256_cmp_ps(difference, _mm256_set1_ps(policy.absolute), _CMP_LE_OQ));
+    }
+
+    SCALEGEOM_TARGET_AVX2 __m256 equalLanesAvx2(__m256 a, __m256 b, const scaleGeom::RelativeTolerance<float>& policy)
+    {
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+        __m256 difference = _mm256_andnot_ps(signMask, _mm256_sub_ps(a, b));
+        __m256 largest = _mm256_max_ps(_mm256_andnot_ps(signMask, a), _mm256_andnot_ps(signMask, b));
+        __m256 bound = _mm256_max_ps(_mm256_set1_ps(policy.absolute), _mm256_mul_ps(_mm256_set1_ps(policy.relative), largest));
+        __m256 within = _mm256_and_ps(_mm256_cmp_ps(difference, bound, _CMP_LE_OQ), _mm256_cmp_ps(difference, _mm256_set1_ps(HUGE_VALF), _CMP_LT_OQ));
+        return _mm256_or_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ), within);
+    }
+
+    SCALEGEOM_TARGET_AVX2 __m256i orderedBitsAvx2(__m256 v)
+    {
+        __m256i bits = _mm256_castps_si256(v);
+        __m256i sign = _mm256_srai_epi32(bits, 31);
+        __m256i magnitude = _mm256_and_si256(bits, _mm256_set1_epi32(0x7fffffff));
+        return _mm256_sub_epi32(_mm256_xor_si256(magnitude, sign), sign);
+    }
+
+    SCALEGEOM_TARGET_AVX2 __m256 equalLanesAvx2(__m256 a, __m256 b, const scaleGeom::UlpTolerance<float>& policy)
+    {
+        __m256i distance = _mm256_abs_epi32(_mm256_sub_epi32(orderedBitsAvx2(a), orderedBitsAvx2(b)));
+        __m256i within = _mm256_cmpeq_epi32(_mm256_min_epu32(distance, _mm256_set1_epi32(static_cast<int>(policy.maxUlps))), distance);
+        return _mm256_or_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ), _mm256_and_ps(_mm256_castsi256_ps(within), _mm256_cmp_ps(a, b, _CMP_ORD_Q)));
+    }
+
+    template<class Policy>
+    SCALEGEOM_TARGET_AVX2 void equal3Avx2(const View3& a, const View3& b, uint8_t* out, const Policy& policy)
+    {
+        size_t i = 0;
+        for (; i + 8 <= a.count; i += 8)
+        {
+            __m256 x = equalLanesAvx2(_mm256_loadu_ps(a.axes[0] + i), _mm256_loadu_ps(b.axes[0] + i), policy);
+            __m256 y = equalLanesAvx2(_mm256_loadu_ps(a.axes[1] + i), _mm256_loadu_ps(b.axes[1] + i), policy);
+            __m256 z = equalLanesAvx2(_mm256_loadu_ps(a.axes[2] + i), _mm256_loadu_ps(b.axes[2] + i), policy);
+            int mask = _mm256_movemask_ps(_mm256_and_ps(_mm256_and_ps(x, y), z));
+            for (int lane = 0; lane < 8; lane++)
+            {
+                out[i + lane] = static_cast<uint8_t>((mask >> lane) & 1);
+            }
+        }
+        equal3Scalar(a, b, out, policy, i);
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // AVX-512 kernels, 16 points per iteration.
+    // ---------------------------------------------------------------------------------------
+
+    // Every lane of a 16-lane mask. The unmasked forms of some AVX-512 intrinsics are written in GCC's headers
+    // as masked ones with an undefined source, which GCC 12 reports as maybe used uninitialized; the kernels use
+    // the zero-masking forms with all lanes set instead, which compile to the same instructions.
+    const __mmask16 ALL_LANES = 0xffff;
+
+    SCALEGEOM_TARGET_AVX512 void dot2Avx512(const View2& a, const View2& b, float* out)
+    {
+        size_t i = 0;
+        for (; i + 16 <= a.count; i += 16)
+        {
+            __m512 x = _mm512_mul_ps(_mm512_loadu_ps(a.axes[0] + i), _mm512_loadu_ps(b.axes[0] + i));
+            __m512 y = _mm512_mul_ps(_mm512_loadu_ps(a.axes[1] + i), _mm512_loadu_ps(b.axes[1] + i));
+            _mm512_storeu_ps(out + i, _mm512_add_ps(x, y));
+        }
+        dot2Scalar(a, b, out, i);
+    }
+
+    SCALEGEOM_TARGET_AVX512 void dot3Avx512(const View3& a, const View3& b, float* out)
+    {
+        size_t i = 0;
+        for (; i + 16 <= a.count; i += 16)
+        {
+            __m512 x = _mm512_mul_ps(_mm512_loadu_ps(a.axes[0] + i), _mm512_loadu_ps(b.axes[0] + i));
+            __m512 y = _mm512_mul_ps(_mm512_loadu_ps(a.axes[1] + i), _mm512_loadu_ps(b.axes[1] + i));
+            __m512 z = _mm512_mul_ps(_mm512_loadu_ps(a.axes[2] + i), _mm512_loadu_ps(b.axes[2] + i));
+            _mm512_storeu_ps(out + i, _mm512_add_ps(_mm512_add_ps(x, y), z));
+        }
+        dot3Scalar(a, b, out, i);
+    }
+
+    SCALEGEOM_TARGET_AVX512 void cross3Avx512(const View3& a, const View3& b, const OutView3& out)
+    {
+        size_t i = 0;
+        for (; i + 16 <= a.count; i += 16)
+        {
+            __m512 ax = _mm512_loadu_ps(a.axes[0] + i), ay = _mm512_loadu_ps(a.axes[1] + i), az = _mm512_loadu_ps(a.axes[2] + i);
+            __m512 bx = _mm512_loadu_ps(b.axes[0] + i), by = _mm512_loadu_ps(b.axes[1] + i), bz = _mm512_loadu_ps(b.axes[2] + i);
+            _mm512_storeu_ps(out.axes[0] + i, _mm512_sub_ps(_mm512_mul_ps(ay, bz), _mm512_mul_ps(az, by)));
+            _mm512_storeu_ps(out.axes[1] + i, _mm512_sub_ps(_mm512_mul_ps(az, bx), _mm512_mul_ps(ax, bz)));
+            _mm512_storeu_ps(out.axes[2] + i, _mm512_sub_ps(_mm512_mul_ps(ax, by), _mm512_mul_ps(ay, bx)));
+        }
+        cross3Scalar(a, b, out, i);
+    }
+
+    SCALEGEOM_TARGET_AVX512 void triple3Avx512(const View3& a, const View3& b, const View3& c, float* out)
+    {
+        size_t i = 0;
+        for (; i + 16 <= a.count; i += 16)
+        {
+            __m512 ax = _mm512_loadu_ps(a.axes[0] + i), ay = _mm512_loadu_ps(a.axes[1] + i), az = _mm512_loadu_ps(a.axes[2] + i);
+            __m512 bx = _mm512_loadu_ps(b.axes[0] + i), by = _mm512_loadu_ps(b.axes[1] + i), bz = _mm512_loadu_ps(b.axes[2] + i);
+            __m512 x = _mm512_sub_ps(_mm512_mul_ps(ay, bz), _mm512_mul_ps(az, by));
+            __m512 y = _mm512_sub_ps(_mm512_mul_ps(az, bx), _mm512_mul_ps(ax, bz));
+            __m512 z = _mm512_sub_ps(_mm512_mul_ps(ax, by), _mm512_mul_ps(ay, bx));
+            __m512 dot = _mm512_add_ps(_mm512_mul_ps(x, _mm512_loadu_ps(c.axes[0] + i)), _mm512_mul_ps(y, _mm512_loadu_ps(c.axes[1] + i)));
+            _mm512_storeu_ps(out + i, _mm512_add_ps(dot, _mm512_mul_ps(z, _mm512_loadu_ps(c.axes[2] + i))));
+        }
+        triple3Scalar(a, b, c, out, i);
+    }
+
+    SCALEGEOM_TARGET_AVX512 void normalize3Avx512(const View3& in, const OutView3& out)
+    {
+        size_t i = 0;
+        for (; i + 16 <= in.count; i += 16)
+        {
+            __m512 x = _mm512_loadu_ps(in.axes[0] + i), y = _mm512_loadu_ps(in.axes[1] + i), z = _mm512_loadu_ps(in.axes[2] + i);
+            __m512 length = _mm512_maskz_sqrt_ps(ALL_LANES, _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(x, x), _mm512_mul_ps(y, y)), _mm512_mul_ps(z, z)));
+            _mm512_storeu_ps(out.axes[0] + i, _mm512_div_ps(x, length));
+            _mm512_storeu_ps(out.axes[1] + i, _mm512_div_ps(y, length));
+            _mm512_storeu_ps(out.axes[2] + i, _mm512_div_ps(z, length));
+        }
+        normalize3Scalar(in, out, i);
+    }
+
+    // Reciprocal square root estimate (14 bits) refined by one Newton-Raphson step: r * (1.5 - 0.5 * s * r * r).
+    SCALEGEOM_TARGET_AVX512 void normalize3FastAvx512(const View3& in, const OutView3& out)
+    {
+        const __m512 half = _mm512_set1_ps(0.5f), threeHalves = _mm512_set1_ps(1.5f);
+        size_t i = 0;
+        for (; i + 16 <= in.count; i += 16)
+        {
+            __m512 x = _mm512_loadu_ps(in.axes[0] + i), y = _mm512_loadu_ps(in.axes[1] + i), z = _mm512_loadu_ps(in.axes[2] + i);
+            __m512 squared = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(x, x), _mm512_mul_ps(y, y)), _mm512_mul_ps(z, z));
+            __m512 estimate = _mm512_maskz_rsqrt14_ps(ALL_LANES, squared);
+            __m512 step = _mm512_sub_ps(threeHalves, _mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(half, squared), estimate), estimate));
+            __m512 inverse = _mm512_mul_ps(estimate, step);
+            _mm512_storeu_ps(out.axes[0] + i, _mm512_mul_ps(x, inverse));
+            _mm512_storeu_ps(out.axes[1] + i, _mm512_mul_ps(y, inverse));
+            _mm512_storeu_ps(out.axes[2] + i, _mm512_mul_ps(z, inverse));
+        }
+        normalize3FastScalar(in, out, i);
+    }
+
+    // |v|, by clearing the sign bits.
+    SCALEGEOM_TARGET_AVX512 __m512 absAvx512(__m512 v)
+    {
+        return _mm512_andnot_ps(_mm512_set1_ps(-0.0f), v);
+    }
+
+    SCALEGEOM_TARGET_AVX512 __mmask16 equalLanesAvx512(__m512 a, __m512 b, const scaleGeom::AbsoluteTolerance<float>& policy)
+    {
+        __m512 difference = absAvx512(_mm512_sub_ps(a, b));
+        return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ) | _mm512_cmp_ps_mask(difference, _mm512_set1_ps(policy.absolute), _CMP_LE_OQ);
+    }
+
+    SCALEGEOM_TARGET_AVX512 __mmask16 equalLanesAvx512(__m512 a, __m512 b, const scaleGeom::RelativeTolerance<float>& policy)
+    {
+        __m512 difference = absAvx512(_mm512_sub_ps(a, b));
+        __m512 largest = _mm512_maskz_max_ps(ALL_LANES, absAvx512(a), absAvx512(b));
+        __m512 bound = _mm512_maskz_max_ps(ALL_LANES, _mm512_set1_ps(policy.absolute), _mm512_mul_ps(_mm512_set1_ps(policy.relative), largest));
+        __mmask16 within = _mm512_cmp_ps_mask(difference, bound, _CMP_LE_OQ) & _mm512_cmp_ps_mask(difference, _mm512_set1_ps(HUGE_VALF), _CMP_LT_OQ);
+        return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ) | within;
+    }
+
+    SCALEGEOM_TARGET_AVX512 __m512i orderedBitsAvx512(__m512 v)
+    {
+        __m512i bits = _mm512_castps_si512(v);
+        __m512i sign = _mm512_maskz_srai_epi32(ALL_LANES, bits, 31);
+        __m512i magnitude = _mm512_and_si512(bits, _mm512_set1_epi32(0x7fffffff));
+        return _mm512_sub_epi32(_mm512_xor_si512(magnitude, sign), sign);
+    }
+
+    SCALEGEOM_TARGET_AVX512 __mmask16 equalLanesAvx512(__m512 a, __m512 b, const scaleGeom::UlpTolerance<float>& policy)
+    {
+        __m512i distance = _mm512_maskz_abs_epi32(ALL_LANES, _mm512_sub_epi32(orderedBitsAvx512(a), orderedBitsAvx512(b)));
+        __mmask16 within = _mm512_cmp_epu32_mask(distance, _mm512_set1_epi32(static_cast<int>(policy.maxUlps)), _MM_CMPINT_LE);
+        return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ) | (within & _mm512_cmp_ps_mask(a, b, _CMP_ORD_Q));
+    }
+
+    template<class Policy>
+    SCALEGEOM_TARGET_AVX512 void equal3Avx512(const View3& a, const View3& b, uint8_t* out, const Policy& policy)
+    {
+        size_t i = 0;
+        for (; i + 16 <= a.count; i += 16)
+        {
+            __mmask16 x = equalLanesAvx512(_mm512_loadu_ps(a.axes[0] + i), _mm512_loadu_ps(b.axes[0] + i), policy);
+            __mmask16 y = equalLanesAvx512(_mm512_loadu_ps(a.axes[1] + i), _mm512_loadu_ps(b.axes[1] + i), policy);
+            __mmask16 z = equalLanesAvx512(_mm512_loadu_ps(a.axes[2] + i), _mm512_loadu_ps(b.axes[2] + i), policy);
+            __m512i flags = _mm512_maskz_set1_epi32(static_cast<__mmask16>(x & y & z), 1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm512_maskz_cvtepi32_epi8(ALL_LANES, flags));
+        }
+        equal3Scalar(a, b, out, policy, i);
+    }
+
+#endif // SCALEGEOM_X86
+
+    template<class Policy>
+    void equal3(const View3& a, const View3& b, uint8_t* out, const Policy& policy)
+    {
+        switch (scaleGeom::activeSimdLevel())
+        {
+#if defined(SCALEGEOM_X86)
+        case scaleGeom::SimdLevel::AVX512: equal3Avx512(a, b, out, policy); return;
+        case scaleGeom::SimdLevel::AVX2: equal3Avx2(a, b, out, policy); return;
+        case scaleGeom::SimdLevel::SSE41: equal3Sse(a, b, out, policy); return;
+#endif
+        default: equal3Scalar(a, b, out, policy, 0); return;
+        }
+    }
+
+    // A Vector is a standard layout wrapper around its coordinate array, so an array of
+    // Vectors can be read as a flat array of interleaved coordinates.
+    static_assert(sizeof(scaleGeom::Vector2f) == 2 * sizeof(float), "Vector2f must be tightly packed");
+    static_assert(sizeof(scaleGeom::Vector3f) == 3 * sizeof(float), "Vector3f must be tightly packed");
+}
+
+void scaleGeom::dotProductBatch(ConstPointCloudView<float, DIM2> a, ConstPointCloudView<float, DIM2> b, float* out)
+{
+    switch (activeSimdLevel())
+    {
+#if defined(SCALEGEOM_X86)
+    case SimdLevel::AVX512: dot2Avx512(a, b, out); return;
+    case SimdLevel::AVX2: dot2Avx2(a, b, out); return;
+    case SimdLevel::SSE41: dot2Sse(a, b, out); return;
+#endif
+    default: dot2Scalar(a, b, out, 0); return;
+    }
+}
+
+void scaleGeom::dotProductBatch(ConstPointCloudView<float, DIM3> a, ConstPointCloudView<float, DIM3> b, float* out)
+{
+    switch (activeSimdLevel())
+    {
+#if defined(SCALEGEOM_X86)
+    case SimdLevel::AVX512: dot3Avx512(a, b, out); return;
+    case SimdLevel::AVX2: dot3Avx2(a, b, out); return;
+    case SimdLevel::SSE41: dot3Sse(a, b, out); return;
+#endif
+    default: dot3Scalar(a, b, out, 0); return;
+    }
+}
+
+void scaleGeom::crossProduct3DBatch(ConstPointCloudView<float, DIM3> a, ConstPointCloudView<float, DIM3> b, PointCloudView<float, DIM3> out)
+{
+    switch (activeSimdLevel())
+    {
+#if defined(SCALEGEOM_X86)
+    case SimdLevel::AVX512: cross3Avx512(a, b, out); return;
+    case SimdLevel::AVX2: cross3Avx2(a, b, out); return;
+    case SimdLevel::SSE41: cross3Sse(a, b, out); return;
+#endif
+    default: cross3Scalar(a, b, out, 0); return;
+    }
+}
+
+void scaleGeom::scalarTripleProductBatch(ConstPointCloudView<float, DIM3> a, ConstPointCloudView<float, DIM3> b, ConstPointCloudView<float, DIM3> c, float* out)
+{
+    switch (activeSimdLevel())
+    {
+#if defined(SCALEGEOM_X86)
+    case SimdLevel::AVX512: triple3Avx512(a, b, c, out); return;
+    case SimdLevel::AVX2: triple3Avx2(a, b, c, out); return;
+    case SimdLevel::SSE41: triple3Sse(a, b, c, out); return;
+#endif
+    default: triple3Scalar(a, b, c, out, 0); return;
+    }
+}
+
+void scaleGeom::normalizeBatch(ConstPointCloudView<float, DIM3> in, PointCloudView<float, DIM3> out, NormalizeMode mode)
+{
+    if (mode == NormalizeMode::Fast)
+    {
+        switch (activeSimdLevel())
+        {
+#if defined(SCALEGEOM_X86)
+        case SimdLevel::AVX512: normalize3FastAvx512(in, out); return;
+        case SimdLevel::AVX2: normalize3FastAvx2(in, out); return;
+        case SimdLevel::SSE41: normalize3FastSse(in, out); return;
+#endif
+        default: normalize3FastScalar(in, out, 0); return;
+        }
+    }
+    switch (activeSimdLevel())
+    {
+#if defined(SCALEGEOM_X86)
+    case SimdLevel::AVX512: normalize3Avx512(in, out); return;
+    case SimdLevel::AVX2: normalize3Avx2(in, out); return;
+    case SimdLevel::SSE41: normalize3Sse(in, out); return;
+#endif
+    default: normalize3Scalar(in, out, 0); return;
+    }
+}
+
+void scaleGeom::dotProductBatch(const Vector2f* a, const Vector2f* b, size_t count, float* out)
+{
+    const float* ra = reinterpret_cast<const float*>(a);
+    const float* rb = reinterpret_cast<const float*>(b);
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = ra[2 * i] * rb[2 * i] + ra[2 * i + 1] * rb[2 * i + 1];
+    }
+}
+
+void scaleGeom::dotProductBatch(const Vector3f* a, const Vector3f* b, size_t count, float* out)
+{
+    const float* ra = reinterpret_cast<const float*>(a);
+    const float* rb = reinterpret_cast<const float*>(b);
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = ra[3 * i] * rb[3 * i] + ra[3 * i + 1] * rb[3 * i + 1] + ra[3 * i + 2] * rb[3 * i + 2];
+    }
+}
+
+void scaleGeom::crossProduct3DBatch(const Vector3f* a, const Vector3f* b, size_t count, Vector3f* out)
+{
+    const float* ra = reinterpret_cast<const float*>(a);
+    const float* rb = reinterpret_cast<const float*>(b);
+    float* ro = reinterpret_cast<float*>(out);
+    for (size_t i = 0; i < 3 * count; i += 3)
+    {
+        ro[i] = ra[i + 1] * rb[i + 2] - ra[i + 2] * rb[i + 1];
+        ro[i + 1] = ra[i + 2] * rb[i] - ra[i] * rb[i + 2];
+        ro[i + 2] = ra[i] * rb[i + 1] - ra[i + 1] * rb[i];
+    }
+}
+
+void scaleGeom::scalarTripleProductBatch(const Vector3f* a, const Vector3f* b, const Vector3f* c, size_t count, float* out)
+{
+    const float* ra = reinterpret_cast<const float*>(a);
+    const float* rb = reinterpret_cast<const float*>(b);
+    const float* rc = reinterpret_cast<const float*>(c);
+    for (size_t p = 0, i = 0; p < count; p++, i += 3)
+    {
+        float x = ra[i + 1] * rb[i + 2] - ra[i + 2] * rb[i + 1];
+        float y = ra[i + 2] * rb[i] - ra[i] * rb[i + 2];
+        float z = ra[i] * rb[i + 1] - ra[i + 1] * rb[i];
+        out[p] = x * rc[i] + y * rc[i + 1] + z * rc[i + 2];
+    }
+}
+
+void scaleGeom::normalizeBatch(const Vector3f* in, size_t count, Vector3f* out, NormalizeMode mode)
+{
+    const float* ri = reinterpret_cast<const float*>(in);
+    float* ro = reinterpret_cast<float*>(out);
+    if (mode == NormalizeMode::Fast)
+    {
+        for (size_t i = 0; i < 3 * count; i += 3)
+        {
+            float x = ri[i], y = ri[i + 1], z = ri[i + 2];
+            float inverse = 1.0f / std::sqrt(x * x + y * y + z * z);
+            ro[i] = x * inverse;
+            ro[i + 1] = y * inverse;
+            ro[i + 2] = z * inverse;
+        }
+        return;
+    }
+    for (size_t i = 0; i < 3 * count; i += 3)
+    {
+        float x = ri[i], y = ri[i + 1], z = ri[i + 2];
+        float length = std::sqrt(x * x + y * y + z * z);
+        ro[i] = x / length;
+        ro[i + 1] = y / length;
+        ro[i + 2] = z / length;
+    }
+}
+
+void scaleGeom::equalBatch(ConstPointCloudView<float, DIM3> a, ConstPointCloudView<float, DIM3> b, uint8_t* out, const AbsoluteTolerance<float>& policy)
+{
+    equal3(a, b, out, policy);
+}
+
+void scaleGeom::equalBatch(ConstPointCloudView<float, DIM3> a, ConstPointCloudView<float, DIM3> b, uint8_t* out, const RelativeTolerance<float>& policy)
+{
+    equal3(a, b, out, policy);
+}
+
+void scaleGeom::equalBatch(ConstPointCloudView<float, DIM3> a, ConstPointCloudView<float, DIM3> b, uint8_t* out, const UlpTolerance<float>& policy)
+{
+    // The SIMD ulp distance is computed modulo 2^32 and is only exact below 2^24 ulps.
+    if (policy.maxUlps >= (1u << 24))
+    {
+        equal3Scalar(a, b, out, policy, 0);
+        return;
+    }
+    equal3(a, b, out, policy);
+}
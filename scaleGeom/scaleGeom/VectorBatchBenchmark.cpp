@@ -0,0 +1,159 @@
+#include "Benchmark.h"
+#include "CpuFeatures.h"
+#include "VectorBatch.h"
+
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    const int REPEATS = 5;
+
+    scaleGeom::PointCloud3f randomCloud(size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+        scaleGeom::PointCloud3f cloud(count);
+        for (size_t i = 0; i < 3; i++)
+        {
+            float* axis = cloud.axis(i);
+            for (size_t p = 0; p < count; p++)
+            {
+                axis[p] = dist(rng);
+            }
+        }
+        return cloud;
+    }
+
+    template<class Function>
+    double bestOf(Function function)
+    {
+        double best = 1e30;
+        for (int r = 0; r < REPEATS; r++)
+        {
+            Timer timer;
+            function();
+            best = std::min(best, timer.seconds());
+        }
+        return best;
+    }
+
+    void report(const char* label, double seconds, size_t count)
+    {
+        std::cout << "  " << std::left << std::setw(34) << label << std::right
+            << std::setw(9) << std::fixed << std::setprecision(3) << seconds * 1e3 << " ms  "
+            << std::setw(9) << std::setprecision(1) << count / seconds / 1e6 << " Mpts/s" << std::endl;
+    }
+}
+
+SCALEGEOM_BENCHMARK(VectorBatchThroughput)
+{
+    const size_t count = scaleGeom::bench::problemSize(4000000);
+    scaleGeom::PointCloud3f a = randomCloud(count, 1), b = randomCloud(count, 2), c = randomCloud(count, 3);
+    std::vector<scaleGeom::Vector3f> aosA = a.toAoS(), aosB = b.toAoS(), aosC = c.toAoS();
+    scaleGeom::PointCloud3f cross(count);
+    std::vector<scaleGeom::Vector3f> aosCross(count);
+    std::vector<float> out(count), reference(count);
+    std::cout << "  points: " << count << ", detected SIMD level: " << scaleGeom::simdLevelName(scaleGeom::detectedSimdLevel()) << std::endl;
+
+    // Baseline: the single-pair functions from Vector.h.
+    report("dotProduct loop", bestOf([&] {
+        for (size_t i = 0; i < count; i++)
+            reference[i] = scaleGeom::dotProduct(aosA[i], aosB[i]);
+    }), count);
+    report("scalarTripleProduct loop", bestOf([&] {
+        for (size_t i = 0; i < count; i++)
+            reference[i] = scaleGeom::scalarTripleProduct(aosA[i], aosB[i], aosC[i]);
+    }), count);
+    scaleGeom::bench::doNotOptimize(reference.data());
+
+    const scaleGeom::SimdLevel levels[] = { scaleGeom::SimdLevel::Scalar, scaleGeom::SimdLevel::SSE41, scaleGeom::SimdLevel::AVX2, scaleGeom::SimdLevel::AVX512 };
+    for (scaleGeom::SimdLevel requested : levels)
+    {
+        if (requested > scaleGeom::detectedSimdLevel())
+            break;
+        scaleGeom::SimdLevel level = scaleGeom::forceSimdLevel(requested);
+        std::cout << "  [" << scaleGeom::simdLevelName(level) << "]" << std::endl;
+
+        report("dotProductBatch (SoA)", bestOf([&] { scaleGeom::dotProductBatch(a.view(), b.view(), out.data()); }), count);
+        report("dotProductBatch (AoS)", bestOf([&] { scaleGeom::dotProductBatch(aosA.data(), aosB.data(), count, out.data()); }), count);
+        report("crossProduct3DBatch (SoA)", bestOf([&] { scaleGeom::crossProduct3DBatch(a.view(), b.view(), cross.view()); }), count);
+        report("crossProduct3DBatch (AoS)", bestOf([&] { scaleGeom::crossProduct3DBatch(aosA.data(), aosB.data(), count, aosCross.data()); }), count);
+        report("scalarTripleProductBatch (SoA)", bestOf([&] { scaleGeom::scalarTripleProductBatch(a.view(), b.view(), c.view(), out.data()); }), count);
+        report("scalarTripleProductBatch (AoS)", bestOf([&] { scaleGeom::scalarTripleProductBatch(aosA.data(), aosB.data(), aosC.data(), count, out.data()); }), count);
+        if (std::memcmp(out.data(), reference.data(), count * sizeof(float)) != 0)
+            std::cout << "  WARNING: AoS results differ from scalarTripleProduct" << std::endl;
+        scaleGeom::scalarTripleProductBatch(a.view(), b.view(), c.view(), out.data());
+
+        // The SIMD kernels must reproduce the single-pair results bit for bit.
+        if (std::memcmp(out.data(), reference.data(), count * sizeof(float)) != 0)
+            std::cout << "  WARNING: results differ from scalarTripleProduct" << std::endl;
+        scaleGeom::bench::doNotOptimize(out.data());
+        scaleGeom::bench::doNotOptimize(cross.axis(0));
+    }
+    scaleGeom::forceSimdLevel(scaleGeom::detectedSimdLevel());
+}
+
+SCALEGEOM_BENCHMARK(NormalizeBatchThroughput)
+{
+    const size_t count = scaleGeom::bench::problemSize(4000000);
+    scaleGeom::PointCloud3f normals = randomCloud(count, 4);
+    std::vector<scaleGeom::Vector3f> aosNormals = normals.toAoS(), reference(count), aosOut(count);
+    scaleGeom::PointCloud3f out(count);
+    std::cout << "  vectors: " << count << std::endl;
+
+    report("Vector::normalize loop", bestOf([&] {
+        for (size_t i = 0; i < count; i++)
+            reference[i] = aosNormals[i].normalized();
+    }), count);
+    scaleGeom::bench::doNotOptimize(reference.data());
+
+    const scaleGeom::SimdLevel levels[] = { scaleGeom::SimdLevel::Scalar, scaleGeom::SimdLevel::SSE41, scaleGeom::SimdLevel::AVX2, scaleGeom::SimdLevel::AVX512 };
+    for (scaleGeom::SimdLevel requested : levels)
+    {
+        if (requested > scaleGeom::detectedSimdLevel())
+            break;
+        scaleGeom::SimdLevel level = scaleGeom::forceSimdLevel(requested);
+        std::cout << "  [" << scaleGeom::simdLevelName(level) << "]" << std::endl;
+
+        report("normalizeBatch exact (SoA)", bestOf([&] { scaleGeom::normalizeBatch(normals.view(), out.view()); }), count);
+        // Exact mode must reproduce Vector::normalize bit for bit.
+        bool identical = true;
+        for (size_t i = 0; i < count; i++)
+        {
+            for (size_t dim = 0; dim < 3; dim++)
+            {
+                identical = identical && out.axis(dim)[i] == reference[i][dim];
+            }
+        }
+        if (!identical)
+            std::cout << "  WARNING: exact results differ from Vector::normalize" << std::endl;
+
+        report("normalizeBatch fast (SoA)", bestOf([&] {
+            scaleGeom::normalizeBatch(normals.view(), out.view(), scaleGeom::NormalizeMode::Fast);
+        }), count);
+        float maxError = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            for (size_t dim = 0; dim < 3; dim++)
+            {
+                maxError = std::max(maxError, std::fabs(out.axis(dim)[i] - reference[i][dim]));
+            }
+        }
+        std::cout << "  fast mode max abs error: " << std::scientific << std::setprecision(2) << maxError << std::fixed << std::endl;
+        scaleGeom::bench::doNotOptimize(out.axis(0));
+    }
+    scaleGeom::forceSimdLevel(scaleGeom::detectedSimdLevel());
+
+    report("normalizeBatch exact (AoS)", bestOf([&] { scaleGeom::normalizeBatch(aosNormals.data(), count, aosOut.data()); }), count);
+    report("normalizeBatch fast (AoS)", bestOf([&] {
+        scaleGeom::normalizeBatch(aosNormals.data(), count, aosOut.data(), scaleGeom::NormalizeMode::Fast);
+    }), count);
+    scaleGeom::bench::doNotOptimize(aosOut.data());
+}
@@ -0,0 +1,184 @@
+/*
+	VectorExpression.h - Expression Templates for Vector Arithmetic
+
+	Overview:
+	Vector addition, subtraction, negation and scalar multiplication/division do not compute
+	anything when they are written; they return a small expression object that records the
+	operation and its operands. The whole expression is evaluated coordinate by coordinate, in a
+	single pass, when it is assigned to (or used to construct) a Vector:
+
+		scaleGeom::Vector3f r = a + b - c + d * 0.5f;   // one pass, no intermediate Vectors
+
+	Each coordinate is computed with the same operations in the same order as the equivalent
+	chain of eager operations, so results are bit-identical to evaluating step by step.
+
+	Operands:
+	Vector operands are held by reference and nested expressions by value. An expression therefore
+	must not outlive the Vectors it was built from: assign it to a Vector rather than to auto when
+	the operands are temporaries. All operations are element-wise, so a Vector may appear on both
+	sides of an assignment (a = b - a).
+
+	Expressions convert implicitly to Vector, so they can be passed to any function taking a
+	Vector (crossProduct3D, orient3d, ...). dotProduct also accepts expressions directly.
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+
+namespace scaleGeom {
+
+	template <class coordDataType, size_t dimension>
+	class Vector;
+
+	// Base of every Vector expression, including Vector itself (CRTP). Derived must provide
+	// coordDataType eval(size_t) const, returning one coordinate of the expression's value.
+	template <class Derived, class coordDataType, size_t dimension>
+	struct VectorExpression
+	{
+		typedef coordDataType coordType;
+
+		constexpr const Derived& derived() const { return static_cast<const Derived&>(*this); }
+
+		constexpr coordDataType eval(size_t _index) const { return derived().eval(_index); }
+	};
+
+	// How an expression holds an operand: Vectors by reference, nested expressions by value.
+	template <class Expression>
+	struct VectorOperand
+	{
+		typedef const Expression type;
+	};
+
+	template <class coordDataType, size_t dimension>
+	struct VectorOperand<Vector<coordDataType, dimension>>
+	{
+		typedef const Vector<coordDataType, dimension>& type;
+	};
+
+	// Element-wise operations used by the expression nodes.
+	struct VectorAdd
+	{
+		template <class T> static constexpr T apply(T a, T b) { return static_cast<T>(a + b); }
+	};
+
+	struct VectorSubtract
+	{
+		template <class T> static constexpr T apply(T a, T b) { return static_cast<T>(a - b); }
+	};
+
+	struct VectorMultiply
+	{
+		template <class T> static constexpr T apply(T a, T b) { return static_cast<T>(a * b); }
+	};
+
+	struct VectorDivide
+	{
+		template <class T> static constexpr T apply(T a, T b) { return static_cast<T>(a / b); }
+	};
+
+	// Element-wise combination of two expressions: left op right.
+	template <class Left, class Right, class Operation, class coordDataType, size_t dimension>
+	class VectorBinaryExpression : public VectorExpression<VectorBinaryExpression<Left, Right, Operation, coordDataType, dimension>, coordDataType, dimension>
+	{
+		typename VectorOperand<Left>::type left;
+		typename VectorOperand<Right>::type right;
+
+	public:
+
+		constexpr VectorBinaryExpression(const Left& _left, const Right& _right) : left(_left), right(_right) {}
+
+		constexpr coordDataType eval(size_t _index) const { return Operation::apply(left.eval(_index), right.eval(_index)); }
+	};
+
+	// Combination of an expression with a scalar: expression op scalar, or scalar op expression when scalarFirst.
+	template <class Operand, class Operation, bool scalarFirst, class coordDataType, size_t dimension>
+	class VectorScalarExpression : public VectorExpression<VectorScalarExpression<Operand, Operation, scalarFirst, coordDataType, dimension>, coordDataType, dimension>
+	{
+		typename VectorOperand<Operand>::type operand;
+		coordDataType scalar;
+
+	public:
+
+		constexpr VectorScalarExpression(const Operand& _operand, coordDataType _scalar) : operand(_operand), scalar(_scalar) {}
+
+		constexpr coordDataType eval(size_t _index) const
+		{
+			return scalarFirst ? Operation::apply(scalar, operand.eval(_index)) : Operation::apply(operand.eval(_index), scalar);
+		}
+	};
+
+	// Negation of an expression.
+	template <class Operand, class coordDataType, size_t dimension>
+	class VectorNegateExpression : public VectorExpression<VectorNegateExpression<Operand, coordDataType, dimension>, coordDataType, dimension>
+	{
+		typename VectorOperand<Operand>::type operand;
+
+	public:
+
+		explicit constexpr VectorNegateExpression(const Operand& _operand) : operand(_operand) {}
+
+		constexpr coordDataType eval(size_t _index) const { return static_cast<coordDataType>(-operand.eval(_index)); }
+	};
+
+	// Addition
+	template <class Left, class Right, class coordDataType, size_t dimension>
+	constexpr VectorBinaryExpression<Left, Right, VectorAdd, coordDataType, dimension>
+		operator+(const VectorExpression<Left, coordDataType, dimension>& _left, const VectorExpression<Right, coordDataType, dimension>& _right)
+	{
+		return VectorBinaryExpression<Left, Right, VectorAdd, coordDataType, dimension>(_left.derived(), _right.derived());
+	}
+
+	// Subtraction
+	template <class Left, class Right, class coordDataType, size_t dimension>
+	constexpr VectorBinaryExpression<Left, Right, VectorSubtract, coordDataType, dimension>
+		operator-(const VectorExpression<Left, coordDataType, dimension>& _left, const VectorExpression<Right, coordDataType, dimension>& _right)
+	{
+		return VectorBinaryExpression<Left, Right, VectorSubtract, coordDataType, dimension>(_left.derived(), _right.derived());
+	}
+
+	// Negation
+	template <class Operand, class coordDataType, size_t dimension>
+	constexpr VectorNegateExpression<Operand, coordDataType, dimension> operator-(const VectorExpression<Operand, coordDataType, dimension>& _operand)
+	{
+		return VectorNegateExpression<Operand, coordDataType, dimension>(_operand.derived());
+	}
+
+	// Scalar multiplication, on either side. The scalar is converted to the coordinate type.
+	template <class Operand, class coordDataType, size_t dimension>
+	constexpr VectorScalarExpression<Operand, VectorMultiply, false, coordDataType, dimension>
+		operator*(const VectorExpression<Operand, coordDataType, dimension>& _operand, typename VectorExpression<Operand, coordDataType, dimension>::coordType _scalar)
+	{
+		return VectorScalarExpression<Operand, VectorMultiply, false, coordDataType, dimension>(_operand.derived(), _scalar);
+	}
+
+	template <class Operand, class coordDataType, size_t dimension>
+	constexpr VectorScalarExpression<Operand, VectorMultiply, true, coordDataType, dimension>
+		operator*(typename VectorExpression<Operand, coordDataType, dimension>::coordType _scalar, const VectorExpression<Operand, coordDataType, dimension>& _operand)
+	{
+		return VectorScalarExpression<Operand, VectorMultiply, true, coordDataType, dimension>(_operand.derived(), _scalar);
+	}
+
+	// Scalar division. Every coordinate is divided (not multiplied by a reciprocal), so results match eager division.
+	template <class Operand, class coordDataType, size_t dimension>
+	constexpr VectorScalarExpression<Operand, VectorDivide, false, coordDataType, dimension>
+		operator/(const VectorExpression<Operand, coordDataType, dimension>& _operand, typename VectorExpression<Operand, coordDataType, dimension>::coordType _scalar)
+	{
+		return VectorScalarExpression<Operand, VectorDivide, false, coordDataType, dimension>(_operand.derived(), _scalar);
+	}
+
+	// Dot product of two expressions, evaluated without materialising either operand.
+	template <class Left, class Right, class coordDataType, size_t dimension>
+	constexpr coordDataType dotProduct(const VectorExpression<Left, coordDataType, dimension>& v1, const VectorExpression<Right, coordDataType, dimension>& v2)
+	{
+		coordDataType dotProduct = 0;
+		for (size_t i = 0; i < dimension; i++)
+		{
+			dotProduct += v1.eval(i) * v2.eval(i);
+		}
+		return dotProduct;
+	}
+
+} // Closing the scaleGeom namespace.
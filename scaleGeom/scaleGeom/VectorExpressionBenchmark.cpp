@@ -0,0 +1,178 @@
+#include "Benchmark.h"
+#include "Vector.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+// Keeps a block function out of the timing loop. Inlined there, the restrict qualifiers of its parameters no longer
+// cover the loads made through the references an expression holds, and GCC leaves the expression loop scalar.
+#if defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
+namespace {
+
+    const int REPEATS = 5;
+    const float SCALE = 0.5f;
+
+    // Points per block (two KB per array), and the time over the hand-written loop that still counts as parity.
+    const size_t BLOCK = 512;
+    const double PARITY = 1.15;
+
+    std::vector<scaleGeom::Vector3f> randomPoints(size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+        std::vector<scaleGeom::Vector3f> points(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            points[i] = scaleGeom::Vector3f(dist(rng), dist(rng), dist(rng));
+        }
+        return points;
+    }
+
+    std::vector<float> flatten(const std::vector<scaleGeom::Vector3f>& points)
+    {
+        std::vector<float> flat(3 * points.size());
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            for (size_t dim = 0; dim < 3; dim++)
+            {
+                flat[3 * i + dim] = points[i][dim];
+            }
+        }
+        return flat;
+    }
+
+    // The forms of one block, each a function of restrict pointers: the arrays are distinct, so the compiler is free
+    // to vectorize every loop across points rather than only the coordinates of one point.
+    NOINLINE void expressionBlock(const scaleGeom::Vector3f* __restrict a, const scaleGeom::Vector3f* __restrict b, const scaleGeom::Vector3f* __restrict c,
+        const scaleGeom::Vector3f* __restrict d, scaleGeom::Vector3f* __restrict r)
+    {
+        for (size_t i = 0; i < BLOCK; i++)
+        {
+            r[i] = a[i] + b[i] - c[i] + d[i] * SCALE;
+        }
+    }
+
+    // Every step materialised into a Vector, as the eager operators did.
+    NOINLINE void temporariesBlock(const scaleGeom::Vector3f* __restrict a, const scaleGeom::Vector3f* __restrict b, const scaleGeom::Vector3f* __restrict c,
+        const scaleGeom::Vector3f* __restrict d, scaleGeom::Vector3f* __restrict r)
+    {
+        for (size_t i = 0; i < BLOCK; i++)
+        {
+            scaleGeom::Vector3f sum = a[i] + b[i];
+            scaleGeom::Vector3f difference = sum - c[i];
+            scaleGeom::Vector3f scaled = d[i] * SCALE;
+            r[i] = difference + scaled;
+        }
+    }
+
+    // The same arrays of points, coordinates written out by hand: what the expression should compile to.
+    NOINLINE void handWrittenBlock(const scaleGeom::Vector3f* __restrict a, const scaleGeom::Vector3f* __restrict b, const scaleGeom::Vector3f* __restrict c,
+        const scaleGeom::Vector3f* __restrict d, scaleGeom::Vector3f* __restrict r)
+    {
+        for (size_t i = 0; i < BLOCK; i++)
+        {
+            r[i] = scaleGeom::Vector3f(a[i][0] + b[i][0] - c[i][0] + d[i][0] * SCALE, a[i][1] + b[i][1] - c[i][1] + d[i][1] * SCALE,
+                a[i][2] + b[i][2] - c[i][2] + d[i][2] * SCALE);
+        }
+    }
+
+    // One flat array per operand: the unit stride loop compilers vectorize most readily, for reference.
+    NOINLINE void flatBlock(const float* __restrict a, const float* __restrict b, const float* __restrict c, const float* __restrict d, float* __restrict r)
+    {
+        for (size_t i = 0; i < 3 * BLOCK; i++)
+        {
+            r[i] = a[i] + b[i] - c[i] + d[i] * SCALE;
+        }
+    }
+
+    template<class Function>
+    double bestOf(Function function)
+    {
+        double best = 1e30;
+        for (int r = 0; r < REPEATS; r++)
+        {
+            Timer timer;
+            function();
+            best = std::min(best, timer.seconds());
+        }
+        return best;
+    }
+
+    void report(const char* label, double seconds, size_t count, double handWritten)
+    {
+        std::cout << "  " << std::left << std::setw(32) << label << std::right
+            << std::setw(9) << std::fixed << std::setprecision(3) << seconds * 1e3 << " ms  "
+            << std::setw(8) << std::setprecision(2) << seconds * 1e9 / count << " ns/pt  "
+            << std::setw(6) << std::setprecision(2) << seconds / handWritten << "x hand-written" << std::endl;
+    }
+}
+
+// r = a + b - c + d * s over arrays of points, written three ways, plus the same sum over flat float arrays. The
+// loops run over one block again and again, so all are bound by the arithmetic and not by memory bandwidth (the
+// five arrays take 30 KB). Parity is checked against the hand-written loop over the same points, which the compiler
+// vectorizes as freely as the expression.
+SCALEGEOM_BENCHMARK(VectorExpressions)
+{
+    const size_t count = scaleGeom::bench::problemSize(4000000);
+    const size_t rounds = std::max<size_t>(1, count / BLOCK), points = rounds * BLOCK;
+    const std::vector<scaleGeom::Vector3f> a = randomPoints(BLOCK, 1), b = randomPoints(BLOCK, 2),
+        c = randomPoints(BLOCK, 3), d = randomPoints(BLOCK, 4);
+    std::cout << "  points: " << points << " (blocks of " << BLOCK << ")" << std::endl;
+
+    std::vector<scaleGeom::Vector3f> r(BLOCK);
+    const double expression = bestOf([&] {
+        for (size_t round = 0; round < rounds; round++)
+        {
+            expressionBlock(a.data(), b.data(), c.data(), d.data(), r.data());
+            scaleGeom::bench::doNotOptimize(r.data());
+        }
+    });
+    const std::vector<float> fromExpression = flatten(r);
+
+    const double temporaries = bestOf([&] {
+        for (size_t round = 0; round < rounds; round++)
+        {
+            temporariesBlock(a.data(), b.data(), c.data(), d.data(), r.data());
+            scaleGeom::bench::doNotOptimize(r.data());
+        }
+    });
+    const std::vector<float> fromTemporaries = flatten(r);
+
+    const double handWritten = bestOf([&] {
+        for (size_t round = 0; round < rounds; round++)
+        {
+            handWrittenBlock(a.data(), b.data(), c.data(), d.data(), r.data());
+            scaleGeom::bench::doNotOptimize(r.data());
+        }
+    });
+    const std::vector<float> fromHandWritten = flatten(r);
+
+    const std::vector<float> fa = flatten(a), fb = flatten(b), fc = flatten(c), fd = flatten(d);
+    std::vector<float> fr(3 * BLOCK);
+    const double flat = bestOf([&] {
+        for (size_t round = 0; round < rounds; round++)
+        {
+            flatBlock(fa.data(), fb.data(), fc.data(), fd.data(), fr.data());
+            scaleGeom::bench::doNotOptimize(fr.data());
+        }
+    });
+
+    report("expression templates", expression, points, handWritten);
+    report("explicit temporaries", temporaries, points, handWritten);
+    report("hand-written loop", handWritten, points, handWritten);
+    report("flat arrays", flat, points, handWritten);
+    if (expression > PARITY * handWritten)
+        std::cout << "  EXPRESSION TEMPLATES SLOWER THAN HAND-WRITTEN LOOP" << std::endl;
+    if (fromExpression != fr || fromTemporaries != fr || fromHandWritten != fr)
+        std::cout << "  MISMATCH" << std::endl;
+}
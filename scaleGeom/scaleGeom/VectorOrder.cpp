@@ -0,0 +1,89 @@
+#include "VectorOrder.h"
+
+namespace {
+
+    const unsigned DIGIT_BITS = 8;
+    const size_t RADIX = size_t(1) << DIGIT_BITS;
+
+    // Chunks smaller than this are not worth a thread of their own.
+    const size_t GRAIN = 1 << 16;
+}
+
+void scaleGeom::radixSort(uint64_t* keys, uint32_t* values, size_t count, unsigned keyBits, unsigned _threads)
+{
+    if (count < 2)
+        return;
+
+    // Every pass splits the range into the same chunks: one histogram per chunk, then each chunk scatters
+    // its elements behind those of the preceding chunks with the same digit, which keeps the sort stable.
+    const unsigned chunks = static_cast<unsigned>(std::min<size_t>(resolveThreadCount(_threads), (count + GRAIN - 1) / GRAIN));
+    std::vector<uint64_t> keyScratch(count);
+    std::vector<uint32_t> valueScratch(count);
+    std::vector<size_t> histograms(chunks * RADIX);
+
+    uint64_t* sourceKeys = keys;
+    uint32_t* sourceValues = values;
+    uint64_t* targetKeys = keyScratch.data();
+    uint32_t* targetValues = valueScratch.data();
+
+    for (unsigned shift = 0; shift < keyBits && shift < 64; shift += DIGIT_BITS)
+    {
+        std::fill(histograms.begin(), histograms.end(), 0);
+        parallelChunks(0, count, chunks, GRAIN, [&](unsigned chunk, size_t begin, size_t end) {
+            const uint64_t* in = sourceKeys;
+            size_t histogram[RADIX] = {};
+            for (size_t i = begin; i < end; i++)
+            {
+                histogram[(in[i] >> shift) & (RADIX - 1)]++;
+            }
+            std::copy(histogram, histogram + RADIX, &histograms[chunk * RADIX]);
+        });
+
+        // Turn the counts into start offsets, digit-major and chunk-minor. A pass in which every key has the
+        // same digit would not move anything and is skipped.
+        bool trivial = false;
+        size_t offset = 0;
+        for (size_t digit = 0; digit < RADIX; digit++)
+        {
+            size_t digitTotal = 0;
+            for (unsigned chunk = 0; chunk < chunks; chunk++)
+            {
+                size_t n = histograms[chunk * RADIX + digit];
+                histograms[chunk * RADIX + digit] = offset;
+                offset += n;
+                digitTotal += n;
+            }
+            if (digitTotal == count)
+                trivial = true;
+        }
+        if (trivial)
+            continue;
+
+        parallelChunks(0, count, chunks, GRAIN, [&](unsigned chunk, size_t begin, size_t end) {
+            // Local copies, so the compiler knows the stores below cannot modify them.
+            const uint64_t* inKeys = sourceKeys;
+            const uint32_t* inValues = sourceValues;
+            uint64_t* outKeys = targetKeys;
+            uint32_t* outValues = targetValues;
+            size_t next[RADIX];
+            std::copy(&histograms[chunk * RADIX], &histograms[chunk * RADIX] + RADIX, next);
+            for (size_t i = begin; i < end; i++)
+            {
+                uint64_t key = inKeys[i];
+                size_t position = next[(key >> shift) & (RADIX - 1)]++;
+                outKeys[position] = key;
+                outValues[position] = inValues[i];
+            }
+        });
+        std::swap(sourceKeys, targetKeys);
+        std::swap(sourceValues, targetValues);
+    }
+
+    if (sourceKeys != keys)
+    {
+        parallelChunks(0, count, chunks, GRAIN, [&](unsigned, size_t begin, size_t end) {
+            std::copy(sourceKeys + begin, sourceKeys + end, keys + begin);
+            std::copy(sourceValues + begin, sourceValues + end, values + begin);
+        });
+    }
+}
@@ -0,0 +1,366 @@
+/*
+	VectorOrder.h - Orderings and Sorting for Vectors
+
+	Overview:
+	Vector::operator< and operator> compare all components strictly, which is a partial order and
+	not a strict weak ordering, so they cannot drive std::sort or std::map. This header provides
+	the orderings geometry code actually sorts by, as comparators and as integer keys:
+
+	- Lexicographic: by x, then y, then z ...
+	- Morton (Z-order): by the bit-interleaved cell coordinates of the point on a 2^bits grid
+	  over a bounding box.
+	- Hilbert: by the position along the Hilbert curve through the same grid, which keeps
+	  consecutive points closer together than Morton order. Its keys take several times longer
+	  to compute than Morton keys.
+
+	The comparators are strict weak orderings (coordinates must not be NaN). The Morton and
+	Hilbert comparators break ties between points of the same grid cell lexicographically.
+
+	For large arrays, spatialSortPermutation / spatialSort compute the keys once and run a
+	parallel LSD radix sort over them. The radix sort is stable: points with equal keys keep their
+	input order (for lexicographic order that only concerns equal points).
+
+	Usage:
+	std::sort(points.begin(), points.end(), scaleGeom::LexicographicLess());
+	scaleGeom::spatialSort(points.data(), points.size(), scaleGeom::SpatialOrder::Hilbert);
+
+*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "Parallel.h"
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	enum class SpatialOrder { Lexicographic, Morton, Hilbert };
+
+	// Sort values by keys, ascending and stable; both arrays are permuted. Only the low keyBits bits of the
+	// keys are looked at. _threads = 0 uses every hardware thread.
+	void radixSort(uint64_t* keys, uint32_t* values, size_t count, unsigned keyBits = 64, unsigned _threads = 0);
+
+	// Unsigned integer with the same order as value, in the low 8 * sizeof(value) bits. -0.0 and 0.0 map to
+	// the same key.
+	template<class coordDataType>
+	uint64_t orderedKey(coordDataType value)
+	{
+		static_assert(std::is_arithmetic<coordDataType>::value && sizeof(coordDataType) <= 8, "Coordinate type must be arithmetic and at most 64 bits");
+		if constexpr (std::is_floating_point<coordDataType>::value)
+		{
+			if (value == 0)
+				value = 0;
+			if constexpr (sizeof(coordDataType) == 4)
+			{
+				uint32_t bits;
+				std::memcpy(&bits, &value, 4);
+				return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+			}
+			else
+			{
+				uint64_t bits;
+				std::memcpy(&bits, &value, 8);
+				return (bits & 0x8000000000000000ull) ? ~bits : bits | 0x8000000000000000ull;
+			}
+		}
+		else
+		{
+			const unsigned width = 8 * sizeof(coordDataType);
+			uint64_t bits = static_cast<uint64_t>(value);
+			if (width < 64)
+				bits &= (1ull << width) - 1;
+			if (std::is_signed<coordDataType>::value)
+				bits ^= 1ull << (width - 1);
+			return bits;
+		}
+	}
+
+	// Lexicographic strict weak ordering.
+	struct LexicographicLess
+	{
+		template<class coordDataType, size_t dimension>
+		bool operator()(const Vector<coordDataType, dimension>& a, const Vector<coordDataType, dimension>& b) const
+		{
+			for (size_t i = 0; i < dimension; i++)
+			{
+				if (a[i] != b[i])
+					return a[i] < b[i];
+			}
+			return false;
+		}
+	};
+
+	// Maps points to cells of a 2^BITS grid per axis over a bounding cube, and cells to Morton and Hilbert keys.
+	template<class coordDataType, size_t dimension = DIM3>
+	class SpatialKeyEncoder
+	{
+	public:
+
+		// Bits per axis, so that all axes fit in a 64-bit key.
+		static constexpr unsigned BITS = 64 / dimension < 32 ? 64 / dimension : 32;
+
+	private:
+
+		static_assert(dimension <= 32, "Spatial keys support at most 32 dimensions");
+
+		std::array<double, dimension> lower;
+		double scale;
+
+		// Bit-interleave the cell coordinates, axis 0 most significant within each group.
+		static uint64_t interleave(const uint32_t* cells)
+		{
+			if constexpr (dimension == DIM2)
+			{
+				return spread2(cells[0]) << 1 | spread2(cells[1]);
+			}
+			else if constexpr (dimension == DIM3)
+			{
+				return spread3(cells[0]) << 2 | spread3(cells[1]) << 1 | spread3(cells[2]);
+			}
+			uint64_t key = 0;
+			for (unsigned b = BITS; b-- > 0;)
+			{
+				for (size_t i = 0; i < dimension; i++)
+				{
+					key = key << 1 | ((cells[i] >> b) & 1);
+				}
+			}
+			return key;
+		}
+
+		// Move bit i of v to bit 2i.
+		static uint64_t spread2(uint64_t v)
+		{
+			v &= 0xffffffffull;
+			v = (v | v << 16) & 0x0000ffff0000ffffull;
+			v = (v | v << 8) & 0x00ff00ff00ff00ffull;
+			v = (v | v << 4) & 0x0f0f0f0f0f0f0f0full;
+			v = (v | v << 2) & 0x3333333333333333ull;
+			v = (v | v << 1) & 0x5555555555555555ull;
+			return v;
+		}
+
+		// Move bit i of v to bit 3i.
+		static uint64_t spread3(uint64_t v)
+		{
+			v &= 0x1fffffull;
+			v = (v | v << 32) & 0x001f00000000ffffull;
+			v = (v | v << 16) & 0x001f0000ff0000ffull;
+			v = (v | v << 8) & 0x100f00f00f00f00full;
+			v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+			v = (v | v << 2) & 0x1249249249249249ull;
+			return v;
+		}
+
+	public:
+
+		// Grid over the cube with corner _lower and the largest extent of [_lower, _upper].
+		SpatialKeyEncoder(const Vector<coordDataType, dimension>& _lower, const Vector<coordDataType, dimension>& _upper)
+		{
+			double extent = 0.0;
+			for (size_t i = 0; i < dimension; i++)
+			{
+				lower[i] = static_cast<double>(_lower[i]);
+				extent = std::max(extent, static_cast<double>(_upper[i]) - lower[i]);
+			}
+			scale = extent > 0.0 ? std::ldexp(1.0, BITS) / extent : 0.0;
+		}
+
+		// Grid over the bounding box of points[0, count).
+		static SpatialKeyEncoder fromPoints(const Vector<coordDataType, dimension>* points, size_t count)
+		{
+			std::array<coordDataType, dimension> low, high;
+			for (size_t i = 0; i < dimension; i++)
+			{
+				low[i] = high[i] = count ? points[0][i] : coordDataType();
+			}
+			for (size_t p = 1; p < count; p++)
+			{
+				for (size_t i = 0; i < dimension; i++)
+				{
+					low[i] = std::min(low[i], points[p][i]);
+					high[i] = std::max(high[i], points[p][i]);
+				}
+			}
+			return SpatialKeyEncoder(Vector<coordDataType, dimension>(low), Vector<coordDataType, dimension>(high));
+		}
+
+		// Grid cell of v, clamped to the grid.
+		void cell(const Vector<coordDataType, dimension>& v, uint32_t* cells) const
+		{
+			const double top = static_cast<double>((1ull << BITS) - 1);
+			for (size_t i = 0; i < dimension; i++)
+			{
+				double c = (static_cast<double>(v[i]) - lower[i]) * scale;
+				cells[i] = static_cast<uint32_t>(std::min(std::max(c, 0.0), top));
+			}
+		}
+
+		// Morton (Z-order) key: the cell coordinates bit-interleaved, x most significant.
+		uint64_t morton(const Vector<coordDataType, dimension>& v) const
+		{
+			uint32_t cells[dimension];
+			cell(v, cells);
+			return interleave(cells);
+		}
+
+		// Hilbert key: position of the cell along the Hilbert curve (Skilling's transpose algorithm).
+		uint64_t hilbert(const Vector<coordDataType, dimension>& v) const
+		{
+			uint32_t cells[dimension];
+			cell(v, cells);
+
+			const uint32_t top = 1u << (BITS - 1);
+			for (uint32_t q = top; q > 1; q >>= 1)
+			{
+				// Branch-free form of: if bit q of cells[i] is set, invert the low bits of cells[0],
+				// otherwise exchange the low bits of cells[0] and cells[i].
+				uint32_t mask = q - 1;
+				for (size_t i = 0; i < dimension; i++)
+				{
+					uint32_t set = 0u - ((cells[i] & q) != 0);
+					uint32_t t = (cells[0] ^ cells[i]) & mask & ~set;
+					cells[0] ^= (mask & set) | t;
+					cells[i] ^= t;
+				}
+			}
+			for (size_t i = 1; i < dimension; i++)
+			{
+				cells[i] ^= cells[i - 1];
+			}
+			uint32_t t = 0;
+			for (uint32_t q = top; q > 1; q >>= 1)
+			{
+				t ^= (q - 1) & (0u - ((cells[dimension - 1] & q) != 0));
+			}
+			for (size_t i = 0; i < dimension; i++)
+			{
+				cells[i] ^= t;
+			}
+			return interleave(cells);
+		}
+	};
+
+	// Morton order over an encoder's grid, ties broken lexicographically.
+	template<class coordDataType, size_t dimension = DIM3>
+	class MortonLess
+	{
+		SpatialKeyEncoder<coordDataType, dimension> encoder;
+
+	public:
+
+		explicit MortonLess(const SpatialKeyEncoder<coordDataType, dimension>& _encoder) : encoder(_encoder) {}
+
+		bool operator()(const Vector<coordDataType, dimension>& a, const Vector<coordDataType, dimension>& b) const
+		{
+			uint64_t ka = encoder.morton(a), kb = encoder.morton(b);
+			return ka != kb ? ka < kb : LexicographicLess()(a, b);
+		}
+	};
+
+	// Hilbert order over an encoder's grid, ties broken lexicographically.
+	template<class coordDataType, size_t dimension = DIM3>
+	class HilbertLess
+	{
+		SpatialKeyEncoder<coordDataType, dimension> encoder;
+
+	public:
+
+		explicit HilbertLess(const SpatialKeyEncoder<coordDataType, dimension>& _encoder) : encoder(_encoder) {}
+
+		bool operator()(const Vector<coordDataType, dimension>& a, const Vector<coordDataType, dimension>& b) const
+		{
+			uint64_t ka = encoder.hilbert(a), kb = encoder.hilbert(b);
+			return ka != kb ? ka < kb : LexicographicLess()(a, b);
+		}
+	};
+
+	// Permutation that sorts points[0, count) in the given order: points[result[0]] comes first.
+	// Morton and Hilbert keys use the bounding box of the points. count must be below 2^32.
+	template<class coordDataType, size_t dimension>
+	std::vector<uint32_t> spatialSortPermutation(const Vector<coordDataType, dimension>* points, size_t count, SpatialOrder order, unsigned _threads = 0)
+	{
+		if (count > 0xffffffffull)
+			throw std::length_error("spatialSortPermutation: too many points for 32-bit indices\n");
+
+		const size_t GRAIN = 1 << 15;
+		std::vector<uint32_t> permutation(count);
+		std::vector<uint64_t> keys(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			permutation[i] = static_cast<uint32_t>(i);
+		}
+
+		if (order != SpatialOrder::Lexicographic)
+		{
+			SpatialKeyEncoder<coordDataType, dimension> encoder = SpatialKeyEncoder<coordDataType, dimension>::fromPoints(points, count);
+			bool hilbert = order == SpatialOrder::Hilbert;
+			parallelFor(0, count, _threads, GRAIN, [&](size_t i) {
+				keys[i] = hilbert ? encoder.hilbert(points[i]) : encoder.morton(points[i]);
+			});
+			radixSort(keys.data(), permutation.data(), count, static_cast<unsigned>(SpatialKeyEncoder<coordDataType, dimension>::BITS * dimension), _threads);
+			return permutation;
+		}
+
+		// As many leading axes as fit go into one key; equal keys are then ordered by the remaining axes.
+		const unsigned width = 8 * sizeof(coordDataType);
+		const size_t leading = std::min<size_t>(dimension, 64 / width);
+		parallelFor(0, count, _threads, GRAIN, [&](size_t i) {
+			uint64_t key = 0;
+			for (size_t d = 0; d < leading; d++)
+			{
+				key = (width < 64 ? key << width : 0) | orderedKey(points[i][d]);
+			}
+			keys[i] = key;
+		});
+		radixSort(keys.data(), permutation.data(), count, static_cast<unsigned>(width * leading), _threads);
+
+		if (leading < dimension)
+		{
+			auto trailingLess = [&](uint32_t a, uint32_t b) {
+				for (size_t d = leading; d < dimension; d++)
+				{
+					if (points[a][d] != points[b][d])
+						return points[a][d] < points[b][d];
+				}
+				return false;
+			};
+			for (size_t begin = 0, end; begin < count; begin = end)
+			{
+				end = begin + 1;
+				while (end < count && keys[end] == keys[begin])
+					end++;
+				if (end - begin > 1)
+					std::stable_sort(permutation.begin() + begin, permutation.begin() + end, trailingLess);
+			}
+		}
+		return permutation;
+	}
+
+	// Sort points[0, count) in place in the given order.
+	template<class coordDataType, size_t dimension>
+	void spatialSort(Vector<coordDataType, dimension>* points, size_t count, SpatialOrder order, unsigned _threads = 0)
+	{
+		std::vector<uint32_t> permutation = spatialSortPermutation(points, count, order, _threads);
+		std::vector<Vector<coordDataType, dimension>> sorted(count);
+		parallelFor(0, count, _threads, 1 << 15, [&](size_t i) {
+			sorted[i] = points[permutation[i]];
+		});
+		std::copy(sorted.begin(), sorted.end(), points);
+	}
+
+	template<class coordDataType, size_t dimension>
+	void spatialSort(std::vector<Vector<coordDataType, dimension>>& points, SpatialOrder order, unsigned _threads = 0)
+	{
+		spatialSort(points.data(), points.size(), order, _threads);
+	}
+
+} // Closing the scaleGeom namespace.
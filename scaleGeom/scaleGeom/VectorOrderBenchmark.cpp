@@ -0,0 +1,73 @@
+#include "Benchmark.h"
+#include "Parallel.h"
+#include "VectorOrder.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    std::vector<scaleGeom::Vector3f> randomPoints(size_t count)
+    {
+        std::mt19937 rng(99);
+        std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+        std::vector<scaleGeom::Vector3f> points(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            points[i] = scaleGeom::Vector3f(dist(rng), dist(rng), dist(rng));
+        }
+        return points;
+    }
+
+    void report(const char* label, unsigned threads, double seconds, size_t count)
+    {
+        std::cout << "  " << std::left << std::setw(36) << label << std::right
+            << std::setw(3) << threads << " threads "
+            << std::setw(9) << std::fixed << std::setprecision(2) << seconds * 1e3 << " ms  "
+            << std::setw(7) << std::setprecision(1) << count / seconds / 1e6 << " Mpts/s" << std::endl;
+    }
+}
+
+SCALEGEOM_BENCHMARK(VectorOrderSorting)
+{
+    const size_t count = scaleGeom::bench::problemSize(4000000);
+    const unsigned hardware = scaleGeom::resolveThreadCount(0);
+    const std::vector<scaleGeom::Vector3f> points = randomPoints(count);
+    std::cout << "  points: " << count << std::endl;
+
+    // Comparison sorts with the comparators, as a baseline.
+    {
+        std::vector<scaleGeom::Vector3f> copy = points;
+        Timer timer;
+        std::sort(copy.begin(), copy.end(), scaleGeom::LexicographicLess());
+        report("std::sort, LexicographicLess", 1, timer.seconds(), count);
+    }
+    {
+        std::vector<scaleGeom::Vector3f> copy = points;
+        scaleGeom::SpatialKeyEncoder<float, scaleGeom::DIM3> encoder = scaleGeom::SpatialKeyEncoder<float, scaleGeom::DIM3>::fromPoints(copy.data(), count);
+        Timer timer;
+        std::sort(copy.begin(), copy.end(), scaleGeom::MortonLess<float, scaleGeom::DIM3>(encoder));
+        report("std::sort, MortonLess", 1, timer.seconds(), count);
+    }
+
+    const scaleGeom::SpatialOrder orders[] = { scaleGeom::SpatialOrder::Lexicographic, scaleGeom::SpatialOrder::Morton, scaleGeom::SpatialOrder::Hilbert };
+    const char* const labels[] = { "spatialSort, lexicographic", "spatialSort, Morton", "spatialSort, Hilbert" };
+    for (int o = 0; o < 3; o++)
+    {
+        for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware))
+        {
+            std::vector<scaleGeom::Vector3f> copy = points;
+            Timer timer;
+            scaleGeom::spatialSort(copy, orders[o], threads);
+            report(labels[o], threads, timer.seconds(), count);
+            scaleGeom::bench::doNotOptimize(copy.data());
+            if (threads == hardware)
+                break;
+        }
+    }
+}
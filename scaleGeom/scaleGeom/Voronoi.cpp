@@ -0,0 +1,716 @@
+#include "Voronoi.h"
+#include "ExactArithmetic.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+    const uint32_t NONE = 0xffffffffu;
+
+    inline uint32_t next(uint32_t h) { return h % 3 == 2 ? h - 2 : h + 1; }
+
+    // Vector.h only provides the float cross products.
+    inline double cross(const scaleGeom::Vector2d& a, const scaleGeom::Vector2d& b) { return a[0] * b[1] - a[1] * b[0]; }
+
+    inline scaleGeom::Vector3d cross(const scaleGeom::Vector3d& a, const scaleGeom::Vector3d& b)
+    {
+        return scaleGeom::Vector3d(a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]);
+    }
+
+    // The double circumcentre of a tetrahedron is used when its denominator, the triple product of the edges from
+    // the first vertex, exceeds this fraction of its permanent: the relative error of the offset from that vertex
+    // is then below about 1e-9. Flatter tetrahedra (slivers, common for rounded lattice input) go to the exact path.
+    const double CIRCUMCENTRE_TRUST = 1e-6;
+
+    // Offset of the circumcentre of a, b, c, d from a, with the numerator and denominator evaluated exactly in
+    // expansion arithmetic and rounded only at the final division.
+    scaleGeom::Vector3d exactCircumcentreOffset(const scaleGeom::Vector3d& a, const scaleGeom::Vector3d& b, const scaleGeom::Vector3d& c,
+        const scaleGeom::Vector3d& d)
+    {
+        using namespace scaleGeom::exact;
+        arena.reset();
+        Expansion eb[3], ec[3], ed[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            eb[axis] = difference(b[axis], a[axis]);
+            ec[axis] = difference(c[axis], a[axis]);
+            ed[axis] = difference(d[axis], a[axis]);
+        }
+        auto cross = [](const Expansion* x, const Expansion* y, Expansion* out) {
+            out[0] = x[1] * y[2] - x[2] * y[1];
+            out[1] = x[2] * y[0] - x[0] * y[2];
+            out[2] = x[0] * y[1] - x[1] * y[0];
+        };
+        auto dot = [](const Expansion* x, const Expansion* y) { return x[0] * y[0] + x[1] * y[1] + x[2] * y[2]; };
+        Expansion cd[3], db[3], bc[3];
+        cross(ec, ed, cd);
+        cross(ed, eb, db);
+        cross(eb, ec, bc);
+        const Expansion bb = dot(eb, eb), cc = dot(ec, ec), dd = dot(ed, ed), denominator = dot(eb, cd);
+        const double scale = 0.5 / estimate(denominator.length, denominator.terms);
+        scaleGeom::Vector3d offset;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const Expansion numerator = cd[axis] * bb + db[axis] * cc + bc[axis] * dd;
+            offset[axis] = estimate(numerator.length, numerator.terms) * scale;
+        }
+        return offset;
+    }
+
+    // Box corner v has the upper coordinate on axis a when bit a of v is set. Faces counterclockwise seen
+    // from outside: -x, +x, -y, +y, -z, +z.
+    const uint32_t BOX_FACES[6][4] = { { 0, 4, 6, 2 }, { 1, 3, 7, 5 }, { 0, 1, 5, 4 }, { 2, 6, 7, 3 }, { 0, 2, 3, 1 }, { 4, 5, 7, 6 } };
+
+    // COMPLETION[a][b] holds the positions c, d of a tetrahedron's other two vertices such that (a, b, c, d) is
+    // an even permutation of (0, 1, 2, 3), and so has the orientation of the tetrahedron.
+    const uint8_t COMPLETION[4][4][2] = {
+        { { 0, 0 }, { 2, 3 }, { 3, 1 }, { 1, 2 } },
+        { { 3, 2 }, { 0, 0 }, { 0, 3 }, { 2, 0 } },
+        { { 1, 3 }, { 3, 0 }, { 0, 0 }, { 0, 1 } },
+        { { 2, 1 }, { 0, 2 }, { 1, 0 }, { 0, 0 } }
+    };
+
+    unsigned positionOf(const uint32_t* tetrahedron, uint32_t vertex)
+    {
+        unsigned k = 0;
+        while (tetrahedron[k] != vertex)
+        {
+            k++;
+        }
+        return k;
+    }
+
+    // Clip the convex polygon (vertices, labels of the edges starting at them) to dot(normal, x) <= offset.
+    // The edge along the clipping line is labelled neighbor. Returns false if nothing is left.
+    bool clipPolygon(std::vector<scaleGeom::Vector2d>& vertices, std::vector<uint32_t>& labels,
+        std::vector<scaleGeom::Vector2d>& clipped, std::vector<uint32_t>& clippedLabels,
+        const scaleGeom::Vector2d& normal, double offset, uint32_t neighbor)
+    {
+        const size_t n = vertices.size();
+        size_t outside = 0;
+        for (const scaleGeom::Vector2d& v : vertices)
+        {
+            outside += scaleGeom::dotProduct(normal, v) > offset;
+        }
+        if (outside == 0)
+            return true;
+        if (outside == n)
+            return false;
+
+        clipped.clear();
+        clippedLabels.clear();
+        for (size_t k = 0; k < n; k++)
+        {
+            const scaleGeom::Vector2d& a = vertices[k];
+            const scaleGeom::Vector2d& b = vertices[(k + 1) % n];
+            const double da = scaleGeom::dotProduct(normal, a) - offset;
+            const double db = scaleGeom::dotProduct(normal, b) - offset;
+            if (da <= 0 && db <= 0)
+            {
+                clipped.push_back(a);
+                clippedLabels.push_back(labels[k]);
+            }
+            else if (da <= 0)
+            {
+                // Leaving: a vertex on the line starts the new edge itself.
+                clipped.push_back(a);
+                clippedLabels.push_back(da < 0 ? labels[k] : neighbor);
+                if (da < 0)
+                {
+                    clipped.push_back(a + (b - a) * (da / (da - db)));
+                    clippedLabels.push_back(neighbor);
+                }
+            }
+            else if (db < 0)
+            {
+                clipped.push_back(b + (a - b) * (db / (db - da)));
+                clippedLabels.push_back(labels[k]);
+            }
+        }
+        std::swap(vertices, clipped);
+        std::swap(labels, clippedLabels);
+        return vertices.size() >= 3;
+    }
+
+    // Clip the convex polyhedron in scratch (vertices, faces in faceStart/faceVertices, labels in neighbors)
+    // to dot(normal, x) <= offset. The new face along the plane is labelled neighbor. Returns false if
+    // nothing is left.
+    bool clipPolyhedron(scaleGeom::VoronoiScratch3D& s, const scaleGeom::Vector3d& normal, double offset, uint32_t neighbor)
+    {
+        const size_t n = s.vertices.size();
+        s.distance.resize(n);
+        size_t outside = 0;
+        for (size_t v = 0; v < n; v++)
+        {
+            s.distance[v] = scaleGeom::dotProduct(normal, s.vertices[v]) - offset;
+            outside += s.distance[v] > 0;
+        }
+        if (outside == 0)
+            return true;
+        if (outside == n)
+            return false;
+
+        // Surviving vertices keep their order; the point where an edge crosses the plane is appended once per edge,
+        // so capNext below needs at most n + (number of edges) entries.
+        s.clipped.clear();
+        s.remap.assign(n, NONE);
+        for (size_t v = 0; v < n; v++)
+        {
+            if (s.distance[v] <= 0)
+            {
+                s.remap[v] = static_cast<uint32_t>(s.clipped.size());
+                s.clipped.push_back(s.vertices[v]);
+            }
+        }
+        s.cuts.clear();
+        auto cut = [&](uint32_t inside, uint32_t outer) {
+            if (s.distance[inside] == 0)
+                return s.remap[inside];
+            for (size_t i = 0; i < s.cuts.size(); i += 3)
+            {
+                if (s.cuts[i] == inside && s.cuts[i + 1] == outer)
+                    return s.cuts[i + 2];
+            }
+            const uint32_t index = static_cast<uint32_t>(s.clipped.size());
+            const double t = s.distance[inside] / (s.distance[inside] - s.distance[outer]);
+            s.clipped.push_back(s.vertices[inside] + (s.vertices[outer] - s.vertices[inside]) * t);
+            s.cuts.insert(s.cuts.end(), { inside, outer, index });
+            return index;
+        };
+
+        // Each face that crosses the plane leaves it at an exit point and comes back at an entry point;
+        // the new face runs along the same segment the other way, from entry to exit.
+        s.capNext.assign(n + s.faceVertices.size(), NONE);
+        s.clippedStart.assign(1, 0);
+        s.clippedVertices.clear();
+        s.clippedNeighbors.clear();
+        const size_t faces = s.neighbors.size();
+        for (size_t f = 0; f < faces; f++)
+        {
+            const uint32_t first = s.faceStart[f], size = s.faceStart[f + 1] - first;
+            const size_t begin = s.clippedVertices.size();
+            uint32_t exit = NONE, firstEntry = NONE;
+            for (uint32_t k = 0; k < size; k++)
+            {
+                const uint32_t a = s.faceVertices[first + k], b = s.faceVertices[first + (k + 1) % size];
+                const bool aInside = s.distance[a] <= 0, bInside = s.distance[b] <= 0;
+                if (aInside)
+                    s.clippedVertices.push_back(s.remap[a]);
+                if (aInside && !bInside)
+                {
+                    exit = cut(a, b);
+                    if (s.distance[a] < 0)
+                        s.clippedVertices.push_back(exit);
+                }
+                else if (!aInside && bInside)
+                {
+                    const uint32_t entry = cut(b, a);
+                    if (s.distance[b] < 0)
+                        s.clippedVertices.push_back(entry);
+                    if (exit == NONE)
+                        firstEntry = entry;
+                    else if (entry != exit)
+                        s.capNext[entry] = exit;
+                    exit = NONE;
+                }
+            }
+            // A loop that started outside met its entry before its exit.
+            if (exit != NONE && firstEntry != NONE && firstEntry != exit)
+                s.capNext[firstEntry] = exit;
+            if (s.clippedVertices.size() - begin >= 3)
+            {
+                s.clippedStart.push_back(static_cast<uint32_t>(s.clippedVertices.size()));
+                s.clippedNeighbors.push_back(s.neighbors[f]);
+            }
+            else
+            {
+                s.clippedVertices.resize(begin);
+            }
+        }
+
+        // Chain the segments into the new face.
+        uint32_t start = NONE;
+        for (uint32_t v = 0; v < s.clipped.size() && start == NONE; v++)
+        {
+            if (s.capNext[v] != NONE)
+                start = v;
+        }
+        if (start != NONE)
+        {
+            const size_t begin = s.clippedVertices.size();
+            uint32_t v = start;
+            do
+            {
+                s.clippedVertices.push_back(v);
+                v = s.capNext[v];
+            } while (v != NONE && v != start && s.clippedVertices.size() - begin <= s.clipped.size());
+            if (v == start && s.clippedVertices.size() - begin >= 3)
+            {
+                s.clippedStart.push_back(static_cast<uint32_t>(s.clippedVertices.size()));
+                s.clippedNeighbors.push_back(neighbor);
+            }
+            else
+            {
+                s.clippedVertices.resize(begin);
+            }
+        }
+
+        std::swap(s.vertices, s.clipped);
+        std::swap(s.faceStart, s.clippedStart);
+        std::swap(s.faceVertices, s.clippedVertices);
+        std::swap(s.neighbors, s.clippedNeighbors);
+        return s.neighbors.size() >= 4;
+    }
+
+    // True if every vertex lies in the box [lower, upper].
+    template<size_t dimension>
+    bool inside(const std::vector<scaleGeom::Vector<double, dimension>>& vertices,
+        const scaleGeom::Vector<double, dimension>& lower, const scaleGeom::Vector<double, dimension>& upper)
+    {
+        for (const scaleGeom::Vector<double, dimension>& v : vertices)
+        {
+            for (size_t a = 0; a < dimension; a++)
+            {
+                if (!(v[a] >= lower[a] && v[a] <= upper[a]))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // Home slot of tetrahedron t in the position table, from the high bits of a multiplicative hash.
+    inline size_t tableSlot(const scaleGeom::VoronoiScratch3D& s, uint32_t t)
+    {
+        const uint32_t hash = t * 0x9e3779b1u;
+        return (hash ^ (hash >> 16)) & (s.table.size() - 1);
+    }
+
+    // Insert tetrahedron t into the position table of scratch. Returns false if it was already there.
+    bool insertTetrahedron(scaleGeom::VoronoiScratch3D& s, uint32_t t)
+    {
+        if (2 * (s.tetrahedra.size() + 1) > s.table.size())
+        {
+            s.table.assign(std::max<size_t>(64, 2 * s.table.size()), NONE);
+            for (uint32_t i = 0; i < s.tetrahedra.size(); i++)
+            {
+                size_t slot = tableSlot(s, s.tetrahedra[i]);
+                while (s.table[slot] != NONE)
+                {
+                    slot = (slot + 1) & (s.table.size() - 1);
+                }
+                s.table[slot] = i;
+            }
+        }
+        size_t slot = tableSlot(s, t);
+        while (s.table[slot] != NONE)
+        {
+            if (s.tetrahedra[s.table[slot]] == t)
+                return false;
+            slot = (slot + 1) & (s.table.size() - 1);
+        }
+        s.table[slot] = static_cast<uint32_t>(s.tetrahedra.size());
+        s.tetrahedra.push_back(t);
+        return true;
+    }
+
+    uint32_t findTetrahedron(const scaleGeom::VoronoiScratch3D& s, uint32_t t)
+    {
+        size_t slot = tableSlot(s, t);
+        while (s.tetrahedra[s.table[slot]] != t)
+        {
+            slot = (slot + 1) & (s.table.size() - 1);
+        }
+        return s.table[slot];
+    }
+
+    void clearTable(scaleGeom::VoronoiScratch3D& s)
+    {
+        for (uint32_t t : s.tetrahedra)
+        {
+            size_t slot = tableSlot(s, t);
+            while (s.table[slot] == NONE || s.tetrahedra[s.table[slot]] != t)
+            {
+                slot = (slot + 1) & (s.table.size() - 1);
+            }
+            s.table[slot] = NONE;
+        }
+        s.tetrahedra.clear();
+    }
+}
+
+scaleGeom::Voronoi2D::Voronoi2D(const Vector2f* sites, size_t count, const DelaunayMesh2D& mesh)
+    : Voronoi2D(static_cast<const Vector2d*>(nullptr), count, mesh)
+{
+    floatSites = reinterpret_cast<const float*>(sites);
+}
+
+scaleGeom::Voronoi2D::Voronoi2D(const Vector2d* sites, size_t count, const DelaunayMesh2D& mesh)
+    : doubleSites(reinterpret_cast<const double*>(sites)), count(count), mesh(&mesh), incident(count, NONE)
+{
+    const uint32_t halfedges = static_cast<uint32_t>(mesh.triangles.size());
+    for (uint32_t e = 0; e < halfedges; e++)
+    {
+        uint32_t& in = incident[mesh.triangles[next(e)]];
+        if (in == NONE || mesh.halfedges[e] == NONE)
+            in = e;
+    }
+}
+
+size_t scaleGeom::Voronoi2D::slotCount() const
+{
+    return mesh->triangles.size();
+}
+
+uint32_t scaleGeom::Voronoi2D::slotSite(size_t slot) const
+{
+    const uint32_t site = mesh->triangles[next(static_cast<uint32_t>(slot))];
+    return incident[site] == slot ? site : NONE;
+}
+
+scaleGeom::Vector2d scaleGeom::Voronoi2D::position(uint32_t site) const
+{
+    const size_t i = 2 * static_cast<size_t>(site);
+    if (floatSites)
+        return Vector2d(floatSites[i], floatSites[i + 1]);
+    return Vector2d(doubleSites[i], doubleSites[i + 1]);
+}
+
+scaleGeom::Vector2d scaleGeom::Voronoi2D::circumcentre(uint32_t triangle) const
+{
+    const uint32_t* v = &mesh->triangles[3 * static_cast<size_t>(triangle)];
+    const Vector2d a = position(v[0]);
+    const Vector2d b = position(v[1]) - a;
+    const Vector2d c = position(v[2]) - a;
+    const double bb = dotProduct(b, b), cc = dotProduct(c, c);
+    const double scale = 0.5 / cross(b, c);
+    return Vector2d(a[0] + (c[1] * bb - b[1] * cc) * scale, a[1] + (b[0] * cc - c[0] * bb) * scale);
+}
+
+bool scaleGeom::Voronoi2D::cell(uint32_t site, VoronoiScratch2D& scratch, VoronoiCell2D& out) const
+{
+    out = VoronoiCell2D();
+    out.site = site;
+    const uint32_t start = incident[site];
+    if (start == NONE)
+        return false;
+
+    // Around the site clockwise, recording the far end of each triangle's outgoing edge.
+    scratch.vertices.clear();
+    scratch.neighbors.clear();
+    uint32_t e = start;
+    do
+    {
+        scratch.vertices.push_back(circumcentre(e / 3));
+        const uint32_t outgoing = next(e);
+        scratch.neighbors.push_back(mesh->triangles[next(outgoing)]);
+        e = mesh->halfedges[outgoing];
+    } while (e != NONE && e != start);
+
+    // Reversed to counterclockwise, the edge from vertex k to k + 1 is the outgoing edge of the triangle of k + 1.
+    std::reverse(scratch.vertices.begin(), scratch.vertices.end());
+    std::reverse(scratch.neighbors.begin(), scratch.neighbors.end());
+    std::rotate(scratch.neighbors.begin(), scratch.neighbors.begin() + 1, scratch.neighbors.end());
+    if (e == NONE)
+    {
+        // The rays are the outer normals of the hull edges into and out of the site.
+        const Vector2d p = position(site);
+        const uint32_t before = mesh->triangles[start], after = scratch.neighbors.back();
+        const Vector2d in = p - position(before), outgoing = position(after) - p;
+        out.rayLast = Vector2d(in[1], -in[0]);
+        out.rayFirst = Vector2d(outgoing[1], -outgoing[0]);
+        scratch.neighbors.insert(scratch.neighbors.end() - 1, before);
+        out.bounded = false;
+    }
+
+    out.vertices = scratch.vertices.data();
+    out.vertexCount = scratch.vertices.size();
+    out.neighbors = scratch.neighbors.data();
+    out.edgeCount = scratch.neighbors.size();
+    return true;
+}
+
+bool scaleGeom::Voronoi2D::clippedCell(uint32_t site, const Vector2d& lower, const Vector2d& upper, VoronoiScratch2D& scratch, VoronoiCell2D& out) const
+{
+    // Most cells lie inside the box and are their own clipped cell.
+    if (!cell(site, scratch, out))
+        return false;
+    if (out.bounded && inside(scratch.vertices, lower, upper))
+        return true;
+    out = VoronoiCell2D();
+    out.site = site;
+    const uint32_t start = incident[site];
+
+    // The box relative to the site, clipped by the bisector of every Delaunay neighbour.
+    const Vector2d p = position(site);
+    const Vector2d low = lower - p, high = upper - p;
+    scratch.vertices.assign({ low, Vector2d(high[0], low[1]), high, Vector2d(low[0], high[1]) });
+    scratch.neighbors.assign(4, VORONOI_BOX);
+    bool empty = false;
+    uint32_t e = start;
+    do
+    {
+        const uint32_t outgoing = next(e);
+        const uint32_t neighbor = mesh->triangles[next(outgoing)];
+        const Vector2d normal = position(neighbor) - p;
+        empty = !clipPolygon(scratch.vertices, scratch.neighbors, scratch.clipped, scratch.clippedNeighbors, normal, 0.5 * dotProduct(normal, normal), neighbor);
+        e = mesh->halfedges[outgoing];
+    } while (!empty && e != NONE && e != start);
+    if (!empty && e == NONE)
+    {
+        const uint32_t neighbor = mesh->triangles[start];
+        const Vector2d normal = position(neighbor) - p;
+        empty = !clipPolygon(scratch.vertices, scratch.neighbors, scratch.clipped, scratch.clippedNeighbors, normal, 0.5 * dotProduct(normal, normal), neighbor);
+    }
+    if (empty)
+        return false;
+
+    for (Vector2d& v : scratch.vertices)
+    {
+        v += p;
+    }
+    out.vertices = scratch.vertices.data();
+    out.vertexCount = scratch.vertices.size();
+    out.neighbors = scratch.neighbors.data();
+    out.edgeCount = scratch.neighbors.size();
+    return true;
+}
+
+scaleGeom::Voronoi3D::Voronoi3D(const Vector3f* sites, size_t count, const DelaunayMesh3D& mesh)
+    : Voronoi3D(static_cast<const Vector3d*>(nullptr), count, mesh)
+{
+    floatSites = reinterpret_cast<const float*>(sites);
+}
+
+scaleGeom::Voronoi3D::Voronoi3D(const Vector3d* sites, size_t count, const DelaunayMesh3D& mesh)
+    : doubleSites(reinterpret_cast<const double*>(sites)), count(count), mesh(&mesh), incident(count, NONE)
+{
+    // The first tetrahedron of each site.
+    for (uint32_t t = static_cast<uint32_t>(mesh.tetrahedronCount()); t-- > 0; )
+    {
+        for (unsigned k = 0; k < 4; k++)
+        {
+            incident[mesh.tetrahedra[4 * static_cast<size_t>(t) + k]] = t;
+        }
+    }
+}
+
+size_t scaleGeom::Voronoi3D::slotCount() const
+{
+    return mesh->tetrahedra.size();
+}
+
+uint32_t scaleGeom::Voronoi3D::slotSite(size_t slot) const
+{
+    const uint32_t site = mesh->tetrahedra[slot];
+    return incident[site] == slot / 4 ? site : NONE;
+}
+
+scaleGeom::Vector3d scaleGeom::Voronoi3D::position(uint32_t site) const
+{
+    const size_t i = 3 * static_cast<size_t>(site);
+    if (floatSites)
+        return Vector3d(floatSites[i], floatSites[i + 1], floatSites[i + 2]);
+    return Vector3d(doubleSites[i], doubleSites[i + 1], doubleSites[i + 2]);
+}
+
+scaleGeom::Vector3d scaleGeom::Voronoi3D::circumcentre(uint32_t tetrahedron) const
+{
+    const uint32_t* v = &mesh->tetrahedra[4 * static_cast<size_t>(tetrahedron)];
+    const Vector3d a = position(v[0]);
+    const Vector3d b = position(v[1]) - a;
+    const Vector3d c = position(v[2]) - a;
+    const Vector3d d = position(v[3]) - a;
+    const Vector3d cd = cross(c, d), db = cross(d, b), bc = cross(b, c);
+    const double denominator = dotProduct(b, cd);
+    const double permanent = std::fabs(b[0]) * (std::fabs(c[1] * d[2]) + std::fabs(c[2] * d[1]))
+        + std::fabs(b[1]) * (std::fabs(c[2] * d[0]) + std::fabs(c[0] * d[2])) + std::fabs(b[2]) * (std::fabs(c[0] * d[1]) + std::fabs(c[1] * d[0]));
+    if (!(std::fabs(denominator) > CIRCUMCENTRE_TRUST * permanent))
+        return a + exactCircumcentreOffset(a, position(v[1]), position(v[2]), position(v[3]));
+    const Vector3d u = cd * dotProduct(b, b) + db * dotProduct(c, c) + bc * dotProduct(d, d);
+    return a + u * (0.5 / denominator);
+}
+
+bool scaleGeom::Voronoi3D::gather(uint32_t site, VoronoiScratch3D& scratch) const
+{
+    clearTable(scratch);
+    insertTetrahedron(scratch, incident[site]);
+    bool closed = true;
+    for (size_t i = 0; i < scratch.tetrahedra.size(); i++)
+    {
+        const uint32_t t = scratch.tetrahedra[i];
+        for (unsigned k = 0; k < 4; k++)
+        {
+            if (mesh->tetrahedra[4 * static_cast<size_t>(t) + k] == site)
+                continue;
+            const uint32_t face = mesh->halffaces[4 * static_cast<size_t>(t) + k];
+            if (face == NONE)
+                closed = false;
+            else
+                insertTetrahedron(scratch, face / 4);
+        }
+    }
+    return closed;
+}
+
+bool scaleGeom::Voronoi3D::cell(uint32_t site, VoronoiScratch3D& scratch, VoronoiCell3D& out) const
+{
+    out = VoronoiCell3D();
+    out.site = site;
+    if (incident[site] == NONE)
+        return false;
+    out.bounded = gather(site, scratch);
+
+    scratch.vertices.clear();
+    for (uint32_t t : scratch.tetrahedra)
+    {
+        scratch.vertices.push_back(circumcentre(t));
+    }
+
+    // One face per Delaunay edge from the site: the circumcentres of the tetrahedra around the edge, in the
+    // order given by stepping across the face opposite d of (site, neighbour, c, d), which winds
+    // counterclockwise seen from the neighbour. Open rings are started at their end. traced holds a bit per
+    // vertex position of each tetrahedron whose edge to the site is done.
+    scratch.traced.assign(scratch.tetrahedra.size(), 0);
+    scratch.faceStart.assign(1, 0);
+    scratch.faceVertices.clear();
+    scratch.neighbors.clear();
+    scratch.open.clear();
+    for (uint32_t i = 0; i < scratch.tetrahedra.size(); i++)
+    {
+        const uint32_t* v = &mesh->tetrahedra[4 * static_cast<size_t>(scratch.tetrahedra[i])];
+        for (unsigned k = 0; k < 4; k++)
+        {
+            const uint32_t neighbor = v[k];
+            if (neighbor == site || scratch.traced[i] >> k & 1)
+                continue;
+
+            uint32_t first = i;
+            bool open = false;
+            for (uint32_t j = i; !out.bounded; )
+            {
+                const uint32_t u = scratch.tetrahedra[j];
+                const uint32_t* w = &mesh->tetrahedra[4 * static_cast<size_t>(u)];
+                const uint8_t* cd = COMPLETION[positionOf(w, site)][positionOf(w, neighbor)];
+                const uint32_t face = mesh->halffaces[4 * static_cast<size_t>(u) + cd[0]];
+                if (face == NONE)
+                {
+                    first = j;
+                    open = true;
+                    break;
+                }
+                j = findTetrahedron(scratch, face / 4);
+                if (j == i)
+                    break;
+            }
+            for (uint32_t j = first; ; )
+            {
+                scratch.faceVertices.push_back(j);
+                const uint32_t u = scratch.tetrahedra[j];
+                const uint32_t* w = &mesh->tetrahedra[4 * static_cast<size_t>(u)];
+                const unsigned b = positionOf(w, neighbor);
+                scratch.traced[j] |= 1 << b;
+                const uint32_t face = mesh->halffaces[4 * static_cast<size_t>(u) + COMPLETION[positionOf(w, site)][b][1]];
+                if (face == NONE)
+                    break;
+                j = findTetrahedron(scratch, face / 4);
+                if (j == first)
+                    break;
+            }
+            scratch.faceStart.push_back(static_cast<uint32_t>(scratch.faceVertices.size()));
+            scratch.neighbors.push_back(neighbor);
+            scratch.open.push_back(open);
+        }
+    }
+
+    out.vertices = scratch.vertices.data();
+    out.vertexCount = scratch.vertices.size();
+    out.faceStart = scratch.faceStart.data();
+    out.faceVertices = scratch.faceVertices.data();
+    out.neighbors = scratch.neighbors.data();
+    out.open = scratch.open.data();
+    out.faceCount = scratch.neighbors.size();
+    return true;
+}
+
+bool scaleGeom::Voronoi3D::clippedCell(uint32_t site, const Vector3d& lower, const Vector3d& upper, VoronoiScratch3D& scratch, VoronoiCell3D& out) const
+{
+    // Most cells lie inside the box and are their own clipped cell; the tetrahedra around the site are
+    // gathered either way.
+    if (!cell(site, scratch, out))
+        return false;
+    if (out.bounded && inside(scratch.vertices, lower, upper))
+        return true;
+    out = VoronoiCell3D();
+    out.site = site;
+
+    // Delaunay neighbours, nearest first so that the polyhedron shrinks early.
+    const Vector3d p = position(site);
+    scratch.sites.clear();
+    for (uint32_t t : scratch.tetrahedra)
+    {
+        for (unsigned k = 0; k < 4; k++)
+        {
+            const uint32_t neighbor = mesh->tetrahedra[4 * static_cast<size_t>(t) + k];
+            if (neighbor != site)
+                scratch.sites.push_back(neighbor);
+        }
+    }
+    std::sort(scratch.sites.begin(), scratch.sites.end());
+    scratch.sites.erase(std::unique(scratch.sites.begin(), scratch.sites.end()), scratch.sites.end());
+    scratch.distance.clear();
+    for (uint32_t neighbor : scratch.sites)
+    {
+        const Vector3d d = position(neighbor) - p;
+        scratch.distance.push_back(dotProduct(d, d));
+    }
+    scratch.remap.resize(scratch.sites.size());
+    for (uint32_t i = 0; i < scratch.remap.size(); i++)
+    {
+        scratch.remap[i] = i;
+    }
+    std::sort(scratch.remap.begin(), scratch.remap.end(), [&](uint32_t a, uint32_t b) { return scratch.distance[a] < scratch.distance[b]; });
+    for (uint32_t& i : scratch.remap)
+    {
+        i = scratch.sites[i];
+    }
+    std::swap(scratch.sites, scratch.remap);
+
+    // The box relative to the site, clipped by the bisector of every neighbour.
+    const Vector3d low = lower - p, high = upper - p;
+    scratch.vertices.clear();
+    for (unsigned v = 0; v < 8; v++)
+    {
+        scratch.vertices.push_back(Vector3d((v & 1 ? high : low)[0], (v & 2 ? high : low)[1], (v & 4 ? high : low)[2]));
+    }
+    scratch.faceStart.clear();
+    scratch.faceVertices.clear();
+    for (unsigned f = 0; f < 6; f++)
+    {
+        scratch.faceStart.push_back(4 * f);
+        scratch.faceVertices.insert(scratch.faceVertices.end(), BOX_FACES[f], BOX_FACES[f] + 4);
+    }
+    scratch.faceStart.push_back(24);
+    scratch.neighbors.assign(6, VORONOI_BOX);
+    for (uint32_t neighbor : scratch.sites)
+    {
+        const Vector3d normal = position(neighbor) - p;
+        if (!clipPolyhedron(scratch, normal, 0.5 * dotProduct(normal, normal), neighbor))
+            return false;
+    }
+
+    for (Vector3d& v : scratch.vertices)
+    {
+        v += p;
+    }
+    scratch.open.assign(scratch.neighbors.size(), 0);
+    out.vertices = scratch.vertices.data();
+    out.vertexCount = scratch.vertices.size();
+    out.faceStart = scratch.faceStart.data();
+    out.faceVertices = scratch.faceVertices.data();
+    out.neighbors = scratch.neighbors.data();
+    out.open = scratch.open.data();
+    out.faceCount = scratch.neighbors.size();
+    return true;
+}
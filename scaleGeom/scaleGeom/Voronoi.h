@@ -0,0 +1,251 @@
+/*
+	Voronoi.h - Voronoi Cells from a Delaunay Triangulation
+
+	Overview:
+	Voronoi2D and Voronoi3D produce the Voronoi cell of any site on demand from the Delaunay mesh
+	of the sites (Delaunay2D.h, Delaunay3D.h). Nothing but one incident triangle or tetrahedron
+	per site is stored, so the diagram as a whole never exists in memory: for 100 million sites
+	the extra space is 400 MB on top of the mesh, and each cell is written into a scratch buffer
+	owned by the caller. The objects are read-only after construction, so any number of threads
+	may extract cells at the same time, each with its own scratch.
+
+	Cells:
+	- cell(): the exact Voronoi cell, whose vertices are the circumcentres of the Delaunay
+	  triangles or tetrahedra around the site. The circumcentre of a simplex is computed the same
+	  way from every cell it appears in, so neighbouring cells share bit-identical vertices. The
+	  circumcentres of near-flat tetrahedra (slivers, frequent for rounded lattice input) are
+	  evaluated in expansion arithmetic (ExactArithmetic.h) and rounded once. Sites on the convex
+	  hull have unbounded cells (see VoronoiCell2D and VoronoiCell3D).
+	- clippedCell(): the cell intersected with an axis-aligned box. A bounded cell inside the box
+	  is returned as is; otherwise the box is clipped by the bisectors of the site's Delaunay
+	  neighbours. Every clipped cell is closed, so this is the mode for box domains; sites
+	  outside the box still get the part of their cell that reaches into it.
+
+	forEachVoronoiCell runs over every site in parallel and passes each non-empty cell to a
+	callback. The callback is called concurrently from several threads unless _threads is 1.
+	Sites are visited in the order of the mesh rather than by index, so that consecutive cells
+	share most of their simplices in cache.
+
+	Coordinates are computed and reported in double precision for both Vector2f/3f and
+	Vector2d/3d sites. The objects keep pointers to the sites and the mesh, which must outlive
+	them. Duplicate sites (not vertices of the mesh) have no cell, and neither has any site when
+	the mesh is empty (collinear or coplanar input).
+
+	Usage:
+	scaleGeom::DelaunayMesh3D mesh = scaleGeom::delaunay3D(sites);
+	scaleGeom::Voronoi3D voronoi(sites.data(), sites.size(), mesh);
+	scaleGeom::forEachVoronoiCell(voronoi, lower, upper, [&](const scaleGeom::VoronoiCell3D& cell) { ... });
+
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Delaunay2D.h"
+#include "Delaunay3D.h"
+#include "Parallel.h"
+#include "Vector.h"
+
+namespace scaleGeom {
+
+	// Neighbour reported for the edges and faces that lie on the clipping box.
+	constexpr uint32_t VORONOI_BOX = 0xffffffffu;
+
+	// A 2D Voronoi cell. The arrays point into a VoronoiScratch2D and stay valid until it is reused.
+	struct VoronoiCell2D
+	{
+		uint32_t site = VORONOI_BOX;
+
+		// Vertices, counterclockwise.
+		const Vector2d* vertices = nullptr;
+		size_t vertexCount = 0;
+
+		// Edge k starts at vertices[k] and separates the cell from the site neighbors[k].
+		// A bounded cell has vertexCount edges, closing back to vertices[0].
+		// An unbounded cell has vertexCount + 1: edges 0 .. vertexCount - 2 join consecutive vertices,
+		// edge vertexCount - 1 is the ray from the last vertex along rayLast, and edge vertexCount is the
+		// ray from infinity into vertices[0], whose direction away from vertices[0] is rayFirst.
+		const uint32_t* neighbors = nullptr;
+		size_t edgeCount = 0;
+
+		bool bounded = true;
+
+		// Ray directions of an unbounded cell (not normalized).
+		Vector2d rayFirst{}, rayLast{};
+	};
+
+	// A 3D Voronoi cell. The arrays point into a VoronoiScratch3D and stay valid until it is reused.
+	struct VoronoiCell3D
+	{
+		uint32_t site = VORONOI_BOX;
+
+		const Vector3d* vertices = nullptr;
+		size_t vertexCount = 0;
+
+		// Face f has the vertices faceVertices[faceStart[f], faceStart[f + 1]), counterclockwise seen
+		// from outside the cell, and separates the cell from the site neighbors[f].
+		const uint32_t* faceStart = nullptr;
+		const uint32_t* faceVertices = nullptr;
+		const uint32_t* neighbors = nullptr;
+		size_t faceCount = 0;
+
+		// Unbounded cells (cell() only) list the finite part of every face. A face with open[f] set is
+		// unbounded: its first and last vertices are joined through infinity, not by an edge.
+		const uint8_t* open = nullptr;
+
+		bool bounded = true;
+	};
+
+	// Output and working buffers of one thread.
+	struct VoronoiScratch2D
+	{
+		std::vector<Vector2d> vertices, clipped;
+		std::vector<uint32_t> neighbors, clippedNeighbors, sites;
+	};
+
+	struct VoronoiScratch3D
+	{
+		std::vector<Vector3d> vertices, clipped;
+		std::vector<uint32_t> faceStart, faceVertices, neighbors, clippedStart, clippedVertices, clippedNeighbors;
+		std::vector<uint8_t> open, traced;
+
+		// Tetrahedra around the site with a hash table of their positions, and the neighbouring sites.
+		std::vector<uint32_t> tetrahedra, table, sites;
+
+		// Per-vertex state of the clipping.
+		std::vector<double> distance;
+		std::vector<uint32_t> remap, capNext, cuts;
+	};
+
+	class Voronoi2D
+	{
+	public:
+
+		static constexpr uint32_t NONE = DelaunayMesh2D::NONE;
+
+		Voronoi2D(const Vector2f* sites, size_t count, const DelaunayMesh2D& mesh);
+		Voronoi2D(const Vector2d* sites, size_t count, const DelaunayMesh2D& mesh);
+
+		size_t siteCount() const { return count; }
+
+		// Sites in mesh order: every site with a cell is slotSite(slot) for exactly one slot in [0, slotCount()),
+		// and the other slots give NONE. Walking the slots visits neighbouring sites close together.
+		size_t slotCount() const;
+		uint32_t slotSite(size_t slot) const;
+
+		// Voronoi cell of site. Returns false if the site has no cell.
+		bool cell(uint32_t site, VoronoiScratch2D& scratch, VoronoiCell2D& out) const;
+
+		// Voronoi cell of site clipped to the box [lower, upper]. Returns false if the result is empty.
+		bool clippedCell(uint32_t site, const Vector2d& lower, const Vector2d& upper, VoronoiScratch2D& scratch, VoronoiCell2D& out) const;
+
+	private:
+
+		Vector2d position(uint32_t site) const;
+		Vector2d circumcentre(uint32_t triangle) const;
+
+		const float* floatSites = nullptr;
+		const double* doubleSites = nullptr;
+		size_t count;
+		const DelaunayMesh2D* mesh;
+
+		// A half-edge ending at each site, the one entering it along the hull for hull sites; NONE if none.
+		std::vector<uint32_t> incident;
+	};
+
+	class Voronoi3D
+	{
+	public:
+
+		static constexpr uint32_t NONE = DelaunayMesh3D::NONE;
+
+		Voronoi3D(const Vector3f* sites, size_t count, const DelaunayMesh3D& mesh);
+		Voronoi3D(const Vector3d* sites, size_t count, const DelaunayMesh3D& mesh);
+
+		size_t siteCount() const { return count; }
+
+		// Sites in mesh order: every site with a cell is slotSite(slot) for exactly one slot in [0, slotCount()),
+		// and the other slots give NONE. Walking the slots visits neighbouring sites close together.
+		size_t slotCount() const;
+		uint32_t slotSite(size_t slot) const;
+
+		// Voronoi cell of site. Returns false if the site has no cell.
+		bool cell(uint32_t site, VoronoiScratch3D& scratch, VoronoiCell3D& out) const;
+
+		// Voronoi cell of site clipped to the box [lower, upper]. Returns false if the result is empty.
+		bool clippedCell(uint32_t site, const Vector3d& lower, const Vector3d& upper, VoronoiScratch3D& scratch, VoronoiCell3D& out) const;
+
+	private:
+
+		Vector3d position(uint32_t site) const;
+		Vector3d circumcentre(uint32_t tetrahedron) const;
+
+		// Collect the tetrahedra around site into scratch.tetrahedra. Returns false if one of them has a hull face through the site.
+		bool gather(uint32_t site, VoronoiScratch3D& scratch) const;
+
+		const float* floatSites = nullptr;
+		const double* doubleSites = nullptr;
+		size_t count;
+		const DelaunayMesh3D* mesh;
+
+		// A tetrahedron incident to each site, or NONE.
+		std::vector<uint32_t> incident;
+	};
+
+	// Mesh slots per chunk of forEachVoronoiCell.
+	constexpr size_t VORONOI_GRAIN = 4096;
+
+	namespace detail {
+
+		template<class Scratch, class Cell, class Diagram, class Produce, class Function>
+		void forEachVoronoiCell(const Diagram& diagram, Produce produce, Function& fn, unsigned _threads)
+		{
+			parallelChunks(0, diagram.slotCount(), _threads, VORONOI_GRAIN, [&](unsigned, size_t begin, size_t end) {
+				Scratch scratch;
+				Cell cell;
+				for (size_t slot = begin; slot < end; slot++)
+				{
+					const uint32_t site = diagram.slotSite(slot);
+					if (site != Diagram::NONE && produce(site, scratch, cell))
+						fn(static_cast<const Cell&>(cell));
+				}
+			});
+		}
+	}
+
+	// Call fn(const VoronoiCell2D&) for every site that has a cell.
+	template<class Function>
+	void forEachVoronoiCell(const Voronoi2D& voronoi, Function fn, unsigned _threads = 0)
+	{
+		detail::forEachVoronoiCell<VoronoiScratch2D, VoronoiCell2D>(voronoi,
+			[&](uint32_t site, VoronoiScratch2D& scratch, VoronoiCell2D& cell) { return voronoi.cell(site, scratch, cell); }, fn, _threads);
+	}
+
+	// As above with every cell clipped to the box [lower, upper].
+	template<class Function>
+	void forEachVoronoiCell(const Voronoi2D& voronoi, const Vector2d& lower, const Vector2d& upper, Function fn, unsigned _threads = 0)
+	{
+		detail::forEachVoronoiCell<VoronoiScratch2D, VoronoiCell2D>(voronoi,
+			[&](uint32_t site, VoronoiScratch2D& scratch, VoronoiCell2D& cell) { return voronoi.clippedCell(site, lower, upper, scratch, cell); }, fn, _threads);
+	}
+
+	// Call fn(const VoronoiCell3D&) for every site that has a cell.
+	template<class Function>
+	void forEachVoronoiCell(const Voronoi3D& voronoi, Function fn, unsigned _threads = 0)
+	{
+		detail::forEachVoronoiCell<VoronoiScratch3D, VoronoiCell3D>(voronoi,
+			[&](uint32_t site, VoronoiScratch3D& scratch, VoronoiCell3D& cell) { return voronoi.cell(site, scratch, cell); }, fn, _threads);
+	}
+
+	// As above with every cell clipped to the box [lower, upper].
+	template<class Function>
+	void forEachVoronoiCell(const Voronoi3D& voronoi, const Vector3d& lower, const Vector3d& upper, Function fn, unsigned _threads = 0)
+	{
+		detail::forEachVoronoiCell<VoronoiScratch3D, VoronoiCell3D>(voronoi,
+			[&](uint32_t site, VoronoiScratch3D& scratch, VoronoiCell3D& cell) { return voronoi.clippedCell(site, lower, upper, scratch, cell); }, fn, _threads);
+	}
+
+} // Closing the scaleGeom namespace.
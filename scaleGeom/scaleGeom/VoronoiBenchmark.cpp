@@ -0,0 +1,154 @@
+#include "Benchmark.h"
+#include "Parallel.h"
+#include "Voronoi.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using scaleGeom::bench::Timer;
+
+namespace {
+
+    template<size_t dimension>
+    std::vector<scaleGeom::Vector<float, dimension>> makeSites(size_t count)
+    {
+        std::mt19937 rng(17);
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        std::vector<scaleGeom::Vector<float, dimension>> sites(count);
+        for (auto& site : sites)
+        {
+            for (size_t axis = 0; axis < dimension; axis++)
+            {
+                site[axis] = uniform(rng);
+            }
+        }
+        return sites;
+    }
+
+    // Volume of a closed cell, from fans of its faces around the site.
+    double cellVolume(const scaleGeom::VoronoiCell3D& cell, const scaleGeom::Vector3d& site)
+    {
+        double volume = 0.0;
+        for (size_t f = 0; f < cell.faceCount; f++)
+        {
+            const scaleGeom::Vector3d a = cell.vertices[cell.faceVertices[cell.faceStart[f]]] - site;
+            for (uint32_t k = cell.faceStart[f] + 1; k + 1 < cell.faceStart[f + 1]; k++)
+            {
+                const scaleGeom::Vector3d b = cell.vertices[cell.faceVertices[k]] - site, c = cell.vertices[cell.faceVertices[k + 1]] - site;
+                volume += (a[0] * (b[1] * c[2] - b[2] * c[1]) + a[1] * (b[2] * c[0] - b[0] * c[2]) + a[2] * (b[0] * c[1] - b[1] * c[0])) / 6;
+            }
+        }
+        return volume;
+    }
+
+    // Self-check on rounded lattice sites (coordinates i / 10.0, about two thirds of a 10^3 lattice kept), whose
+    // cospherical groups make the Delaunay mesh full of slivers. No vertex of a bounded cell may be closer to a
+    // neighbouring site than to the cell's own site, and the clipped cells must fill the box exactly once.
+    void checkLattice()
+    {
+        std::mt19937 rng(20);
+        std::vector<scaleGeom::Vector3d> sites;
+        for (int z = 0; z < 10; z++)
+        {
+            for (int y = 0; y < 10; y++)
+            {
+                for (int x = 0; x < 10; x++)
+                {
+                    if (rng() % 3 != 0)
+                        sites.push_back(scaleGeom::Vector3d(x / 10.0, y / 10.0, z / 10.0));
+                }
+            }
+        }
+        const scaleGeom::DelaunayMesh3D mesh = scaleGeom::delaunay3D(sites);
+        const scaleGeom::Voronoi3D voronoi(sites.data(), sites.size(), mesh);
+        const scaleGeom::Vector3d lower(0, 0, 0), upper(0.9, 0.9, 0.9);
+        scaleGeom::VoronoiScratch3D scratch;
+        scaleGeom::VoronoiCell3D cell;
+        size_t wrongVertices = 0;
+        double volume = 0.0;
+        for (uint32_t s = 0; s < sites.size(); s++)
+        {
+            if (voronoi.cell(s, scratch, cell) && cell.bounded)
+            {
+                for (size_t v = 0; v < cell.vertexCount; v++)
+                {
+                    const scaleGeom::Vector3d toSite = cell.vertices[v] - sites[s];
+                    const double own = scaleGeom::dotProduct(toSite, toSite);
+                    for (size_t f = 0; f < cell.faceCount; f++)
+                    {
+                        const scaleGeom::Vector3d toNeighbor = cell.vertices[v] - sites[cell.neighbors[f]];
+                        if (scaleGeom::dotProduct(toNeighbor, toNeighbor) < own * (1 - 1e-9))
+                        {
+                            wrongVertices++;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (voronoi.clippedCell(s, lower, upper, scratch, cell))
+                volume += cellVolume(cell, sites[s]);
+        }
+        const double error = std::fabs(volume - 0.9 * 0.9 * 0.9);
+        std::cout << "  rounded lattice, " << sites.size() << " sites: volume error " << std::scientific << std::setprecision(1) << error << std::fixed
+            << ((wrongVertices || error > 1e-12) ? "  MISMATCH, " + std::to_string(wrongVertices) + " misplaced vertices" : "") << std::endl;
+    }
+
+    // Stream every cell of the diagram (clipped to the unit box or not) and count the vertices produced.
+    template<class Diagram, class Point, class Cell>
+    void run(const char* label, const Diagram& voronoi, const Point* box)
+    {
+        const unsigned hardware = scaleGeom::resolveThreadCount(0);
+        size_t reference = 0;
+        for (unsigned threads = 1; ; threads = std::min(threads * 2, hardware))
+        {
+            std::atomic<size_t> cells(0), vertices(0);
+            auto count = [&](const Cell& cell) {
+                cells.fetch_add(1, std::memory_order_relaxed);
+                vertices.fetch_add(cell.vertexCount, std::memory_order_relaxed);
+            };
+            Timer timer;
+            if (box)
+                scaleGeom::forEachVoronoiCell(voronoi, box[0], box[1], count, threads);
+            else
+                scaleGeom::forEachVoronoiCell(voronoi, count, threads);
+            const double seconds = timer.seconds();
+            if (threads == 1)
+                reference = vertices;
+            std::cout << "  " << std::left << std::setw(20) << label << std::right
+                << std::setw(3) << threads << " threads "
+                << std::setw(9) << std::fixed << std::setprecision(2) << seconds * 1e3 << " ms  "
+                << std::setw(7) << std::setprecision(2) << cells / seconds / 1e6 << " Mcells/s  "
+                << std::setw(6) << std::setprecision(1) << static_cast<double>(vertices) / cells << " vertices/cell"
+                << (vertices == reference ? "" : "  MISMATCH") << std::endl;
+            if (threads == hardware)
+                break;
+        }
+    }
+}
+
+SCALEGEOM_BENCHMARK(Voronoi)
+{
+    {
+        const std::vector<scaleGeom::Vector2f> sites = makeSites<scaleGeom::DIM2>(scaleGeom::bench::problemSize(2000000));
+        const scaleGeom::DelaunayMesh2D mesh = scaleGeom::delaunay2D(sites);
+        const scaleGeom::Voronoi2D voronoi(sites.data(), sites.size(), mesh);
+        const scaleGeom::Vector2d box[2] = { scaleGeom::Vector2d(0, 0), scaleGeom::Vector2d(1, 1) };
+        run<scaleGeom::Voronoi2D, scaleGeom::Vector2d, scaleGeom::VoronoiCell2D>("2D", voronoi, nullptr);
+        run<scaleGeom::Voronoi2D, scaleGeom::Vector2d, scaleGeom::VoronoiCell2D>("2D, clipped", voronoi, box);
+    }
+    {
+        const std::vector<scaleGeom::Vector3f> sites = makeSites<scaleGeom::DIM3>(scaleGeom::bench::problemSize(2000000) / 4);
+        const scaleGeom::DelaunayMesh3D mesh = scaleGeom::delaunay3D(sites);
+        const scaleGeom::Voronoi3D voronoi(sites.data(), sites.size(), mesh);
+        const scaleGeom::Vector3d box[2] = { scaleGeom::Vector3d(0, 0, 0), scaleGeom::Vector3d(1, 1, 1) };
+        run<scaleGeom::Voronoi3D, scaleGeom::Vector3d, scaleGeom::VoronoiCell3D>("3D", voronoi, nullptr);
+        run<scaleGeom::Voronoi3D, scaleGeom::Vector3d, scaleGeom::VoronoiCell3D>("3D, clipped", voronoi, box);
+    }
+    checkLattice();
+}
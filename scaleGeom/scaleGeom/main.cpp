@@ -1,6 +1,13 @@
 #include "Vector.h" // Assuming the above file is saved as Vector.h
+#include "Benchmark.h"
+#include <cstring>
+
+int main(int argc, char** argv) {
+    // "scaleGeom bench [filter]" runs the registered benchmarks instead of the demo below.
+    if (argc > 1 && std::strcmp(argv[1], "bench") == 0) {
+        return scaleGeom::bench::runBenchmarks(argc > 2 ? argv[2] : nullptr) > 0 ? 0 : 1;
+    }
 
-int main() {
     // Create two 3D vectors of type int
     scaleGeom::Vector<float> vec1(5.1, 6.2, 8.3);
     scaleGeom::Vector<float> vec2(4.2, 5.1, 6.5);